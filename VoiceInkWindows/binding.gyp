@@ -1,14 +1,22 @@
 {
+  "variables": {
+    "count_allocations%": 0
+  },
   "targets": [
     {
       "target_name": "audiorecorder",
       "sources": [
-        "src/native/wasapi_recorder.cpp",
-        "src/native/wasapi_binding.cpp"
+        "src/native/capture_core.cpp",
+        "src/native/file_capture_source.cpp",
+        "src/native/synthetic_capture_source.cpp",
+        "src/native/utterance_endpoint_stage.cpp",
+        "src/native/echo_reference_stage.cpp",
+        "src/native/capture_binding.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
-        "src/native/audio-recorder"
+        "src/native/audio-recorder",
+        "src/native/common"
       ],
       "dependencies": [
         "<!(node -p \"require('node-addon-api').gyp\")"
@@ -17,7 +25,16 @@
       "cflags_cc!": ["-fno-exceptions"],
       "defines": ["NAPI_CPP_EXCEPTIONS"],
       "conditions": [
+        ["count_allocations==1", {
+          "defines": ["VOICEINK_COUNT_ALLOCATIONS"],
+          "conditions": [
+            ["OS=='linux'", {
+              "ldflags": ["-Wl,-Bsymbolic"]
+            }]
+          ]
+        }],
         ["OS=='win'", {
+          "sources": ["src/native/wasapi_capture_source.cpp"],
           "defines": ["_HAS_EXCEPTIONS=1", "WIN32_LEAN_AND_MEAN", "NOMINMAX"],
           "libraries": [
             "-lole32",
@@ -47,15 +64,47 @@
         }]
       ]
     },
+    {
+      "target_name": "audiodsp",
+      "sources": [
+        "src/native/audio_dsp_binding.cpp"
+      ],
+      "include_dirs": [
+        "<!@(node -p \"require('node-addon-api').include\")",
+        "src/native/common"
+      ],
+      "dependencies": [
+        "<!(node -p \"require('node-addon-api').gyp\")"
+      ],
+      "cflags!": ["-fno-exceptions"],
+      "cflags_cc!": ["-fno-exceptions"],
+      "defines": ["NAPI_CPP_EXCEPTIONS"],
+      "conditions": [
+        ["OS=='win'", {
+          "defines": ["_HAS_EXCEPTIONS=1"],
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "ExceptionHandling": 1,
+              "AdditionalOptions": ["/std:c++17"]
+            }
+          }
+        }],
+        ["OS!='win'", {
+          "cflags_cc": ["-std=c++17"]
+        }]
+      ]
+    },
     {
       "target_name": "whisperbinding",
       "sources": [
         "src/native/whisper_transcription.cpp",
+        "src/native/whisper_model_registry.cpp",
         "src/native/whisper_binding.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
-        "src/native/whisper-binding"
+        "src/native/whisper-binding",
+        "src/native/common"
       ],
       "dependencies": [
         "<!(node -p \"require('node-addon-api').gyp\")"
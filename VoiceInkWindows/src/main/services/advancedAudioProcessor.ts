@@ -7,6 +7,26 @@ import { EventEmitter } from 'events'
 import * as fs from 'fs'
 import * as path from 'path'
 
+interface NativeDsp {
+  suppressNoise(samples: Float32Array, options: { sampleRate: number, channels?: number, maxAttenuationDb?: number }): Float32Array
+}
+
+let nativeDsp: NativeDsp | null | undefined
+
+/**
+ * Load the native DSP module once; null if it has not been built
+ */
+function loadNativeDsp(): NativeDsp | null {
+  if (nativeDsp === undefined) {
+    try {
+      nativeDsp = require(path.join(__dirname, '../../build/Release/audiodsp.node'))
+    } catch (error) {
+      nativeDsp = null
+    }
+  }
+  return nativeDsp ?? null
+}
+
 export interface AudioProcessingConfig {
   // Noise reduction settings
   noiseReduction: {
@@ -414,13 +434,19 @@ registerProcessor('advanced-audio-processor', AdvancedAudioProcessorWorklet)
   }
 
   /**
-   * Apply noise reduction using spectral subtraction
+   * Apply noise reduction with the native spectral noise suppressor
    */
   private async applyNoiseReduction(audioBuffer: AudioBuffer): Promise<AudioBuffer> {
     if (!this.config.noiseReduction.enabled) {
       return audioBuffer
     }
 
+    const dsp = loadNativeDsp()
+    if (!dsp) {
+      console.log('⚠️ Native DSP module not available, skipping noise reduction')
+      return audioBuffer
+    }
+
     console.log('🔇 Applying noise reduction...')
     
     const processedBuffer = this.audioContext!.createBuffer(
@@ -429,148 +455,30 @@ registerProcessor('advanced-audio-processor', AdvancedAudioProcessorWorklet)
       audioBuffer.sampleRate
     )
 
+    const options = {
+      sampleRate: audioBuffer.sampleRate,
+      maxAttenuationDb: this.getMaxAttenuationDb()
+    }
     for (let channel = 0; channel < audioBuffer.numberOfChannels; channel++) {
-      const inputData = audioBuffer.getChannelData(channel)
-      const outputData = processedBuffer.getChannelData(channel)
-      
-      // Apply spectral subtraction
-      this.spectralSubtractionDenoising(inputData, outputData)
+      const denoised = dsp.suppressNoise(audioBuffer.getChannelData(channel), options)
+      processedBuffer.copyToChannel(denoised, channel)
     }
 
     return processedBuffer
   }
 
   /**
-   * Spectral subtraction denoising algorithm
-   */
-  private spectralSubtractionDenoising(input: Float32Array, output: Float32Array): void {
-    const frameSize = 1024
-    const overlap = frameSize / 2
-    const window = this.createHannWindow(frameSize)
-    
-    // Estimate noise from first 0.5 seconds
-    const noiseFrames = Math.floor(0.5 * input.length / frameSize)
-    const noiseSpectrum = this.estimateNoiseSpectrum(input, frameSize, noiseFrames)
-    
-    // Process audio in overlapping frames
-    for (let i = 0; i < input.length - frameSize; i += overlap) {
-      const frame = input.slice(i, i + frameSize)
-      
-      // Apply window
-      for (let j = 0; j < frameSize; j++) {
-        frame[j] *= window[j]
-      }
-      
-      // Apply spectral subtraction
-      const processedFrame = this.applySpectralSubtraction(frame, noiseSpectrum)
-      
-      // Overlap-add
-      for (let j = 0; j < frameSize && i + j < output.length; j++) {
-        output[i + j] += processedFrame[j] * window[j]
-      }
-    }
-  }
-
-  /**
-   * Create Hann window
-   */
-  private createHannWindow(size: number): Float32Array {
-    const window = new Float32Array(size)
-    for (let i = 0; i < size; i++) {
-      window[i] = 0.5 * (1 - Math.cos(2 * Math.PI * i / (size - 1)))
-    }
-    return window
-  }
-
-  /**
-   * Estimate noise spectrum from initial frames
-   */
-  private estimateNoiseSpectrum(signal: Float32Array, frameSize: number, numFrames: number): Float32Array {
-    const spectrum = new Float32Array(frameSize / 2)
-    
-    for (let frame = 0; frame < numFrames; frame++) {
-      const start = frame * frameSize
-      if (start + frameSize > signal.length) break
-      
-      const frameData = signal.slice(start, start + frameSize)
-      const frameSpectrum = this.simpleFFT(frameData)
-      
-      // Accumulate magnitude spectrum
-      for (let i = 0; i < spectrum.length; i++) {
-        spectrum[i] += Math.abs(frameSpectrum[i])
-      }
-    }
-    
-    // Average
-    for (let i = 0; i < spectrum.length; i++) {
-      spectrum[i] /= numFrames
-    }
-    
-    return spectrum
-  }
-
-  /**
-   * Apply spectral subtraction to a frame
+   * Get the deepest noise cut based on config
    */
-  private applySpectralSubtraction(frame: Float32Array, noiseSpectrum: Float32Array): Float32Array {
-    const spectrum = this.simpleFFT(frame)
-    const alpha = this.getSubtractionFactor()
-    const beta = 0.01 // Spectral floor
-    
-    // Apply spectral subtraction
-    for (let i = 0; i < spectrum.length; i++) {
-      const magnitude = Math.abs(spectrum[i])
-      const noise = noiseSpectrum[Math.min(i, noiseSpectrum.length - 1)]
-      
-      const reducedMagnitude = Math.max(
-        magnitude - alpha * noise,
-        beta * magnitude
-      )
-      
-      // Preserve phase, modify magnitude
-      const phase = Math.atan2(spectrum[i], spectrum[i])
-      spectrum[i] = reducedMagnitude * Math.cos(phase)
-    }
-    
-    return this.simpleIFFT(spectrum)
-  }
-
-  /**
-   * Get subtraction factor based on config
-   */
-  private getSubtractionFactor(): number {
+  private getMaxAttenuationDb(): number {
     switch (this.config.noiseReduction.level) {
-      case 'light': return 1.5
-      case 'moderate': return 2.0
-      case 'aggressive': return 3.0
-      default: return 2.0
+      case 'light': return 10
+      case 'moderate': return 18
+      case 'aggressive': return 25
+      default: return 18
     }
   }
 
-  /**
-   * Simple FFT implementation (placeholder - would use optimized FFT library)
-   */
-  private simpleFFT(signal: Float32Array): Float32Array {
-    // This is a simplified placeholder - real implementation would use FFTW or similar
-    const result = new Float32Array(signal.length)
-    for (let i = 0; i < signal.length; i++) {
-      result[i] = signal[i] // Placeholder
-    }
-    return result
-  }
-
-  /**
-   * Simple IFFT implementation (placeholder)
-   */
-  private simpleIFFT(spectrum: Float32Array): Float32Array {
-    // This is a simplified placeholder
-    const result = new Float32Array(spectrum.length)
-    for (let i = 0; i < spectrum.length; i++) {
-      result[i] = spectrum[i] // Placeholder
-    }
-    return result
-  }
-
   /**
    * Apply audio enhancement
    */
@@ -58,6 +58,8 @@ interface TranscriptionOptions {
   beamSize?: number
   initialPrompt?: string
   enableGPU?: boolean
+  // Aborting stops native inference and rejects with an AbortError
+  signal?: AbortSignal
 }
 
 class TranscriptionService extends EventEmitter {
@@ -239,10 +241,13 @@ class TranscriptionService extends EventEmitter {
     }
   }
 
-  async loadModel(modelId: string): Promise<void> {
+  async loadModel(modelId: string, options: { signal?: AbortSignal } = {}): Promise<void> {
     try {
       if (this.isUsingNative && this.nativeModule) {
-        await this.nativeModule.loadModel(modelId)
+        // Loads off the main thread; stages are mapping, tensors, warmup, ready
+        await this.nativeModule.loadModel(modelId, (progress: any) => {
+          this.emit('modelLoadProgress', { modelId, ...progress })
+        }, options)
       } else if (this.mockModule) {
         await this.mockModule.loadModel(modelId)
       } else {
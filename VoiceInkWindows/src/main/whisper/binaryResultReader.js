@@ -0,0 +1,135 @@
+/**
+ * Binary Result Reader
+ * Lazily decodes the flat transcription result buffer produced by the native
+ * bindings when called with `{ binary: true }`.
+ *
+ * Nothing is decoded up front: fields are read from a DataView on access and
+ * strings are decoded once, on first use. Layout is documented in
+ * src/native/common/binary_result_builder.h.
+ */
+
+const MAGIC = 0x52524956; // "VIRR"
+const VERSION = 1;
+const SEGMENT_SIZE = 40;
+const WORD_SIZE = 24;
+
+const decoder = new TextDecoder('utf-8');
+
+class BinaryTranscriptionResult {
+    /**
+     * @param {ArrayBuffer|ArrayBufferView} buffer
+     */
+    constructor(buffer) {
+        const view = ArrayBuffer.isView(buffer)
+            ? new DataView(buffer.buffer, buffer.byteOffset, buffer.byteLength)
+            : new DataView(buffer);
+
+        if (view.byteLength < 64 || view.getUint32(0, true) !== MAGIC) {
+            throw new Error('Not a binary transcription result');
+        }
+        const version = view.getUint16(4, true);
+        if (version !== VERSION) {
+            throw new Error(`Unsupported binary transcription result version ${version}`);
+        }
+        if (view.getUint32(8, true) > view.byteLength) {
+            throw new Error('Truncated binary transcription result');
+        }
+
+        this.view = view;
+        this.bytes = new Uint8Array(view.buffer, view.byteOffset, view.byteLength);
+        this.segmentCount = view.getUint32(12, true);
+        this.wordCount = view.getUint32(16, true);
+        this.stringCount = view.getUint32(20, true);
+        this.segmentsOffset = view.getUint32(24, true);
+        this.wordsOffset = view.getUint32(28, true);
+        this.stringOffsetsOffset = view.getUint32(32, true);
+        this.stringDataOffset = view.getUint32(36, true);
+        this.strings = new Array(this.stringCount);
+    }
+
+    get text() { return this.string(this.view.getUint32(40, true)); }
+    get language() { return this.string(this.view.getUint32(44, true)); }
+    get duration() { return this.view.getFloat64(48, true); }
+    get confidence() { return this.view.getFloat32(56, true); }
+    get processingTime() { return this.view.getFloat32(60, true); }
+
+    /**
+     * Decodes string `index` from the string table, caching the result.
+     */
+    string(index) {
+        let value = this.strings[index];
+        if (value === undefined) {
+            const offsets = this.stringOffsetsOffset + index * 4;
+            const start = this.stringDataOffset + this.view.getUint32(offsets, true);
+            const end = this.stringDataOffset + this.view.getUint32(offsets + 4, true);
+            value = decoder.decode(this.bytes.subarray(start, end));
+            this.strings[index] = value;
+        }
+        return value;
+    }
+
+    segment(index) {
+        if (index < 0 || index >= this.segmentCount) {
+            throw new RangeError(`Segment ${index} out of range`);
+        }
+        const v = this.view;
+        const o = this.segmentsOffset + index * SEGMENT_SIZE;
+        return {
+            startTime: v.getFloat64(o, true),
+            endTime: v.getFloat64(o + 8, true),
+            text: this.string(v.getUint32(o + 16, true)),
+            language: this.string(v.getUint32(o + 20, true)),
+            confidence: v.getFloat32(o + 24, true),
+            speakerId: v.getInt32(o + 28, true),
+            firstWord: v.getUint32(o + 32, true),
+            wordCount: v.getUint32(o + 36, true)
+        };
+    }
+
+    word(index) {
+        if (index < 0 || index >= this.wordCount) {
+            throw new RangeError(`Word ${index} out of range`);
+        }
+        const v = this.view;
+        const o = this.wordsOffset + index * WORD_SIZE;
+        return {
+            startTime: v.getFloat64(o, true),
+            endTime: v.getFloat64(o + 8, true),
+            text: this.string(v.getUint32(o + 16, true)),
+            confidence: v.getFloat32(o + 20, true)
+        };
+    }
+
+    /**
+     * Words of one segment.
+     */
+    wordsOf(segment) {
+        const words = new Array(segment.wordCount);
+        for (let i = 0; i < segment.wordCount; i++) {
+            words[i] = this.word(segment.firstWord + i);
+        }
+        return words;
+    }
+
+    /**
+     * Fully materialised result, in the same shape as the object path.
+     */
+    toObject() {
+        const segments = new Array(this.segmentCount);
+        for (let i = 0; i < this.segmentCount; i++) {
+            const { firstWord, wordCount, ...segment } = this.segment(i);
+            segment.words = this.wordsOf({ firstWord, wordCount });
+            segments[i] = segment;
+        }
+        return {
+            text: this.text,
+            language: this.language,
+            duration: this.duration,
+            confidence: this.confidence,
+            processingTime: this.processingTime,
+            segments
+        };
+    }
+}
+
+module.exports = { BinaryTranscriptionResult };
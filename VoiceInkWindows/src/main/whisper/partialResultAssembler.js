@@ -0,0 +1,76 @@
+/**
+ * Partial Result Assembler
+ * Rebuilds streaming transcripts from the deltas emitted by the native
+ * binding's setPartialResultCallback().
+ *
+ * Each delta carries only the segments committed since the previous delta
+ * plus a replacement for the unstable tail. `tailOffset` is the UTF-8 byte
+ * length of everything committed so far; a mismatch means a delta was lost
+ * and the stream must be resynchronised from a full result.
+ */
+
+class PartialResultAssembler {
+    constructor() {
+        this.streams = new Map();
+    }
+
+    /**
+     * Applies one delta. Returns the updated stream state, or throws if the
+     * delta does not line up with what has been assembled so far.
+     */
+    apply(streamId, delta) {
+        let state = this.streams.get(streamId);
+        if (!state) {
+            state = { segments: [], committedText: '', committedBytes: 0, tail: null, sequence: 0, isFinal: false };
+            this.streams.set(streamId, state);
+        }
+
+        if (delta.sequence <= state.sequence) {
+            return state; // Duplicate or stale delivery
+        }
+
+        for (const segment of delta.committed) {
+            state.segments.push(segment);
+            state.committedText += segment.text;
+            state.committedBytes += Buffer.byteLength(segment.text, 'utf8');
+        }
+
+        if (state.segments.length !== delta.committedCount || state.committedBytes !== delta.tailOffset) {
+            this.streams.delete(streamId);
+            throw new Error(`Partial result stream ${streamId} is out of sync at sequence ${delta.sequence}`);
+        }
+
+        state.tail = delta.tail;
+        state.sequence = delta.sequence;
+        state.isFinal = delta.isFinal;
+
+        if (state.isFinal) {
+            this.streams.delete(streamId);
+        }
+        return state;
+    }
+
+    /**
+     * Full transcript text for a stream: committed segments followed by the tail.
+     */
+    static textOf(state) {
+        return state.tail ? state.committedText + state.tail.text : state.committedText;
+    }
+
+    /**
+     * All segments, with the tail (if any) as the last entry.
+     */
+    static segmentsOf(state) {
+        return state.tail ? [...state.segments, state.tail] : state.segments.slice();
+    }
+
+    reset(streamId) {
+        if (streamId === undefined) {
+            this.streams.clear();
+        } else {
+            this.streams.delete(streamId);
+        }
+    }
+}
+
+module.exports = { PartialResultAssembler };
@@ -5,7 +5,11 @@
 
 #include <napi.h>
 #include "wasapi_recorder.h"
+#include "buffer_pool.h"
+#include "external_buffer.h"
 #include <iostream>
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 
 class AudioRecorder : public Napi::ObjectWrap<AudioRecorder> {
@@ -20,8 +24,11 @@ public:
             InstanceMethod("getDevices", &AudioRecorder::GetDevices),
             InstanceMethod("getLevel", &AudioRecorder::GetLevel),
             InstanceMethod("getAudioData", &AudioRecorder::GetAudioData),
-            InstanceMethod("saveToWAV", &AudioRecorder::SaveToWAV),
+            InstanceMethod("recordToFile", &AudioRecorder::RecordToFile),
+            InstanceMethod("getRecordingFileStats", &AudioRecorder::GetRecordingFileStats),
+            StaticMethod("recoverRecordingFile", &AudioRecorder::RecoverRecordingFile),
             InstanceMethod("clearBuffer", &AudioRecorder::ClearBuffer),
+            InstanceMethod("getBufferStats", &AudioRecorder::GetBufferStats),
             InstanceMethod("isRecording", &AudioRecorder::IsRecording),
             InstanceMethod("getLastError", &AudioRecorder::GetLastError)
         });
@@ -32,7 +39,8 @@ public:
 
     AudioRecorder(const Napi::CallbackInfo& info) 
         : Napi::ObjectWrap<AudioRecorder>(info)
-        , recorder_(std::make_unique<WASAPIRecorder>()) {
+        , recorder_(std::make_unique<WASAPIRecorder>())
+        , bufferPool_(std::make_shared<BufferPool<uint8_t>>()) {
         std::cout << "AudioRecorder: WASAPI instance created" << std::endl;
     }
 
@@ -45,6 +53,20 @@ public:
 
 private:
     std::unique_ptr<WASAPIRecorder> recorder_;
+    // Backing storage for returned Buffers; recycled by their finalizers
+    std::shared_ptr<BufferPool<uint8_t>> bufferPool_;
+
+    // Drains up to `maxBytes` of captured PCM straight into pooled storage
+    // and hands it to JS without a further copy.
+    Napi::Buffer<uint8_t> ReadAudioBuffer(Napi::Env env, size_t maxBytes) {
+        size_t available = (std::min)(maxBytes, recorder_->GetAvailableData());
+        
+        std::vector<uint8_t> storage = bufferPool_->Acquire(available);
+        storage.resize(available);
+        storage.resize(recorder_->GetAudioData(storage.data(), available));
+        
+        return MoveToBuffer(env, std::move(storage), bufferPool_);
+    }
 
     // Step 13: Initialize audio capture
     Napi::Value Initialize(const Napi::CallbackInfo& info) {
@@ -103,23 +125,13 @@ private:
         result.Set("success", Napi::Boolean::New(env, success));
         
         if (success) {
-            // Get available audio data size
-            const size_t maxBufferSize = 1024 * 1024; // 1MB
-            std::vector<uint8_t> tempBuffer(maxBufferSize);
-            size_t dataSize = recorder_->GetAudioData(tempBuffer.data(), maxBufferSize);
+            // Everything still buffered, moved into the returned Buffer
+            auto buffer = ReadAudioBuffer(env, SIZE_MAX);
+            size_t dataSize = buffer.Length();
             
-            // Create buffer with actual data
-            if (dataSize > 0) {
-                auto buffer = Napi::Buffer<uint8_t>::New(env, dataSize);
-                memcpy(buffer.Data(), tempBuffer.data(), dataSize);
-                result.Set("data", buffer);
-                result.Set("size", Napi::Number::New(env, dataSize));
-                result.Set("duration", Napi::Number::New(env, static_cast<double>(dataSize) / 32000.0)); // Approximate for 16kHz 16-bit mono
-            } else {
-                result.Set("data", Napi::Buffer<uint8_t>::New(env, 0));
-                result.Set("size", Napi::Number::New(env, 0));
-                result.Set("duration", Napi::Number::New(env, 0.0));
-            }
+            result.Set("data", buffer);
+            result.Set("size", Napi::Number::New(env, dataSize));
+            result.Set("duration", Napi::Number::New(env, static_cast<double>(dataSize) / 32000.0)); // Approximate for 16kHz 16-bit mono
         }
         
         return result;
@@ -169,37 +181,58 @@ private:
             requestedSize = info[0].As<Napi::Number>().Uint32Value();
         }
         
-        std::vector<uint8_t> buffer(requestedSize);
-        size_t actualSize = recorder_->GetAudioData(buffer.data(), requestedSize);
-        
-        if (actualSize > 0) {
-            auto resultBuffer = Napi::Buffer<uint8_t>::New(env, actualSize);
-            memcpy(resultBuffer.Data(), buffer.data(), actualSize);
-            return resultBuffer;
-        } else {
-            return Napi::Buffer<uint8_t>::New(env, 0);
-        }
+        return ReadAudioBuffer(env, requestedSize);
     }
 
     // Step 15: Save to WAV file
-    Napi::Value SaveToWAV(const Napi::CallbackInfo& info) {
+    // recordToFile(filename | null) - streams each following recording to
+    // `filename` from a background writer; call while stopped
+    Napi::Value RecordToFile(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
         
-        if (info.Length() < 1 || !info[0].IsString()) {
-            Napi::TypeError::New(env, "Filename required").ThrowAsJavaScriptException();
+        if (info.Length() < 1 || !(info[0].IsString() || info[0].IsNull() || info[0].IsUndefined())) {
+            Napi::TypeError::New(env, "Filename or null required").ThrowAsJavaScriptException();
             return env.Null();
         }
         
-        std::string filename = info[0].As<Napi::String>().Utf8Value();
-        bool success = recorder_->SaveToWAV(filename);
+        std::string filename = info[0].IsString() ? info[0].As<Napi::String>().Utf8Value() : std::string();
+        bool success = recorder_->RecordToFile(filename);
         
-        std::cout << "AudioRecorder: SaveToWAV(" << filename << ") - " << (success ? "SUCCESS" : "FAILED") << std::endl;
+        std::cout << "AudioRecorder: RecordToFile(" << filename << ") - " << (success ? "SUCCESS" : "FAILED") << std::endl;
         
-        if (!success) {
-            std::cout << "Error: " << recorder_->GetLastError() << std::endl;
+        return Napi::Boolean::New(env, success);
+    }
+
+    Napi::Value GetRecordingFileStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        RecordingFileStats stats = recorder_->GetRecordingFileStats();
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(stats.bytesWritten)));
+        result.Set("droppedBytes", Napi::Number::New(env, static_cast<double>(stats.droppedBytes)));
+        result.Set("headerUpdates", Napi::Number::New(env, static_cast<double>(stats.headerUpdates)));
+        result.Set("rf64", Napi::Boolean::New(env, stats.rf64));
+        result.Set("failed", Napi::Boolean::New(env, stats.failed));
+        return result;
+    }
+
+    // AudioRecorder.recoverRecordingFile(filename) - repairs the header of a
+    // recording left behind by a crash; returns the PCM bytes kept
+    static Napi::Value RecoverRecordingFile(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Filename required").ThrowAsJavaScriptException();
+            return env.Null();
         }
         
-        return Napi::Boolean::New(env, success);
+        uint64_t dataBytes = 0;
+        std::string error;
+        if (!WavFileWriter::Recover(info[0].As<Napi::String>().Utf8Value(), dataBytes, error)) {
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Number::New(env, static_cast<double>(dataBytes));
     }
 
     Napi::Value ClearBuffer(const Napi::CallbackInfo& info) {
@@ -209,6 +242,21 @@ private:
         return env.Undefined();
     }
 
+    // Byte counters of the capture ring; droppedOldest grows when JS reads
+    // too slowly to keep up with the device
+    Napi::Value GetBufferStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        RingBufferStats stats = recorder_->GetBufferStats();
+
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("written", Napi::Number::New(env, static_cast<double>(stats.written)));
+        result.Set("read", Napi::Number::New(env, static_cast<double>(stats.read)));
+        result.Set("droppedOldest", Napi::Number::New(env, static_cast<double>(stats.droppedOldest)));
+        result.Set("droppedNewest", Napi::Number::New(env, static_cast<double>(stats.droppedNewest)));
+        result.Set("available", Napi::Number::New(env, static_cast<double>(recorder_->GetAvailableData())));
+        return result;
+    }
+
     Napi::Value IsRecording(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
         return Napi::Boolean::New(env, recorder_->IsRecording());
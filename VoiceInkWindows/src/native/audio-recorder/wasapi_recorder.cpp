@@ -1,64 +1,9 @@
 #include "wasapi_recorder.h"
 #include <iostream>
-#include <fstream>
 #include <algorithm>
 #include <cmath>
 
-// Circular Buffer Implementation
-CircularBuffer::CircularBuffer(size_t size) 
-    : buffer_(size), head_(0), tail_(0), size_(size) {}
-
-CircularBuffer::~CircularBuffer() = default;
-
-bool CircularBuffer::Write(const void* data, size_t size) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (size > size_) return false;
-    
-    const uint8_t* src = static_cast<const uint8_t*>(data);
-    
-    for (size_t i = 0; i < size; ++i) {
-        buffer_[head_] = src[i];
-        head_ = (head_ + 1) % size_;
-        
-        // If buffer is full, move tail forward (overwrite old data)
-        if (head_ == tail_) {
-            tail_ = (tail_ + 1) % size_;
-        }
-    }
-    
-    return true;
-}
-
-size_t CircularBuffer::Read(void* data, size_t size) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    uint8_t* dst = static_cast<uint8_t*>(data);
-    size_t bytesRead = 0;
-    
-    while (bytesRead < size && tail_ != head_) {
-        dst[bytesRead] = buffer_[tail_];
-        tail_ = (tail_ + 1) % size_;
-        bytesRead++;
-    }
-    
-    return bytesRead;
-}
-
-size_t CircularBuffer::AvailableData() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (head_ >= tail_) {
-        return head_ - tail_;
-    } else {
-        return size_ - tail_ + head_;
-    }
-}
-
-void CircularBuffer::Clear() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    head_ = tail_ = 0;
-}
+static constexpr size_t kAudioBufferBytes = 1024 * 1024;
 
 // WASAPI Recorder Implementation
 WASAPIRecorder::WASAPIRecorder()
@@ -68,7 +13,7 @@ WASAPIRecorder::WASAPIRecorder()
     , captureClient_(nullptr)
     , recording_(false)
     , initialized_(false)
-    , audioBuffer_(std::make_unique<CircularBuffer>(1024 * 1024)) // 1MB buffer
+    , audioBuffer_(std::make_unique<SpscRingBuffer<uint8_t>>(kAudioBufferBytes))
     , currentLevel_(0.0f) {
     
     ZeroMemory(&audioFormat_, sizeof(audioFormat_));
@@ -209,6 +154,11 @@ bool WASAPIRecorder::Initialize(uint32_t sampleRate, uint16_t channels, uint16_t
     audioFormat_.nAvgBytesPerSec = sampleRate * audioFormat_.nBlockAlign;
     audioFormat_.cbSize = 0;
     
+    if (!recording_) {
+        audioBuffer_ = std::make_unique<SpscRingBuffer<uint8_t>>(
+            kAudioBufferBytes, RingOverflowPolicy::DropOldest, audioFormat_.nBlockAlign);
+    }
+    
     // Get audio client
     HRESULT hr = device_->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr, (void**)&audioClient_);
     if (FAILED(hr)) {
@@ -247,9 +197,23 @@ bool WASAPIRecorder::StartRecording() {
     
     audioBuffer_->Clear();
     
+    if (!recordingFilename_.empty()) {
+        RecordingFileFormat format;
+        format.encoding = SampleFormatFromWave(audioFormat_.wFormatTag, audioFormat_.nChannels, audioFormat_.wBitsPerSample,
+                                               audioFormat_.nBlockAlign, 0).encoding;
+        format.channels = audioFormat_.nChannels;
+        format.sampleRate = audioFormat_.nSamplesPerSec;
+        std::string error;
+        if (!recordingFile_.Open(recordingFilename_, format, error)) {
+            SetError(error);
+            return false;
+        }
+    }
+    
     HRESULT hr = audioClient_->Start();
     if (FAILED(hr)) {
         SetError("Failed to start audio client: " + HRESULTToString(hr));
+        recordingFile_.Close();
         return false;
     }
     
@@ -274,6 +238,11 @@ bool WASAPIRecorder::StopRecording() {
         audioClient_->Stop();
     }
     
+    if (recordingFile_.IsOpen() && !recordingFile_.Close()) {
+        SetError("Failed to write the recording to " + recordingFilename_);
+        return false;
+    }
+    
     return true;
 }
 
@@ -297,10 +266,12 @@ void WASAPIRecorder::RecordingThreadProc() {
                 
                 if (!(flags & AUDCLNT_BUFFERFLAGS_SILENT) && data && dataSize > 0) {
                     audioBuffer_->Write(data, dataSize);
+                    recordingFile_.Write(data, dataSize);
                     
                     // Calculate RMS level for monitoring
                     if (audioFormat_.wBitsPerSample == 16) {
-                        float level = CalculateRMSLevel(reinterpret_cast<const int16_t*>(data), numFramesAvailable);
+                        float level = CalculateRMSLevel(reinterpret_cast<const int16_t*>(data), numFramesAvailable,
+                                                        audioFormat_.nChannels);
                         currentLevel_.store(level);
                     }
                 }
@@ -314,47 +285,35 @@ void WASAPIRecorder::RecordingThreadProc() {
 }
 
 size_t WASAPIRecorder::GetAudioData(void* buffer, size_t bufferSize) {
-    return audioBuffer_->Read(buffer, bufferSize);
+    return audioBuffer_->Read(static_cast<uint8_t*>(buffer), bufferSize);
 }
 
-bool WASAPIRecorder::SaveToWAV(const std::string& filename) {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        SetError("Failed to open file for writing: " + filename);
-        return false;
-    }
-    
-    // Get all available audio data
-    size_t availableData = audioBuffer_->AvailableData();
-    if (availableData == 0) {
-        SetError("No audio data to save");
+size_t WASAPIRecorder::GetAvailableData() const {
+    return audioBuffer_->Available();
+}
+
+bool WASAPIRecorder::RecordToFile(const std::string& filename) {
+    if (recording_) {
+        SetError("Cannot change the recording file while recording");
         return false;
     }
     
-    std::vector<uint8_t> audioData(availableData);
-    size_t actualSize = audioBuffer_->Read(audioData.data(), availableData);
-    
-    // Write WAV header
-    WAVHeader header;
-    header.dataSize = static_cast<uint32_t>(actualSize);
-    header.fileSize = sizeof(WAVHeader) - 8 + header.dataSize;
-    header.sampleRate = audioFormat_.nSamplesPerSec;
-    header.byteRate = audioFormat_.nAvgBytesPerSec;
-    header.numChannels = audioFormat_.nChannels;
-    header.bitsPerSample = audioFormat_.wBitsPerSample;
-    header.blockAlign = audioFormat_.nBlockAlign;
-    
-    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
-    file.write(reinterpret_cast<const char*>(audioData.data()), actualSize);
-    file.close();
-    
+    recordingFilename_ = filename;
     return true;
 }
 
+RecordingFileStats WASAPIRecorder::GetRecordingFileStats() const {
+    return recordingFile_.Stats();
+}
+
 void WASAPIRecorder::ClearBuffer() {
     audioBuffer_->Clear();
 }
 
+RingBufferStats WASAPIRecorder::GetBufferStats() const {
+    return audioBuffer_->Stats();
+}
+
 float WASAPIRecorder::GetCurrentLevel() const {
     return currentLevel_.load();
 }
@@ -370,17 +329,12 @@ void WASAPIRecorder::SetError(const std::string& error) {
     std::cout << "WASAPI Error: " << error << std::endl;
 }
 
-float WASAPIRecorder::CalculateRMSLevel(const int16_t* samples, size_t sampleCount) {
-    if (!samples || sampleCount == 0) return 0.0f;
-    
-    double sum = 0.0;
-    for (size_t i = 0; i < sampleCount; ++i) {
-        double sample = samples[i] / 32768.0; // Normalize to [-1, 1]
-        sum += sample * sample;
-    }
-    
-    double rms = std::sqrt(sum / sampleCount);
-    return static_cast<float>(rms * 100.0); // Convert to percentage
+float WASAPIRecorder::CalculateRMSLevel(const int16_t* samples, size_t frameCount, size_t channels) {
+    if (!samples || frameCount == 0) return 0.0f;
+
+    // Every channel, scaled to [-1, 1) as it is read
+    const PacketStatistics stats = MeasurePacket(samples, frameCount, channels);
+    return stats.Rms() * 100.0f; // Convert to percentage
 }
 
 // Helper functions
@@ -9,42 +9,9 @@
 #include <vector>
 #include <memory>
 #include <mutex>
-
-// WAV file header structure
-struct WAVHeader {
-    char riff[4] = {'R', 'I', 'F', 'F'};
-    uint32_t fileSize;
-    char wave[4] = {'W', 'A', 'V', 'E'};
-    char fmt[4] = {'f', 'm', 't', ' '};
-    uint32_t fmtSize = 16;
-    uint16_t audioFormat = 1;  // PCM
-    uint16_t numChannels = 1;  // Mono
-    uint32_t sampleRate = 16000;
-    uint32_t byteRate = 32000;  // sampleRate * numChannels * bitsPerSample / 8
-    uint16_t blockAlign = 2;    // numChannels * bitsPerSample / 8
-    uint16_t bitsPerSample = 16;
-    char data[4] = {'d', 'a', 't', 'a'};
-    uint32_t dataSize;
-};
-
-// Circular buffer for audio data
-class CircularBuffer {
-public:
-    CircularBuffer(size_t size);
-    ~CircularBuffer();
-    
-    bool Write(const void* data, size_t size);
-    size_t Read(void* data, size_t size);
-    size_t AvailableData() const;
-    void Clear();
-
-private:
-    std::vector<uint8_t> buffer_;
-    size_t head_;
-    size_t tail_;
-    size_t size_;
-    mutable std::mutex mutex_;
-};
+#include "packet_statistics.h"
+#include "spsc_ring_buffer.h"
+#include "wav_file_writer.h"
 
 // WASAPI Audio Recorder
 class WASAPIRecorder {
@@ -64,8 +31,15 @@ public:
     
     // Audio data access
     size_t GetAudioData(void* buffer, size_t bufferSize);
-    bool SaveToWAV(const std::string& filename);
+    size_t GetAvailableData() const;
     void ClearBuffer();
+    RingBufferStats GetBufferStats() const;
+    
+    // Streams every following recording to `filename` as it is captured, in
+    // the capture format; an empty name turns it off. Only while stopped.
+    // The file is complete once StopRecording() returns.
+    bool RecordToFile(const std::string& filename);
+    RecordingFileStats GetRecordingFileStats() const;
     
     // Audio level monitoring
     float GetCurrentLevel() const;
@@ -88,8 +62,13 @@ private:
     std::atomic<bool> initialized_;
     std::thread recordingThread_;
     
-    // Audio buffer
-    std::unique_ptr<CircularBuffer> audioBuffer_;
+    // Captured PCM: written by the recording thread, read by the JS thread.
+    // When the reader falls behind the oldest audio is dropped, in whole frames.
+    std::unique_ptr<SpscRingBuffer<uint8_t>> audioBuffer_;
+    
+    // Recording file; opened by StartRecording(), closed by StopRecording()
+    std::string recordingFilename_;
+    WavFileWriter recordingFile_;
     
     // Error tracking
     mutable std::mutex errorMutex_;
@@ -103,7 +82,7 @@ private:
     bool InitializeCOM();
     void CleanupCOM();
     void SetError(const std::string& error);
-    float CalculateRMSLevel(const int16_t* samples, size_t sampleCount);
+    float CalculateRMSLevel(const int16_t* samples, size_t frameCount, size_t channels);
 };
 
 // Helper functions
@@ -0,0 +1,1196 @@
+#include <napi.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "capture_format_stage.h"
+#include "echo_canceller.h"
+#include "flac_encoder.h"
+#include "flac_reader.h"
+#include "gain_stage.h"
+#include "noise_suppressor.h"
+#include "packet_statistics.h"
+#include "polyphase_resampler.h"
+#include "promise_worker.h"
+#include "real_fft.h"
+#include "sample_format_converter.h"
+#include "utterance_endpointer.h"
+#include "wav_reader.h"
+
+// Platform-neutral DSP kernels shared by the capture and transcription paths.
+//
+// Nothing here depends on an audio device, so the module builds on every
+// platform and the kernels can be checked against reference implementations
+// in JS. The capture code includes the same headers directly.
+
+// Raw bytes from a Buffer, typed array or ArrayBuffer
+static bool GetBytes(const Napi::Value& value, const uint8_t*& data, size_t& length) {
+    if (value.IsTypedArray()) {
+        Napi::TypedArray array = value.As<Napi::TypedArray>();
+        data = static_cast<const uint8_t*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+        length = array.ByteLength();
+        return true;
+    }
+    if (value.IsArrayBuffer()) {
+        Napi::ArrayBuffer buffer = value.As<Napi::ArrayBuffer>();
+        data = static_cast<const uint8_t*>(buffer.Data());
+        length = buffer.ByteLength();
+        return true;
+    }
+    return false;
+}
+
+static SampleEncoding ParseEncoding(const std::string& name) {
+    if (name == "int16") return SampleEncoding::Int16;
+    if (name == "int24") return SampleEncoding::Int24;
+    if (name == "int32") return SampleEncoding::Int32;
+    if (name == "float32") return SampleEncoding::Float32;
+    return SampleEncoding::Unknown;
+}
+
+// convertSamples(bytes, { encoding: 'int16' | 'int24' | 'int32' | 'float32', channels })
+// Returns the interleaved samples as a Float32Array.
+static Napi::Value ConvertSamples(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    if (info.Length() < 2 || !GetBytes(info[0], data, length) || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected (bytes, { encoding, channels })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[1].As<Napi::Object>();
+    SampleFormat format;
+    format.encoding = ParseEncoding(options.Get("encoding").ToString().Utf8Value());
+    format.channels = static_cast<uint16_t>(options.Get("channels").ToNumber().Uint32Value());
+
+    const SampleConverter converter = SelectSampleConverter(format);
+    if (!converter.Valid()) {
+        Napi::TypeError::New(env, "Unsupported sample format").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const size_t frames = length / format.BytesPerFrame();
+    Napi::Float32Array samples = Napi::Float32Array::New(env, frames * format.channels);
+    if (frames > 0) {
+        converter.Convert(data, samples.Data(), frames);
+    }
+    return samples;
+}
+
+// parseWaveFormat({ formatTag, channels, bitsPerSample, blockAlign, subFormatTag? })
+// Returns the encoding the capture path would pick for a WAVEFORMATEX, or null.
+static Napi::Value ParseWaveFormat(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected a wave format object").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object wave = info[0].As<Napi::Object>();
+    auto field = [&wave](const char* name) { return wave.Get(name).ToNumber().Uint32Value(); };
+    const SampleFormat format = SampleFormatFromWave(
+        static_cast<uint16_t>(field("formatTag")), static_cast<uint16_t>(field("channels")),
+        static_cast<uint16_t>(field("bitsPerSample")), static_cast<uint16_t>(field("blockAlign")),
+        wave.Has("subFormatTag") ? field("subFormatTag") : 0);
+
+    static const char* const kNames[] = { nullptr, "int16", "int24", "int32", "float32" };
+    const char* name = kNames[static_cast<size_t>(format.encoding)];
+    if (!format.Valid() || !name) {
+        return env.Null();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("encoding", Napi::String::New(env, name));
+    result.Set("channels", Napi::Number::New(env, format.channels));
+    return result;
+}
+
+// Float samples from a Float32Array
+static bool GetSamples(const Napi::Value& value, const float*& data, size_t& count) {
+    if (!value.IsTypedArray() || value.As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        return false;
+    }
+    Napi::Float32Array array = value.As<Napi::Float32Array>();
+    data = array.Data();
+    count = array.ElementLength();
+    return true;
+}
+
+// resample(samples: Float32Array, inputRate, outputRate)
+// Resamples a whole mono clip, aligned with the input, as transcription does.
+static Napi::Value Resample(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const float* data = nullptr;
+    size_t count = 0;
+    if (info.Length() < 3 || !GetSamples(info[0], data, count) || !info[1].IsNumber() || !info[2].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (Float32Array, inputRate, outputRate)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const uint32_t inputRate = info[1].As<Napi::Number>().Uint32Value();
+    const uint32_t outputRate = info[2].As<Napi::Number>().Uint32Value();
+    if (inputRate == 0 || outputRate == 0) {
+        Napi::RangeError::New(env, "Sample rates must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const std::vector<float> resampled = PolyphaseResampler::ResampleClip(data, count, inputRate, outputRate);
+    Napi::Float32Array result = Napi::Float32Array::New(env, resampled.size());
+    std::copy(resampled.begin(), resampled.end(), result.Data());
+    return result;
+}
+
+// formatCapture(samples: Float32Array, { inputRate, channels, outputRate?, downmix?, channel?, packetFrames? })
+// Runs interleaved frames through the recorder's capture stage in packets of
+// `packetFrames`, exactly as the capture thread would, and returns the output.
+static Napi::Value FormatCapture(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const float* data = nullptr;
+    size_t count = 0;
+    if (info.Length() < 2 || !GetSamples(info[0], data, count) || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected (Float32Array, { inputRate, channels })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[1].As<Napi::Object>();
+    auto number = [&options](const char* name, uint32_t fallback) {
+        return options.Has(name) ? options.Get(name).ToNumber().Uint32Value() : fallback;
+    };
+    const uint32_t inputRate = number("inputRate", 0);
+    const unsigned channels = number("channels", 0);
+    if (inputRate == 0 || channels == 0) {
+        Napi::RangeError::New(env, "inputRate and channels must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    CaptureOutputFormat format;
+    format.sampleRate = number("outputRate", format.sampleRate);
+    format.channel = number("channel", 0);
+    const std::string downmix = options.Has("downmix") ? options.Get("downmix").ToString().Utf8Value() : "average";
+    if (downmix == "average") {
+        format.downmix = DownmixMode::Average;
+    } else if (downmix == "channel") {
+        format.downmix = DownmixMode::SelectChannel;
+    } else if (downmix == "none") {
+        format.downmix = DownmixMode::None;
+    } else {
+        Napi::TypeError::New(env, "downmix must be 'average', 'channel' or 'none'").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!format.Valid()) {
+        Napi::RangeError::New(env, "Resampling requires a downmix to mono").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const size_t frames = count / channels;
+    const size_t packetFrames = (std::max)(number("packetFrames", 480), 1u);
+    CaptureFormatStage stage(channels, inputRate, format);
+    std::vector<float> output(stage.MaxOutputFrames(frames) * stage.OutputChannels() + stage.MaxOutputFrames(packetFrames));
+
+    size_t produced = 0;
+    for (size_t offset = 0; offset < frames; offset += packetFrames) {
+        const size_t packet = (std::min)(packetFrames, frames - offset);
+        produced += stage.Process(data + offset * channels, packet, output.data() + produced * stage.OutputChannels());
+    }
+
+    Napi::Float32Array result = Napi::Float32Array::New(env, produced * stage.OutputChannels());
+    std::copy(output.begin(), output.begin() + result.ElementLength(), result.Data());
+    return result;
+}
+
+// segmentUtterances(samples: Float32Array, { sampleRate, thresholdDb?, releaseDb?, minLevelDb?, frameMs?,
+//                    onsetMs?, hangoverMs?, minSpeechMs?, maxUtteranceMs?, preSpeechMs?, postSpeechMs? })
+// Runs the capture endpointer over a mono clip; returns the kept utterances
+// as [{ start, end }] sample offsets, padding included.
+static Napi::Value SegmentUtterances(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const float* data = nullptr;
+    size_t count = 0;
+    if (info.Length() < 2 || !GetSamples(info[0], data, count) || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected (Float32Array, { sampleRate })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[1].As<Napi::Object>();
+    EndpointerConfig config;
+    auto number = [&](const char* name, uint32_t fallback) {
+        return options.Has(name) ? options.Get(name).ToNumber().Uint32Value() : fallback;
+    };
+    auto level = [&](const char* name, float fallback) {
+        return options.Has(name) ? options.Get(name).ToNumber().FloatValue() : fallback;
+    };
+    config.sampleRate = number("sampleRate", 0);
+    config.frameMs = number("frameMs", config.frameMs);
+    if (config.sampleRate == 0 || config.frameMs == 0) {
+        Napi::RangeError::New(env, "sampleRate and frameMs must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    config.thresholdDb = level("thresholdDb", config.thresholdDb);
+    config.releaseDb = level("releaseDb", config.releaseDb);
+    config.minLevelDb = level("minLevelDb", config.minLevelDb);
+    config.onsetMs = number("onsetMs", config.onsetMs);
+    config.hangoverMs = number("hangoverMs", config.hangoverMs);
+    config.minSpeechMs = number("minSpeechMs", config.minSpeechMs);
+    config.maxUtteranceMs = number("maxUtteranceMs", config.maxUtteranceMs);
+    config.preSpeechMs = number("preSpeechMs", config.preSpeechMs);
+    config.postSpeechMs = number("postSpeechMs", config.postSpeechMs);
+
+    UtteranceEndpointer endpointer(config);
+    Napi::Array segments = Napi::Array::New(env);
+    uint32_t segmentCount = 0;
+    auto record = [&](EndpointEvent event) {
+        if (event != EndpointEvent::End) {
+            return;
+        }
+        Napi::Object segment = Napi::Object::New(env);
+        segment.Set("start", Napi::Number::New(env, static_cast<double>(endpointer.UtteranceStart())));
+        segment.Set("end", Napi::Number::New(env, static_cast<double>(endpointer.UtteranceEnd())));
+        segments.Set(segmentCount++, segment);
+    };
+
+    const size_t frameSamples = endpointer.FrameSamples();
+    for (size_t offset = 0; offset + frameSamples <= count; offset += frameSamples) {
+        record(endpointer.ProcessFrame(data + offset));
+    }
+    record(endpointer.Finish());
+    return segments;
+}
+
+// suppressNoise(samples: Float32Array, { sampleRate, channels?, maxAttenuationDb?, noiseWindowMs?, hopMs? })
+// Runs the capture noise suppressor over a whole interleaved clip and returns
+// the result, shifted back by the suppressor's latency so it lines up with
+// the input.
+static Napi::Value SuppressNoise(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const float* data = nullptr;
+    size_t count = 0;
+    if (info.Length() < 2 || !GetSamples(info[0], data, count) || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected (Float32Array, { sampleRate })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[1].As<Napi::Object>();
+    auto number = [&options](const char* name, uint32_t fallback) {
+        return options.Has(name) ? options.Get(name).ToNumber().Uint32Value() : fallback;
+    };
+    NoiseSuppressorConfig config;
+    config.sampleRate = number("sampleRate", 0);
+    config.hopMs = number("hopMs", config.hopMs);
+    config.noiseWindowMs = number("noiseWindowMs", config.noiseWindowMs);
+    if (options.Has("maxAttenuationDb")) {
+        config.maxAttenuationDb = options.Get("maxAttenuationDb").ToNumber().FloatValue();
+    }
+    const uint32_t channels = number("channels", 1);
+    if (config.sampleRate == 0 || config.hopMs == 0 || config.noiseWindowMs == 0 || channels == 0) {
+        Napi::RangeError::New(env, "sampleRate, channels, hopMs and noiseWindowMs must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    NoiseSuppressor suppressor(config, channels);
+    const size_t frames = count / channels;
+    const size_t latency = suppressor.LatencyFrames();
+
+    // Flushed with silence so the last frames come out too
+    std::vector<float> samples((frames + latency) * channels, 0.0f);
+    std::copy(data, data + frames * channels, samples.begin());
+    suppressor.Process(samples.data(), frames + latency);
+
+    Napi::Float32Array result = Napi::Float32Array::New(env, frames * channels);
+    std::copy(samples.begin() + latency * channels, samples.end(), result.Data());
+    return result;
+}
+
+// Options shared by applyGainStage() and benchmarkGainStage()
+static GainStageConfig ParseGainStageConfig(const Napi::Object& options) {
+    GainStageConfig config;
+    auto number = [&options](const char* name, float fallback) {
+        return options.Has(name) ? options.Get(name).ToNumber().FloatValue() : fallback;
+    };
+    config.sampleRate = options.Has("sampleRate") ? options.Get("sampleRate").ToNumber().Uint32Value() : 0;
+    config.targetDb = number("targetDb", config.targetDb);
+    config.maxGainDb = number("maxGainDb", config.maxGainDb);
+    config.ceilingDb = number("ceilingDb", config.ceilingDb);
+    return config;
+}
+
+// applyGainStage(samples: Float32Array, { sampleRate, channels?, gain?, agc?, targetDb?, maxGainDb?, ceilingDb? })
+// Runs the capture gain stage over a whole interleaved clip and returns the
+// result lined up with the input, as suppressNoise() does.
+static Napi::Value ApplyGainStage(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const float* data = nullptr;
+    size_t count = 0;
+    if (info.Length() < 2 || !GetSamples(info[0], data, count) || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected (Float32Array, { sampleRate })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[1].As<Napi::Object>();
+    const GainStageConfig config = ParseGainStageConfig(options);
+    const uint32_t channels = options.Has("channels") ? options.Get("channels").ToNumber().Uint32Value() : 1;
+    if (config.sampleRate == 0 || channels == 0) {
+        Napi::RangeError::New(env, "sampleRate and channels must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    GainStage stage(config, channels);
+    stage.SetGain(options.Has("gain") ? options.Get("gain").ToNumber().FloatValue() : 1.0f);
+    stage.SetAgcEnabled(options.Has("agc") && options.Get("agc").ToBoolean().Value());
+    stage.Reset();
+    const size_t frames = count / channels;
+    const size_t latency = stage.LatencyFrames();
+
+    std::vector<float> samples((frames + latency) * channels, 0.0f);
+    std::copy(data, data + frames * channels, samples.begin());
+    stage.Process(samples.data(), frames + latency);
+
+    Napi::Float32Array result = Napi::Float32Array::New(env, frames * channels);
+    std::copy(samples.begin() + latency * channels, samples.end(), result.Data());
+    return result;
+}
+
+// The chain GainStage replaced: manual gain, then one AGC gain per packet
+// from the packet's RMS. The baseline for benchmarkGainStage().
+static void ReferencePacketGain(float* samples, size_t sampleCount, float gainLevel) {
+    if (gainLevel != 1.0f) {
+        for (size_t i = 0; i < sampleCount; i++) {
+            samples[i] *= gainLevel;
+        }
+    }
+
+    float rms = 0.0f;
+    for (size_t i = 0; i < sampleCount; i++) {
+        rms += samples[i] * samples[i];
+    }
+    rms = std::sqrt(rms / sampleCount);
+    if (rms > 0.001f) {
+        const float gain = (std::max)(0.1f, (std::min)(4.0f, 0.3f / rms));
+        for (size_t i = 0; i < sampleCount; i++) {
+            samples[i] *= gain;
+        }
+    }
+}
+
+// benchmarkGainStage({ sampleRate, channels?, packetFrames?, seconds?, gain?, agc? })
+// Times GainStage against ReferencePacketGain() packet by packet over the
+// same synthetic speech and returns { seconds, nanosPerChannelSecond,
+// referenceNanosPerChannelSecond }.
+static Napi::Value BenchmarkGainStage(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected ({ sampleRate })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+    auto number = [&options](const char* name, uint32_t fallback) {
+        return options.Has(name) ? options.Get(name).ToNumber().Uint32Value() : fallback;
+    };
+    const GainStageConfig config = ParseGainStageConfig(options);
+    const uint32_t channels = number("channels", 1);
+    const size_t packetFrames = number("packetFrames", config.sampleRate / 100);
+    const uint32_t seconds = (std::max)(number("seconds", 10), 1u);
+    const float gain = options.Has("gain") ? options.Get("gain").ToNumber().FloatValue() : 1.0f;
+    const bool agc = !options.Has("agc") || options.Get("agc").ToBoolean().Value();
+    if (config.sampleRate == 0 || channels == 0 || packetFrames == 0) {
+        Napi::RangeError::New(env, "sampleRate, channels and packetFrames must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    // A tone pulsing at a syllable rate, swinging 30 dB every second
+    const size_t frames = static_cast<size_t>(seconds) * config.sampleRate;
+    std::vector<float> input(frames * channels);
+    for (size_t i = 0; i < frames; i++) {
+        const double t = static_cast<double>(i) / config.sampleRate;
+        const double level = (i / config.sampleRate) % 2 == 0 ? 0.5 : 0.016;
+        const double envelope = 0.5 - 0.5 * std::cos(2.0 * 3.14159265358979323846 * 4.0 * t);
+        for (uint32_t c = 0; c < channels; c++) {
+            input[i * channels + c] = static_cast<float>(level * envelope * std::sin(2.0 * 3.14159265358979323846 * 220.0 * (c + 1) * t));
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    std::vector<float> samples(input);
+    GainStage stage(config, channels);
+    stage.SetGain(gain);
+    stage.SetAgcEnabled(agc);
+    stage.Reset();
+    const Clock::time_point stageStart = Clock::now();
+    for (size_t offset = 0; offset < frames; offset += packetFrames) {
+        stage.Process(samples.data() + offset * channels, (std::min)(packetFrames, frames - offset));
+    }
+    const double stageNanos = std::chrono::duration<double, std::nano>(Clock::now() - stageStart).count();
+
+    samples = input;
+    const Clock::time_point referenceStart = Clock::now();
+    for (size_t offset = 0; offset < frames; offset += packetFrames) {
+        ReferencePacketGain(samples.data() + offset * channels, (std::min)(packetFrames, frames - offset) * channels, gain);
+    }
+    const double referenceNanos = std::chrono::duration<double, std::nano>(Clock::now() - referenceStart).count();
+
+    const double channelSeconds = static_cast<double>(seconds) * channels;
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("seconds", Napi::Number::New(env, seconds));
+    result.Set("nanosPerChannelSecond", Napi::Number::New(env, stageNanos / channelSeconds));
+    result.Set("referenceNanosPerChannelSecond", Napi::Number::New(env, referenceNanos / channelSeconds));
+    return result;
+}
+
+// cancelEcho(mic: Float32Array, reference: Float32Array, { sampleRate, channels?, tailMs?, maxDelayMs?, stepSize? })
+// Runs the capture echo canceller over an interleaved microphone clip with
+// the mono far-end `reference` that played over the same stretch of time,
+// 10 ms at a time as capture would. Returns { samples, delayMs, delayLocked,
+// erleDb, nanosPerSecond }; `samples` is lined up with the input, and the
+// rest is the canceller's state at the end of the clip.
+static Napi::Value CancelEcho(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const float* micData = nullptr;
+    const float* referenceData = nullptr;
+    size_t micCount = 0;
+    size_t referenceCount = 0;
+    if (info.Length() < 3 || !GetSamples(info[0], micData, micCount) || !GetSamples(info[1], referenceData, referenceCount) ||
+        !info[2].IsObject()) {
+        Napi::TypeError::New(env, "Expected (Float32Array, Float32Array, { sampleRate })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object options = info[2].As<Napi::Object>();
+    auto number = [&options](const char* name, uint32_t fallback) {
+        return options.Has(name) ? options.Get(name).ToNumber().Uint32Value() : fallback;
+    };
+    EchoCancellerConfig config;
+    config.sampleRate = number("sampleRate", 0);
+    config.tailMs = number("tailMs", config.tailMs);
+    config.maxDelayMs = number("maxDelayMs", config.maxDelayMs);
+    if (options.Has("stepSize")) {
+        config.stepSize = options.Get("stepSize").ToNumber().FloatValue();
+    }
+    const uint32_t channels = number("channels", 1);
+    if (config.sampleRate == 0 || channels == 0 || config.tailMs == 0) {
+        Napi::RangeError::New(env, "sampleRate, channels and tailMs must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    EchoCanceller canceller(config, channels);
+    const size_t frames = micCount / channels;
+    const size_t latency = canceller.LatencyFrames();
+    const size_t packetFrames = (std::max<size_t>)(config.sampleRate / 100, 1);
+
+    // Both flushed with silence so the last frames come out too; a short
+    // reference is silent past its end
+    std::vector<float> samples((frames + latency) * channels, 0.0f);
+    std::copy(micData, micData + frames * channels, samples.begin());
+    std::vector<float> reference(frames + latency, 0.0f);
+    std::copy(referenceData, referenceData + (std::min)(referenceCount, frames), reference.begin());
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    for (size_t offset = 0; offset < frames + latency; offset += packetFrames) {
+        const size_t count = (std::min)(packetFrames, frames + latency - offset);
+        canceller.Process(samples.data() + offset * channels, reference.data() + offset, count);
+    }
+    const double nanos = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+    const EchoCancellerStats stats = canceller.Stats();
+    Napi::Float32Array output = Napi::Float32Array::New(env, frames * channels);
+    std::copy(samples.begin() + latency * channels, samples.end(), output.Data());
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("samples", output);
+    result.Set("delayMs", Napi::Number::New(env, static_cast<double>(stats.delayFrames) * 1000.0 / config.sampleRate));
+    result.Set("delayLocked", Napi::Boolean::New(env, stats.delayLocked));
+    result.Set("erleDb", Napi::Number::New(env, stats.erleDb));
+    result.Set("nanosPerSecond", Napi::Number::New(env, frames > 0 ? nanos * config.sampleRate / static_cast<double>(frames) : 0.0));
+    return result;
+}
+
+static bool IsFftSize(size_t size) {
+    return size >= 4 && (size & (size - 1)) == 0;
+}
+
+// fft(samples: Float32Array) with a power-of-two length of at least 4.
+// Returns bins 0..length/2 as interleaved (re, im) pairs.
+static Napi::Value Fft(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const float* data = nullptr;
+    size_t count = 0;
+    if (info.Length() < 1 || !GetSamples(info[0], data, count)) {
+        Napi::TypeError::New(env, "Expected a Float32Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!IsFftSize(count)) {
+        Napi::RangeError::New(env, "Length must be a power of two of at least 4").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    RealFft fft(count);
+    Napi::Float32Array result = Napi::Float32Array::New(env, 2 * fft.Bins());
+    fft.Forward(data, reinterpret_cast<RealFft::Complex*>(result.Data()));
+    return result;
+}
+
+// ifft(spectrum: Float32Array) with (re, im) pairs for bins 0..n/2, as fft() returns.
+// Returns the n real samples.
+static Napi::Value Ifft(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const float* data = nullptr;
+    size_t count = 0;
+    if (info.Length() < 1 || !GetSamples(info[0], data, count)) {
+        Napi::TypeError::New(env, "Expected a Float32Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    const size_t size = count >= 2 ? count - 2 : 0;
+    if (count % 2 != 0 || !IsFftSize(size)) {
+        Napi::RangeError::New(env, "Expected n/2 + 1 bins for a power of two n of at least 4").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    RealFft fft(size);
+    std::vector<RealFft::Complex> spectrum(fft.Bins());
+    std::copy(data, data + count, reinterpret_cast<float*>(spectrum.data()));
+    Napi::Float32Array result = Napi::Float32Array::New(env, size);
+    fft.Inverse(spectrum.data(), result.Data());
+    return result;
+}
+
+// Textbook iterative radix-2 FFT of the real input as a complex sequence,
+// twiddles by recurrence; the baseline for benchmarkFft()
+static void ReferenceFft(std::vector<std::complex<float>>& data) {
+    const size_t size = data.size();
+    for (size_t i = 1, j = 0; i < size; i++) {
+        size_t bit = size >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+    for (size_t length = 2; length <= size; length <<= 1) {
+        const double angle = -2.0 * 3.14159265358979323846 / static_cast<double>(length);
+        const std::complex<float> step(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+        for (size_t start = 0; start < size; start += length) {
+            std::complex<float> w(1.0f, 0.0f);
+            for (size_t j = 0; j < length / 2; j++) {
+                const std::complex<float> u = data[start + j];
+                const std::complex<float> v = data[start + j + length / 2] * w;
+                data[start + j] = u + v;
+                data[start + j + length / 2] = u - v;
+                w *= step;
+            }
+        }
+    }
+}
+
+// benchmarkFft(size, iterations?)
+// Times RealFft::Forward() against ReferenceFft() on the same noise and
+// returns { size, iterations, nanosPerTransform, referenceNanosPerTransform,
+// maxError } with maxError relative to the largest bin.
+static Napi::Value BenchmarkFft(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected (size, iterations?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    const size_t size = info[0].As<Napi::Number>().Uint32Value();
+    const uint32_t iterations = info.Length() > 1 && info[1].IsNumber()
+        ? (std::max)(info[1].As<Napi::Number>().Uint32Value(), 1u) : 1000;
+    if (!IsFftSize(size)) {
+        Napi::RangeError::New(env, "Size must be a power of two of at least 4").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::vector<float> input(size);
+    uint32_t seed = 12345;
+    for (float& sample : input) {
+        seed = seed * 1103515245u + 12345u;
+        sample = static_cast<float>(seed >> 8) / 8388608.0f - 1.0f;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    RealFft fft(size);
+    std::vector<RealFft::Complex> spectrum(fft.Bins());
+    fft.Forward(input.data(), spectrum.data());
+    const Clock::time_point fastStart = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        fft.Forward(input.data(), spectrum.data());
+    }
+    const double fastNanos = std::chrono::duration<double, std::nano>(Clock::now() - fastStart).count();
+
+    // The reference transforms a copy each time, as callers of a complex FFT
+    // with real input have to
+    std::vector<std::complex<float>> reference(size);
+    const Clock::time_point referenceStart = Clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        std::copy(input.begin(), input.end(), reference.begin());
+        ReferenceFft(reference);
+    }
+    const double referenceNanos = std::chrono::duration<double, std::nano>(Clock::now() - referenceStart).count();
+
+    double maxError = 0.0;
+    double maxMagnitude = 0.0;
+    for (size_t k = 0; k < spectrum.size(); k++) {
+        maxError = (std::max)(maxError, static_cast<double>(std::abs(spectrum[k] - reference[k])));
+        maxMagnitude = (std::max)(maxMagnitude, static_cast<double>(std::abs(reference[k])));
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("size", Napi::Number::New(env, static_cast<double>(size)));
+    result.Set("iterations", Napi::Number::New(env, iterations));
+    result.Set("nanosPerTransform", Napi::Number::New(env, fastNanos / iterations));
+    result.Set("referenceNanosPerTransform", Napi::Number::New(env, referenceNanos / iterations));
+    result.Set("maxError", Napi::Number::New(env, maxMagnitude > 0.0 ? maxError / maxMagnitude : maxError));
+    return result;
+}
+
+// measurePacket(samples: Float32Array | Int16Array, channels = 1)
+// Returns { sampleCount, rms, peak, dcOffset, zeroCrossings, zeroCrossingRate }
+// for interleaved samples, as the capture thread measures each block.
+static Napi::Value MeasurePacketStatistics(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected (Float32Array | Int16Array, channels?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    const uint32_t channels = info.Length() > 1 && info[1].IsNumber() ? info[1].As<Napi::Number>().Uint32Value() : 1;
+    if (channels == 0) {
+        Napi::RangeError::New(env, "channels must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::TypedArray array = info[0].As<Napi::TypedArray>();
+    PacketStatistics stats;
+    if (array.TypedArrayType() == napi_float32_array) {
+        Napi::Float32Array samples = array.As<Napi::Float32Array>();
+        stats = MeasurePacket(samples.Data(), samples.ElementLength() / channels, channels);
+    } else if (array.TypedArrayType() == napi_int16_array) {
+        Napi::Int16Array samples = array.As<Napi::Int16Array>();
+        stats = MeasurePacket(samples.Data(), samples.ElementLength() / channels, channels);
+    } else {
+        Napi::TypeError::New(env, "Expected a Float32Array or Int16Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("sampleCount", Napi::Number::New(env, static_cast<double>(stats.sampleCount)));
+    result.Set("rms", Napi::Number::New(env, stats.Rms()));
+    result.Set("peak", Napi::Number::New(env, stats.peak));
+    result.Set("dcOffset", Napi::Number::New(env, stats.DcOffset()));
+    result.Set("zeroCrossings", Napi::Number::New(env, stats.zeroCrossings));
+    result.Set("zeroCrossingRate", Napi::Number::New(env, stats.ZeroCrossingRate()));
+    return result;
+}
+
+// The scans the capture thread made of every block before PacketStatistics:
+// the meter's RMS and peak, then VAD's and AGC's RMS again. The float
+// baseline for benchmarkPacketStatistics().
+static float ReferencePacketScans(const float* samples, size_t frameCount, size_t channels) {
+    float sumSquares = 0.0f;
+    float peak = 0.0f;
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+        for (size_t ch = 0; ch < channels; ++ch) {
+            const float sample = samples[frame * channels + ch];
+            sumSquares += sample * sample;
+            peak = (std::max)(peak, std::abs(sample));
+        }
+    }
+    const size_t sampleCount = frameCount * channels;
+    float vad = 0.0f;
+    for (size_t i = 0; i < sampleCount; i++) {
+        vad += samples[i] * samples[i];
+    }
+    float agc = 0.0f;
+    for (size_t i = 0; i < sampleCount; i++) {
+        agc += samples[i] * samples[i];
+    }
+    return std::sqrt(sumSquares / sampleCount) + peak + std::sqrt(vad / sampleCount) + std::sqrt(agc / sampleCount);
+}
+
+// The recorder's level before PacketStatistics, in double precision. The
+// int16 baseline for benchmarkPacketStatistics().
+static float ReferenceInt16Rms(const int16_t* samples, size_t sampleCount) {
+    double sum = 0.0;
+    for (size_t i = 0; i < sampleCount; ++i) {
+        const double sample = samples[i] / 32768.0;
+        sum += sample * sample;
+    }
+    return static_cast<float>(std::sqrt(sum / sampleCount) * 100.0);
+}
+
+// benchmarkPacketStatistics({ sampleRate, channels?, packetFrames?, seconds? })
+// Times MeasurePacket() against the separate scans it replaced, packet by
+// packet over the same noisy tone, for float and int16 samples. Returns
+// { seconds, nanosPerChannelSecond, referenceNanosPerChannelSecond,
+// int16NanosPerChannelSecond, int16ReferenceNanosPerChannelSecond }.
+static Napi::Value BenchmarkPacketStatistics(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected ({ sampleRate })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+    auto number = [&options](const char* name, uint32_t fallback) {
+        return options.Has(name) ? options.Get(name).ToNumber().Uint32Value() : fallback;
+    };
+    const uint32_t sampleRate = number("sampleRate", 0);
+    const uint32_t channels = number("channels", 1);
+    const size_t packetFrames = number("packetFrames", sampleRate / 100);
+    const uint32_t seconds = (std::max)(number("seconds", 10), 1u);
+    if (sampleRate == 0 || channels == 0 || packetFrames == 0) {
+        Napi::RangeError::New(env, "sampleRate, channels and packetFrames must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const size_t frames = static_cast<size_t>(seconds) * sampleRate;
+    std::vector<float> input(frames * channels);
+    std::vector<int16_t> input16(input.size());
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < frames; i++) {
+        const double t = static_cast<double>(i) / sampleRate;
+        for (uint32_t c = 0; c < channels; c++) {
+            seed = seed * 1103515245u + 12345u;
+            const double noise = static_cast<double>(seed >> 8) / 8388608.0 - 1.0;
+            const double sample = 0.3 * std::sin(2.0 * 3.14159265358979323846 * 220.0 * (c + 1) * t) + 0.05 * noise;
+            input[i * channels + c] = static_cast<float>(sample);
+            input16[i * channels + c] = static_cast<int16_t>(std::lround(sample * 32767.0));
+        }
+    }
+
+    // Each loop folds its results into a sink so none of the work can be dropped
+    using Clock = std::chrono::steady_clock;
+    volatile float sink = 0.0f;
+    auto timePackets = [&](auto&& measure) {
+        float total = 0.0f;
+        const Clock::time_point start = Clock::now();
+        for (size_t offset = 0; offset < frames; offset += packetFrames) {
+            total += measure(offset, (std::min)(packetFrames, frames - offset));
+        }
+        const double nanos = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        sink = sink + total;
+        return nanos;
+    };
+
+    const double fusedNanos = timePackets([&](size_t offset, size_t count) {
+        const PacketStatistics stats = MeasurePacket(input.data() + offset * channels, count, channels);
+        return stats.Rms() + stats.peak + stats.DcOffset() + static_cast<float>(stats.zeroCrossings);
+    });
+    const double referenceNanos = timePackets([&](size_t offset, size_t count) {
+        return ReferencePacketScans(input.data() + offset * channels, count, channels);
+    });
+    const double int16Nanos = timePackets([&](size_t offset, size_t count) {
+        return MeasurePacket(input16.data() + offset * channels, count, channels).Rms() * 100.0f;
+    });
+    const double int16ReferenceNanos = timePackets([&](size_t offset, size_t count) {
+        return ReferenceInt16Rms(input16.data() + offset * channels, count * channels);
+    });
+
+    const double channelSeconds = static_cast<double>(seconds) * channels;
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("seconds", Napi::Number::New(env, seconds));
+    result.Set("nanosPerChannelSecond", Napi::Number::New(env, fusedNanos / channelSeconds));
+    result.Set("referenceNanosPerChannelSecond", Napi::Number::New(env, referenceNanos / channelSeconds));
+    result.Set("int16NanosPerChannelSecond", Napi::Number::New(env, int16Nanos / channelSeconds));
+    result.Set("int16ReferenceNanosPerChannelSecond", Napi::Number::New(env, int16ReferenceNanos / channelSeconds));
+    return result;
+}
+
+// The encoder options shared by encodeFlac() and convertToFlac()
+static FlacEncoderConfig ParseFlacConfig(const Napi::Object& options, FlacEncoderConfig config) {
+    auto number = [&options](const char* name, uint32_t fallback) {
+        return options.Has(name) ? options.Get(name).ToNumber().Uint32Value() : fallback;
+    };
+    config.sampleRate = number("sampleRate", config.sampleRate);
+    config.channels = static_cast<uint16_t>(number("channels", config.channels));
+    config.bitsPerSample = static_cast<uint16_t>(number("bitsPerSample", config.bitsPerSample));
+    config.blockSize = number("blockSize", config.blockSize);
+    config.maxLpcOrder = number("maxLpcOrder", config.maxLpcOrder);
+    return config;
+}
+
+static unsigned ParseThreads(const Napi::Object& options) {
+    return options.Has("threads") ? options.Get("threads").ToNumber().Uint32Value() : 0;
+}
+
+// encodeFlac(samples: Int16Array | Int32Array, { sampleRate, channels?, bitsPerSample?,
+//            blockSize?, maxLpcOrder?, threads? })
+// Encodes interleaved integer samples as a whole FLAC stream and returns it as a
+// Buffer. bitsPerSample defaults to 16 for an Int16Array and 24 for an Int32Array;
+// threads defaults to one per core.
+static Napi::Value EncodeFlacSamples(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsTypedArray() || !info[1].IsObject()) {
+        Napi::TypeError::New(env, "Expected (Int16Array | Int32Array, { sampleRate })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::TypedArray array = info[0].As<Napi::TypedArray>();
+    const napi_typedarray_type type = array.TypedArrayType();
+    if (type != napi_int16_array && type != napi_int32_array) {
+        Napi::TypeError::New(env, "Samples must be an Int16Array or Int32Array").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Object options = info[1].As<Napi::Object>();
+    FlacEncoderConfig defaults;
+    defaults.sampleRate = 0;
+    defaults.bitsPerSample = type == napi_int16_array ? 16 : 24;
+    const FlacEncoderConfig config = ParseFlacConfig(options, defaults);
+    const size_t count = array.ElementLength();
+    if (!config.Valid() || (type == napi_int16_array && config.bitsPerSample > 16) || count % config.channels != 0) {
+        Napi::RangeError::New(env, "Unsupported FLAC format, or samples not whole frames").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::vector<int32_t> samples(count);
+    const int32_t limit = 1 << (config.bitsPerSample - 1);
+    bool inRange = true;
+    if (type == napi_int16_array) {
+        const int16_t* data = array.As<Napi::Int16Array>().Data();
+        for (size_t i = 0; i < count; i++) {
+            samples[i] = data[i];
+            inRange = inRange && samples[i] >= -limit && samples[i] < limit;
+        }
+    } else {
+        const int32_t* data = array.As<Napi::Int32Array>().Data();
+        for (size_t i = 0; i < count; i++) {
+            samples[i] = data[i];
+            inRange = inRange && samples[i] >= -limit && samples[i] < limit;
+        }
+    }
+    if (!inRange) {
+        Napi::RangeError::New(env, "Samples exceed bitsPerSample").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const std::vector<uint8_t> stream = EncodeFlac(samples.data(), count / config.channels, config, ParseThreads(options));
+    return Napi::Buffer<uint8_t>::Copy(env, stream.data(), stream.size());
+}
+
+// decodeFlac(path)
+// Decodes a whole FLAC file with FlacReader and returns { samples, sampleRate,
+// channels, bitsPerSample, damaged }: samples interleaved at the stream's own
+// depth, an Int16Array up to 16 bits and an Int32Array above. Decoding stops
+// at a damaged frame, which sets `damaged`.
+static Napi::Value DecodeFlacFile(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "File path required").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    FlacReader reader;
+    std::string error;
+    if (!reader.Open(info[0].As<Napi::String>().Utf8Value(), error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const size_t channels = reader.Format().channels;
+    constexpr size_t kChunkFrames = 4096;
+    std::vector<int32_t> decoded;
+    size_t frames = 0;
+    for (;;) {
+        decoded.resize((std::max)(decoded.size(), (frames + kChunkFrames) * channels));
+        const size_t read = reader.ReadSamples(decoded.data() + frames * channels, kChunkFrames);
+        if (read == 0) {
+            break;
+        }
+        frames += read;
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    const size_t count = frames * channels;
+    if (reader.BitsPerSample() <= 16) {
+        Napi::Int16Array samples = Napi::Int16Array::New(env, count);
+        std::copy(decoded.begin(), decoded.begin() + count, samples.Data());
+        result.Set("samples", samples);
+    } else {
+        Napi::Int32Array samples = Napi::Int32Array::New(env, count);
+        std::copy(decoded.begin(), decoded.begin() + count, samples.Data());
+        result.Set("samples", samples);
+    }
+    result.Set("sampleRate", Napi::Number::New(env, reader.SampleRate()));
+    result.Set("channels", Napi::Number::New(env, static_cast<double>(channels)));
+    result.Set("bitsPerSample", Napi::Number::New(env, reader.BitsPerSample()));
+    result.Set("damaged", Napi::Boolean::New(env, reader.Damaged()));
+    return result;
+}
+
+// Re-encodes an opened WAV as FLAC on a pool thread, a chunk of blocks at a
+// time spread over the encoder threads, so memory does not grow with the
+// recording. Resolves with { frames, pcmBytes, flacBytes }.
+class ConvertToFlacWorker : public PromiseWorker {
+public:
+    ConvertToFlacWorker(Napi::Env env, const Napi::Object& owner, std::unique_ptr<WavReader> reader,
+                        const std::string& flacPath, const FlacEncoderConfig& config, unsigned threads)
+        : PromiseWorker(env, "ConvertToFlac", owner)
+        , m_reader(std::move(reader))
+        , m_flacPath(flacPath)
+        , m_config(config)
+        , m_threads(threads) {}
+
+    void Execute() override {
+        std::ofstream file(m_flacPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            SetError("Cannot create " + m_flacPath);
+            return;
+        }
+        uint8_t header[Flac::kStreamHeaderBytes] = {};
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+        // 64 blocks per thread per chunk keeps every thread busy between writes
+        const SampleFormat format = m_reader->Format();
+        const size_t chunkFrames = static_cast<size_t>(m_config.blockSize) * 64 * m_threads;
+        const size_t bytesPerSample = format.BytesPerSample();
+        std::vector<uint8_t> pcm(chunkFrames * format.BytesPerFrame());
+        std::vector<int32_t> samples(chunkFrames * format.channels);
+        std::vector<uint8_t> encoded;
+        FlacFrameSizes sizes;
+        m_flacBytes = sizeof(header);
+        for (;;) {
+            size_t read = 0;
+            while (read < chunkFrames) {
+                const size_t got = m_reader->ReadFrames(pcm.data() + read * format.BytesPerFrame(), chunkFrames - read);
+                if (got == 0) {
+                    break;
+                }
+                read += got;
+            }
+            if (read == 0) {
+                break;
+            }
+            const uint8_t* p = pcm.data();
+            for (size_t i = 0; i < read * format.channels; i++, p += bytesPerSample) {
+                samples[i] = bytesPerSample == 2 ? static_cast<int16_t>(p[0] | (p[1] << 8)) : SampleKernels::LoadInt24(p);
+            }
+            encoded.clear();
+            EncodeFlacBlocks(samples.data(), read, m_frames / m_config.blockSize, m_config, m_threads, encoded, sizes);
+            file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+            m_frames += read;
+            m_flacBytes += encoded.size();
+            if (read < chunkFrames) {
+                break;
+            }
+        }
+
+        Flac::WriteStreamHeader(header, m_config, m_frames, sizes.Min(), sizes.maxBytes);
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.close();
+        if (!file) {
+            SetError("Cannot write to " + m_flacPath);
+        }
+    }
+
+protected:
+    Napi::Value Resolve(Napi::Env env) override {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("frames", Napi::Number::New(env, static_cast<double>(m_frames)));
+        result.Set("pcmBytes", Napi::Number::New(env, static_cast<double>(m_frames * m_reader->Format().BytesPerFrame())));
+        result.Set("flacBytes", Napi::Number::New(env, static_cast<double>(m_flacBytes)));
+        return result;
+    }
+
+private:
+    std::unique_ptr<WavReader> m_reader;
+    std::string m_flacPath;
+    FlacEncoderConfig m_config;
+    unsigned m_threads;
+    uint64_t m_frames = 0;
+    uint64_t m_flacBytes = 0;
+};
+
+// convertToFlac(wavPath, flacPath, { threads?, maxLpcOrder? })
+// The batch job for stored recordings: re-encodes a 16- or 24-bit WAV as
+// FLAC off the JS thread. Arguments and the WAV header are checked up front
+// and throw; write errors reject. Returns a Promise for { frames, pcmBytes,
+// flacBytes }.
+static Napi::Value ConvertToFlac(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+        Napi::TypeError::New(env, "Expected (wavPath, flacPath, options?)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    const std::string wavPath = info[0].As<Napi::String>().Utf8Value();
+    const std::string flacPath = info[1].As<Napi::String>().Utf8Value();
+    Napi::Object options = info.Length() > 2 && info[2].IsObject() ? info[2].As<Napi::Object>() : Napi::Object::New(env);
+
+    auto reader = std::make_unique<WavReader>();
+    std::string error;
+    if (!reader->Open(wavPath, error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    const SampleFormat format = reader->Format();
+    if (format.encoding != SampleEncoding::Int16 && format.encoding != SampleEncoding::Int24) {
+        Napi::Error::New(env, "Only 16- and 24-bit PCM recordings convert to FLAC").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    FlacEncoderConfig defaults;
+    defaults.sampleRate = reader->SampleRate();
+    defaults.channels = format.channels;
+    defaults.bitsPerSample = format.encoding == SampleEncoding::Int16 ? 16 : 24;
+    FlacEncoderConfig config = ParseFlacConfig(options, defaults);
+    config.sampleRate = defaults.sampleRate;
+    config.channels = defaults.channels;
+    config.bitsPerSample = defaults.bitsPerSample;
+    if (!config.Valid()) {
+        Napi::RangeError::New(env, "Unsupported FLAC format").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    unsigned threads = ParseThreads(options);
+    if (threads == 0) {
+        threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+    }
+
+    // A module function has no native instance to keep alive; the options
+    // object stands in as the owner
+    auto* worker = new ConvertToFlacWorker(env, options, std::move(reader), flacPath, config, threads);
+    Napi::Promise promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+}
+
+// benchmarkFlac({ sampleRate, channels?, seconds?, threads? })
+// Encodes a speech-like 16-bit recording (voiced harmonics under a syllable
+// envelope over a -60 dBFS noise floor) on one thread and on `threads`
+// (default one per core), then decodes it with FlacReader. Throughput is in
+// MB of 16-bit PCM per second. Returns { seconds, pcmBytes, flacBytes, ratio,
+// encodeMBPerSecondPerCore, threads, threadedEncodeMBPerSecond,
+// decodeMBPerSecond }.
+static Napi::Value BenchmarkFlac(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected ({ sampleRate })").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+    auto number = [&options](const char* name, uint32_t fallback) {
+        return options.Has(name) ? options.Get(name).ToNumber().Uint32Value() : fallback;
+    };
+    FlacEncoderConfig config;
+    config.sampleRate = number("sampleRate", 0);
+    config.channels = static_cast<uint16_t>(number("channels", 1));
+    const uint32_t seconds = (std::max)(number("seconds", 10), 1u);
+    unsigned threads = ParseThreads(options);
+    if (threads == 0) {
+        threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+    }
+    if (!config.Valid()) {
+        Napi::RangeError::New(env, "Unsupported sampleRate or channels").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const size_t frames = static_cast<size_t>(seconds) * config.sampleRate;
+    std::vector<int32_t> samples(frames * config.channels);
+    uint32_t seed = 12345;
+    const double twoPi = 2.0 * 3.14159265358979323846;
+    for (size_t i = 0; i < frames; i++) {
+        const double t = static_cast<double>(i) / config.sampleRate;
+        const double envelope = 0.5 + 0.5 * std::sin(twoPi * 4.0 * t);
+        const double pitch = 140.0 + 20.0 * std::sin(twoPi * 0.7 * t);
+        for (uint32_t c = 0; c < config.channels; c++) {
+            seed = seed * 1103515245u + 12345u;
+            const double noise = static_cast<double>(seed >> 8) / 8388608.0 - 1.0;
+            double voiced = 0.0;
+            for (int harmonic = 1; harmonic <= 6; harmonic++) {
+                voiced += std::sin(twoPi * pitch * harmonic * t + c) / harmonic;
+            }
+            const double sample = 0.25 * envelope * voiced + 0.001 * noise;
+            samples[i * config.channels + c] = static_cast<int32_t>(std::lround((std::max)(-1.0, (std::min)(1.0, sample)) * 32767.0));
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const double pcmMegabytes = static_cast<double>(frames) * config.channels * 2 / 1e6;
+    Clock::time_point start = Clock::now();
+    const std::vector<uint8_t> stream = EncodeFlac(samples.data(), frames, config, 1);
+    const double singleSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    start = Clock::now();
+    EncodeFlac(samples.data(), frames, config, threads);
+    const double threadedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const std::string path = (std::filesystem::temp_directory_path() / "voiceink-flac-benchmark.flac").string();
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(stream.data()), static_cast<std::streamsize>(stream.size()));
+    }
+    FlacReader reader;
+    std::string error;
+    double decodeSeconds = 0.0;
+    if (reader.Open(path, error)) {
+        std::vector<uint8_t> pcm(static_cast<size_t>(4096) * reader.Format().BytesPerFrame());
+        start = Clock::now();
+        while (reader.ReadFrames(pcm.data(), 4096) > 0) {
+        }
+        decodeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    if (!error.empty()) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("seconds", Napi::Number::New(env, seconds));
+    result.Set("pcmBytes", Napi::Number::New(env, static_cast<double>(frames) * config.channels * 2));
+    result.Set("flacBytes", Napi::Number::New(env, static_cast<double>(stream.size())));
+    result.Set("ratio", Napi::Number::New(env, static_cast<double>(stream.size()) / (pcmMegabytes * 1e6)));
+    result.Set("encodeMBPerSecondPerCore", Napi::Number::New(env, pcmMegabytes / singleSeconds));
+    result.Set("threads", Napi::Number::New(env, threads));
+    result.Set("threadedEncodeMBPerSecond", Napi::Number::New(env, pcmMegabytes / threadedSeconds));
+    result.Set("decodeMBPerSecond", Napi::Number::New(env, pcmMegabytes / decodeSeconds));
+    return result;
+}
+
+static Napi::Object InitModule(Napi::Env env, Napi::Object exports) {
+    exports.Set("convertSamples", Napi::Function::New(env, ConvertSamples, "convertSamples"));
+    exports.Set("parseWaveFormat", Napi::Function::New(env, ParseWaveFormat, "parseWaveFormat"));
+    exports.Set("resample", Napi::Function::New(env, Resample, "resample"));
+    exports.Set("formatCapture", Napi::Function::New(env, FormatCapture, "formatCapture"));
+    exports.Set("segmentUtterances", Napi::Function::New(env, SegmentUtterances, "segmentUtterances"));
+    exports.Set("suppressNoise", Napi::Function::New(env, SuppressNoise, "suppressNoise"));
+    exports.Set("applyGainStage", Napi::Function::New(env, ApplyGainStage, "applyGainStage"));
+    exports.Set("benchmarkGainStage", Napi::Function::New(env, BenchmarkGainStage, "benchmarkGainStage"));
+    exports.Set("cancelEcho", Napi::Function::New(env, CancelEcho, "cancelEcho"));
+    exports.Set("fft", Napi::Function::New(env, Fft, "fft"));
+    exports.Set("ifft", Napi::Function::New(env, Ifft, "ifft"));
+    exports.Set("benchmarkFft", Napi::Function::New(env, BenchmarkFft, "benchmarkFft"));
+    exports.Set("measurePacket", Napi::Function::New(env, MeasurePacketStatistics, "measurePacket"));
+    exports.Set("benchmarkPacketStatistics", Napi::Function::New(env, BenchmarkPacketStatistics, "benchmarkPacketStatistics"));
+    exports.Set("encodeFlac", Napi::Function::New(env, EncodeFlacSamples, "encodeFlac"));
+    exports.Set("decodeFlac", Napi::Function::New(env, DecodeFlacFile, "decodeFlac"));
+    exports.Set("convertToFlac", Napi::Function::New(env, ConvertToFlac, "convertToFlac"));
+    exports.Set("benchmarkFlac", Napi::Function::New(env, BenchmarkFlac, "benchmarkFlac"));
+#if defined(VOICEINK_SAMPLE_SSE2)
+    exports.Set("simd", Napi::String::New(env, "sse2"));
+#elif defined(VOICEINK_SAMPLE_NEON)
+    exports.Set("simd", Napi::String::New(env, "neon"));
+#else
+    exports.Set("simd", Napi::String::New(env, "none"));
+#endif
+    return exports;
+}
+
+NODE_API_MODULE(audiodsp, InitModule)
@@ -9,7 +9,8 @@
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
         "../../../whisper.cpp",
-        "./whisper-binding"
+        "./whisper-binding",
+        "./common"
       ],
       "dependencies": [
         "<!(node -p \"require('node-addon-api').gyp\")"
@@ -45,7 +46,8 @@
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
-        "./audio-recorder"
+        "./audio-recorder",
+        "./common"
       ],
       "dependencies": [
         "<!(node -p \"require('node-addon-api').gyp\")"
@@ -0,0 +1,1260 @@
+#include <napi.h>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include "capture_core.h"
+#include "file_capture_source.h"
+#include "synthetic_capture_source.h"
+#ifdef _WIN32
+#include "wasapi_capture_source.h"
+#endif
+#include "buffer_pool.h"
+#include "external_buffer.h"
+#include "audio_batch_dispatcher.h"
+#include "allocation_counter.h"
+#include "utterance_sink.h"
+
+// Counts allocations per thread in builds configured with -Dcount_allocations=1
+VOICEINK_DEFINE_ALLOCATION_COUNTER()
+
+static Napi::Object MeterReadingToJS(Napi::Env env, const AudioMeterReading& reading) {
+    Napi::Object meter = Napi::Object::New(env);
+    meter.Set("rms", Napi::Number::New(env, reading.rms));
+    meter.Set("peak", Napi::Number::New(env, reading.peak));
+    meter.Set("level", Napi::Number::New(env, reading.level));
+    meter.Set("peakHold", Napi::Number::New(env, reading.peakHold));
+    meter.Set("dcOffset", Napi::Number::New(env, reading.dcOffset));
+    meter.Set("zeroCrossingRate", Napi::Number::New(env, reading.zeroCrossingRate));
+    meter.Set("timestamp", Napi::Number::New(env, reading.timestamp));
+    meter.Set("sequence", Napi::Number::New(env, static_cast<double>(reading.sequence)));
+    
+    Napi::Float32Array bands = Napi::Float32Array::New(env, AudioMeterReading::kBandCount);
+    std::copy(reading.bands, reading.bands + AudioMeterReading::kBandCount, bands.Data());
+    meter.Set("bands", bands);
+    
+    return meter;
+}
+
+#ifdef _WIN32
+static Napi::Object DeviceToJS(Napi::Env env, const AudioDevice& device) {
+    Napi::Object deviceObj = Napi::Object::New(env);
+    deviceObj.Set("id", Napi::String::New(env, WASAPIUtils::wstringToString(device.id)));
+    deviceObj.Set("name", Napi::String::New(env, WASAPIUtils::wstringToString(device.name)));
+    deviceObj.Set("description", Napi::String::New(env, WASAPIUtils::wstringToString(device.description)));
+    deviceObj.Set("isDefault", Napi::Boolean::New(env, device.isDefault));
+    deviceObj.Set("isActive", Napi::Boolean::New(env, device.isActive));
+    deviceObj.Set("state", Napi::Number::New(env, device.state));
+    return deviceObj;
+}
+#endif
+
+static Napi::Object UtteranceEventToJS(Napi::Env env, const UtteranceEvent& event) {
+    static const char* const kTypeNames[] = { "start", "end", "discard" };
+    Napi::Object eventObj = Napi::Object::New(env);
+    eventObj.Set("type", Napi::String::New(env, kTypeNames[event.type]));
+    eventObj.Set("session", Napi::Number::New(env, static_cast<double>(event.session)));
+    eventObj.Set("sequence", Napi::Number::New(env, static_cast<double>(event.sequence)));
+    eventObj.Set("startTime", Napi::Number::New(env, event.startTime));
+    eventObj.Set("endTime", Napi::Number::New(env, event.endTime));
+    eventObj.Set("sampleCount", Napi::Number::New(env, static_cast<double>(event.sampleCount)));
+    eventObj.Set("jobId", event.jobId.empty() ? env.Null() : Napi::String::New(env, event.jobId));
+    return eventObj;
+}
+
+static bool GetBoolOption(const Napi::Object& options, const char* key, bool fallback) {
+    return options.Has(key) ? options.Get(key).ToBoolean().Value() : fallback;
+}
+
+static uint32_t GetUint32Option(const Napi::Object& options, const char* key, uint32_t fallback) {
+    return options.Has(key) ? options.Get(key).ToNumber().Uint32Value() : fallback;
+}
+
+static float GetFloatOption(const Napi::Object& options, const char* key, float fallback) {
+    return options.Has(key) ? options.Get(key).ToNumber().FloatValue() : fallback;
+}
+
+// Delivers meter snapshots to a JS level callback at a fixed rate.
+//
+// A small timer thread samples the recorder's meter mailbox and posts only
+// fresh readings. The TSFN queue holds a single reading, so a busy JS thread
+// skips frames instead of accumulating a backlog. Once Node has closed the
+// TSFN at teardown the thread stops posting.
+class LevelCallbackPump {
+public:
+    LevelCallbackPump(Napi::Env env, Napi::Function callback, CaptureCore* recorder, double rateHz)
+        : m_recorder(recorder)
+        , m_interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(1.0 / rateHz)))
+        , m_state(std::make_shared<State>()) {
+        m_state->tsfn = MeterTsfn::New(env, callback, "LevelCallback", 1, 1,
+                                       new std::shared_ptr<State>(m_state), &Finalize);
+        // The timer thread is no reason to keep the process alive
+        m_state->tsfn.Unref(env);
+        m_thread = std::thread(&LevelCallbackPump::run, this);
+    }
+
+    ~LevelCallbackPump() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (!m_state->closed) {
+            m_state->tsfn.Release();
+        }
+    }
+
+    LevelCallbackPump(const LevelCallbackPump&) = delete;
+    LevelCallbackPump& operator=(const LevelCallbackPump&) = delete;
+
+private:
+    struct State;
+
+    static void CallJs(Napi::Env env, Napi::Function callback, std::shared_ptr<State>*, AudioMeterReading* reading) {
+        std::unique_ptr<AudioMeterReading> owned(reading);
+        if (!env || !callback) {
+            return;
+        }
+        
+        callback.Call({
+            Napi::Number::New(env, owned->level),
+            Napi::Number::New(env, owned->peak),
+            MeterReadingToJS(env, *owned)
+        });
+    }
+
+    void run() {
+        auto next = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        
+        while (!m_stop) {
+            next += m_interval;
+            if (m_wake.wait_until(lock, next, [this] { return m_stop; })) {
+                break;
+            }
+            
+            AudioMeterReading reading;
+            if (!m_recorder->readMeter(reading)) {
+                continue; // Nothing captured since the last tick
+            }
+            
+            std::lock_guard<std::mutex> tsfnLock(m_state->mutex);
+            if (m_state->closed) {
+                break;
+            }
+            auto* pending = new AudioMeterReading(reading);
+            if (m_state->tsfn.NonBlockingCall(pending) != napi_ok) {
+                delete pending; // JS has not consumed the previous reading yet
+            }
+        }
+    }
+
+    using MeterTsfn = Napi::TypedThreadSafeFunction<std::shared_ptr<State>, AudioMeterReading, CallJs>;
+
+    struct State {
+        std::mutex mutex;
+        MeterTsfn tsfn;
+        bool closed = false;
+    };
+
+    // Runs on the JS thread once the TSFN is closed, after Release() or at
+    // teardown
+    static void Finalize(Napi::Env, std::shared_ptr<State>* state) {
+        {
+            std::lock_guard<std::mutex> lock((*state)->mutex);
+            (*state)->closed = true;
+        }
+        delete state;
+    }
+
+    CaptureCore* m_recorder;
+    const std::chrono::steady_clock::duration m_interval;
+    std::shared_ptr<State> m_state;
+    
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+    std::thread m_thread;
+};
+
+// A JS callback that native threads may call until it is released.
+//
+// Node closes every thread-safe function at environment teardown, e.g. on
+// worker.terminate(), before the recorder that holds it is destroyed. From
+// then on calls are dropped and Release() does nothing.
+class ClosableCallback {
+public:
+    static std::shared_ptr<ClosableCallback> New(Napi::Env env, Napi::Function callback, const char* resourceName) {
+        auto shared = std::make_shared<ClosableCallback>();
+        // Events are rare, so the queue is unbounded and none is dropped
+        shared->m_tsfn = Napi::ThreadSafeFunction::New(env, callback, resourceName, 0, 1,
+                                                      new std::shared_ptr<ClosableCallback>(shared), &Finalize);
+        return shared;
+    }
+
+    // Any thread
+    template <typename Callback>
+    void NonBlockingCall(Callback callback) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_closed) {
+            m_tsfn.NonBlockingCall(callback);
+        }
+    }
+
+    // No call goes through once this returns
+    void Release() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_closed) {
+            m_closed = true;
+            m_tsfn.Release();
+        }
+    }
+
+private:
+    static void Finalize(Napi::Env, std::shared_ptr<ClosableCallback>* callback) {
+        {
+            std::lock_guard<std::mutex> lock((*callback)->m_mutex);
+            (*callback)->m_closed = true;
+        }
+        delete callback;
+    }
+
+    std::mutex m_mutex;
+    Napi::ThreadSafeFunction m_tsfn;
+    bool m_closed = false;
+};
+
+// Per-environment state. Init runs once for the main thread and once for
+// every worker_thread that loads the addon; each copy is freed with its
+// environment.
+struct RecorderAddonData {
+    Napi::FunctionReference constructor;
+    // Sample storage recycled across all recorders in this environment
+    std::shared_ptr<BufferPool<float>> samplePool = std::make_shared<BufferPool<float>>();
+};
+
+class CaptureBinding : public Napi::ObjectWrap<CaptureBinding> {
+private:
+    std::unique_ptr<CaptureCore> m_recorder;
+    // Shared with outstanding ArrayBuffers, whose finalizers recycle into it
+    std::shared_ptr<BufferPool<float>> m_samplePool;
+    // Shared with the recorder's capture callback, which may outlive a re-registration
+    std::shared_ptr<AudioBatchDispatcher> m_audioBatcher;
+    std::unique_ptr<LevelCallbackPump> m_levelPump;
+    std::shared_ptr<ClosableCallback> m_deviceChangeCallback;
+    std::shared_ptr<ClosableCallback> m_utteranceCallback;
+
+#ifdef _WIN32
+    // Device management only applies while recording from a WASAPI endpoint
+    WasapiCaptureSource* wasapiSource() {
+        CaptureSource* source = m_recorder->getSource();
+        return source && std::string(source->name()) == "wasapi" ? static_cast<WasapiCaptureSource*>(source) : nullptr;
+    }
+#endif
+
+    // Builds the source described by setSource()-style options. Throws a JS
+    // TypeError and returns null if they are invalid.
+    static std::unique_ptr<CaptureSource> CreateSource(Napi::Env env, Napi::Object options) {
+        const std::string type = options.Has("type") ? options.Get("type").ToString().Utf8Value() : "";
+        std::unique_ptr<CaptureSource> source;
+        
+        if (type == "file") {
+            if (!options.Has("path") || !options.Get("path").IsString()) {
+                Napi::TypeError::New(env, "File source requires a path").ThrowAsJavaScriptException();
+                return nullptr;
+            }
+            FileCaptureSource::Options fileOptions;
+            fileOptions.path = options.Get("path").As<Napi::String>().Utf8Value();
+            fileOptions.realtime = GetBoolOption(options, "realtime", fileOptions.realtime);
+            fileOptions.loop = GetBoolOption(options, "loop", fileOptions.loop);
+            source = std::make_unique<FileCaptureSource>(fileOptions);
+        } else if (type == "synthetic") {
+            SyntheticCaptureSource::Options signalOptions;
+            if (options.Has("signal")) {
+                const std::string signal = options.Get("signal").ToString().Utf8Value();
+                if (signal == "sine") {
+                    signalOptions.signal = SyntheticCaptureSource::Signal::Sine;
+                } else if (signal == "noise") {
+                    signalOptions.signal = SyntheticCaptureSource::Signal::Noise;
+                } else if (signal == "silence") {
+                    signalOptions.signal = SyntheticCaptureSource::Signal::Silence;
+                } else if (signal == "speech") {
+                    signalOptions.signal = SyntheticCaptureSource::Signal::Speech;
+                } else {
+                    Napi::TypeError::New(env, "signal must be 'sine', 'noise', 'silence' or 'speech'").ThrowAsJavaScriptException();
+                    return nullptr;
+                }
+            }
+            if (options.Has("encoding")) {
+                const std::string encoding = options.Get("encoding").ToString().Utf8Value();
+                if (encoding == "float32") {
+                    signalOptions.encoding = SampleEncoding::Float32;
+                } else if (encoding == "int16") {
+                    signalOptions.encoding = SampleEncoding::Int16;
+                } else {
+                    Napi::TypeError::New(env, "encoding must be 'float32' or 'int16'").ThrowAsJavaScriptException();
+                    return nullptr;
+                }
+            }
+            signalOptions.sampleRate = GetUint32Option(options, "sampleRate", signalOptions.sampleRate);
+            signalOptions.channels = static_cast<uint16_t>(GetUint32Option(options, "channels", signalOptions.channels));
+            signalOptions.durationMs = GetUint32Option(options, "durationMs", signalOptions.durationMs);
+            signalOptions.seed = GetUint32Option(options, "seed", signalOptions.seed);
+            signalOptions.realtime = GetBoolOption(options, "realtime", signalOptions.realtime);
+            if (options.Has("frequency")) {
+                signalOptions.frequency = options.Get("frequency").ToNumber().FloatValue();
+            }
+            if (options.Has("amplitude")) {
+                signalOptions.amplitude = options.Get("amplitude").ToNumber().FloatValue();
+            }
+            source = std::make_unique<SyntheticCaptureSource>(signalOptions);
+#ifdef _WIN32
+        } else if (type == "wasapi") {
+            source = std::make_unique<WasapiCaptureSource>();
+        } else if (type == "loopback") {
+            source = std::make_unique<WasapiCaptureSource>(true);
+#endif
+        } else {
+            Napi::TypeError::New(env, "Unsupported capture source type: '" + type + "'").ThrowAsJavaScriptException();
+            return nullptr;
+        }
+        return source;
+    }
+
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+        Napi::Function func = DefineClass(env, "WASAPIRecorder", {
+            InstanceMethod("initialize", &CaptureBinding::Initialize),
+            InstanceMethod("setSource", &CaptureBinding::SetSource),
+            InstanceMethod("getSource", &CaptureBinding::GetSource),
+            InstanceMethod("enumerateDevices", &CaptureBinding::EnumerateDevices),
+            InstanceMethod("selectDevice", &CaptureBinding::SelectDevice),
+            InstanceMethod("getCurrentDevice", &CaptureBinding::GetCurrentDevice),
+            InstanceMethod("startRecording", &CaptureBinding::StartRecording),
+            InstanceMethod("stopRecording", &CaptureBinding::StopRecording),
+            InstanceMethod("pauseRecording", &CaptureBinding::PauseRecording),
+            InstanceMethod("resumeRecording", &CaptureBinding::ResumeRecording),
+            InstanceMethod("isRecording", &CaptureBinding::IsRecording),
+            InstanceMethod("isPaused", &CaptureBinding::IsPaused),
+            InstanceMethod("hasEnded", &CaptureBinding::HasEnded),
+            InstanceMethod("enableHistory", &CaptureBinding::EnableHistory),
+            InstanceMethod("disableHistory", &CaptureBinding::DisableHistory),
+            InstanceMethod("getHistory", &CaptureBinding::GetHistory),
+            InstanceMethod("getHistoryInfo", &CaptureBinding::GetHistoryInfo),
+            InstanceMethod("enableEndpointing", &CaptureBinding::EnableEndpointing),
+            InstanceMethod("disableEndpointing", &CaptureBinding::DisableEndpointing),
+            InstanceMethod("setUtteranceSink", &CaptureBinding::SetUtteranceSink),
+            InstanceMethod("setUtteranceCallback", &CaptureBinding::SetUtteranceCallback),
+            InstanceMethod("getSessionId", &CaptureBinding::GetSessionId),
+            InstanceMethod("getCurrentLevel", &CaptureBinding::GetCurrentLevel),
+            InstanceMethod("getPeakLevel", &CaptureBinding::GetPeakLevel),
+            InstanceMethod("resetPeakLevel", &CaptureBinding::ResetPeakLevel),
+            InstanceMethod("getMeter", &CaptureBinding::GetMeter),
+            InstanceMethod("getAudioData", &CaptureBinding::GetAudioData),
+            InstanceMethod("hasAudioData", &CaptureBinding::HasAudioData),
+            InstanceMethod("clearBuffer", &CaptureBinding::ClearBuffer),
+            InstanceMethod("setFormat", &CaptureBinding::SetFormat),
+            InstanceMethod("getFormat", &CaptureBinding::GetFormat),
+            InstanceMethod("setOutputFormat", &CaptureBinding::SetOutputFormat),
+            InstanceMethod("getOutputFormat", &CaptureBinding::GetOutputFormat),
+            InstanceMethod("setBufferSize", &CaptureBinding::SetBufferSize),
+            InstanceMethod("getBufferSize", &CaptureBinding::GetBufferSize),
+            InstanceMethod("enableNoiseSupression", &CaptureBinding::EnableNoiseSupression),
+            InstanceMethod("enableEchoCancellation", &CaptureBinding::EnableEchoCancellation),
+            InstanceMethod("setEchoReference", &CaptureBinding::SetEchoReference),
+            InstanceMethod("getEchoCancellerStats", &CaptureBinding::GetEchoCancellerStats),
+            InstanceMethod("setRecordingFile", &CaptureBinding::SetRecordingFile),
+            InstanceMethod("getRecordingFileStats", &CaptureBinding::GetRecordingFileStats),
+            StaticMethod("recoverRecordingFile", &CaptureBinding::RecoverRecordingFile),
+            InstanceMethod("enableAutomaticGainControl", &CaptureBinding::EnableAutomaticGainControl),
+            InstanceMethod("setGainLevel", &CaptureBinding::SetGainLevel),
+            InstanceMethod("getPerformanceStats", &CaptureBinding::GetPerformanceStats),
+            StaticMethod("getThreadAllocations", &CaptureBinding::GetThreadAllocations),
+            InstanceMethod("setAudioDataCallback", &CaptureBinding::SetAudioDataCallback),
+            InstanceMethod("setLevelCallback", &CaptureBinding::SetLevelCallback),
+            InstanceMethod("setDeviceChangeCallback", &CaptureBinding::SetDeviceChangeCallback),
+            InstanceMethod("getLastError", &CaptureBinding::GetLastError),
+            InstanceMethod("hasError", &CaptureBinding::HasError),
+            InstanceMethod("clearError", &CaptureBinding::ClearError)
+        });
+
+        auto* data = new RecorderAddonData();
+        data->constructor = Napi::Persistent(func);
+        env.SetInstanceData(data);
+
+        exports.Set("WASAPIRecorder", func);
+        return exports;
+    }
+
+    CaptureBinding(const Napi::CallbackInfo& info) : Napi::ObjectWrap<CaptureBinding>(info) {
+        m_recorder = std::make_unique<CaptureCore>();
+        m_samplePool = info.Env().GetInstanceData<RecorderAddonData>()->samplePool;
+    }
+
+    ~CaptureBinding() {
+        // Stop sampling the recorder before it is destroyed
+        m_levelPump.reset();
+        if (m_deviceChangeCallback) {
+            m_deviceChangeCallback->Release();
+        }
+        // Finish the recording so no utterance is reported into a released callback
+        m_recorder->stopRecording();
+        m_recorder->setUtteranceCallback(nullptr);
+        if (m_utteranceCallback) {
+            m_utteranceCallback->Release();
+        }
+    }
+
+    Napi::Value Initialize(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+#ifdef _WIN32
+        // Without an explicit source, record from the default WASAPI endpoint
+        if (!m_recorder->getSource()) {
+            bool result = m_recorder->setSource(std::make_unique<WasapiCaptureSource>());
+            return Napi::Boolean::New(env, result);
+        }
+#endif
+        bool result = m_recorder->reopenSource();
+        return Napi::Boolean::New(env, result);
+    }
+
+    // setSource({ type: 'wasapi' })
+    // setSource({ type: 'loopback' })  What the default render device plays
+    // setSource({ type: 'file', path: string, realtime?: boolean, loop?: boolean })  WAV or FLAC
+    // setSource({ type: 'synthetic', signal?: 'sine' | 'noise' | 'silence' | 'speech', sampleRate?, channels?,
+    //             encoding?: 'float32' | 'int16', frequency?, amplitude?, durationMs?, realtime?, seed? })
+    // Replaces and opens the capture source; not allowed while recording.
+    Napi::Value SetSource(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Source object required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        std::unique_ptr<CaptureSource> source = CreateSource(env, info[0].As<Napi::Object>());
+        if (!source) {
+            return env.Null();
+        }
+        
+        bool result = m_recorder->setSource(std::move(source));
+        return Napi::Boolean::New(env, result);
+    }
+
+    // setEchoReference(options | null), options as for setSource(); on
+    // Windows { type: 'loopback' } is the usual reference. Opens it as the
+    // far end for echo cancellation, or removes it; not allowed while recording.
+    Napi::Value SetEchoReference(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !(info[0].IsObject() || info[0].IsNull() || info[0].IsUndefined())) {
+            Napi::TypeError::New(env, "Source object or null required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        std::unique_ptr<CaptureSource> source;
+        if (info[0].IsObject()) {
+            source = CreateSource(env, info[0].As<Napi::Object>());
+            if (!source) {
+                return env.Null();
+            }
+        }
+        
+        bool result = m_recorder->setEchoReference(std::move(source));
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value GetEchoCancellerStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        const EchoCancellerReport report = m_recorder->getEchoCancellerStats();
+        const CaptureSource* reference = m_recorder->getEchoReferenceSource();
+        Napi::Object statsObj = Napi::Object::New(env);
+        statsObj.Set("running", Napi::Boolean::New(env, report.running));
+        statsObj.Set("reference", reference ? Napi::Value(Napi::String::New(env, reference->name())) : env.Null());
+        statsObj.Set("erleDb", Napi::Number::New(env, report.erleDb));
+        statsObj.Set("delayMs", Napi::Number::New(env, report.delayMs));
+        statsObj.Set("delayLocked", Napi::Boolean::New(env, report.delayLocked));
+        statsObj.Set("farEndActive", Napi::Boolean::New(env, report.farEndActive));
+        statsObj.Set("nanosPerSecond", Napi::Number::New(env, report.nanosPerSecond));
+        statsObj.Set("referenceUnderrunFrames", Napi::Number::New(env, static_cast<double>(report.referenceUnderrunFrames)));
+        statsObj.Set("referenceDroppedFrames", Napi::Number::New(env, static_cast<double>(report.referenceDroppedFrames)));
+        return statsObj;
+    }
+
+    // setRecordingFile(path | null, { encoding?: 'int16' | 'int24' | 'float32',
+    // container?: 'wav' | 'flac' }) - from the next startRecording(), streams
+    // each recording to `path` as well
+    Napi::Value SetRecordingFile(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !(info[0].IsString() || info[0].IsNull() || info[0].IsUndefined())) {
+            Napi::TypeError::New(env, "File path or null required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        SampleEncoding encoding = SampleEncoding::Int16;
+        RecordingContainer container = RecordingContainer::Wav;
+        if (info.Length() > 1 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            if (options.Has("encoding")) {
+                const std::string name = options.Get("encoding").ToString().Utf8Value();
+                if (name == "int24") {
+                    encoding = SampleEncoding::Int24;
+                } else if (name == "float32") {
+                    encoding = SampleEncoding::Float32;
+                } else if (name != "int16") {
+                    Napi::TypeError::New(env, "encoding must be 'int16', 'int24' or 'float32'").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+            }
+            if (options.Has("container")) {
+                const std::string name = options.Get("container").ToString().Utf8Value();
+                if (name == "flac") {
+                    container = RecordingContainer::Flac;
+                } else if (name != "wav") {
+                    Napi::TypeError::New(env, "container must be 'wav' or 'flac'").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+            }
+        }
+        
+        const std::string path = info[0].IsString() ? info[0].As<Napi::String>().Utf8Value() : std::string();
+        bool result = m_recorder->setRecordingFile(path, encoding, container);
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value GetRecordingFileStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        const RecordingFileStats stats = m_recorder->getRecordingFileStats();
+        const std::string path = m_recorder->getRecordingFile();
+        Napi::Object statsObj = Napi::Object::New(env);
+        statsObj.Set("path", path.empty() ? env.Null() : Napi::Value(Napi::String::New(env, path)));
+        statsObj.Set("sourceBytes", Napi::Number::New(env, static_cast<double>(stats.sourceBytes)));
+        statsObj.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(stats.bytesWritten)));
+        statsObj.Set("droppedBytes", Napi::Number::New(env, static_cast<double>(stats.droppedBytes)));
+        statsObj.Set("headerUpdates", Napi::Number::New(env, static_cast<double>(stats.headerUpdates)));
+        statsObj.Set("rf64", Napi::Boolean::New(env, stats.rf64));
+        statsObj.Set("failed", Napi::Boolean::New(env, stats.failed));
+        return statsObj;
+    }
+
+    // WASAPIRecorder.recoverRecordingFile(path) - repairs a WAV or FLAC
+    // recording file left behind by a crash; returns the PCM bytes kept
+    static Napi::Value RecoverRecordingFile(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "File path required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        uint64_t dataBytes = 0;
+        std::string error;
+        if (!::RecoverRecordingFile(info[0].As<Napi::String>().Utf8Value(), dataBytes, error)) {
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Number::New(env, static_cast<double>(dataBytes));
+    }
+
+    Napi::Value GetSource(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        const CaptureSource* source = m_recorder->getSource();
+        if (!source) {
+            return env.Null();
+        }
+        
+        Napi::Object sourceObj = GetFormat(info).As<Napi::Object>();
+        sourceObj.Set("type", Napi::String::New(env, source->name()));
+        return sourceObj;
+    }
+
+    Napi::Value HasEnded(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        bool result = m_recorder->hasEnded();
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value EnumerateDevices(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        Napi::Array deviceArray = Napi::Array::New(env);
+#ifdef _WIN32
+        if (WasapiCaptureSource* wasapi = wasapiSource()) {
+            auto devices = wasapi->enumerateDevices();
+            for (size_t i = 0; i < devices.size(); i++) {
+                deviceArray.Set(i, DeviceToJS(env, devices[i]));
+            }
+        }
+#endif
+        return deviceArray;
+    }
+
+    Napi::Value SelectDevice(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Device ID required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        bool result = false;
+#ifdef _WIN32
+        if (WasapiCaptureSource* wasapi = wasapiSource()) {
+            std::string deviceId = info[0].As<Napi::String>().Utf8Value();
+            std::wstring wDeviceId = WASAPIUtils::stringToWstring(deviceId);
+            
+            result = wasapi->selectDevice(wDeviceId);
+        }
+#endif
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value GetCurrentDevice(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+#ifdef _WIN32
+        if (WasapiCaptureSource* wasapi = wasapiSource()) {
+            return DeviceToJS(env, wasapi->getCurrentDevice());
+        }
+#endif
+        return Napi::Object::New(env);
+    }
+
+    // startRecording({ preRollMs?: number }) - pre-roll comes from the history, see enableHistory()
+    Napi::Value StartRecording(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        uint32_t preRollMs = 0;
+        if (info.Length() > 0 && info[0].IsObject()) {
+            preRollMs = GetUint32Option(info[0].As<Napi::Object>(), "preRollMs", 0);
+        }
+        
+        // The capture thread must not size batches itself
+        if (m_audioBatcher) {
+            m_audioBatcher->Reserve(m_recorder->getOutputSampleRate(), m_recorder->getOutputChannels());
+        }
+        bool result = m_recorder->startRecording(preRollMs);
+        return Napi::Boolean::New(env, result);
+    }
+
+    // enableHistory(durationMs) - keeps the source running and the newest
+    // `durationMs` of output audio in a fixed-size ring
+    Napi::Value EnableHistory(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "History duration in milliseconds required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        bool result = m_recorder->enableHistory(info[0].As<Napi::Number>().Uint32Value());
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value DisableHistory(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        m_recorder->disableHistory();
+        return env.Undefined();
+    }
+
+    // getHistory(durationMs?) -> { samples, timestamp, sampleRate, channels, expiresAfterMs } | null
+    // `samples` is a live view of the ring, not a copy: it reads correctly for
+    // `expiresAfterMs` of further capture, after which the oldest samples are
+    // overwritten. slice() it to keep it longer.
+    Napi::Value GetHistory(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        std::shared_ptr<AudioHistoryRing> history = m_recorder->getHistory();
+        if (!history) {
+            return env.Null();
+        }
+        
+        size_t frames = history->CapacityFrames();
+        if (info.Length() > 0 && info[0].IsNumber()) {
+            frames = static_cast<size_t>(info[0].As<Napi::Number>().Uint32Value()) * history->SampleRate() / 1000;
+        }
+        
+        const AudioHistoryRing::Window window = history->Latest(frames);
+        const size_t sampleCount = window.frames * history->Channels();
+        auto arrayBuffer = ViewAsArrayBuffer(env, window.data, sampleCount * sizeof(float), history);
+        
+        Napi::Object historyObj = Napi::Object::New(env);
+        historyObj.Set("samples", Napi::Float32Array::New(env, sampleCount, arrayBuffer, 0));
+        historyObj.Set("timestamp", Napi::Number::New(env, window.startTimestamp));
+        historyObj.Set("sampleRate", Napi::Number::New(env, history->SampleRate()));
+        historyObj.Set("channels", Napi::Number::New(env, history->Channels()));
+        historyObj.Set("expiresAfterMs", Napi::Number::New(env,
+            1000.0 * (history->CapacityFrames() - window.frames) / history->SampleRate()));
+        
+        return historyObj;
+    }
+
+    Napi::Value GetHistoryInfo(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        std::shared_ptr<AudioHistoryRing> history = m_recorder->getHistory();
+        Napi::Object infoObj = Napi::Object::New(env);
+        
+        infoObj.Set("durationMs", Napi::Number::New(env, m_recorder->getHistoryDuration()));
+        infoObj.Set("availableMs", Napi::Number::New(env, history
+            ? 1000.0 * history->AvailableFrames() / history->SampleRate() : 0.0));
+        infoObj.Set("memoryBytes", Napi::Number::New(env, history ? static_cast<double>(history->MemoryBytes()) : 0.0));
+        infoObj.Set("capturing", Napi::Boolean::New(env, m_recorder->isCapturing()));
+        
+        return infoObj;
+    }
+
+    // enableEndpointing({ mode?: 'hands-free' | 'push-to-talk', thresholdDb?, releaseDb?, minLevelDb?, frameMs?,
+    //                     onsetMs?, hangoverMs?, minSpeechMs?, maxUtteranceMs?, preSpeechMs?, postSpeechMs? })
+    // Splits each following recording into utterances as it is captured;
+    // finished ones go to the sink set with setUtteranceSink(). `mode` picks
+    // the defaults the other fields override.
+    Napi::Value EnableEndpointing(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        EndpointerConfig config;
+        if (info.Length() > 0 && info[0].IsObject()) {
+            Napi::Object options = info[0].As<Napi::Object>();
+            if (options.Has("mode")) {
+                const std::string mode = options.Get("mode").ToString().Utf8Value();
+                if (mode == "push-to-talk") {
+                    config = EndpointerConfig::PushToTalk();
+                } else if (mode != "hands-free") {
+                    Napi::TypeError::New(env, "mode must be 'hands-free' or 'push-to-talk'").ThrowAsJavaScriptException();
+                    return env.Null();
+                }
+            }
+            config.thresholdDb = GetFloatOption(options, "thresholdDb", config.thresholdDb);
+            config.releaseDb = GetFloatOption(options, "releaseDb", config.releaseDb);
+            config.minLevelDb = GetFloatOption(options, "minLevelDb", config.minLevelDb);
+            config.frameMs = (std::max)(1u, GetUint32Option(options, "frameMs", config.frameMs));
+            config.onsetMs = GetUint32Option(options, "onsetMs", config.onsetMs);
+            config.hangoverMs = GetUint32Option(options, "hangoverMs", config.hangoverMs);
+            config.minSpeechMs = GetUint32Option(options, "minSpeechMs", config.minSpeechMs);
+            config.maxUtteranceMs = GetUint32Option(options, "maxUtteranceMs", config.maxUtteranceMs);
+            config.preSpeechMs = GetUint32Option(options, "preSpeechMs", config.preSpeechMs);
+            config.postSpeechMs = GetUint32Option(options, "postSpeechMs", config.postSpeechMs);
+        }
+        
+        m_recorder->enableEndpointing(config);
+        return env.Undefined();
+    }
+
+    Napi::Value DisableEndpointing(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        m_recorder->disableEndpointing();
+        return env.Undefined();
+    }
+
+    // setUtteranceSink(sink | null) - `sink` comes from the transcription
+    // addon's createUtteranceSink(); utterances are queued there natively
+    Napi::Value SetUtteranceSink(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || info[0].IsNull() || info[0].IsUndefined()) {
+            m_recorder->setUtteranceSink(UtteranceSinkRef());
+            return env.Undefined();
+        }
+        
+        static const napi_type_tag kSinkTag = { VOICEINK_UTTERANCE_SINK_TAG_LOWER, VOICEINK_UTTERANCE_SINK_TAG_UPPER };
+        bool isSink = false;
+        if (info[0].IsExternal()) {
+            napi_check_object_type_tag(env, info[0], &kSinkTag, &isSink);
+        }
+        if (!isSink) {
+            Napi::TypeError::New(env, "Utterance sink required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        UtteranceSinkRef sink(info[0].As<Napi::External<VoiceInkUtteranceSink>>().Data());
+        if (!sink) {
+            Napi::Error::New(env, "Utterance sink is from an incompatible build").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        m_recorder->setUtteranceSink(std::move(sink));
+        return env.Undefined();
+    }
+
+    // setUtteranceCallback(fn | null) - fn({ type: 'start' | 'end' | 'discard', session, sequence,
+    //                                       startTime, endTime, sampleCount, jobId })
+    Napi::Value SetUtteranceCallback(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        const bool clearing = info.Length() < 1 || info[0].IsNull() || info[0].IsUndefined();
+        if (!clearing && !info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Callback function required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        // Detach the recorder before the old callback goes away
+        m_recorder->setUtteranceCallback(nullptr);
+        if (m_utteranceCallback) {
+            m_utteranceCallback->Release();
+            m_utteranceCallback.reset();
+        }
+        if (clearing) {
+            return env.Undefined();
+        }
+        
+        m_utteranceCallback = ClosableCallback::New(env, info[0].As<Napi::Function>(), "UtteranceCallback");
+        std::shared_ptr<ClosableCallback> utteranceCallback = m_utteranceCallback;
+        m_recorder->setUtteranceCallback([utteranceCallback](const UtteranceEvent& event) {
+            auto pending = std::make_shared<UtteranceEvent>(event);
+            utteranceCallback->NonBlockingCall([pending](Napi::Env env, Napi::Function jsCallback) {
+                jsCallback.Call({ UtteranceEventToJS(env, *pending) });
+            });
+        });
+        
+        return env.Undefined();
+    }
+
+    // getSessionId() - the current or last endpointed recording, as passed to
+    // the transcriber's awaitDictation(); 0 before the first
+    Napi::Value GetSessionId(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        return Napi::Number::New(env, static_cast<double>(m_recorder->getUtteranceSession()));
+    }
+
+    Napi::Value StopRecording(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        bool result = m_recorder->stopRecording();
+        
+        // Nothing is delivered after stopRecording() returns, even if the
+        // source keeps running for the history; flush the last batch
+        if (m_audioBatcher) {
+            m_audioBatcher->Flush();
+        }
+        
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value PauseRecording(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        bool result = m_recorder->pauseRecording();
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value ResumeRecording(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        bool result = m_recorder->resumeRecording();
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value IsRecording(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        bool result = m_recorder->isRecording();
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value IsPaused(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        bool result = m_recorder->isPaused();
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value GetCurrentLevel(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        float level = m_recorder->getCurrentLevel();
+        return Napi::Number::New(env, level);
+    }
+
+    Napi::Value GetPeakLevel(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        float level = m_recorder->getPeakLevel();
+        return Napi::Number::New(env, level);
+    }
+
+    Napi::Value ResetPeakLevel(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        m_recorder->resetPeakLevel();
+        return env.Undefined();
+    }
+
+    Napi::Value GetMeter(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        // Latest snapshot only; meant to be polled at the UI frame rate
+        AudioMeterReading reading;
+        m_recorder->readMeter(reading);
+        return MeterReadingToJS(env, reading);
+    }
+
+    Napi::Value GetAudioData(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        size_t maxFrames = 0;
+        if (info.Length() > 0 && info[0].IsNumber()) {
+            maxFrames = info[0].As<Napi::Number>().Uint32Value();
+        }
+        
+        std::vector<float> audioData = m_samplePool->Acquire();
+        m_recorder->getAudioData(audioData, maxFrames);
+        
+        // Hand the pooled storage to JS; it is recycled when the array is collected
+        size_t sampleCount = audioData.size();
+        auto arrayBuffer = MoveToArrayBuffer(env, std::move(audioData), m_samplePool);
+        
+        return Napi::Float32Array::New(env, sampleCount, arrayBuffer, 0);
+    }
+
+    Napi::Value HasAudioData(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        bool result = m_recorder->hasAudioData();
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value ClearBuffer(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        m_recorder->clearBuffer();
+        return env.Undefined();
+    }
+
+    Napi::Value SetFormat(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        // The capture format is whatever the source delivers; callers shape
+        // the stream they receive with setOutputFormat() instead
+        Napi::Error::New(env, "Capture format follows the source; use setOutputFormat()").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Value GetFormat(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        static const char* const kEncodingNames[] = { "unknown", "int16", "int24", "int32", "float32" };
+        const CaptureSourceFormat format = m_recorder->getSourceFormat();
+        const uint32_t blockAlign = format.sample.BytesPerFrame();
+        Napi::Object formatObj = Napi::Object::New(env);
+        
+        formatObj.Set("sampleRate", Napi::Number::New(env, format.sampleRate));
+        formatObj.Set("channels", Napi::Number::New(env, format.sample.channels));
+        formatObj.Set("bitsPerSample", Napi::Number::New(env, format.sample.BytesPerSample() * 8));
+        formatObj.Set("blockAlign", Napi::Number::New(env, blockAlign));
+        formatObj.Set("avgBytesPerSec", Napi::Number::New(env, static_cast<double>(blockAlign) * format.sampleRate));
+        formatObj.Set("encoding", Napi::String::New(env, kEncodingNames[static_cast<size_t>(format.sample.encoding)]));
+        
+        return formatObj;
+    }
+
+    // setOutputFormat({ sampleRate?: number (0 = device rate), downmix?: 'average' | 'channel' | 'none', channel?: number })
+    // Applies from the next startRecording(); omitted fields keep their current value.
+    Napi::Value SetOutputFormat(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Output format object required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        Napi::Object formatObj = info[0].As<Napi::Object>();
+        CaptureOutputFormat format = m_recorder->getOutputFormat();
+        if (formatObj.Has("sampleRate")) {
+            format.sampleRate = formatObj.Get("sampleRate").ToNumber().Uint32Value();
+        }
+        if (formatObj.Has("downmix")) {
+            const std::string downmix = formatObj.Get("downmix").ToString().Utf8Value();
+            if (downmix == "average") {
+                format.downmix = DownmixMode::Average;
+            } else if (downmix == "channel") {
+                format.downmix = DownmixMode::SelectChannel;
+            } else if (downmix == "none") {
+                format.downmix = DownmixMode::None;
+            } else {
+                Napi::TypeError::New(env, "downmix must be 'average', 'channel' or 'none'").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+        }
+        if (formatObj.Has("channel")) {
+            format.channel = formatObj.Get("channel").ToNumber().Uint32Value();
+        }
+        
+        bool result = m_recorder->setOutputFormat(format);
+        return Napi::Boolean::New(env, result);
+    }
+
+    Napi::Value GetOutputFormat(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        const CaptureOutputFormat format = m_recorder->getOutputFormat();
+        static const char* const kDownmixNames[] = { "none", "average", "channel" };
+        Napi::Object formatObj = Napi::Object::New(env);
+        
+        formatObj.Set("sampleRate", Napi::Number::New(env, m_recorder->getOutputSampleRate()));
+        formatObj.Set("channels", Napi::Number::New(env, m_recorder->getOutputChannels()));
+        formatObj.Set("downmix", Napi::String::New(env, kDownmixNames[static_cast<size_t>(format.downmix)]));
+        formatObj.Set("channel", Napi::Number::New(env, format.channel));
+        
+        return formatObj;
+    }
+
+    Napi::Value SetBufferSize(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Buffer size in milliseconds required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        uint32_t bufferSizeMs = info[0].As<Napi::Number>().Uint32Value();
+        m_recorder->setBufferSize(bufferSizeMs);
+        
+        return env.Undefined();
+    }
+
+    Napi::Value GetBufferSize(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        uint32_t bufferSize = m_recorder->getBufferSize();
+        return Napi::Number::New(env, bufferSize);
+    }
+
+    // enableNoiseSupression(enable, { maxAttenuationDb?, noiseWindowMs?, hopMs? })
+    // Options take effect when capture next starts.
+    Napi::Value EnableNoiseSupression(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsBoolean()) {
+            Napi::TypeError::New(env, "Boolean value required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        if (info.Length() > 1 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            NoiseSuppressorConfig config = m_recorder->getNoiseSuppressorConfig();
+            config.maxAttenuationDb = GetFloatOption(options, "maxAttenuationDb", config.maxAttenuationDb);
+            config.noiseWindowMs = GetUint32Option(options, "noiseWindowMs", config.noiseWindowMs);
+            config.hopMs = GetUint32Option(options, "hopMs", config.hopMs);
+            if (config.hopMs == 0 || config.noiseWindowMs == 0) {
+                Napi::RangeError::New(env, "hopMs and noiseWindowMs must be positive").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            m_recorder->setNoiseSuppressorConfig(config);
+        }
+        
+        bool enable = info[0].As<Napi::Boolean>().Value();
+        m_recorder->enableNoiseSupression(enable);
+        
+        return env.Undefined();
+    }
+
+    Napi::Value EnableEchoCancellation(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsBoolean()) {
+            Napi::TypeError::New(env, "Boolean value required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        bool enable = info[0].As<Napi::Boolean>().Value();
+        m_recorder->enableEchoCancellation(enable);
+        
+        return env.Undefined();
+    }
+
+    Napi::Value EnableAutomaticGainControl(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsBoolean()) {
+            Napi::TypeError::New(env, "Boolean value required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        bool enable = info[0].As<Napi::Boolean>().Value();
+        m_recorder->enableAutomaticGainControl(enable);
+        
+        return env.Undefined();
+    }
+
+    Napi::Value SetGainLevel(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Gain level required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        float gain = info[0].As<Napi::Number>().FloatValue();
+        m_recorder->setGainLevel(gain);
+        
+        return env.Undefined();
+    }
+
+    Napi::Value GetPerformanceStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        auto stats = m_recorder->getPerformanceStats();
+        Napi::Object statsObj = Napi::Object::New(env);
+        
+        statsObj.Set("cpuUsage", Napi::Number::New(env, stats.cpuUsage));
+        statsObj.Set("memoryUsage", Napi::Number::New(env, stats.memoryUsage));
+        statsObj.Set("droppedFrames", Napi::Number::New(env, stats.droppedFrames));
+        statsObj.Set("averageLatency", Napi::Number::New(env, stats.averageLatency));
+        statsObj.Set("bufferOverruns", Napi::Number::New(env, stats.bufferOverruns));
+        statsObj.Set("bufferUnderruns", Napi::Number::New(env, stats.bufferUnderruns));
+        // null unless this build counts allocations
+        statsObj.Set("captureAllocations", AllocationCounter::Enabled()
+            ? Napi::Value(Napi::Number::New(env, static_cast<double>(stats.captureAllocations)))
+            : env.Null());
+        
+        AudioBatchDispatcher::Stats batchStats;
+        if (m_audioBatcher) {
+            batchStats = m_audioBatcher->GetStats();
+        }
+        statsObj.Set("deliveredBatches", Napi::Number::New(env, static_cast<double>(batchStats.deliveredBatches)));
+        statsObj.Set("droppedBatches", Napi::Number::New(env, static_cast<double>(batchStats.droppedBatches)));
+        statsObj.Set("droppedBatchFrames", Napi::Number::New(env, static_cast<double>(batchStats.droppedFrames)));
+        
+        return statsObj;
+    }
+
+    // WASAPIRecorder.getThreadAllocations() - operator new calls the addon
+    // has made on the calling thread; null unless this build counts
+    // allocations. Shows that the counter sees the addon's allocations at all.
+    static Napi::Value GetThreadAllocations(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (!AllocationCounter::Enabled()) {
+            return env.Null();
+        }
+        return Napi::Number::New(env, static_cast<double>(AllocationCounter::ThisThread()));
+    }
+
+    Napi::Value SetAudioDataCallback(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Callback function required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        AudioBatchDispatcher::Options options;
+        if (info.Length() > 1 && info[1].IsObject()) {
+            Napi::Object optionsObj = info[1].As<Napi::Object>();
+            if (optionsObj.Has("batchMs")) {
+                options.batchMs = (std::max)(1u, optionsObj.Get("batchMs").As<Napi::Number>().Uint32Value());
+            }
+            if (optionsObj.Has("maxQueuedBatches")) {
+                options.maxQueuedBatches = (std::max)(1u, optionsObj.Get("maxQueuedBatches").As<Napi::Number>().Uint32Value());
+            }
+        }
+        
+        // Packets are copied into pooled batches on the capture thread and
+        // handed to JS without waiting; a busy JS thread costs dropped batches,
+        // never a stalled capture loop
+        auto batcher = std::make_shared<AudioBatchDispatcher>(env, info[0].As<Napi::Function>(), options, m_samplePool);
+        batcher->Reserve(m_recorder->getOutputSampleRate(), m_recorder->getOutputChannels());
+        CaptureCore* recorder = m_recorder.get();
+        
+        m_recorder->setAudioDataCallback([batcher, recorder](const float* data, size_t frameCount, double timestamp) {
+            batcher->Append(data, frameCount, recorder->getOutputChannels(), recorder->getOutputSampleRate(), timestamp);
+        });
+        m_audioBatcher = std::move(batcher);
+        
+        return env.Undefined();
+    }
+
+    Napi::Value SetLevelCallback(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Callback function required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        double rateHz = 30.0;
+        if (info.Length() > 1 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            if (options.Has("rateHz")) {
+                rateHz = std::clamp(options.Get("rateHz").As<Napi::Number>().DoubleValue(), 1.0, 240.0);
+            }
+        }
+        
+        // Replacing the pump joins the previous timer thread first
+        m_levelPump.reset();
+        m_levelPump = std::make_unique<LevelCallbackPump>(env, info[0].As<Napi::Function>(), m_recorder.get(), rateHz);
+        
+        return env.Undefined();
+    }
+
+    Napi::Value SetDeviceChangeCallback(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Callback function required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        if (m_deviceChangeCallback) {
+            m_deviceChangeCallback->Release();
+        }
+        m_deviceChangeCallback = ClosableCallback::New(env, info[0].As<Napi::Function>(), "DeviceChangeCallback");
+        
+#ifdef _WIN32
+        if (WasapiCaptureSource* wasapi = wasapiSource()) {
+            std::shared_ptr<ClosableCallback> deviceChangeCallback = m_deviceChangeCallback;
+            wasapi->setDeviceChangeCallback([deviceChangeCallback](const AudioDevice& device, bool connected) {
+                deviceChangeCallback->NonBlockingCall([=](Napi::Env env, Napi::Function jsCallback) {
+                    jsCallback.Call({
+                        DeviceToJS(env, device),
+                        Napi::Boolean::New(env, connected)
+                    });
+                });
+            });
+        }
+#endif
+        
+        return env.Undefined();
+    }
+
+    Napi::Value GetLastError(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        return Napi::String::New(env, m_recorder->getLastError());
+    }
+
+    Napi::Value HasError(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        bool hasError = m_recorder->hasError();
+        return Napi::Boolean::New(env, hasError);
+    }
+
+    Napi::Value ClearError(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        m_recorder->clearError();
+        return env.Undefined();
+    }
+};
+
+Napi::Object InitModule(Napi::Env env, Napi::Object exports) {
+    return CaptureBinding::Init(env, exports);
+}
+
+NODE_API_MODULE(wasapi_recorder, InitModule)
\ No newline at end of file
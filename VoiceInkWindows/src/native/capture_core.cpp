@@ -0,0 +1,972 @@
+#include "capture_core.h"
+#include "allocation_counter.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+constexpr float VAD_THRESHOLD = 0.01f;
+constexpr size_t MAX_QUEUE_SIZE = 100;
+constexpr uint32_t DEFAULT_BUFFER_SIZE_MS = 50;
+constexpr size_t ALLOCATION_WARMUP_PACKETS = 50;
+constexpr uint32_t NO_BLOCK = FixedBlockPool<float>::kNoBlock;
+
+// Seconds, on the same clock for every source
+static double captureTimestamp() {
+    auto now = std::chrono::high_resolution_clock::now();
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch());
+    return static_cast<double>(millis.count()) / 1000.0;
+}
+
+CaptureCore::CaptureCore()
+    : m_bufferSizeMs(DEFAULT_BUFFER_SIZE_MS)
+    , m_isCapturing(false)
+    , m_isRecording(false)
+    , m_isPaused(false)
+    , m_processingPacket(false)
+    , m_pendingPreRollFrames(0)
+    , m_shouldStop(false)
+    , m_sourceEnded(false)
+    , m_readBlock(NO_BLOCK)
+    , m_readOffset(0)
+    , m_maxQueueSize(MAX_QUEUE_SIZE)
+    , m_historyMs(0)
+    , m_endpointingEnabled(false)
+    , m_utteranceSession(0)
+    , m_recordingFileEncoding(SampleEncoding::Int16)
+    , m_recordingFileContainer(RecordingContainer::Wav)
+    , m_currentLevel(0.0f)
+    , m_peakLevel(0.0f)
+    , m_noiseSuppressionEnabled(false)
+    , m_noiseSuppressorRunning(false)
+    , m_echoCancellationEnabled(false)
+    , m_echoCancellerRunning(false)
+    , m_echoCancellerNanos(0)
+    , m_echoCancellerFrames(0)
+    , m_agcEnabled(false)
+    , m_gainLevel(1.0f)
+    , m_gainStageRunning(false)
+    , m_perfStats{}
+    , m_vadThreshold(VAD_THRESHOLD)
+    , m_vadSmoothingFactor(0.95f)
+    , m_vadLevel(0.0f)
+{
+    m_lastPerfUpdate = std::chrono::high_resolution_clock::now();
+}
+
+CaptureCore::~CaptureCore() {
+    stopRecording();
+    stopCapture();
+    finishEndpointing();
+    finishRecordingFile();
+}
+
+bool CaptureCore::setSource(std::unique_ptr<CaptureSource> source) {
+    if (m_isCapturing) {
+        setError("Cannot change the capture source while capturing");
+        return false;
+    }
+
+    m_source = std::move(source);
+    return reopenSource();
+}
+
+bool CaptureCore::reopenSource() {
+    if (!m_source) {
+        setError("No capture source");
+        return false;
+    }
+    if (m_isCapturing) {
+        setError("Cannot reopen the capture source while capturing");
+        return false;
+    }
+    if (!m_source->open(m_bufferSizeMs)) {
+        setError(m_source->getLastError());
+        return false;
+    }
+    return true;
+}
+
+bool CaptureCore::setEchoReference(std::unique_ptr<CaptureSource> source) {
+    if (m_isCapturing) {
+        setError("Cannot change the echo reference while capturing");
+        return false;
+    }
+
+    m_echoReference.reset();
+    if (!source) {
+        return true;
+    }
+    auto reference = std::make_unique<EchoReferenceStage>(std::move(source));
+    if (!reference->open(m_bufferSizeMs)) {
+        setError(reference->getLastError());
+        return false;
+    }
+    m_echoReference = std::move(reference);
+    return true;
+}
+
+EchoCancellerReport CaptureCore::getEchoCancellerStats() {
+    EchoCancellerReport report;
+    m_echoMailbox.Read(report);
+    if (m_echoReference) {
+        const EchoReferenceStage::Stats stats = m_echoReference->stats();
+        report.referenceUnderrunFrames = stats.underrunFrames;
+        report.referenceDroppedFrames = stats.droppedFrames;
+    }
+    return report;
+}
+
+CaptureSourceFormat CaptureCore::getSourceFormat() const {
+    return m_source ? m_source->format() : CaptureSourceFormat();
+}
+
+bool CaptureCore::startRecording(uint32_t preRollMs) {
+    if (m_isRecording) {
+        return true; // Already recording
+    }
+
+    // Without history the capture thread starts out recording, so an
+    // unclocked source cannot run ahead of the first packets
+    if (!m_isCapturing) {
+        return startCapture(true);
+    }
+    if (!startEndpointing()) {
+        return false;
+    }
+    if (!startRecordingFile()) {
+        finishEndpointing();
+        return false;
+    }
+
+    // Picked up by the capture thread before its next packet
+    m_pendingPreRollFrames = m_history
+        ? static_cast<size_t>(preRollMs) * m_history->SampleRate() / 1000
+        : 0;
+    m_isPaused = false;
+    m_isRecording = true;
+    return true;
+}
+
+bool CaptureCore::stopRecording() {
+    if (!m_isRecording) {
+        return true; // Already stopped
+    }
+
+    m_isRecording = false;
+    m_pendingPreRollFrames = 0;
+
+    if (m_historyMs == 0) {
+        stopCapture();
+    } else {
+        // The source keeps feeding the history. Wait out the packet in flight
+        // so nothing is queued or delivered after this returns.
+        while (m_processingPacket) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Submits the utterance still open, if it is long enough
+    finishEndpointing();
+    return finishRecordingFile();
+}
+
+bool CaptureCore::startCapture(bool recording) {
+    if (!m_source) {
+        setError("Capture source not initialized");
+        return false;
+    }
+
+    // The source format is fixed for the whole capture
+    m_sourceFormat = m_source->format();
+    m_sampleConverter = SelectSampleConverter(m_sourceFormat.sample);
+    if (!m_sampleConverter.Valid() || m_sourceFormat.sampleRate == 0 || m_sourceFormat.maxPacketFrames == 0) {
+        setError("Unsupported capture format");
+        return false;
+    }
+
+    // Everything the capture thread needs is allocated here, up front
+    if (!allocateCaptureBlocks()) {
+        return false;
+    }
+
+    if (recording && !startEndpointing()) {
+        return false;
+    }
+    if (recording && !startRecordingFile()) {
+        finishEndpointing();
+        return false;
+    }
+
+    // The reference runs first so it has audio by the first microphone packet
+    if (m_echoReference && !m_echoReference->start()) {
+        setError(m_echoReference->getLastError());
+        finishEndpointing();
+        finishRecordingFile();
+        return false;
+    }
+    if (!m_source->start()) {
+        setError(m_source->getLastError());
+        if (m_echoReference) {
+            m_echoReference->stop();
+        }
+        finishEndpointing();
+        finishRecordingFile();
+        return false;
+    }
+
+    m_shouldStop = false;
+    m_sourceEnded = false;
+    m_isPaused = false;
+    m_pendingPreRollFrames = 0;
+    m_isRecording = recording;
+    m_perfStats.capturedFrames = 0;
+    m_isCapturing = true;
+    
+    // Start recording thread
+    m_recordingThread = std::thread(&CaptureCore::recordingLoop, this);
+
+    return true;
+}
+
+void CaptureCore::stopCapture() {
+    if (!m_isCapturing) {
+        return;
+    }
+
+    m_shouldStop = true;
+
+    // Wait for recording thread to finish
+    if (m_recordingThread.joinable()) {
+        m_recordingThread.join();
+    }
+
+    m_source->stop();
+    if (m_echoReference) {
+        m_echoReference->stop();
+    }
+    m_isCapturing = false;
+
+    if (m_historyMs == 0) {
+        m_history.reset();
+    }
+}
+
+bool CaptureCore::enableHistory(uint32_t durationMs) {
+    if (durationMs == 0) {
+        disableHistory();
+        return true;
+    }
+
+    if (m_isCapturing) {
+        // The ring is only allocated while the capture thread is stopped
+        const uint32_t rate = m_formatStage->OutputRate();
+        if (m_history && m_history->CapacityFrames() == static_cast<size_t>(durationMs) * rate / 1000) {
+            m_historyMs = durationMs;
+            return true;
+        }
+        setError(m_history ? "Cannot resize the history while capturing" : "Enable the history before recording");
+        return false;
+    }
+
+    m_historyMs = durationMs;
+    if (!startCapture(false)) {
+        m_historyMs = 0;
+        return false;
+    }
+    return true;
+}
+
+void CaptureCore::disableHistory() {
+    m_historyMs = 0;
+    if (!m_isRecording) {
+        stopCapture();
+        m_history.reset();
+    }
+}
+
+void CaptureCore::enableEndpointing(const EndpointerConfig& config) {
+    m_endpointerConfig = config;
+    m_endpointingEnabled = true;
+}
+
+void CaptureCore::setUtteranceSink(UtteranceSinkRef sink) {
+    std::lock_guard<std::mutex> lock(m_utteranceMutex);
+    m_utteranceSink = sink;
+    if (m_endpointStage) {
+        m_endpointStage->setSink(std::move(sink));
+    }
+}
+
+void CaptureCore::setUtteranceCallback(UtteranceCallback callback) {
+    std::lock_guard<std::mutex> lock(m_utteranceMutex);
+    m_utteranceCallback = callback;
+    if (m_endpointStage) {
+        m_endpointStage->setEventCallback(std::move(callback));
+    }
+}
+
+// Before the capture thread starts queueing a recording
+bool CaptureCore::startEndpointing() {
+    finishEndpointing();
+    if (!m_endpointingEnabled) {
+        return true;
+    }
+
+    EndpointerConfig config = m_endpointerConfig;
+    config.sampleRate = m_formatStage->OutputRate();
+    const size_t maxPushFrames = m_formatStage->MaxOutputFrames(std::max<size_t>(m_sourceFormat.maxPacketFrames, 1));
+
+    std::lock_guard<std::mutex> lock(m_utteranceMutex);
+    try {
+        m_endpointStage = std::make_unique<UtteranceEndpointStage>(config, static_cast<uint32_t>(m_formatStage->OutputChannels()),
+                                                                   maxPushFrames);
+    } catch (const std::bad_alloc&) {
+        setError("Failed to allocate the endpointing buffers");
+        return false;
+    }
+    m_utteranceSession = m_endpointStage->session();
+    m_endpointStage->setSink(m_utteranceSink);
+    m_endpointStage->setEventCallback(m_utteranceCallback);
+    m_endpointStage->start();
+    return true;
+}
+
+// Once the capture thread has stopped queueing
+void CaptureCore::finishEndpointing() {
+    std::unique_ptr<UtteranceEndpointStage> stage;
+    {
+        std::lock_guard<std::mutex> lock(m_utteranceMutex);
+        stage = std::move(m_endpointStage);
+    }
+    if (stage) {
+        stage->finish();
+    }
+}
+
+bool CaptureCore::setRecordingFile(const std::string& path, SampleEncoding encoding, RecordingContainer container) {
+    if (container == RecordingContainer::Flac && encoding != SampleEncoding::Int16 && encoding != SampleEncoding::Int24) {
+        setError("FLAC recordings are 16- or 24-bit PCM");
+        return false;
+    }
+    if (encoding != SampleEncoding::Int16 && encoding != SampleEncoding::Int24 && encoding != SampleEncoding::Float32) {
+        setError("Recording files are 16- or 24-bit PCM or 32-bit float");
+        return false;
+    }
+    m_recordingFilePath = path;
+    m_recordingFileEncoding = encoding;
+    m_recordingFileContainer = container;
+    return true;
+}
+
+RecordingFileStats CaptureCore::getRecordingFileStats() const {
+    return m_recordingFile ? m_recordingFile->Stats() : RecordingFileStats();
+}
+
+// Before the capture thread starts queueing a recording
+bool CaptureCore::startRecordingFile() {
+    finishRecordingFile();
+    m_recordingFile.reset();
+    if (m_recordingFilePath.empty()) {
+        return true;
+    }
+
+    RecordingFileFormat format;
+    format.encoding = m_recordingFileEncoding;
+    format.channels = static_cast<uint16_t>(m_formatStage->OutputChannels());
+    format.sampleRate = m_formatStage->OutputRate();
+    std::unique_ptr<RecordingFileWriter> writer = CreateRecordingFileWriter(m_recordingFileContainer);
+    std::string error;
+    if (!writer->Open(m_recordingFilePath, format, error)) {
+        setError(error);
+        return false;
+    }
+    m_recordingFile = std::move(writer);
+    return true;
+}
+
+// Once the capture thread has stopped queueing. The writer is kept for its stats.
+bool CaptureCore::finishRecordingFile() {
+    if (!m_recordingFile || !m_recordingFile->IsOpen()) {
+        return true;
+    }
+    const std::string path = m_recordingFile->Path();
+    if (!m_recordingFile->Close()) {
+        setError("Failed to write the recording to " + path);
+        return false;
+    }
+    return true;
+}
+
+bool CaptureCore::pauseRecording() {
+    if (!m_isRecording || m_isPaused) {
+        return false;
+    }
+
+    m_isPaused = true;
+    return true;
+}
+
+bool CaptureCore::resumeRecording() {
+    if (!m_isRecording || !m_isPaused) {
+        return false;
+    }
+
+    m_isPaused = false;
+    return true;
+}
+
+float CaptureCore::getCurrentLevel() {
+    return m_currentLevel.load();
+}
+
+float CaptureCore::getPeakLevel() {
+    return m_peakLevel.load();
+}
+
+void CaptureCore::resetPeakLevel() {
+    m_peakLevel = 0.0f;
+}
+
+bool CaptureCore::readMeter(AudioMeterReading& reading) {
+    return m_meterMailbox.Read(reading);
+}
+
+bool CaptureCore::setOutputFormat(const CaptureOutputFormat& format) {
+    if (m_isCapturing) {
+        setError("Cannot change the output format while capturing");
+        return false;
+    }
+    if (!format.Valid()) {
+        setError("Resampling requires a downmix to mono");
+        return false;
+    }
+
+    m_outputFormat = format;
+    return true;
+}
+
+uint32_t CaptureCore::getOutputSampleRate() const {
+    return m_outputFormat.sampleRate ? m_outputFormat.sampleRate : getSourceFormat().sampleRate;
+}
+
+uint32_t CaptureCore::getOutputChannels() const {
+    return m_outputFormat.downmix == DownmixMode::None ? getSourceFormat().sample.channels : 1;
+}
+
+std::vector<float> CaptureCore::getAudioData(size_t maxFrames) {
+    std::vector<float> result;
+    getAudioData(result, maxFrames);
+    return result;
+}
+
+size_t CaptureCore::getAudioData(std::vector<float>& out, size_t maxFrames) {
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    if (!m_blockPool) {
+        return 0;
+    }
+    
+    // Size the output once for everything queued so draining rarely reallocates
+    size_t queuedSamples = (m_filledBlocks->Available() + 1) * m_blockPool->BlockSize();
+    if (maxFrames > 0) {
+        queuedSamples = std::min(queuedSamples, maxFrames * m_formatStage->OutputChannels());
+    }
+    out.reserve(out.size() + queuedSamples);
+    
+    size_t totalFrames = 0;
+    
+    while (maxFrames == 0 || totalFrames < maxFrames) {
+        const uint32_t block = nextReadBlock();
+        if (block == NO_BLOCK) {
+            break;
+        }
+        
+        const BlockInfo& info = m_blockInfo[block];
+        size_t framesToCopy = info.frameCount - m_readOffset;
+        if (maxFrames > 0) {
+            framesToCopy = std::min(framesToCopy, maxFrames - totalFrames);
+        }
+        
+        const float* samples = m_blockPool->Data(block) + m_readOffset * info.channelCount;
+        out.insert(out.end(), samples, samples + framesToCopy * info.channelCount);
+        
+        totalFrames += framesToCopy;
+        m_readOffset += framesToCopy;
+        
+        // A partially read block stays current for the next call
+        if (m_readOffset == info.frameCount) {
+            releaseReadBlock();
+        }
+    }
+    
+    return totalFrames;
+}
+
+AudioBuffer CaptureCore::getAudioBuffer() {
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    
+    const uint32_t block = m_blockPool ? nextReadBlock() : NO_BLOCK;
+    if (block == NO_BLOCK) {
+        return AudioBuffer();
+    }
+    
+    const BlockInfo& info = m_blockInfo[block];
+    const float* samples = m_blockPool->Data(block) + m_readOffset * info.channelCount;
+    
+    AudioBuffer buffer;
+    buffer.frameCount = info.frameCount - m_readOffset;
+    buffer.samples.assign(samples, samples + buffer.frameCount * info.channelCount);
+    buffer.timestamp = info.timestamp;
+    buffer.channelCount = info.channelCount;
+    buffer.sampleRate = info.sampleRate;
+    
+    releaseReadBlock();
+    return buffer;
+}
+
+bool CaptureCore::hasAudioData() {
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    return m_readBlock != NO_BLOCK || (m_filledBlocks && m_filledBlocks->Available() > 0);
+}
+
+void CaptureCore::clearBuffer() {
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    if (!m_blockPool) {
+        return;
+    }
+    
+    if (m_readBlock != NO_BLOCK) {
+        releaseReadBlock();
+    }
+    uint32_t block = NO_BLOCK;
+    while (m_filledBlocks->Read(&block, 1) == 1) {
+        m_blockPool->Release(block);
+    }
+}
+
+bool CaptureCore::allocateCaptureBlocks() {
+    // One block holds the largest packet the source can deliver, after
+    // conversion to the output format
+    const size_t packetFrames = std::max<size_t>(m_sourceFormat.maxPacketFrames, 1);
+    
+    std::lock_guard<std::mutex> lock(m_bufferMutex);
+    try {
+        // A fresh stage per recording also drops the previous filter history
+        m_formatStage = std::make_unique<CaptureFormatStage>(m_sourceFormat.sample.channels, m_sourceFormat.sampleRate, m_outputFormat);
+        m_sourceSamples.assign(packetFrames * m_formatStage->InputChannels(), 0.0f);
+        // Built even while disabled so it can be switched on mid-recording
+        NoiseSuppressorConfig suppressorConfig = m_noiseSuppressorConfig;
+        suppressorConfig.sampleRate = m_formatStage->OutputRate();
+        m_noiseSuppressor = std::make_unique<NoiseSuppressor>(suppressorConfig, static_cast<uint32_t>(m_formatStage->OutputChannels()));
+        m_noiseSuppressorRunning = false;
+        GainStageConfig gainConfig;
+        gainConfig.sampleRate = m_formatStage->OutputRate();
+        m_gainStage = std::make_unique<GainStage>(gainConfig, static_cast<uint32_t>(m_formatStage->OutputChannels()));
+        m_gainStageRunning = false;
+        EchoCancellerConfig echoConfig;
+        echoConfig.sampleRate = m_formatStage->OutputRate();
+        m_echoCanceller = std::make_unique<EchoCanceller>(echoConfig, static_cast<uint32_t>(m_formatStage->OutputChannels()));
+        m_echoCancellerRunning = false;
+        m_referenceSamples.assign(m_formatStage->MaxOutputFrames(packetFrames), 0.0f);
+    } catch (const std::bad_alloc&) {
+        setError("Failed to allocate capture buffers");
+        return false;
+    }
+    m_echoMailbox.Publish(EchoCancellerReport());
+    if (m_echoReference && !m_echoReference->prepare(m_formatStage->OutputRate(), m_referenceSamples.size())) {
+        setError(m_echoReference->getLastError());
+        return false;
+    }
+    
+    const size_t channelCount = m_formatStage->OutputChannels();
+    const uint32_t outputRate = m_formatStage->OutputRate();
+    const size_t historyFrames = static_cast<size_t>(m_historyMs) * outputRate / 1000;
+    if (historyFrames == 0) {
+        m_history.reset();
+    } else if (m_history && m_history->CapacityFrames() == historyFrames && m_history->Channels() == channelCount &&
+               m_history->SampleRate() == outputRate) {
+        m_history->Reset();
+    } else {
+        try {
+            // Views handed out earlier keep the old ring alive
+            m_history = std::make_shared<AudioHistoryRing>(historyFrames, static_cast<uint32_t>(channelCount), outputRate);
+        } catch (const std::bad_alloc&) {
+            m_history.reset();
+            setError("Failed to allocate the audio history");
+            return false;
+        }
+    }
+
+    const size_t blockSize = m_formatStage->MaxOutputFrames(packetFrames) * channelCount;
+    if (m_blockPool && m_blockPool->BlockSize() == blockSize) {
+        return true;
+    }
+    
+    // Room for a full queue plus the block the reader is partway through;
+    // the index ring can then never overflow
+    const uint32_t blockCount = static_cast<uint32_t>(m_maxQueueSize) + 1;
+    try {
+        m_blockPool = std::make_unique<FixedBlockPool<float>>(blockCount, blockSize);
+        m_filledBlocks = std::make_unique<SpscRingBuffer<uint32_t>>(blockCount, RingOverflowPolicy::DropOldest);
+        m_blockInfo.assign(blockCount, BlockInfo{ 0.0, 0, channelCount, m_formatStage->OutputRate() });
+        m_scratchBlock.assign(blockSize, 0.0f);
+    } catch (const std::bad_alloc&) {
+        m_blockPool.reset();
+        m_filledBlocks.reset();
+        setError("Failed to allocate capture buffers");
+        return false;
+    }
+    
+    m_readBlock = NO_BLOCK;
+    m_readOffset = 0;
+    return true;
+}
+
+// Capture thread. Never allocates: when the reader has fallen behind and
+// every block is queued, the oldest queued block is recycled.
+uint32_t CaptureCore::acquireCaptureBlock() {
+    uint32_t block = m_blockPool->Acquire();
+    if (block == NO_BLOCK && m_filledBlocks->EvictOldest(block)) {
+        m_perfStats.bufferOverruns++;
+        m_perfStats.droppedFrames += m_blockInfo[block].frameCount;
+    }
+    return block;
+}
+
+// Reader side, under m_bufferMutex
+uint32_t CaptureCore::nextReadBlock() {
+    uint32_t block = NO_BLOCK;
+    if (m_readBlock == NO_BLOCK && m_filledBlocks->Read(&block, 1) == 1) {
+        m_readBlock = block;
+        m_readOffset = 0;
+    }
+    return m_readBlock;
+}
+
+void CaptureCore::releaseReadBlock() {
+    m_blockPool->Release(m_readBlock);
+    m_readBlock = NO_BLOCK;
+    m_readOffset = 0;
+}
+
+void CaptureCore::recordingLoop() {
+    m_source->onCaptureThreadStart();
+    if (m_echoReference) {
+        m_echoReference->onCaptureThreadStart();
+    }
+    
+    // Allocations are only tolerated while the first packets warm up
+    size_t packetCount = 0;
+    uint64_t allocationBaseline = 0;
+    
+    const bool realtime = m_source->isRealtime();
+    
+    while (!m_shouldStop) {
+        // An unclocked source waits for the reader and the endpointer rather
+        // than overrunning them
+        if (!realtime && !hasQueueRoom()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        CapturePacket packet;
+        const CaptureReadStatus status = m_source->readPacket(packet);
+        if (status == CaptureReadStatus::Timeout) {
+            continue;
+        }
+        if (status == CaptureReadStatus::EndOfStream) {
+            m_sourceEnded = true;
+            break;
+        }
+        if (status == CaptureReadStatus::Failed) {
+            setError(m_source->getLastError());
+            break;
+        }
+
+        // Announced before the recording state is read; stopRecording()
+        // waits for it to clear
+        m_processingPacket = true;
+        const bool queueing = m_isRecording && !m_isPaused;
+        if (queueing) {
+            const size_t preRollFrames = m_pendingPreRollFrames.exchange(0);
+            if (preRollFrames > 0) {
+                queuePreRoll(preRollFrames);
+            }
+        }
+
+        // Paused recordings keep draining the source so nothing stale is
+        // left queued on resume; the history keeps rolling regardless
+        if ((queueing || m_history) && packet.data && packet.frameCount > 0) {
+            processAudioData(packet, queueing);
+        }
+        m_processingPacket = false;
+
+        m_source->releasePacket(packet);
+        m_perfStats.capturedFrames += packet.frameCount;
+
+        if (AllocationCounter::Enabled()) {
+            if (++packetCount == ALLOCATION_WARMUP_PACKETS) {
+                allocationBaseline = AllocationCounter::ThisThread();
+            } else if (packetCount > ALLOCATION_WARMUP_PACKETS) {
+                m_perfStats.captureAllocations = AllocationCounter::ThisThread() - allocationBaseline;
+            }
+        }
+    }
+
+    if (m_echoReference) {
+        m_echoReference->onCaptureThreadStop();
+    }
+    m_source->onCaptureThreadStop();
+}
+
+// Capture thread. Brackets the check like a packet, so stopRecording()
+// cannot retire the endpointing stage underneath it.
+bool CaptureCore::hasQueueRoom() {
+    m_processingPacket = true;
+    bool room = true;
+    if (m_isRecording && !m_isPaused) {
+        const size_t blockFrames = m_blockPool->BlockSize() / m_formatStage->OutputChannels();
+        room = m_blockPool->FreeCount() > 0 && (!m_endpointStage || m_endpointStage->hasRoom(blockFrames));
+    }
+    m_processingPacket = false;
+    return room;
+}
+
+void CaptureCore::processAudioData(const CapturePacket& packet, bool queueing) {
+    const size_t sourceChannels = m_formatStage->InputChannels();
+    const size_t channelCount = m_formatStage->OutputChannels();
+    const size_t packetFrames = m_sourceSamples.size() / sourceChannels;
+    const size_t bytesPerFrame = m_sampleConverter.Format().BytesPerFrame();
+    const double timestamp = captureTimestamp();
+
+    // Packets fit in one block; anything larger is split
+    for (size_t offset = 0; offset < packet.frameCount;) {
+        const size_t sourceFrameCount = std::min<size_t>(packet.frameCount - offset, packetFrames);
+        offset += sourceFrameCount;
+
+        // Convert from the source encoding to float
+        float* sourceSamples = m_sourceSamples.data();
+        if (packet.silent) {
+            std::fill(sourceSamples, sourceSamples + sourceFrameCount * sourceChannels, 0.0f);
+        } else {
+            m_sampleConverter.Convert(packet.data + (offset - sourceFrameCount) * bytesPerFrame, sourceSamples, sourceFrameCount);
+        }
+
+        // Without a free block the packet is still metered and delivered,
+        // just not queued for getAudioData(). Between recordings it only
+        // feeds the history.
+        const uint32_t block = queueing ? acquireCaptureBlock() : NO_BLOCK;
+        float* samples = block != NO_BLOCK ? m_blockPool->Data(block) : m_scratchBlock.data();
+
+        // Downmix and resample to the output format. The resampler holds
+        // input back until it has enough history, so a short packet can
+        // produce nothing.
+        const size_t blockFrameCount = m_formatStage->Process(sourceSamples, sourceFrameCount, samples);
+        if (blockFrameCount == 0) {
+            if (block != NO_BLOCK) {
+                m_blockPool->Release(block);
+            }
+            continue;
+        }
+        if (queueing && block == NO_BLOCK) {
+            m_perfStats.droppedFrames += blockFrameCount;
+        }
+
+        // The reference is pulled for every block, cancelling or not, so it
+        // keeps pace with the microphone
+        const float* reference = nullptr;
+        if (m_echoReference) {
+            m_echoReference->pull(m_referenceSamples.data(), blockFrameCount);
+            reference = m_referenceSamples.data();
+        }
+
+        // Apply audio processing
+        applyAudioProcessing(samples, reference, blockFrameCount);
+
+        if (m_history) {
+            m_history->Write(samples, blockFrameCount, timestamp);
+        }
+        if (queueing && m_endpointStage) {
+            m_endpointStage->push(samples, blockFrameCount, timestamp);
+        }
+        if (queueing && m_recordingFile) {
+            m_recordingFile->WriteSamples(samples, blockFrameCount * channelCount);
+        }
+
+        // One pass over the processed block feeds both the meter and VAD
+        const PacketStatistics stats = MeasurePacket(samples, blockFrameCount, channelCount);
+        updateAudioLevels(samples, blockFrameCount, stats, timestamp);
+        bool voiceDetected = detectVoiceActivity(stats);
+
+        // Call audio data callback; it copies what it needs before returning
+        if (queueing && m_audioDataCallback && voiceDetected) {
+            m_audioDataCallback(samples, blockFrameCount, timestamp);
+        }
+
+        // Hand the block to the reader; the ring holds every block, so this cannot fail
+        if (block != NO_BLOCK) {
+            m_blockInfo[block] = BlockInfo{ timestamp, blockFrameCount, channelCount, m_formatStage->OutputRate() };
+            m_filledBlocks->Write(&block, 1);
+        }
+    }
+}
+
+// Capture thread. Queues the newest history ahead of the first live packet
+// of a recording, block by block, with the timestamps it was captured at.
+// Pre-roll is delivered whether or not VAD fired; catching onsets VAD is
+// late for is its purpose.
+void CaptureCore::queuePreRoll(size_t frameCount) {
+    if (!m_history) {
+        return;
+    }
+
+    const AudioHistoryRing::Window window = m_history->LatestFromWriter(frameCount);
+    const size_t channelCount = m_history->Channels();
+    const size_t blockFrames = m_blockPool->BlockSize() / channelCount;
+    const uint32_t sampleRate = m_history->SampleRate();
+
+    for (size_t offset = 0; offset < window.frames;) {
+        const size_t frames = std::min(window.frames - offset, blockFrames);
+        const float* samples = window.data + offset * channelCount;
+        const double timestamp = window.startTimestamp + static_cast<double>(offset) / sampleRate;
+        offset += frames;
+
+        if (m_audioDataCallback) {
+            m_audioDataCallback(samples, frames, timestamp);
+        }
+        if (m_endpointStage) {
+            m_endpointStage->push(samples, frames, timestamp);
+        }
+        if (m_recordingFile) {
+            m_recordingFile->WriteSamples(samples, frames * channelCount);
+        }
+
+        const uint32_t block = acquireCaptureBlock();
+        if (block == NO_BLOCK) {
+            m_perfStats.droppedFrames += frames;
+            continue;
+        }
+        std::copy(samples, samples + frames * channelCount, m_blockPool->Data(block));
+        m_blockInfo[block] = BlockInfo{ timestamp, frames, channelCount, sampleRate };
+        m_filledBlocks->Write(&block, 1);
+    }
+}
+
+void CaptureCore::updateAudioLevels(const float* samples, size_t frameCount, const PacketStatistics& stats,
+                                    double timestamp) {
+    const AudioMeterReading& reading = m_meter.Process(samples, frameCount, m_formatStage->OutputChannels(),
+                                                       m_formatStage->OutputRate(), stats, timestamp);
+    
+    m_currentLevel = reading.level;
+    m_peakLevel = std::max(m_peakLevel.load(), reading.peak);
+    
+    // Readers pick up the latest snapshot at their own rate; nothing is
+    // pushed across threads per packet
+    m_meterMailbox.Publish(reading);
+}
+
+void CaptureCore::applyAudioProcessing(float* samples, const float* reference, size_t frameCount) {
+    // First, while the echo is still a linear function of the reference
+    applyEchoCancellation(samples, reference, frameCount);
+
+    if (m_noiseSuppressionEnabled) {
+        applyNoiseSupression(samples, frameCount);
+    } else {
+        m_noiseSuppressorRunning = false;
+    }
+
+    // Last, so nothing after the limiter can push a peak over its ceiling
+    applyGainStage(samples, frameCount);
+}
+
+void CaptureCore::applyNoiseSupression(float* samples, size_t frameCount) {
+    // Switched back on: start over rather than replay audio from before the gap
+    if (!m_noiseSuppressorRunning) {
+        m_noiseSuppressor->Reset();
+        m_noiseSuppressorRunning = true;
+    }
+    m_noiseSuppressor->Process(samples, frameCount);
+}
+
+void CaptureCore::applyGainStage(float* samples, size_t frameCount) {
+    // At unity with AGC off the stage is bypassed, so it only adds latency
+    // while it has something to do. Engaging it mid-stream inserts its
+    // look-ahead as silence; bypassing it drops what it was holding.
+    const float gain = m_gainLevel;
+    const bool agc = m_agcEnabled;
+    if (gain == 1.0f && !agc) {
+        m_gainStageRunning = false;
+        return;
+    }
+
+    m_gainStage->SetGain(gain);
+    m_gainStage->SetAgcEnabled(agc);
+    if (!m_gainStageRunning) {
+        m_gainStage->Reset();
+        m_gainStageRunning = true;
+    }
+    m_gainStage->Process(samples, frameCount);
+}
+
+void CaptureCore::applyEchoCancellation(float* samples, const float* reference, size_t frameCount) {
+    // Bypassed without a reference, adding no latency; engaging it starts the
+    // filter and the delay search over
+    if (!reference || !m_echoCancellationEnabled) {
+        if (m_echoCancellerRunning) {
+            m_echoCancellerRunning = false;
+            m_echoMailbox.Publish(EchoCancellerReport());
+        }
+        return;
+    }
+    if (!m_echoCancellerRunning) {
+        m_echoCanceller->Reset();
+        m_echoCancellerNanos = 0;
+        m_echoCancellerFrames = 0;
+        m_echoCancellerRunning = true;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    m_echoCanceller->Process(samples, reference, frameCount);
+    m_echoCancellerNanos += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    m_echoCancellerFrames += frameCount;
+
+    const EchoCancellerStats stats = m_echoCanceller->Stats();
+    const uint32_t rate = m_formatStage->OutputRate();
+    EchoCancellerReport report;
+    report.running = true;
+    report.erleDb = stats.erleDb;
+    report.delayMs = static_cast<double>(stats.delayFrames) * 1000.0 / rate;
+    report.delayLocked = stats.delayLocked;
+    report.farEndActive = stats.farEndActive;
+    report.nanosPerSecond = static_cast<double>(m_echoCancellerNanos) * rate / static_cast<double>(m_echoCancellerFrames);
+    m_echoMailbox.Publish(report);
+}
+
+bool CaptureCore::detectVoiceActivity(const PacketStatistics& stats) {
+    const float energy = stats.Rms();
+
+    // Smooth the VAD level
+    m_vadLevel = m_vadLevel * m_vadSmoothingFactor + energy * (1.0f - m_vadSmoothingFactor);
+    
+    return m_vadLevel > m_vadThreshold;
+}
+
+void CaptureCore::setError(const std::string& error) {
+    m_lastError = error;
+    std::cout << "CaptureCore Error: " << error << std::endl;
+}
+
+CaptureCore::PerformanceStats CaptureCore::getPerformanceStats() {
+    auto now = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastPerfUpdate);
+    
+    if (duration.count() >= 1000) { // Update every second
+        // Update performance statistics
+        m_perfStats.averageLatency = static_cast<double>(m_bufferSizeMs);
+        
+        // Reset counters
+        m_lastPerfUpdate = now;
+    }
+    
+    return m_perfStats;
+}
@@ -0,0 +1,314 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_history_ring.h"
+#include "audio_meter.h"
+#include "capture_format_stage.h"
+#include "capture_source.h"
+#include "echo_canceller.h"
+#include "echo_reference_stage.h"
+#include "fixed_block_pool.h"
+#include "gain_stage.h"
+#include "latest_value_mailbox.h"
+#include "noise_suppressor.h"
+#include "packet_statistics.h"
+#include "sample_format_converter.h"
+#include "spsc_ring_buffer.h"
+#include "utterance_endpoint_stage.h"
+#include "recording_file.h"
+
+struct AudioBuffer {
+    std::vector<float> samples;
+    double timestamp;
+    size_t channelCount;
+    size_t sampleRate;
+    size_t frameCount;
+};
+
+// Echo canceller state as last published by the capture thread
+struct EchoCancellerReport {
+    bool running = false;               // Enabled, with a reference, while capturing
+    float erleDb = 0.0f;
+    double delayMs = 0.0;               // Bulk delay between reference and microphone
+    bool delayLocked = false;
+    bool farEndActive = false;
+    double nanosPerSecond = 0.0;        // Capture-thread CPU per second of audio
+    uint64_t referenceUnderrunFrames = 0;
+    uint64_t referenceDroppedFrames = 0;
+};
+
+// The capture pipeline, independent of where the audio comes from.
+//
+// A capture thread pulls packets from a CaptureSource (WASAPI, file replay,
+// synthetic signal), converts them to float, downmixes and resamples them to
+// the output format, runs gain/DSP, metering and VAD, and queues the result
+// in preallocated blocks for getAudioData(). Nothing here depends on an OS
+// audio API, so the whole path builds and runs on any platform.
+class CaptureCore {
+public:
+    CaptureCore();
+    ~CaptureCore();
+
+    // Source management. setSource() opens the new source; neither works while capturing.
+    bool setSource(std::unique_ptr<CaptureSource> source);
+    CaptureSource* getSource() const { return m_source.get(); }
+    bool reopenSource();
+    CaptureSourceFormat getSourceFormat() const;
+
+    // Recording control. With history enabled, startRecording() queues the
+    // last `preRollMs` of it ahead of the first live packet, so speech that
+    // began before the call is not cut off.
+    bool startRecording(uint32_t preRollMs = 0);
+    bool stopRecording();
+    bool pauseRecording();
+    bool resumeRecording();
+    bool isRecording() const { return m_isRecording; }
+    bool isPaused() const { return m_isPaused; }
+    // True while the source runs, which with history enabled includes the
+    // time between recordings
+    bool isCapturing() const { return m_isCapturing; }
+    // True once a finite source (file, timed signal) has delivered everything
+    bool hasEnded() const { return m_sourceEnded; }
+
+    // Format of everything the core hands out (queued data, callbacks,
+    // meters). Defaults to 16 kHz mono; takes effect on the next startRecording().
+    bool setOutputFormat(const CaptureOutputFormat& format);
+    CaptureOutputFormat getOutputFormat() const { return m_outputFormat; }
+    uint32_t getOutputSampleRate() const;
+    uint32_t getOutputChannels() const;
+
+    // Rolling history of the newest `durationMs` of output audio. Enabling it
+    // starts the source right away and keeps it running between recordings;
+    // the ring is allocated once, at a fixed size. Disabling it while
+    // recording takes effect at stopRecording().
+    bool enableHistory(uint32_t durationMs);
+    void disableHistory();
+    uint32_t getHistoryDuration() const { return m_historyMs; }
+    // The ring, for reading recent audio in place; null while disabled.
+    // Shared so views handed out keep their memory after it is replaced.
+    std::shared_ptr<AudioHistoryRing> getHistory() const { return m_history; }
+
+    // Utterance endpointing. While enabled, every recording is split into
+    // utterances as it is captured, and each finished one goes to the sink
+    // (typically the transcription queue) without passing through the
+    // reader. Changes apply from the next startRecording(); the sample rate
+    // is taken from the output format.
+    void enableEndpointing(const EndpointerConfig& config);
+    void disableEndpointing() { m_endpointingEnabled = false; }
+    bool isEndpointingEnabled() const { return m_endpointingEnabled; }
+    EndpointerConfig getEndpointerConfig() const { return m_endpointerConfig; }
+    // Both take effect immediately, including mid-recording. Events are
+    // reported on the endpointing thread and must not block.
+    void setUtteranceSink(UtteranceSinkRef sink);
+    using UtteranceCallback = UtteranceEndpointStage::EventCallback;
+    void setUtteranceCallback(UtteranceCallback callback);
+    // Session of the current or last endpointed recording, 0 before the first.
+    // The sink hears its end before stopRecording() returns.
+    uint64_t getUtteranceSession() const { return m_utteranceSession; }
+
+    // Recording to disk. While a path is set, each recording is also streamed
+    // to that file in the output format by a background writer, so its length
+    // is limited only by the disk; each recording replaces the file. WAV
+    // (RF64 past 4 GiB) takes Int16, Int24 or Float32; FLAC, compressed on
+    // the writer thread, takes Int16 or Int24. Changes apply from the next
+    // startRecording(); an empty path turns it off. The file is complete once
+    // stopRecording() returns.
+    bool setRecordingFile(const std::string& path, SampleEncoding encoding = SampleEncoding::Int16,
+                          RecordingContainer container = RecordingContainer::Wav);
+    std::string getRecordingFile() const { return m_recordingFilePath; }
+    // Of the current or last recording's file
+    RecordingFileStats getRecordingFileStats() const;
+
+    // Buffer management; the duration applies when the source is next opened
+    void setBufferSize(uint32_t bufferSizeMs) { m_bufferSizeMs = bufferSizeMs; }
+    uint32_t getBufferSize() const { return m_bufferSizeMs; }
+
+    // Audio level monitoring
+    float getCurrentLevel();
+    float getPeakLevel();
+    void resetPeakLevel();
+    // Latest meter snapshot. Returns true if it was produced since the
+    // previous call; safe to call from any thread at any rate.
+    bool readMeter(AudioMeterReading& reading);
+
+    // Data retrieval
+    std::vector<float> getAudioData(size_t maxFrames = 0);
+    // Appends up to `maxFrames` queued frames to `out` (0 = everything queued)
+    // and returns the number of frames appended. Lets callers supply pooled storage.
+    size_t getAudioData(std::vector<float>& out, size_t maxFrames = 0);
+    AudioBuffer getAudioBuffer();
+    bool hasAudioData();
+    void clearBuffer();
+
+    // Callbacks
+    // Invoked on the capture thread with `frameCount` interleaved frames in the
+    // output format. `data` is only valid for the duration of the call and the
+    // callback must not block.
+    using AudioDataCallback = std::function<void(const float* data, size_t frameCount, double timestamp)>;
+    void setAudioDataCallback(AudioDataCallback callback) { m_audioDataCallback = callback; }
+
+    // Advanced features
+    void enableNoiseSupression(bool enable) { m_noiseSuppressionEnabled = enable; }
+    // Takes effect when capture next starts; the sample rate is the output rate
+    void setNoiseSuppressorConfig(const NoiseSuppressorConfig& config) { m_noiseSuppressorConfig = config; }
+    NoiseSuppressorConfig getNoiseSuppressorConfig() const { return m_noiseSuppressorConfig; }
+    // Echo cancellation removes what the speakers leak into the microphone,
+    // given what they play. setEchoReference() opens the reference (WASAPI
+    // loopback, or any other source); pass null to remove it. Neither works
+    // while capturing. Enabling cancellation without a reference does nothing.
+    bool setEchoReference(std::unique_ptr<CaptureSource> source);
+    bool hasEchoReference() const { return m_echoReference != nullptr; }
+    CaptureSource* getEchoReferenceSource() const { return m_echoReference ? m_echoReference->source() : nullptr; }
+    void enableEchoCancellation(bool enable) { m_echoCancellationEnabled = enable; }
+    EchoCancellerReport getEchoCancellerStats();
+    void enableAutomaticGainControl(bool enable) { m_agcEnabled = enable; }
+    void setGainLevel(float gain) { m_gainLevel = gain; }
+
+    // Performance monitoring
+    struct PerformanceStats {
+        double cpuUsage;
+        size_t memoryUsage;
+        size_t droppedFrames;
+        double averageLatency;
+        size_t bufferOverruns;
+        size_t bufferUnderruns;
+        // Allocations on the capture thread after warm-up; only counted in
+        // builds with VOICEINK_COUNT_ALLOCATIONS
+        size_t captureAllocations;
+        size_t capturedFrames;          // Source frames pulled since the last start
+    };
+    PerformanceStats getPerformanceStats();
+
+    // Error handling
+    std::string getLastError() const { return m_lastError; }
+    bool hasError() const { return !m_lastError.empty(); }
+    void clearError() { m_lastError.clear(); }
+
+private:
+    std::unique_ptr<CaptureSource> m_source;
+    CaptureSourceFormat m_sourceFormat;                  // Fixed at startRecording()
+    SampleConverter m_sampleConverter;                   // Source format to float
+    CaptureOutputFormat m_outputFormat;
+    std::unique_ptr<CaptureFormatStage> m_formatStage;   // Source float to output format
+    std::vector<float> m_sourceSamples;                  // One converted packet, source format
+    uint32_t m_bufferSizeMs;
+
+    // Recording state
+    std::atomic<bool> m_isCapturing;                     // Capture thread started
+    std::atomic<bool> m_isRecording;                     // Packets are queued and delivered
+    std::atomic<bool> m_isPaused;
+    std::atomic<bool> m_processingPacket;                // Capture thread is inside a packet
+    std::atomic<size_t> m_pendingPreRollFrames;
+    std::atomic<bool> m_shouldStop;
+    std::atomic<bool> m_sourceEnded;
+    std::thread m_recordingThread;
+    std::mutex m_bufferMutex;
+
+    // Audio data. The capture thread fills preallocated blocks and queues
+    // their indices; the reader drains them under m_bufferMutex and returns
+    // them to the pool. Nothing on the capture thread allocates or locks.
+    struct BlockInfo {
+        double timestamp;
+        size_t frameCount;
+        size_t channelCount;
+        size_t sampleRate;
+    };
+    std::unique_ptr<FixedBlockPool<float>> m_blockPool;
+    std::unique_ptr<SpscRingBuffer<uint32_t>> m_filledBlocks;
+    std::vector<BlockInfo> m_blockInfo;              // Indexed by block
+    std::vector<float> m_scratchBlock;               // Used when every block is queued
+    uint32_t m_readBlock;                            // Partially read block, reader only
+    size_t m_readOffset;                             // Frames already read from it
+    size_t m_maxQueueSize;
+
+    // History; only replaced while the capture thread is stopped
+    uint32_t m_historyMs;
+    std::shared_ptr<AudioHistoryRing> m_history;
+
+    // Endpointing. The stage is built per recording and only replaced while
+    // the capture thread does not queue.
+    bool m_endpointingEnabled;
+    EndpointerConfig m_endpointerConfig;
+    std::mutex m_utteranceMutex;                     // Guards the sink and callback below
+    UtteranceSinkRef m_utteranceSink;
+    UtteranceCallback m_utteranceCallback;
+    std::unique_ptr<UtteranceEndpointStage> m_endpointStage;
+    uint64_t m_utteranceSession;
+
+    // Recording file. The writer is opened per recording and only replaced
+    // while the capture thread does not queue.
+    std::string m_recordingFilePath;
+    SampleEncoding m_recordingFileEncoding;
+    RecordingContainer m_recordingFileContainer;
+    std::unique_ptr<RecordingFileWriter> m_recordingFile;
+
+    // Level monitoring
+    std::atomic<float> m_currentLevel;
+    std::atomic<float> m_peakLevel;
+    AudioMeter m_meter;                              // Capture thread only
+    LatestValueMailbox<AudioMeterReading> m_meterMailbox;
+
+    // Audio processing
+    std::atomic<bool> m_noiseSuppressionEnabled;
+    NoiseSuppressorConfig m_noiseSuppressorConfig;
+    std::unique_ptr<NoiseSuppressor> m_noiseSuppressor;  // Built per capture
+    bool m_noiseSuppressorRunning;                       // Capture thread only
+    std::atomic<bool> m_echoCancellationEnabled;
+    std::unique_ptr<EchoReferenceStage> m_echoReference;
+    std::vector<float> m_referenceSamples;               // Reference for one block, output rate
+    std::unique_ptr<EchoCanceller> m_echoCanceller;      // Built per capture
+    bool m_echoCancellerRunning;                         // Capture thread only
+    uint64_t m_echoCancellerNanos;                       // Capture thread only, since engaged
+    uint64_t m_echoCancellerFrames;
+    LatestValueMailbox<EchoCancellerReport> m_echoMailbox;
+    std::atomic<bool> m_agcEnabled;
+    std::atomic<float> m_gainLevel;
+    std::unique_ptr<GainStage> m_gainStage;              // Built per capture
+    bool m_gainStageRunning;                             // Capture thread only
+
+    // Callbacks
+    AudioDataCallback m_audioDataCallback;
+
+    // Performance tracking
+    PerformanceStats m_perfStats;
+    std::chrono::high_resolution_clock::time_point m_lastPerfUpdate;
+
+    // Error handling
+    std::string m_lastError;
+
+    // Private methods
+    bool startCapture(bool recording);
+    void stopCapture();
+    void recordingLoop();
+    bool hasQueueRoom();
+    void processAudioData(const CapturePacket& packet, bool queueing);
+    void queuePreRoll(size_t frameCount);
+    bool allocateCaptureBlocks();
+    bool startEndpointing();
+    void finishEndpointing();
+    bool startRecordingFile();
+    bool finishRecordingFile();
+    uint32_t acquireCaptureBlock();
+    uint32_t nextReadBlock();
+    void releaseReadBlock();
+    void updateAudioLevels(const float* samples, size_t frameCount, const PacketStatistics& stats, double timestamp);
+    void applyAudioProcessing(float* samples, const float* reference, size_t frameCount);
+    void applyNoiseSupression(float* samples, size_t frameCount);
+    void applyEchoCancellation(float* samples, const float* reference, size_t frameCount);
+    void applyGainStage(float* samples, size_t frameCount);
+    void setError(const std::string& error);
+
+    // VAD (Voice Activity Detection)
+    bool detectVoiceActivity(const PacketStatistics& stats);
+    float m_vadThreshold;
+    float m_vadSmoothingFactor;
+    float m_vadLevel;
+};
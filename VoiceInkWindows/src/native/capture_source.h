@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "sample_format_converter.h"
+
+// Where CaptureCore gets its audio from.
+//
+// A source opens a stream with a fixed format and then hands out packets of
+// raw device-format frames on the capture thread, WASAPI-style: every packet
+// returned by readPacket() is released with releasePacket() before the next
+// read. The core does all conversion, buffering, DSP and metering, so a
+// source only has to produce bytes.
+
+struct CaptureSourceFormat {
+    SampleFormat sample;            // Encoding and channel count of packet data
+    uint32_t sampleRate = 0;
+    uint32_t maxPacketFrames = 0;   // Largest packet readPacket() can return
+};
+
+struct CapturePacket {
+    const uint8_t* data = nullptr;
+    uint32_t frameCount = 0;
+    bool silent = false;            // Treat the packet as digital silence
+};
+
+enum class CaptureReadStatus {
+    Packet,         // `packet` is filled and must be released
+    Timeout,        // Nothing yet; the core checks for stop and pause, then reads again
+    EndOfStream,    // The source is exhausted (file replay, finite signal)
+    Failed          // See lastError()
+};
+
+class CaptureSource {
+public:
+    virtual ~CaptureSource() = default;
+
+    // Short identifier reported to JS, e.g. "wasapi", "file", "synthetic"
+    virtual const char* name() const = 0;
+
+    // JS thread. open() fixes the stream format; it may be called again to
+    // reopen with a new buffer duration while the source is stopped.
+    virtual bool open(uint32_t bufferSizeMs) = 0;
+    virtual CaptureSourceFormat format() const = 0;
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+
+    // False for sources that deliver as fast as they are read (file replay,
+    // benchmarks). The core then waits for getAudioData() to free queue
+    // space instead of dropping the oldest audio, so such a source stalls
+    // until someone reads it.
+    virtual bool isRealtime() const { return true; }
+
+    // Capture thread
+    virtual void onCaptureThreadStart() {}
+    virtual void onCaptureThreadStop() {}
+    virtual CaptureReadStatus readPacket(CapturePacket& packet) = 0;
+    virtual void releasePacket(const CapturePacket& packet) = 0;
+
+    std::string getLastError() const { return m_lastError; }
+
+protected:
+    void setError(const std::string& error) { m_lastError = error; }
+
+    std::string m_lastError;
+};
+
+// Paces a generated stream at its nominal sample rate, or lets it run as
+// fast as the consumer can take it. Waits are capped so the capture loop
+// still notices stop requests promptly.
+class PacketClock {
+public:
+    static constexpr auto kMaxWait = std::chrono::milliseconds(20);
+
+    void start(uint32_t sampleRate, bool realtime) {
+        m_sampleRate = sampleRate;
+        m_realtime = realtime;
+        m_framesDelivered = 0;
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    // True once the packet after the frames delivered so far is due
+    bool waitForPacket() {
+        if (!m_realtime) {
+            return true;
+        }
+        const auto due = m_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(m_framesDelivered) / m_sampleRate));
+        const auto now = std::chrono::steady_clock::now();
+        if (due <= now) {
+            return true;
+        }
+        if (due - now > kMaxWait) {
+            std::this_thread::sleep_for(kMaxWait);
+            return false;
+        }
+        std::this_thread::sleep_until(due);
+        return true;
+    }
+
+    void delivered(uint32_t frames) { m_framesDelivered += frames; }
+
+private:
+    uint32_t m_sampleRate = 1;
+    bool m_realtime = true;
+    uint64_t m_framesDelivered = 0;
+    std::chrono::steady_clock::time_point m_start;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <napi.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+// Follows a JS AbortSignal into native code.
+//
+// Anything shaped like a signal is accepted: an object with `aborted`,
+// `reason`, `addEventListener` and `removeEventListener`, so callers can pass
+// an AbortController's signal or a hand-rolled token. Attach() registers an
+// 'abort' listener that raises a native flag; workers poll the flag from
+// any thread. Detach() removes the listener once the work has settled, so a
+// long-lived signal does not collect one listener per call.
+class AbortSignalLink {
+public:
+    static bool IsSignal(const Napi::Value& value) {
+        if (!value.IsObject()) {
+            return false;
+        }
+        Napi::Object signal = value.As<Napi::Object>();
+        return signal.Get("addEventListener").IsFunction() && signal.Get("removeEventListener").IsFunction();
+    }
+
+    static bool IsAborted(const Napi::Object& signal) {
+        Napi::Value aborted = signal.Get("aborted");
+        return aborted.IsBoolean() && aborted.As<Napi::Boolean>().Value();
+    }
+
+    // The error an aborted call rejects with, matching the DOM/Node
+    // convention: name 'AbortError', code 'ABORT_ERR', signal.reason as cause.
+    static Napi::Error MakeError(Napi::Env env, const Napi::Object& signal) {
+        Napi::Error error = Napi::Error::New(env, "The operation was aborted");
+        error.Set("name", Napi::String::New(env, "AbortError"));
+        error.Set("code", Napi::String::New(env, "ABORT_ERR"));
+        Napi::Value reason = signal.Get("reason");
+        if (!reason.IsUndefined()) {
+            error.Set("cause", reason);
+        }
+        return error;
+    }
+
+    static Napi::Promise RejectedPromise(Napi::Env env, const Napi::Object& signal) {
+        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+        deferred.Reject(MakeError(env, signal).Value());
+        return deferred.Promise();
+    }
+
+    // Raises `flag` when the signal aborts; `onAbort`, if set, then runs on
+    // the JS thread. Must be called on the JS thread.
+    void Attach(Napi::Env env, const Napi::Object& signal, std::shared_ptr<std::atomic<bool>> flag,
+                std::function<void()> onAbort = nullptr) {
+        m_fired = std::make_shared<std::atomic<bool>>(false);
+        std::shared_ptr<std::atomic<bool>> fired = m_fired;
+
+        Napi::Function listener = Napi::Function::New(env,
+            [fired, flag, onAbort](const Napi::CallbackInfo&) {
+                fired->store(true);
+                flag->store(true);
+                if (onAbort) {
+                    onAbort();
+                }
+            }, "onAbort");
+
+        Napi::Object options = Napi::Object::New(env);
+        options.Set("once", Napi::Boolean::New(env, true));
+        signal.Get("addEventListener").As<Napi::Function>().Call(signal,
+            { Napi::String::New(env, "abort"), listener, options });
+
+        m_signal = Napi::Persistent(signal);
+        m_listener = Napi::Persistent(listener);
+    }
+
+    // JS thread only. Safe to call more than once.
+    void Detach() {
+        if (m_signal.IsEmpty()) {
+            return;
+        }
+        Napi::Env env = m_signal.Env();
+        Napi::HandleScope scope(env);
+        Napi::Object signal = m_signal.Value();
+        signal.Get("removeEventListener").As<Napi::Function>().Call(signal,
+            { Napi::String::New(env, "abort"), m_listener.Value() });
+        m_listener.Reset();
+        m_signal.Reset();
+    }
+
+    bool Attached() const { return static_cast<bool>(m_fired); }
+    bool Fired() const { return m_fired && m_fired->load(); }
+
+    // Valid until Detach()
+    Napi::Error Error(Napi::Env env) const { return MakeError(env, m_signal.Value()); }
+
+private:
+    Napi::ObjectReference m_signal;
+    Napi::FunctionReference m_listener;
+    std::shared_ptr<std::atomic<bool>> m_fired;
+};
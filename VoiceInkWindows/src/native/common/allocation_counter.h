@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+// Per-thread count of heap allocations made through operator new.
+//
+// Real-time threads must not allocate once they are warmed up. Builds
+// configured with `-Dcount_allocations=1` define VOICEINK_COUNT_ALLOCATIONS;
+// exactly one translation unit then expands VOICEINK_DEFINE_ALLOCATION_COUNTER
+// to replace the global operator new, and tests assert that the counter of
+// the thread under test stops moving. In regular builds nothing is replaced
+// and Enabled() is false.
+//
+// On Linux the addon's own calls to operator new would bind to libstdc++'s
+// at load time, past the replacement, so counting builds link with
+// -Bsymbolic to bind them inside the addon.
+namespace AllocationCounter {
+
+inline uint64_t& ThreadCount() {
+    thread_local uint64_t count = 0;
+    return count;
+}
+
+inline uint64_t ThisThread() { return ThreadCount(); }
+
+constexpr bool Enabled() {
+#ifdef VOICEINK_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+}  // namespace AllocationCounter
+
+#ifdef VOICEINK_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+#define VOICEINK_DEFINE_ALLOCATION_COUNTER()                                     \
+    void* operator new(std::size_t size) {                                       \
+        ++AllocationCounter::ThreadCount();                                      \
+        if (void* p = std::malloc(size ? size : 1)) {                            \
+            return p;                                                            \
+        }                                                                        \
+        throw std::bad_alloc();                                                  \
+    }                                                                            \
+    void* operator new[](std::size_t size) { return ::operator new(size); }     \
+    void* operator new(std::size_t size, const std::nothrow_t&) noexcept {       \
+        ++AllocationCounter::ThreadCount();                                      \
+        return std::malloc(size ? size : 1);                                     \
+    }                                                                            \
+    void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { \
+        return ::operator new(size, tag);                                        \
+    }                                                                            \
+    void operator delete(void* p) noexcept { std::free(p); }                     \
+    void operator delete[](void* p) noexcept { std::free(p); }                   \
+    void operator delete(void* p, std::size_t) noexcept { std::free(p); }        \
+    void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#else
+#define VOICEINK_DEFINE_ALLOCATION_COUNTER()
+#endif
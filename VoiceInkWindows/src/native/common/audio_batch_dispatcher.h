@@ -0,0 +1,267 @@
+#pragma once
+
+#include <napi.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "external_buffer.h"
+
+// Collects small capture packets into fixed-duration batches and delivers
+// them to a JS callback without ever blocking or allocating on the capture
+// thread.
+//
+// Enough batches for a full queue and the one being filled are allocated up
+// front, and Reserve() sizes their buffers for the recording's format. They
+// are queued to the JS thread with NonBlockingCall on a bounded thread-safe
+// function. When JS falls behind and the queue is full the batch is dropped,
+// counted, and reused. On the JS thread the batch's buffer moves into the
+// ArrayBuffer handed to the callback, and the batch takes a fresh one from
+// the pool before it goes back to the capture thread.
+// The callback receives (samples: Float32Array, frameCount, timestamp,
+// channels), with samples interleaved.
+//
+// At environment teardown Node closes the function while the recorder may
+// still be capturing; from then on every batch is dropped, and the
+// destructor does not release the function a second time.
+class AudioBatchDispatcher {
+public:
+    struct Options {
+        uint32_t batchMs = 100;         // Duration of each delivered batch
+        size_t maxQueuedBatches = 8;    // Batches waiting for the JS thread
+    };
+
+    struct Stats {
+        uint64_t deliveredBatches = 0;
+        uint64_t droppedBatches = 0;
+        uint64_t droppedFrames = 0;
+    };
+
+    AudioBatchDispatcher(Napi::Env env, Napi::Function callback, const Options& options,
+                         std::shared_ptr<BufferPool<float>> pool)
+        : m_options(options)
+        , m_state(std::make_shared<State>()) {
+        // A full queue, the batch being filled and the one JS is handing back
+        const size_t batchCount = options.maxQueuedBatches + 2;
+        m_state->pool = std::move(pool);
+        m_state->batches.reserve(batchCount);
+        m_state->free.reserve(batchCount);
+        for (size_t i = 0; i < batchCount; ++i) {
+            m_state->batches.push_back(std::make_unique<Batch>());
+            m_state->free.push_back(m_state->batches.back().get());
+        }
+
+        m_state->tsfn = BatchTsfn::New(env, callback, "AudioDataCallback", options.maxQueuedBatches, 1,
+                                       new std::shared_ptr<State>(m_state), &Finalize);
+        // Batches only flow while recording, which JS starts and stops; a
+        // callback alone must not hold the process open
+        m_state->tsfn.Unref(env);
+    }
+
+    ~AudioBatchDispatcher() {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_pending) {
+            ReturnLocked(*m_state, m_pending);
+            m_pending = nullptr;
+        }
+        if (!m_state->closed) {
+            m_state->tsfn.Release();
+        }
+    }
+
+    AudioBatchDispatcher(const AudioBatchDispatcher&) = delete;
+    AudioBatchDispatcher& operator=(const AudioBatchDispatcher&) = delete;
+
+    // JS thread, before capture starts. Sizes every batch for `sampleRate`
+    // and `channels` so Append() never has to.
+    void Reserve(uint32_t sampleRate, size_t channels) {
+        if (sampleRate == 0 || channels == 0) {
+            return;
+        }
+
+        const size_t samples = BatchFrames(sampleRate) * channels;
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->batchSamples = samples;
+        for (Batch* batch : m_state->free) {
+            batch->samples.reserve(samples);
+        }
+    }
+
+    // Capture thread. Copies `frameCount` interleaved frames into the pending
+    // batch and dispatches every batch that fills up.
+    void Append(const float* samples, size_t frameCount, size_t channels, uint32_t sampleRate, double timestamp) {
+        if (!samples || frameCount == 0 || channels == 0 || sampleRate == 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+
+        // A format change mid-batch closes the batch in its old format
+        if (m_pending && (m_pending->channels != channels || m_pending->sampleRate != sampleRate)) {
+            DispatchLocked();
+        }
+
+        const size_t batchFrames = BatchFrames(sampleRate);
+        while (frameCount > 0) {
+            if (!m_pending) {
+                if (m_state->free.empty()) {
+                    // Not reached while the queue bound holds
+                    m_droppedFrames.fetch_add(frameCount, std::memory_order_relaxed);
+                    return;
+                }
+                m_pending = m_state->free.back();
+                m_state->free.pop_back();
+                // A no-op once Reserve() has seen this format
+                m_pending->samples.reserve(batchFrames * channels);
+                m_pending->channels = channels;
+                m_pending->sampleRate = sampleRate;
+                m_pending->timestamp = timestamp;
+            }
+
+            const size_t take = (std::min)(frameCount, batchFrames - m_pending->frameCount);
+            m_pending->samples.insert(m_pending->samples.end(), samples, samples + take * channels);
+            m_pending->frameCount += take;
+
+            samples += take * channels;
+            frameCount -= take;
+            timestamp += static_cast<double>(take) / sampleRate;
+
+            if (m_pending->frameCount == batchFrames) {
+                DispatchLocked();
+            }
+        }
+    }
+
+    // Delivers a partially filled batch, e.g. once capture has stopped.
+    void Flush() {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_pending) {
+            DispatchLocked();
+        }
+    }
+
+    Stats GetStats() const {
+        Stats stats;
+        stats.deliveredBatches = m_deliveredBatches.load(std::memory_order_relaxed);
+        stats.droppedBatches = m_droppedBatches.load(std::memory_order_relaxed);
+        stats.droppedFrames = m_droppedFrames.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct State;
+
+    struct Batch {
+        std::vector<float> samples;
+        size_t frameCount = 0;
+        size_t channels = 0;
+        uint32_t sampleRate = 0;
+        double timestamp = 0.0;
+    };
+
+    size_t BatchFrames(uint32_t sampleRate) const {
+        return (std::max<size_t>)(1, static_cast<size_t>(sampleRate) * m_options.batchMs / 1000);
+    }
+
+    // Under the state's lock. The free list has room for every batch, so
+    // this never allocates.
+    static void ReturnLocked(State& state, Batch* batch) {
+        batch->samples.clear();
+        batch->frameCount = 0;
+        state.free.push_back(batch);
+    }
+
+    static void CallJs(Napi::Env env, Napi::Function callback, std::shared_ptr<State>* context, Batch* batch) {
+        State& state = **context;
+        if (!env || !callback) {
+            // Finalizing: the queue is being drained without a JS thread
+            std::lock_guard<std::mutex> lock(state.mutex);
+            ReturnLocked(state, batch);
+            return;
+        }
+
+        Napi::HandleScope scope(env);
+        const size_t sampleCount = batch->samples.size();
+        const size_t capacity = (std::max)(batch->samples.capacity(), state.batchSamples);
+        const size_t frameCount = batch->frameCount;
+        const size_t channels = batch->channels;
+        const double timestamp = batch->timestamp;
+        Napi::ArrayBuffer arrayBuffer = MoveToArrayBuffer(env, std::move(batch->samples), state.pool);
+
+        // Allocating here keeps it off the capture thread
+        std::vector<float> next = state.pool->Acquire(capacity);
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            batch->samples = std::move(next);
+            ReturnLocked(state, batch);
+        }
+
+        try {
+            callback.Call({
+                Napi::Float32Array::New(env, sampleCount, arrayBuffer, 0),
+                Napi::Number::New(env, static_cast<double>(frameCount)),
+                Napi::Number::New(env, timestamp),
+                Napi::Number::New(env, static_cast<double>(channels))
+            });
+        } catch (const Napi::Error& e) {
+            // Surface listener errors as uncaught exceptions rather than
+            // unwinding through the thread-safe function machinery
+            napi_fatal_exception(env, e.Value());
+        }
+    }
+
+    void DispatchLocked() {
+        Batch* batch = m_pending;
+        m_pending = nullptr;
+
+        const size_t frameCount = batch->frameCount;
+        if (!m_state->closed && m_state->tsfn.NonBlockingCall(batch) == napi_ok) {
+            m_deliveredBatches.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // Queue full (JS is behind) or closed: drop rather than wait
+            ReturnLocked(*m_state, batch);
+            m_droppedBatches.fetch_add(1, std::memory_order_relaxed);
+            m_droppedFrames.fetch_add(frameCount, std::memory_order_relaxed);
+        }
+    }
+
+    using BatchTsfn = Napi::TypedThreadSafeFunction<std::shared_ptr<State>, Batch, CallJs>;
+
+    // Shared with the function, so batches still queued at teardown outlive
+    // the dispatcher
+    struct State {
+        // Guards the function and the free list; only ever contended by
+        // Flush(), Reserve(), the JS thread handing a batch back and the
+        // finalizer, never held across a call into JS
+        std::mutex mutex;
+        BatchTsfn tsfn;
+        bool closed = false;
+
+        std::shared_ptr<BufferPool<float>> pool;
+        std::vector<std::unique_ptr<Batch>> batches;
+        std::vector<Batch*> free;
+        size_t batchSamples = 0;    // Set by Reserve(); read on the JS thread
+    };
+
+    // Runs on the JS thread once the function is closed, after Release() or
+    // at teardown
+    static void Finalize(Napi::Env, std::shared_ptr<State>* state) {
+        {
+            std::lock_guard<std::mutex> lock((*state)->mutex);
+            (*state)->closed = true;
+        }
+        delete state;
+    }
+
+    const Options m_options;
+    std::shared_ptr<State> m_state;
+    Batch* m_pending = nullptr;     // Guarded by the state's lock
+
+    std::atomic<uint64_t> m_deliveredBatches{ 0 };
+    std::atomic<uint64_t> m_droppedBatches{ 0 };
+    std::atomic<uint64_t> m_droppedFrames{ 0 };
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include "latest_value_mailbox.h"
+
+// Rolling, timestamped history of the most recent captured audio.
+//
+// One writer (the capture thread) appends interleaved frames; any thread can
+// look at the latest N frames in place. Every frame is stored twice, at its
+// ring position and again one capacity further on, so any window up to the
+// full capacity is a single contiguous span: readers get a pointer instead
+// of a copy, and the memory is fixed when the ring is built
+// (2 x capacity x channels floats). A window stays intact until the writer
+// has appended another (capacity - window) frames; StillValid() tells.
+class AudioHistoryRing {
+public:
+    struct Window {
+        const float* data = nullptr;    // Interleaved, `frames * channels` samples
+        size_t frames = 0;
+        uint64_t startFrame = 0;        // Position in the stream since the last Reset()
+        double startTimestamp = 0.0;    // Capture time of the first frame, in seconds
+    };
+
+    AudioHistoryRing(size_t capacityFrames, uint32_t channels, uint32_t sampleRate)
+        : m_capacity((std::max<size_t>)(capacityFrames, 1))
+        , m_channels((std::max<uint32_t>)(channels, 1))
+        , m_sampleRate((std::max<uint32_t>)(sampleRate, 1))
+        , m_storage(new float[2 * m_capacity * m_channels]()) {}
+
+    AudioHistoryRing(const AudioHistoryRing&) = delete;
+    AudioHistoryRing& operator=(const AudioHistoryRing&) = delete;
+
+    size_t CapacityFrames() const { return m_capacity; }
+    uint32_t Channels() const { return m_channels; }
+    uint32_t SampleRate() const { return m_sampleRate; }
+    size_t MemoryBytes() const { return 2 * m_capacity * m_channels * sizeof(float); }
+
+    // Writer. `timestamp` is the capture time of the first frame.
+    void Write(const float* samples, size_t frames, double timestamp) {
+        if (frames == 0) {
+            return;
+        }
+        // Only the newest `capacity` frames can be kept
+        if (frames > m_capacity) {
+            timestamp += static_cast<double>(frames - m_capacity) / m_sampleRate;
+            samples += (frames - m_capacity) * m_channels;
+            frames = m_capacity;
+        }
+
+        const uint64_t start = m_written;
+        // Readers compare against this before trusting a window
+        m_writeLimit.store(start + frames, std::memory_order_release);
+
+        size_t done = 0;
+        while (done < frames) {
+            const size_t position = static_cast<size_t>((start + done) % m_capacity);
+            const size_t count = (std::min)(frames - done, m_capacity - position);
+            const size_t bytes = count * m_channels * sizeof(float);
+            std::memcpy(m_storage.get() + position * m_channels, samples + done * m_channels, bytes);
+            std::memcpy(m_storage.get() + (position + m_capacity) * m_channels, samples + done * m_channels, bytes);
+            done += count;
+        }
+
+        m_written = start + frames;
+        m_endTimestamp = timestamp + static_cast<double>(frames) / m_sampleRate;
+        m_anchor.Publish(Anchor{ m_written, m_endTimestamp });
+    }
+
+    // Writer, or while nothing writes. Forgets everything captured so far.
+    void Reset() {
+        m_written = 0;
+        m_endTimestamp = 0.0;
+        m_writeLimit.store(0, std::memory_order_release);
+        m_anchor.Publish(Anchor{});
+    }
+
+    // Any thread. The newest `frames` frames, or fewer if less has been captured.
+    Window Latest(size_t frames) {
+        Anchor anchor;
+        m_anchor.Read(anchor);
+        return MakeWindow(frames, anchor);
+    }
+
+    // Writer only; same as Latest() without touching the readers' lock
+    Window LatestFromWriter(size_t frames) const {
+        return MakeWindow(frames, Anchor{ m_written, m_endTimestamp });
+    }
+
+    // Frames available in the history right now
+    size_t AvailableFrames() {
+        Anchor anchor;
+        m_anchor.Read(anchor);
+        return static_cast<size_t>((std::min<uint64_t>)(anchor.endFrame, m_capacity));
+    }
+
+    // True if the writer has not started overwriting `window` yet
+    bool StillValid(const Window& window) const {
+        return window.startFrame + m_capacity >= m_writeLimit.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Anchor {
+        uint64_t endFrame = 0;          // Frames written when published
+        double endTimestamp = 0.0;      // Capture time just past the last frame
+    };
+
+    Window MakeWindow(size_t frames, const Anchor& anchor) const {
+        Window window;
+        window.frames = static_cast<size_t>((std::min<uint64_t>)((std::min)(frames, m_capacity), anchor.endFrame));
+        window.startFrame = anchor.endFrame - window.frames;
+        window.startTimestamp = anchor.endTimestamp - static_cast<double>(window.frames) / m_sampleRate;
+        window.data = m_storage.get() + static_cast<size_t>(window.startFrame % m_capacity) * m_channels;
+        return window;
+    }
+
+    const size_t m_capacity;
+    const uint32_t m_channels;
+    const uint32_t m_sampleRate;
+    std::unique_ptr<float[]> m_storage;
+
+    uint64_t m_written = 0;                     // Writer only
+    double m_endTimestamp = 0.0;                // Writer only
+    std::atomic<uint64_t> m_writeLimit{ 0 };    // Highest frame the writer may be touching
+    LatestValueMailbox<Anchor> m_anchor;
+};
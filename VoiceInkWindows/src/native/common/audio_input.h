@@ -0,0 +1,106 @@
+#pragma once
+
+#include <napi.h>
+#include <memory>
+#include <mutex>
+
+// Helpers for handing caller-owned JS audio to native code without copying.
+//
+// Native code only ever sees a raw view over the ArrayBuffer backing store.
+// The view stays valid because a persistent reference pins the buffer until
+// the native consumer drops its owner handle. Callers must not transfer or
+// detach the buffer while a job is using it.
+
+// Returns `value` as a Float32Array. Plain JS arrays are converted with a
+// single call into the Float32Array constructor rather than element by
+// element; any other input throws a TypeError.
+inline Napi::Float32Array CoerceToFloat32Array(Napi::Env env, const Napi::Value& value) {
+    if (value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_float32_array) {
+        return value.As<Napi::Float32Array>();
+    }
+
+    if (value.IsArray()) {
+        Napi::Function ctor = env.Global().Get("Float32Array").As<Napi::Function>();
+        return ctor.New({ value }).As<Napi::Float32Array>();
+    }
+
+    throw Napi::TypeError::New(env, "Audio data must be a Float32Array or an array of numbers");
+}
+
+// Releases pinned JS references from any thread.
+//
+// Job owners are often destroyed on native worker threads, where touching a
+// napi_ref is illegal, so the release is bounced to the JS thread through a
+// thread-safe function. The TSFN is unref'd and never keeps the loop alive.
+//
+// At environment teardown Node closes the TSFN on its own, possibly while
+// jobs still hold pinned buffers. The shared state records that, so later
+// releases leave the references to be reclaimed with the environment
+// instead of touching the closed TSFN.
+class JsReferenceReleaser {
+public:
+    explicit JsReferenceReleaser(Napi::Env env)
+        : m_state(std::make_shared<State>()) {
+        m_state->tsfn = ReleaseTsfn::New(env, "ReleaseAudioReference", 0, 1,
+                                         new std::shared_ptr<State>(m_state), &Finalize);
+        m_state->tsfn.Unref(env);
+    }
+
+    ~JsReferenceReleaser() {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (!m_state->closed) {
+            m_state->tsfn.Release();
+        }
+    }
+
+    JsReferenceReleaser(const JsReferenceReleaser&) = delete;
+    JsReferenceReleaser& operator=(const JsReferenceReleaser&) = delete;
+
+    // Pins `value` and returns an owner handle. When the last copy of the
+    // handle is destroyed, on whatever thread, the reference is released on
+    // the JS thread.
+    std::shared_ptr<const void> Pin(const Napi::Object& value) {
+        auto* ref = new Napi::ObjectReference(Napi::Persistent(value));
+        std::shared_ptr<State> state = m_state;
+        state->tsfn.Acquire();
+
+        return std::shared_ptr<const void>(ref, [state](const void* p) {
+            auto* pinned = const_cast<Napi::ObjectReference*>(static_cast<const Napi::ObjectReference*>(p));
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->closed) {
+                return;
+            }
+            // If the environment is already shutting down the call fails and
+            // the reference is reclaimed together with the environment.
+            state->tsfn.NonBlockingCall(pinned);
+            state->tsfn.Release();
+        });
+    }
+
+private:
+    struct State;
+
+    static void ReleaseOnJsThread(Napi::Env, Napi::Function, std::shared_ptr<State>*, Napi::ObjectReference* ref) {
+        delete ref;
+    }
+
+    using ReleaseTsfn = Napi::TypedThreadSafeFunction<std::shared_ptr<State>, Napi::ObjectReference, ReleaseOnJsThread>;
+
+    struct State {
+        std::mutex mutex;
+        ReleaseTsfn tsfn;
+        bool closed = false;
+    };
+
+    // Runs on the JS thread once the TSFN is closed, after the last Release()
+    // or at teardown
+    static void Finalize(Napi::Env, std::shared_ptr<State>* state) {
+        {
+            std::lock_guard<std::mutex> lock((*state)->mutex);
+            (*state)->closed = true;
+        }
+        delete state;
+    }
+
+    std::shared_ptr<State> m_state;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "packet_statistics.h"
+
+// Snapshot produced by AudioMeter for each capture packet.
+struct AudioMeterReading {
+    static constexpr size_t kBandCount = 8;
+
+    float rms = 0.0f;                   // Packet RMS, linear full scale
+    float peak = 0.0f;                  // Packet absolute peak
+    float level = 0.0f;                 // Smoothed RMS, what meters should draw
+    float peakHold = 0.0f;              // Peak with linear decay
+    float dcOffset = 0.0f;              // Packet mean
+    float zeroCrossingRate = 0.0f;      // Per consecutive sample pair, 0 to 1
+    float bands[kBandCount] = {};       // Amplitude near each band centre
+    double timestamp = 0.0;             // Capture timestamp of the packet
+    uint64_t sequence = 0;              // Increments once per processed packet
+};
+
+// Turns a packet's PacketStatistics into meter readings and adds a coarse
+// spectrum summary in one pass over the packet.
+//
+// The spectrum uses one Goertzel filter per band on the mono downmix, which
+// is far cheaper than an FFT for eight bins and needs no scratch memory.
+// Runs on the capture thread; not thread-safe.
+class AudioMeter {
+public:
+    static constexpr float kBandFrequencies[AudioMeterReading::kBandCount] = {
+        125.0f, 250.0f, 500.0f, 1000.0f, 2000.0f, 3000.0f, 4000.0f, 6000.0f
+    };
+
+    explicit AudioMeter(float smoothingFactor = 0.9f, float peakDecayPerSecond = 1.5f)
+        : m_smoothingFactor(smoothingFactor)
+        , m_peakDecayPerSecond(peakDecayPerSecond) {}
+
+    // `stats` must be MeasurePacket() of the same samples
+    const AudioMeterReading& Process(const float* samples, size_t frameCount, size_t channels,
+                                     uint32_t sampleRate, const PacketStatistics& stats, double timestamp) {
+        if (!samples || frameCount == 0 || channels == 0 || sampleRate == 0) {
+            return m_reading;
+        }
+
+        if (sampleRate != m_sampleRate) {
+            updateCoefficients(sampleRate);
+        }
+
+        float s1[AudioMeterReading::kBandCount] = {};
+        float s2[AudioMeterReading::kBandCount] = {};
+        const float channelScale = 1.0f / static_cast<float>(channels);
+
+        for (size_t frame = 0; frame < frameCount; ++frame) {
+            const float* frameSamples = samples + frame * channels;
+            float mono = 0.0f;
+            for (size_t ch = 0; ch < channels; ++ch) {
+                mono += frameSamples[ch];
+            }
+            mono *= channelScale;
+
+            for (size_t band = 0; band < AudioMeterReading::kBandCount; ++band) {
+                const float s0 = mono + m_coefficients[band] * s1[band] - s2[band];
+                s2[band] = s1[band];
+                s1[band] = s0;
+            }
+        }
+
+        const float rms = stats.Rms();
+        const float peak = stats.peak;
+        const float seconds = static_cast<float>(frameCount) / static_cast<float>(sampleRate);
+
+        m_reading.rms = rms;
+        m_reading.peak = peak;
+        m_reading.level = m_reading.level * m_smoothingFactor + rms * (1.0f - m_smoothingFactor);
+        m_reading.peakHold = (std::max)(peak, m_reading.peakHold - m_peakDecayPerSecond * seconds);
+        m_reading.dcOffset = stats.DcOffset();
+        m_reading.zeroCrossingRate = stats.ZeroCrossingRate();
+        m_reading.timestamp = timestamp;
+        m_reading.sequence++;
+
+        const float amplitudeScale = 2.0f / static_cast<float>(frameCount);
+        for (size_t band = 0; band < AudioMeterReading::kBandCount; ++band) {
+            if (!m_bandActive[band]) {
+                m_reading.bands[band] = 0.0f; // Above Nyquist for this stream
+                continue;
+            }
+            const float power = s1[band] * s1[band] + s2[band] * s2[band]
+                              - m_coefficients[band] * s1[band] * s2[band];
+            m_reading.bands[band] = std::sqrt((std::max)(power, 0.0f)) * amplitudeScale;
+        }
+
+        return m_reading;
+    }
+
+    const AudioMeterReading& Reading() const { return m_reading; }
+
+private:
+    void updateCoefficients(uint32_t sampleRate) {
+        constexpr float kTwoPi = 6.28318530717958647692f;
+        m_sampleRate = sampleRate;
+        for (size_t band = 0; band < AudioMeterReading::kBandCount; ++band) {
+            const float frequency = kBandFrequencies[band];
+            m_bandActive[band] = frequency * 2.0f < static_cast<float>(sampleRate);
+            m_coefficients[band] = m_bandActive[band]
+                ? 2.0f * std::cos(kTwoPi * frequency / static_cast<float>(sampleRate))
+                : 0.0f;
+        }
+    }
+
+    const float m_smoothingFactor;
+    const float m_peakDecayPerSecond;
+    uint32_t m_sampleRate = 0;
+    float m_coefficients[AudioMeterReading::kBandCount] = {};
+    bool m_bandActive[AudioMeterReading::kBandCount] = {};
+    AudioMeterReading m_reading;
+};
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Flat binary encoding of a transcription result, returned to JS as a single
+// ArrayBuffer and decoded lazily by src/main/whisper/binaryResultReader.js.
+//
+// Layout (version 1, all fields little-endian):
+//
+//   Header, 64 bytes
+//     0  u32 magic 'VIRR'          4  u16 version      6  u16 header size
+//     8  u32 total size           12  u32 segments     16  u32 words
+//    20  u32 strings              24  u32 segments offset
+//    28  u32 words offset         32  u32 string offsets offset
+//    36  u32 string data offset   40  u32 text string  44  u32 language string
+//    48  f64 duration             56  f32 confidence   60  f32 processing time
+//
+//   Segment, 40 bytes
+//     0  f64 start  8  f64 end  16  u32 text  20  u32 language
+//    24  f32 confidence  28  i32 speaker  32  u32 first word  36  u32 word count
+//
+//   Word, 24 bytes
+//     0  f64 start  8  f64 end  16  u32 text  20  f32 confidence
+//
+//   String offsets: u32[strings + 1], relative to the string data
+//   String data: UTF-8, not terminated
+//
+// Strings are interned, so repeated words and languages are stored once.
+// Readers must reject a buffer whose version they do not know.
+namespace binary_result {
+
+constexpr uint32_t kMagic = 0x52524956; // "VIRR"
+constexpr uint16_t kVersion = 1;
+constexpr uint32_t kHeaderSize = 64;
+constexpr uint32_t kSegmentSize = 40;
+constexpr uint32_t kWordSize = 24;
+
+} // namespace binary_result
+
+class BinaryResultBuilder {
+public:
+    // Strings are referenced, not copied: every view passed in must stay
+    // valid until Finish() returns.
+    void SetSummary(std::string_view text, std::string_view language, double duration,
+                    float confidence, float processingTime) {
+        m_text = Intern(text);
+        m_language = Intern(language);
+        m_duration = duration;
+        m_confidence = confidence;
+        m_processingTime = processingTime;
+    }
+
+    void AddSegment(double start, double end, std::string_view text, std::string_view language,
+                    float confidence, int32_t speakerId) {
+        m_segments.push_back({ start, end, Intern(text), Intern(language), confidence, speakerId,
+                               static_cast<uint32_t>(m_words.size()), 0 });
+    }
+
+    // Adds a word to the most recently added segment.
+    void AddWord(double start, double end, std::string_view text, float confidence) {
+        if (m_segments.empty()) {
+            return;
+        }
+        m_words.push_back({ start, end, Intern(text), confidence });
+        m_segments.back().wordCount++;
+    }
+
+    void Reserve(size_t segments, size_t words) {
+        m_segments.reserve(segments);
+        m_words.reserve(words);
+        m_strings.reserve(words + segments + 2);
+        m_stringIndex.reserve(words + segments + 2);
+    }
+
+    // Serializes into `out`, replacing its contents. `out` may come from a
+    // buffer pool; its capacity is reused.
+    void Finish(std::vector<uint8_t>& out) const {
+        using namespace binary_result;
+
+        const uint32_t segmentsOffset = kHeaderSize;
+        const uint32_t wordsOffset = segmentsOffset + kSegmentSize * static_cast<uint32_t>(m_segments.size());
+        const uint32_t stringOffsetsOffset = wordsOffset + kWordSize * static_cast<uint32_t>(m_words.size());
+        const uint32_t stringDataOffset = stringOffsetsOffset + 4 * static_cast<uint32_t>(m_strings.size() + 1);
+        const uint32_t totalSize = stringDataOffset + static_cast<uint32_t>(m_stringBytes);
+
+        out.resize(totalSize);
+        uint8_t* base = out.data();
+
+        uint8_t* p = base;
+        p = Put<uint32_t>(p, kMagic);
+        p = Put<uint16_t>(p, kVersion);
+        p = Put<uint16_t>(p, static_cast<uint16_t>(kHeaderSize));
+        p = Put<uint32_t>(p, totalSize);
+        p = Put<uint32_t>(p, static_cast<uint32_t>(m_segments.size()));
+        p = Put<uint32_t>(p, static_cast<uint32_t>(m_words.size()));
+        p = Put<uint32_t>(p, static_cast<uint32_t>(m_strings.size()));
+        p = Put<uint32_t>(p, segmentsOffset);
+        p = Put<uint32_t>(p, wordsOffset);
+        p = Put<uint32_t>(p, stringOffsetsOffset);
+        p = Put<uint32_t>(p, stringDataOffset);
+        p = Put<uint32_t>(p, m_text);
+        p = Put<uint32_t>(p, m_language);
+        p = Put<double>(p, m_duration);
+        p = Put<float>(p, m_confidence);
+        p = Put<float>(p, m_processingTime);
+
+        for (const Segment& segment : m_segments) {
+            p = Put<double>(p, segment.start);
+            p = Put<double>(p, segment.end);
+            p = Put<uint32_t>(p, segment.text);
+            p = Put<uint32_t>(p, segment.language);
+            p = Put<float>(p, segment.confidence);
+            p = Put<int32_t>(p, segment.speakerId);
+            p = Put<uint32_t>(p, segment.firstWord);
+            p = Put<uint32_t>(p, segment.wordCount);
+        }
+
+        for (const Word& word : m_words) {
+            p = Put<double>(p, word.start);
+            p = Put<double>(p, word.end);
+            p = Put<uint32_t>(p, word.text);
+            p = Put<float>(p, word.confidence);
+        }
+
+        uint32_t offset = 0;
+        for (std::string_view str : m_strings) {
+            p = Put<uint32_t>(p, offset);
+            offset += static_cast<uint32_t>(str.size());
+        }
+        p = Put<uint32_t>(p, offset);
+
+        for (std::string_view str : m_strings) {
+            if (!str.empty()) {
+                std::memcpy(p, str.data(), str.size());
+                p += str.size();
+            }
+        }
+    }
+
+private:
+    struct Segment {
+        double start;
+        double end;
+        uint32_t text;
+        uint32_t language;
+        float confidence;
+        int32_t speakerId;
+        uint32_t firstWord;
+        uint32_t wordCount;
+    };
+
+    struct Word {
+        double start;
+        double end;
+        uint32_t text;
+        float confidence;
+    };
+
+    uint32_t Intern(std::string_view str) {
+        auto it = m_stringIndex.find(str);
+        if (it != m_stringIndex.end()) {
+            return it->second;
+        }
+        const uint32_t index = static_cast<uint32_t>(m_strings.size());
+        m_strings.push_back(str);
+        m_stringIndex.emplace(str, index);
+        m_stringBytes += str.size();
+        return index;
+    }
+
+    // Byte-wise little-endian store; compiles to a plain store on LE targets.
+    template <typename T>
+    static uint8_t* Put(uint8_t* p, T value) {
+        static_assert(sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "unsupported field size");
+        using Bits = std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>;
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            p[i] = static_cast<uint8_t>(bits >> (8 * i));
+        }
+        return p + sizeof(T);
+    }
+
+    uint32_t m_text = 0;
+    uint32_t m_language = 0;
+    double m_duration = 0.0;
+    float m_confidence = 0.0f;
+    float m_processingTime = 0.0f;
+
+    std::vector<Segment> m_segments;
+    std::vector<Word> m_words;
+    std::vector<std::string_view> m_strings;
+    std::unordered_map<std::string_view, uint32_t> m_stringIndex;
+    size_t m_stringBytes = 0;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Thread-safe free list of reusable sample buffers.
+//
+// Buffers handed to JS as external ArrayBuffers come back through their
+// finalizer on the JS thread, so a pool is always owned by a shared_ptr that
+// outstanding buffers can keep alive after the binding itself is gone.
+template <typename T>
+class BufferPool {
+public:
+    explicit BufferPool(size_t maxPooledBuffers = 8, size_t maxPooledBytes = 16 * 1024 * 1024)
+        : m_maxPooledBuffers(maxPooledBuffers)
+        , m_maxPooledBytes(maxPooledBytes) {}
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Returns an empty buffer with room for at least `minCapacity` elements,
+    // reusing a pooled allocation whenever one is large enough.
+    std::vector<T> Acquire(size_t minCapacity = 0) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+                if (it->capacity() >= minCapacity) {
+                    std::vector<T> buffer = std::move(*it);
+                    m_free.erase(it);
+                    m_pooledBytes -= buffer.capacity() * sizeof(T);
+                    ++m_reused;
+                    return buffer;
+                }
+            }
+            ++m_allocated;
+        }
+
+        std::vector<T> buffer;
+        buffer.reserve(minCapacity);
+        return buffer;
+    }
+
+    // Hands a buffer back for reuse. Buffers beyond the pool limits are freed.
+    void Recycle(std::vector<T>&& buffer) {
+        const size_t bytes = buffer.capacity() * sizeof(T);
+        if (bytes == 0) {
+            return;
+        }
+
+        buffer.clear();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.size() < m_maxPooledBuffers && m_pooledBytes + bytes <= m_maxPooledBytes) {
+            m_pooledBytes += bytes;
+            m_free.push_back(std::move(buffer));
+        }
+    }
+
+    size_t AllocatedCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_allocated;
+    }
+
+    size_t ReusedCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_reused;
+    }
+
+private:
+    const size_t m_maxPooledBuffers;
+    const size_t m_maxPooledBytes;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::vector<T>> m_free;
+    size_t m_pooledBytes = 0;
+    size_t m_allocated = 0;
+    size_t m_reused = 0;
+};
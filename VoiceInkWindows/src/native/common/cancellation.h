@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// Cancellation flags shared between the JS thread and native workers.
+//
+// A flag is a plain std::atomic<bool>: raising it is safe from any thread,
+// and long-running work polls it at points where it can stop cleanly. A
+// null flag means the work cannot be cancelled.
+
+inline bool IsCancelled(const std::atomic<bool>* cancelled) {
+    return cancelled && cancelled->load(std::memory_order_relaxed);
+}
+
+// Locks `mutex`, giving up if `cancelled` is raised while waiting, so a
+// cancelled job queued behind a long inference frees its thread right away.
+// The returned lock does not own the mutex if the wait was cancelled.
+template <typename TimedMutex>
+std::unique_lock<TimedMutex> LockUnlessCancelled(TimedMutex& mutex, const std::atomic<bool>* cancelled) {
+    if (!cancelled) {
+        return std::unique_lock<TimedMutex>(mutex);
+    }
+
+    std::unique_lock<TimedMutex> lock(mutex, std::defer_lock);
+    while (!lock.try_lock_for(std::chrono::milliseconds(5))) {
+        if (IsCancelled(cancelled)) {
+            break;
+        }
+    }
+    return lock;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "polyphase_resampler.h"
+
+// Turns interleaved device frames into the stream the rest of the pipeline
+// wants, by default 16 kHz mono for Whisper.
+//
+// Channels are folded first (averaged, or one channel picked) so the
+// resampler only ever filters a single channel. DownmixMode::None keeps the
+// device stream untouched and cannot be combined with a rate change.
+
+enum class DownmixMode : uint8_t {
+    None,           // Keep every channel at the device rate
+    Average,        // Mean of all channels
+    SelectChannel   // One channel, by index
+};
+
+struct CaptureOutputFormat {
+    uint32_t sampleRate = 16000;        // 0 keeps the device rate
+    DownmixMode downmix = DownmixMode::Average;
+    unsigned channel = 0;               // For DownmixMode::SelectChannel
+
+    bool Valid() const { return downmix != DownmixMode::None || sampleRate == 0; }
+};
+
+class CaptureFormatStage {
+public:
+    // Allocates everything up front; Process() is allocation-free
+    CaptureFormatStage(unsigned inputChannels, uint32_t inputRate, const CaptureOutputFormat& output)
+        : m_inputChannels((std::max)(inputChannels, 1u))
+        , m_inputRate(inputRate)
+        , m_output(output)
+        , m_resampler(inputRate, output.sampleRate && output.downmix != DownmixMode::None ? output.sampleRate : inputRate) {
+        if (m_output.downmix == DownmixMode::SelectChannel) {
+            m_output.channel = (std::min)(m_output.channel, m_inputChannels - 1);
+        }
+        if (m_output.downmix != DownmixMode::None && !m_resampler.Passthrough()) {
+            m_mono.assign(PolyphaseResampler::kSliceFrames, 0.0f);
+        }
+    }
+
+    unsigned InputChannels() const { return m_inputChannels; }
+    unsigned OutputChannels() const { return m_output.downmix == DownmixMode::None ? m_inputChannels : 1; }
+    uint32_t OutputRate() const { return m_output.sampleRate && m_output.downmix != DownmixMode::None ? m_output.sampleRate : m_inputRate; }
+    const CaptureOutputFormat& Output() const { return m_output; }
+
+    // Upper bound on the frames Process() returns for `inputFrames`
+    size_t MaxOutputFrames(size_t inputFrames) const {
+        return m_resampler.Passthrough() ? inputFrames : m_resampler.MaxOutputFrames(inputFrames);
+    }
+
+    // Converts `frames` interleaved input frames into `out`, which must hold
+    // MaxOutputFrames(frames) * OutputChannels() floats. Returns frames written.
+    size_t Process(const float* in, size_t frames, float* out) {
+        if (m_output.downmix == DownmixMode::None) {
+            std::memcpy(out, in, frames * m_inputChannels * sizeof(float));
+            return frames;
+        }
+        if (m_resampler.Passthrough()) {
+            Downmix(in, frames, out);
+            return frames;
+        }
+
+        size_t produced = 0;
+        while (frames > 0) {
+            const size_t slice = (std::min)(frames, m_mono.size());
+            Downmix(in, slice, m_mono.data());
+            produced += m_resampler.Process(m_mono.data(), slice, out + produced);
+            in += slice * m_inputChannels;
+            frames -= slice;
+        }
+        return produced;
+    }
+
+    // Drops filter history, e.g. between recordings
+    void Reset() { m_resampler.Reset(); }
+
+private:
+    void Downmix(const float* in, size_t frames, float* out) const {
+        const unsigned channels = m_inputChannels;
+        if (m_output.downmix == DownmixMode::SelectChannel || channels == 1) {
+            const unsigned channel = channels == 1 ? 0 : m_output.channel;
+            for (size_t i = 0; i < frames; ++i) {
+                out[i] = in[i * channels + channel];
+            }
+        } else if (channels == 2) {
+            for (size_t i = 0; i < frames; ++i) {
+                out[i] = 0.5f * (in[i * 2] + in[i * 2 + 1]);
+            }
+        } else {
+            const float scale = 1.0f / channels;
+            for (size_t i = 0; i < frames; ++i) {
+                float sum = 0.0f;
+                for (unsigned c = 0; c < channels; ++c) {
+                    sum += in[i * channels + c];
+                }
+                out[i] = sum * scale;
+            }
+        }
+    }
+
+    unsigned m_inputChannels;
+    uint32_t m_inputRate;
+    CaptureOutputFormat m_output;
+    PolyphaseResampler m_resampler;
+    std::vector<float> m_mono;          // One slice of downmixed input
+};
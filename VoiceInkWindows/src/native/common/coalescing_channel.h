@@ -0,0 +1,130 @@
+#pragma once
+
+#include <napi.h>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+// Delivers keyed updates from native threads to a JS callback, merging
+// updates that arrive while an earlier delivery is still waiting for the JS
+// thread.
+//
+// At most one call is ever queued on the thread-safe function. Everything
+// posted before it runs is folded, per key, with T::Merge(T&&), so a busy JS
+// thread receives one combined update per key instead of a backlog.
+//
+// At environment teardown Node closes the function before the owner is
+// destroyed. The state outlives it until both sides are done, so later
+// posts are dropped and the destructor does not release it a second time.
+template <typename T>
+class CoalescingChannel {
+public:
+    // Converts one merged update into the JS call; runs on the JS thread.
+    using Deliver = std::function<void(Napi::Env, Napi::Function, const std::string& key, T&& value)>;
+
+    CoalescingChannel(Napi::Env env, Napi::Function callback, const char* resourceName, Deliver deliver)
+        : m_state(new State(std::move(deliver))) {
+        m_tsfn = Tsfn::New(env, callback, resourceName, 0, 1, m_state, &Finalize);
+        // Updates come from work that keeps the loop alive on its own; an
+        // idle channel must not hold the process open
+        m_tsfn.Unref(env);
+    }
+
+    ~CoalescingChannel() {
+        bool finalized = false;
+        {
+            std::lock_guard<std::mutex> lock(m_state->mutex);
+            finalized = m_state->finalized;
+            m_state->orphaned = true;
+        }
+        if (finalized) {
+            delete m_state;
+        } else {
+            // The finalizer frees the state once any queued call has run
+            m_tsfn.Release();
+        }
+    }
+
+    CoalescingChannel(const CoalescingChannel&) = delete;
+    CoalescingChannel& operator=(const CoalescingChannel&) = delete;
+
+    // Any thread. Never blocks on JS.
+    void Post(const std::string& key, T&& value) {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_state->finalized) {
+            return;
+        }
+
+        auto it = m_state->pending.find(key);
+        if (it == m_state->pending.end()) {
+            m_state->pending.emplace(key, std::move(value));
+        } else {
+            it->second.Merge(std::move(value));
+            m_state->coalesced++;
+        }
+
+        // Called under the lock, so the function cannot be finalized in
+        // between. On failure it is closing; the update stays pending.
+        if (!m_state->scheduled) {
+            m_state->scheduled = m_tsfn.NonBlockingCall() == napi_ok;
+        }
+    }
+
+    // Number of updates that were folded into an earlier pending one.
+    uint64_t CoalescedCount() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->coalesced;
+    }
+
+private:
+    struct State {
+        explicit State(Deliver d) : deliver(std::move(d)) {}
+
+        Deliver deliver;
+        mutable std::mutex mutex;
+        std::map<std::string, T> pending;
+        bool scheduled = false;
+        uint64_t coalesced = 0;
+        bool finalized = false;     // The function is gone
+        bool orphaned = false;      // The channel is gone
+    };
+
+    // Runs once the function is closed, after a Release() or at teardown
+    static void Finalize(Napi::Env, State* state) {
+        bool orphaned = false;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->finalized = true;
+            orphaned = state->orphaned;
+        }
+        if (orphaned) {
+            delete state;
+        }
+    }
+
+    static void CallJs(Napi::Env env, Napi::Function callback, State* state, std::nullptr_t*) {
+        std::map<std::string, T> ready;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            ready.swap(state->pending);
+            state->scheduled = false;
+        }
+
+        if (!env || !callback) {
+            return;
+        }
+
+        for (auto& entry : ready) {
+            Napi::HandleScope scope(env);
+            state->deliver(env, callback, entry.first, std::move(entry.second));
+        }
+    }
+
+    using Tsfn = Napi::TypedThreadSafeFunction<State, std::nullptr_t, CallJs>;
+
+    State* m_state;
+    Tsfn m_tsfn;
+};
@@ -0,0 +1,398 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "real_fft.h"
+
+// Tuning for EchoCanceller
+struct EchoCancellerConfig {
+    uint32_t sampleRate = 16000;
+    uint32_t blockMs = 8;               // Rounded up to a power of two of samples
+    uint32_t tailMs = 128;              // Echo path the filter covers past the bulk delay
+    uint32_t maxDelayMs = 500;          // Largest bulk delay the estimator looks for
+    float stepSize = 0.6f;              // NLMS step, 0-1
+};
+
+struct EchoCancellerStats {
+    float erleDb = 0.0f;                // Echo return loss enhancement while the far end plays
+    uint32_t delayFrames = 0;           // Bulk delay compensated before the filter
+    bool delayLocked = false;           // The estimator has settled on that delay
+    bool farEndActive = false;          // The reference reaching the filter is not silent
+};
+
+// Acoustic echo canceller: removes what a far-end reference (the speaker
+// output) leaks into the microphone signal.
+//
+// The echo path is modelled by a partitioned-block frequency-domain NLMS
+// filter: overlap-save over blocks of BlockFrames(), with the tail split into
+// block-sized partitions so each block costs a handful of FFTs however long
+// the tail is. The step is normalised per bin by the smoothed reference
+// power and scaled by the share of the error that is still echo, so near-end
+// speech over the far end (double talk) is not learnt; it is skipped while
+// the reference is silent. One partition per block has the gradient
+// constraint applied, round robin.
+//
+// Loopback and microphone streams are offset by buffering as well as by the
+// acoustic path, so a bulk delay is estimated first: block log-energies of
+// the reference are correlated with the microphone's at every lag up to
+// maxDelayMs, and once one lag has clearly won for long enough the reference
+// is delayed by it, less a two-block margin, and the filter starts over.
+//
+// Each microphone channel has its own filter; the reference is mono. Output
+// lags the input by LatencyFrames(). Everything is allocated in the
+// constructor; Process() is real-time safe. One thread at a time.
+class EchoCanceller {
+public:
+    using Complex = RealFft::Complex;
+
+    // Throws std::bad_alloc
+    EchoCanceller(const EchoCancellerConfig& config, uint32_t channels)
+        : m_config(config)
+        , m_channels((std::max<uint32_t>)(channels, 1))
+        , m_block(BlockSizeFor(config))
+        , m_partitions((std::max<size_t>)((static_cast<size_t>(config.tailMs) * config.sampleRate / 1000 + m_block - 1) / m_block, 1))
+        , m_maxLag(static_cast<size_t>(config.maxDelayMs) * config.sampleRate / 1000 / m_block)
+        , m_fft(2 * m_block)
+        , m_bins(m_fft.Bins())
+        , m_delayMask(PowerOfTwoAtLeast((m_maxLag + 3) * m_block) - 1)
+        , m_delayLine(m_delayMask + 1)
+        , m_micBlock(m_block * m_channels)
+        , m_ready(m_block * m_channels)
+        , m_time(2 * m_block)
+        , m_spectrum(m_bins)
+        , m_references(m_partitions * m_bins)
+        , m_referencePower(m_bins)
+        , m_channelState(m_channels, ChannelState(m_partitions * m_bins))
+        , m_referenceLevels(m_maxLag + 1)
+        , m_lagCovariance(m_maxLag + 1)
+        , m_lagVariance(m_maxLag + 1) {
+        Reset();
+    }
+
+    const EchoCancellerConfig& Config() const { return m_config; }
+    uint32_t Channels() const { return m_channels; }
+    size_t BlockFrames() const { return m_block; }
+    size_t LatencyFrames() const { return m_block; }
+    EchoCancellerStats Stats() const { return m_stats; }
+
+    void Reset() {
+        std::fill(m_delayLine.begin(), m_delayLine.end(), 0.0f);
+        std::fill(m_micBlock.begin(), m_micBlock.end(), 0.0f);
+        std::fill(m_ready.begin(), m_ready.end(), 0.0f);
+        m_written = 0;
+        m_fill = 0;
+        m_referenceBlockPower = 0.0f;
+        m_delay = 0;
+        ResetFilter();
+
+        std::fill(m_referenceLevels.begin(), m_referenceLevels.end(), 0.0f);
+        std::fill(m_lagCovariance.begin(), m_lagCovariance.end(), 0.0f);
+        std::fill(m_lagVariance.begin(), m_lagVariance.end(), 0.0f);
+        m_newestLevel = 0;
+        m_micVariance = 0.0f;
+        m_referenceMean = 0.0f;
+        m_micMean = 0.0f;
+        m_haveLevels = false;
+        m_farEndHangover = 0;
+        m_candidateLag = 0;
+        m_candidateBlocks = 0;
+        m_lockedLag = 0;
+        m_stats = EchoCancellerStats();
+    }
+
+    // Cancels the echo of `reference` (mono, `frameCount` frames, the same
+    // stretch of time) from `samples` (interleaved, `frameCount` frames) in
+    // place, delayed by LatencyFrames()
+    void Process(float* samples, const float* reference, size_t frameCount) {
+        for (size_t frame = 0; frame < frameCount;) {
+            const size_t count = (std::min)(m_block - m_fill, frameCount - frame);
+            float* io = samples + frame * m_channels;
+            std::copy(io, io + count * m_channels, m_micBlock.data() + m_fill * m_channels);
+            std::copy(m_ready.data() + m_fill * m_channels, m_ready.data() + (m_fill + count) * m_channels, io);
+            for (size_t i = 0; i < count; i++) {
+                const float x = reference[frame + i];
+                m_delayLine[m_written++ & m_delayMask] = x;
+                m_referenceBlockPower += x * x;
+            }
+            frame += count;
+            m_fill += count;
+            if (m_fill == m_block) {
+                ProcessBlock();
+                m_fill = 0;
+            }
+        }
+    }
+
+private:
+    static constexpr float kSilence = 1e-7f;          // Block mean square, -70 dBFS
+    static constexpr size_t kDelayMarginBlocks = 2;   // Echo lands this far into the filter
+    static constexpr size_t kLockBlocks = 24;         // A lag must win this long to be taken
+    static constexpr float kLockCorrelation = 0.5f;
+    static constexpr float kPowerSmoothing = 0.9f;    // Reference power per bin, per block
+    static constexpr float kPowerFloor = 0.1f;        // Of the mean bin power; keeps tonal references stable
+    static constexpr float kBootstrapEcho = 0.3f;     // Of the microphone, assumed echo before convergence
+
+    struct ChannelState {
+        explicit ChannelState(size_t weights) : weights(weights) {}
+
+        std::vector<Complex> weights;        // Partition p at [p * bins, (p + 1) * bins)
+        float farMicPower = 0.0f;            // Smoothed over far-end activity, for ERLE
+        float farErrorPower = 0.0f;
+    };
+
+    static size_t PowerOfTwoAtLeast(size_t value) {
+        size_t size = 1;
+        while (size < value) {
+            size *= 2;
+        }
+        return size;
+    }
+
+    static size_t BlockSizeFor(const EchoCancellerConfig& config) {
+        return (std::max<size_t>)(PowerOfTwoAtLeast(static_cast<size_t>(config.blockMs) * config.sampleRate / 1000), 16);
+    }
+
+    void ResetFilter() {
+        std::fill(m_references.begin(), m_references.end(), Complex());
+        std::fill(m_referencePower.begin(), m_referencePower.end(), 0.0f);
+        m_referencePowerFloor = 0.0f;
+        for (ChannelState& state : m_channelState) {
+            std::fill(state.weights.begin(), state.weights.end(), Complex());
+            state.farMicPower = 0.0f;
+            state.farErrorPower = 0.0f;
+        }
+        m_newestPartition = 0;
+        m_constrainNext = 0;
+    }
+
+    void ProcessBlock() {
+        const float referencePower = m_referenceBlockPower / static_cast<float>(m_block);
+        m_referenceBlockPower = 0.0f;
+        float micPower = 0.0f;
+        for (float sample : m_micBlock) {
+            micPower += sample * sample;
+        }
+        micPower /= static_cast<float>(m_micBlock.size());
+        UpdateDelayEstimate(referencePower, micPower);
+
+        // Overlap-save input: the last two blocks of the delayed reference
+        const size_t end = m_written - m_delay;
+        float delayedPower = 0.0f;
+        for (size_t n = 0; n < 2 * m_block; n++) {
+            m_time[n] = m_delayLine[(end - 2 * m_block + n) & m_delayMask];
+        }
+        for (size_t n = m_block; n < 2 * m_block; n++) {
+            delayedPower += m_time[n] * m_time[n];
+        }
+        delayedPower /= static_cast<float>(m_block);
+        m_stats.farEndActive = delayedPower > kSilence;
+
+        m_newestPartition = (m_newestPartition + m_partitions - 1) % m_partitions;
+        Complex* newest = m_references.data() + m_newestPartition * m_bins;
+        m_fft.Forward(m_time.data(), newest);
+
+        float totalPower = 0.0f;
+        for (size_t k = 0; k < m_bins; k++) {
+            m_referencePower[k] = m_referencePower[k] * kPowerSmoothing + std::norm(newest[k]) * (1.0f - kPowerSmoothing);
+            totalPower += m_referencePower[k];
+        }
+        m_referencePowerFloor = kPowerFloor * totalPower / static_cast<float>(m_bins);
+
+        float erleSum = 0.0f;
+        for (uint32_t c = 0; c < m_channels; c++) {
+            erleSum += FilterChannel(c);
+        }
+        m_stats.erleDb = erleSum / static_cast<float>(m_channels);
+        m_constrainNext = (m_constrainNext + 1) % m_partitions;
+    }
+
+    // Runs one block of channel `c` through its filter and adapts it.
+    // Returns the channel's ERLE in dB.
+    float FilterChannel(uint32_t c) {
+        ChannelState& state = m_channelState[c];
+        const size_t bins = m_bins;
+
+        // Echo estimate: sum over partitions of W_p * X_p, newest first
+        std::fill(m_spectrum.begin(), m_spectrum.end(), Complex());
+        for (size_t p = 0; p < m_partitions; p++) {
+            const Complex* x = m_references.data() + ((m_newestPartition + p) % m_partitions) * bins;
+            const Complex* w = state.weights.data() + p * bins;
+            for (size_t k = 0; k < bins; k++) {
+                m_spectrum[k] += Complex(w[k].real() * x[k].real() - w[k].imag() * x[k].imag(),
+                                         w[k].real() * x[k].imag() + w[k].imag() * x[k].real());
+            }
+        }
+        m_fft.Inverse(m_spectrum.data(), m_time.data());
+
+        // Error = microphone - echo estimate; the second half of the
+        // overlap-save output is valid
+        float micPower = 0.0f;
+        float echoPower = 0.0f;
+        float errorPower = 0.0f;
+        for (size_t n = 0; n < m_block; n++) {
+            const float mic = m_micBlock[n * m_channels + c];
+            const float echo = m_time[m_block + n];
+            const float error = mic - echo;
+            m_ready[n * m_channels + c] = error;
+            micPower += mic * mic;
+            echoPower += echo * echo;
+            errorPower += error * error;
+            m_time[n] = 0.0f;
+            m_time[m_block + n] = error;
+        }
+
+        if (m_stats.farEndActive) {
+            const float smoothing = 0.02f;
+            state.farMicPower += (micPower - state.farMicPower) * smoothing;
+            state.farErrorPower += (errorPower - state.farErrorPower) * smoothing;
+        }
+        const float erleDb = 10.0f * std::log10((state.farMicPower + 1e-9f) / (state.farErrorPower + 1e-9f));
+
+        // A filter that adds more than it removes has diverged; start it over
+        if (erleDb < -6.0f) {
+            std::fill(state.weights.begin(), state.weights.end(), Complex());
+            state.farMicPower = 0.0f;
+            state.farErrorPower = 0.0f;
+            return erleDb;
+        }
+
+        if (!m_stats.farEndActive) {
+            return erleDb;
+        }
+
+        // The step shrinks by the share of the error that is residual echo,
+        // estimated from the echo estimate and the ERLE so far (a fixed share
+        // of the microphone until the filter has an estimate). Anything else
+        // in the error is near-end speech or noise that must not be learnt.
+        const float echoLevel = (std::max)(echoPower, kBootstrapEcho * micPower);
+        const float residualEcho = echoLevel / (std::max)(state.farMicPower / (state.farErrorPower + 1e-9f), 1.0f);
+        const float step = m_config.stepSize * (std::min)(1.0f, residualEcho / (errorPower + 1e-9f));
+
+        m_fft.Forward(m_time.data(), m_spectrum.data());
+        const float regularisation = static_cast<float>(m_partitions) * static_cast<float>(2 * m_block) * kSilence;
+        for (size_t k = 0; k < bins; k++) {
+            const float scale = step / (static_cast<float>(m_partitions) * (m_referencePower[k] + m_referencePowerFloor) + regularisation);
+            m_spectrum[k] *= scale;
+        }
+        for (size_t p = 0; p < m_partitions; p++) {
+            const Complex* x = m_references.data() + ((m_newestPartition + p) % m_partitions) * bins;
+            Complex* w = state.weights.data() + p * bins;
+            for (size_t k = 0; k < bins; k++) {
+                const Complex& e = m_spectrum[k];
+                // w += conj(x) * e
+                w[k] += Complex(x[k].real() * e.real() + x[k].imag() * e.imag(),
+                                x[k].real() * e.imag() - x[k].imag() * e.real());
+            }
+        }
+
+        // Gradient constraint for one partition: its impulse response must
+        // fit in one block
+        Complex* constrained = state.weights.data() + m_constrainNext * bins;
+        m_fft.Inverse(constrained, m_time.data());
+        std::fill(m_time.begin() + m_block, m_time.end(), 0.0f);
+        m_fft.Forward(m_time.data(), constrained);
+        return erleDb;
+    }
+
+    // Correlates block log-energies of the reference with the microphone's
+    // at every lag and moves the delay line to a lag that keeps winning
+    void UpdateDelayEstimate(float referencePower, float micPower) {
+        const float referenceLevel = std::log(referencePower + 1e-10f);
+        const float micLevel = std::log(micPower + 1e-10f);
+        if (!m_haveLevels) {
+            m_referenceMean = referenceLevel;
+            m_micMean = micLevel;
+            m_haveLevels = true;
+        }
+        m_referenceMean += (referenceLevel - m_referenceMean) * 0.01f;
+        m_micMean += (micLevel - m_micMean) * 0.01f;
+        m_newestLevel = (m_newestLevel + m_maxLag) % (m_maxLag + 1);
+        m_referenceLevels[m_newestLevel] = referenceLevel - m_referenceMean;
+
+        // Only while the far end has played within the search window
+        m_farEndHangover = referencePower > kSilence ? m_maxLag + 1 : (m_farEndHangover > 0 ? m_farEndHangover - 1 : 0);
+        if (m_farEndHangover == 0) {
+            return;
+        }
+
+        const float forget = 0.995f;
+        const float mic = micLevel - m_micMean;
+        m_micVariance = m_micVariance * forget + mic * mic;
+        size_t best = 0;
+        float bestCorrelation = -1.0f;
+        for (size_t lag = 0; lag <= m_maxLag; lag++) {
+            const float reference = m_referenceLevels[(m_newestLevel + lag) % (m_maxLag + 1)];
+            m_lagCovariance[lag] = m_lagCovariance[lag] * forget + reference * mic;
+            m_lagVariance[lag] = m_lagVariance[lag] * forget + reference * reference;
+            const float correlation = m_lagCovariance[lag] / std::sqrt(m_lagVariance[lag] * m_micVariance + 1e-12f);
+            if (correlation > bestCorrelation) {
+                bestCorrelation = correlation;
+                best = lag;
+            }
+        }
+
+        if (bestCorrelation < kLockCorrelation) {
+            m_candidateBlocks = 0;
+            return;
+        }
+        m_candidateBlocks = best == m_candidateLag ? m_candidateBlocks + 1 : 1;
+        m_candidateLag = best;
+        const size_t drift = best > m_lockedLag ? best - m_lockedLag : m_lockedLag - best;
+        if (m_candidateBlocks >= kLockBlocks && (!m_stats.delayLocked || drift > 1)) {
+            m_lockedLag = best;
+            m_stats.delayLocked = true;
+            const size_t delay = (best > kDelayMarginBlocks ? best - kDelayMarginBlocks : 0) * m_block;
+            if (delay != m_delay) {
+                m_delay = delay;
+                m_stats.delayFrames = static_cast<uint32_t>(m_delay);
+                ResetFilter();
+            }
+        }
+    }
+
+    const EchoCancellerConfig m_config;
+    const uint32_t m_channels;
+    const size_t m_block;
+    const size_t m_partitions;
+    const size_t m_maxLag;                   // In blocks
+    RealFft m_fft;                           // Two blocks
+    const size_t m_bins;
+
+    const size_t m_delayMask;
+    std::vector<float> m_delayLine;          // Reference history, a ring
+    size_t m_written;                        // Reference samples written, ever
+    size_t m_delay;                          // Reference delay before the filter, in samples
+    float m_referenceBlockPower;             // Sum of squares of the block being collected
+
+    std::vector<float> m_micBlock;           // Interleaved block being collected
+    std::vector<float> m_ready;              // Output played out while a block is collected
+    size_t m_fill;                           // Frames of the block collected
+    std::vector<float> m_time;               // FFT input and output, two blocks
+    std::vector<Complex> m_spectrum;
+
+    std::vector<Complex> m_references;       // Reference spectra, one per partition, a ring
+    size_t m_newestPartition;
+    std::vector<float> m_referencePower;     // Per bin, for the step normalisation
+    float m_referencePowerFloor;
+    std::vector<ChannelState> m_channelState;
+    size_t m_constrainNext;
+
+    // Delay estimation; levels are log block energies less their running mean
+    std::vector<float> m_referenceLevels;    // The last m_maxLag + 1, a ring
+    size_t m_newestLevel;
+    std::vector<float> m_lagCovariance;
+    std::vector<float> m_lagVariance;
+    float m_micVariance;
+    float m_referenceMean;
+    float m_micMean;
+    bool m_haveLevels;
+    size_t m_farEndHangover;                 // Blocks until the far end counts as silent
+    size_t m_candidateLag;
+    size_t m_candidateBlocks;
+    size_t m_lockedLag;
+
+    EchoCancellerStats m_stats;
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <napi.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "buffer_pool.h"
+
+// Hands pooled native storage to JS without copying.
+//
+// The storage is moved into an external ArrayBuffer (or Buffer) whose
+// finalizer returns it to the pool once JS has collected the last view.
+// Runtimes that forbid external buffers (Electron's V8 sandbox, or builds with
+// NODE_API_NO_EXTERNAL_BUFFERS_ALLOWED) get a single copy into a JS-owned
+// buffer instead, and the storage is recycled immediately.
+namespace external_buffer_detail {
+
+template <typename T>
+struct PooledStorage {
+    std::vector<T> data;
+    std::shared_ptr<BufferPool<T>> pool;
+};
+
+template <typename T>
+void Finalize(napi_env /*env*/, void* /*data*/, void* hint) {
+    auto* storage = static_cast<PooledStorage<T>*>(hint);
+    if (storage->pool) {
+        storage->pool->Recycle(std::move(storage->data));
+    }
+    delete storage;
+}
+
+// Tries `createExternal`, falling back to `createCopy` when the runtime
+// refuses external memory. Returns the raw napi_value of whichever succeeded.
+template <typename T, typename CreateExternal, typename CreateCopy>
+napi_value Create(std::vector<T>&& data, const std::shared_ptr<BufferPool<T>>& pool,
+                  CreateExternal createExternal, CreateCopy createCopy) {
+#ifndef NODE_API_NO_EXTERNAL_BUFFERS_ALLOWED
+    if (!data.empty()) {
+        auto* storage = new PooledStorage<T>{ std::move(data), pool };
+        napi_value result = nullptr;
+        if (createExternal(storage->data.data(), storage->data.size() * sizeof(T),
+                           &Finalize<T>, storage, &result) == napi_ok) {
+            return result;
+        }
+        // napi_no_external_buffers_allowed: the finalizer was not registered
+        data = std::move(storage->data);
+        delete storage;
+    }
+#endif
+
+    napi_value result = createCopy(data.data(), data.size() * sizeof(T));
+    if (pool) {
+        pool->Recycle(std::move(data));
+    }
+    return result;
+}
+
+} // namespace external_buffer_detail
+
+// Moves `data` into an ArrayBuffer. `pool` may be null, in which case the
+// storage is simply freed when the ArrayBuffer is collected.
+template <typename T>
+Napi::ArrayBuffer MoveToArrayBuffer(Napi::Env env, std::vector<T>&& data,
+                                    const std::shared_ptr<BufferPool<T>>& pool = nullptr) {
+    napi_value value = external_buffer_detail::Create<T>(
+        std::move(data), pool,
+        [env](void* bytes, size_t length, napi_finalize finalize, void* hint, napi_value* result) {
+            return napi_create_external_arraybuffer(env, bytes, length, finalize, hint, result);
+        },
+        [env](const void* bytes, size_t length) -> napi_value {
+            Napi::ArrayBuffer copy = Napi::ArrayBuffer::New(env, length);
+            if (length > 0) {
+                std::memcpy(copy.Data(), bytes, length);
+            }
+            return copy;
+        });
+    return Napi::ArrayBuffer(env, value);
+}
+
+// Moves `data` into a Node Buffer, with the same ownership rules as
+// MoveToArrayBuffer().
+inline Napi::Buffer<uint8_t> MoveToBuffer(Napi::Env env, std::vector<uint8_t>&& data,
+                                          const std::shared_ptr<BufferPool<uint8_t>>& pool = nullptr) {
+    napi_value value = external_buffer_detail::Create<uint8_t>(
+        std::move(data), pool,
+        [env](void* bytes, size_t length, napi_finalize finalize, void* hint, napi_value* result) {
+            return napi_create_external_buffer(env, length, bytes, finalize, hint, result);
+        },
+        [env](const void* bytes, size_t length) -> napi_value {
+            return Napi::Buffer<uint8_t>::Copy(env, static_cast<const uint8_t*>(bytes), length);
+        });
+    return Napi::Buffer<uint8_t>(env, value);
+}
+
+// Wraps memory owned by `owner` in an ArrayBuffer without copying. The
+// ArrayBuffer keeps `owner` alive until it is collected, so the memory stays
+// valid even if the native side lets go of it first. Where external buffers
+// are not allowed the bytes are copied once instead.
+inline Napi::ArrayBuffer ViewAsArrayBuffer(Napi::Env env, const void* data, size_t length,
+                                           std::shared_ptr<const void> owner) {
+#ifndef NODE_API_NO_EXTERNAL_BUFFERS_ALLOWED
+    if (length > 0) {
+        auto* hint = new std::shared_ptr<const void>(std::move(owner));
+        napi_value result = nullptr;
+        napi_status status = napi_create_external_arraybuffer(
+            env, const_cast<void*>(data), length,
+            [](napi_env /*env*/, void* /*data*/, void* hint) {
+                delete static_cast<std::shared_ptr<const void>*>(hint);
+            },
+            hint, &result);
+        if (status == napi_ok) {
+            return Napi::ArrayBuffer(env, result);
+        }
+        delete hint;
+    }
+#endif
+
+    Napi::ArrayBuffer copy = Napi::ArrayBuffer::New(env, length);
+    if (length > 0) {
+        std::memcpy(copy.Data(), data, length);
+    }
+    return copy;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Preallocated pool of equally sized blocks with a lock-free free list.
+//
+// All storage is allocated once in the constructor, so Acquire() and
+// Release() never touch the heap and are safe on a real-time thread. Blocks
+// are named by index; the free list is a Treiber stack whose head carries a
+// generation tag next to the index, so a block that is taken and returned
+// between another thread's load and compare-exchange cannot corrupt it (ABA).
+// Any number of threads may acquire and release concurrently.
+template <typename T>
+class FixedBlockPool {
+public:
+    static constexpr uint32_t kNoBlock = UINT32_MAX;
+
+    FixedBlockPool(uint32_t blockCount, size_t blockSize)
+        : m_blockCount(blockCount)
+        , m_blockSize(blockSize)
+        , m_storage(new T[static_cast<size_t>(blockCount) * blockSize]())
+        , m_next(new std::atomic<uint32_t>[blockCount]) {
+        for (uint32_t i = 0; i < blockCount; ++i) {
+            m_next[i].store(i + 1 < blockCount ? i + 1 : kNoBlock, std::memory_order_relaxed);
+        }
+        m_head.store(Pack(blockCount > 0 ? 0 : kNoBlock, 0), std::memory_order_release);
+        m_free.store(blockCount, std::memory_order_relaxed);
+    }
+
+    FixedBlockPool(const FixedBlockPool&) = delete;
+    FixedBlockPool& operator=(const FixedBlockPool&) = delete;
+
+    // Returns a free block, or kNoBlock when every block is in use.
+    uint32_t Acquire() {
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        while (Index(head) != kNoBlock) {
+            const uint32_t next = m_next[Index(head)].load(std::memory_order_relaxed);
+            if (m_head.compare_exchange_weak(head, Pack(next, Tag(head) + 1), std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+                m_free.fetch_sub(1, std::memory_order_relaxed);
+                return Index(head);
+            }
+        }
+        return kNoBlock;
+    }
+
+    void Release(uint32_t block) {
+        if (block >= m_blockCount) {
+            return;
+        }
+
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        do {
+            m_next[block].store(Index(head), std::memory_order_relaxed);
+        } while (!m_head.compare_exchange_weak(head, Pack(block, Tag(head) + 1), std::memory_order_release,
+                                               std::memory_order_relaxed));
+        m_free.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    T* Data(uint32_t block) { return m_storage.get() + static_cast<size_t>(block) * m_blockSize; }
+    const T* Data(uint32_t block) const { return m_storage.get() + static_cast<size_t>(block) * m_blockSize; }
+
+    uint32_t BlockCount() const { return m_blockCount; }
+    size_t BlockSize() const { return m_blockSize; }
+    // Approximate while other threads acquire or release
+    uint32_t FreeCount() const { return m_free.load(std::memory_order_relaxed); }
+
+private:
+    static uint64_t Pack(uint32_t index, uint32_t tag) { return (static_cast<uint64_t>(tag) << 32) | index; }
+    static uint32_t Index(uint64_t head) { return static_cast<uint32_t>(head); }
+    static uint32_t Tag(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+
+    const uint32_t m_blockCount;
+    const size_t m_blockSize;
+    const std::unique_ptr<T[]> m_storage;
+    const std::unique_ptr<std::atomic<uint32_t>[]> m_next;
+
+    alignas(64) std::atomic<uint64_t> m_head{ 0 };
+    std::atomic<uint32_t> m_free{ 0 };
+};
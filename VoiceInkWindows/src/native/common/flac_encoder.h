@@ -0,0 +1,794 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+// FLAC (RFC 9639) encoding for stored recordings.
+//
+// FlacFrameEncoder turns one block of interleaved integer samples into one
+// self-contained FLAC frame, so blocks can be encoded on any thread and in
+// any order. Each channel gets the cheapest of a constant, verbatim, fixed
+// (orders 0-4) or LPC subframe, the residual is Rice coded in the cheapest
+// partitioning. Stereo is coded as left/right, left/side, side/right or
+// mid/side, whichever pair the fixed predictors find cheapest.
+// EncodeFlac() wraps frames into a whole stream, spreading the blocks over
+// threads.
+//
+// The STREAMINFO MD5 is left as zeros, which the format defines as unknown.
+
+struct FlacEncoderConfig {
+    uint32_t sampleRate = 16000;
+    uint16_t channels = 1;              // 1 to 8
+    uint16_t bitsPerSample = 16;        // 4 to 24
+    uint32_t blockSize = 4096;          // Frames per FLAC frame, 16 to 65535
+    uint32_t maxLpcOrder = 8;           // Up to 32; 0 leaves fixed predictors only
+    uint32_t maxPartitionOrder = 6;     // Up to 8
+
+    bool Valid() const {
+        return sampleRate > 0 && sampleRate < (1u << 20) && channels >= 1 && channels <= 8 && bitsPerSample >= 4 &&
+               bitsPerSample <= 24 && blockSize >= 16 && blockSize <= 65535 && maxLpcOrder <= 32 && maxPartitionOrder <= 8;
+    }
+};
+
+namespace Flac {
+
+constexpr size_t kStreamHeaderBytes = 42;      // "fLaC" and the STREAMINFO block
+constexpr uint32_t kMaxLpcOrder = 32;
+constexpr uint32_t kMaxPartitionOrder = 8;
+
+inline const uint8_t* Crc8Table() {
+    static const struct Table {
+        uint8_t values[256];
+        Table() {
+            for (int i = 0; i < 256; i++) {
+                uint8_t crc = static_cast<uint8_t>(i);
+                for (int bit = 0; bit < 8; bit++) {
+                    crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+                }
+                values[i] = crc;
+            }
+        }
+    } table;
+    return table.values;
+}
+
+inline const uint16_t* Crc16Table() {
+    static const struct Table {
+        uint16_t values[256];
+        Table() {
+            for (int i = 0; i < 256; i++) {
+                uint16_t crc = static_cast<uint16_t>(i << 8);
+                for (int bit = 0; bit < 8; bit++) {
+                    crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x8005 : crc << 1);
+                }
+                values[i] = crc;
+            }
+        }
+    } table;
+    return table.values;
+}
+
+inline uint8_t Crc8(const uint8_t* data, size_t length) {
+    const uint8_t* table = Crc8Table();
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[crc ^ data[i]];
+    }
+    return crc;
+}
+
+inline uint16_t Crc16(const uint8_t* data, size_t length) {
+    const uint16_t* table = Crc16Table();
+    uint16_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc = static_cast<uint16_t>((crc << 8) ^ table[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+inline uint32_t ZigZag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+// MSB-first bit packing into caller-sized memory
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t* out) : m_out(out) {}
+
+    // `count` up to 32
+    void Write(uint32_t value, unsigned count) {
+        if (count == 0) {
+            return;
+        }
+        m_cache = (m_cache << count) | (value & (0xFFFFFFFFu >> (32 - count)));
+        m_bits += count;
+        while (m_bits >= 8) {
+            m_bits -= 8;
+            m_out[m_bytes++] = static_cast<uint8_t>(m_cache >> m_bits);
+        }
+    }
+    void WriteSigned(int32_t value, unsigned count) { Write(static_cast<uint32_t>(value), count); }
+    void WriteUnary(uint32_t zeros) {
+        for (; zeros >= 32; zeros -= 32) {
+            Write(0, 32);
+        }
+        Write(1, zeros + 1);
+    }
+    void WriteRice(uint32_t folded, unsigned parameter) {
+        const uint32_t quotient = folded >> parameter;
+        if (quotient + 1 + parameter <= 32) {
+            // The quotient's zeros are the leading bits of one write
+            Write((1u << parameter) | (folded & ((1u << parameter) - 1)), quotient + 1 + parameter);
+        } else {
+            WriteUnary(quotient);
+            Write(folded, parameter);
+        }
+    }
+    void AlignToByte() {
+        if (m_bits > 0) {
+            Write(0, 8 - m_bits);
+        }
+    }
+    // Whole bytes written so far
+    size_t Bytes() const { return m_bytes; }
+
+private:
+    uint8_t* m_out;
+    size_t m_bytes = 0;
+    uint64_t m_cache = 0;
+    unsigned m_bits = 0;
+};
+
+// "fLaC" and a STREAMINFO block, the only metadata block
+inline void WriteStreamHeader(uint8_t* out, const FlacEncoderConfig& config, uint64_t totalFrames,
+                              uint32_t minFrameBytes, uint32_t maxFrameBytes) {
+    std::memset(out, 0, kStreamHeaderBytes);
+    std::memcpy(out, "fLaC", 4);
+    BitWriter bits(out + 4);
+    bits.Write(1, 1);                               // Last metadata block
+    bits.Write(0, 7);                               // STREAMINFO
+    bits.Write(34, 24);
+    bits.Write(config.blockSize, 16);
+    bits.Write(config.blockSize, 16);
+    bits.Write(minFrameBytes, 24);
+    bits.Write(maxFrameBytes, 24);
+    bits.Write(config.sampleRate, 20);
+    bits.Write(config.channels - 1u, 3);
+    bits.Write(config.bitsPerSample - 1u, 5);
+    bits.Write(static_cast<uint32_t>(totalFrames >> 32) & 0xF, 4);
+    bits.Write(static_cast<uint32_t>(totalFrames), 32);
+    // MD5 stays zero: unknown
+}
+
+} // namespace Flac
+
+class FlacFrameEncoder {
+public:
+    // Throws std::bad_alloc. Everything is allocated here; EncodeFrame()
+    // does not allocate.
+    explicit FlacFrameEncoder(const FlacEncoderConfig& config)
+        : m_config(config)
+        , m_lpcOrder((std::min)(config.maxLpcOrder, Flac::kMaxLpcOrder))
+        , m_precision(config.bitsPerSample <= 16 ? 12u : 14u) {
+        const size_t block = config.blockSize;
+        const size_t sources = config.channels == 2 ? 4 : config.channels;
+        m_sources.assign(sources, std::vector<int32_t>(block));
+        m_residuals.assign(sources, std::vector<int32_t>(block));
+        m_plans.resize(sources);
+        m_trial.resize(block);
+        m_shifted.resize(block);
+        m_window.resize(block);
+        m_windowed.resize(block);
+        m_partitionSums.resize(size_t(1) << Flac::kMaxPartitionOrder);
+    }
+
+    const FlacEncoderConfig& Config() const { return m_config; }
+
+    // Bound on what EncodeFrame() writes: verbatim subframes, one extra bit
+    // per sample for a side channel, and the header and footer
+    size_t MaxFrameBytes() const {
+        return 32 + static_cast<size_t>(m_config.channels) * ((m_config.blockSize * (m_config.bitsPerSample + 1u) + 7) / 8 + 8);
+    }
+
+    // Encodes `frames` (1 to blockSize; only the last block of a stream may
+    // be shorter) interleaved samples as frame number `frameNumber`. Samples
+    // must fit bitsPerSample. Returns the bytes written to `out`, which must
+    // hold MaxFrameBytes().
+    size_t EncodeFrame(const int32_t* interleaved, size_t frames, uint64_t frameNumber, uint8_t* out) {
+        const uint32_t channels = m_config.channels;
+        const uint32_t bps = m_config.bitsPerSample;
+        for (uint32_t c = 0; c < channels; c++) {
+            int32_t* source = m_sources[c].data();
+            for (size_t i = 0; i < frames; i++) {
+                source[i] = interleaved[i * channels + c];
+            }
+        }
+
+        // Channel assignment: independent, or one of the three stereo pairs
+        uint32_t assignment = channels - 1;
+        int pair[2] = { 0, 1 };
+        if (channels == 2) {
+            int32_t* mid = m_sources[2].data();
+            int32_t* side = m_sources[3].data();
+            const int32_t* left = m_sources[0].data();
+            const int32_t* right = m_sources[1].data();
+            for (size_t i = 0; i < frames; i++) {
+                mid[i] = (left[i] + right[i]) >> 1;
+                side[i] = left[i] - right[i];
+            }
+            // Picked from the fixed predictors' residuals, so only the chosen
+            // pair goes through LPC
+            uint64_t totals[4];
+            for (int s = 0; s < 4; s++) {
+                BestFixedOrder(m_sources[s].data(), frames, &totals[s]);
+            }
+            const uint64_t independent = totals[0] + totals[1];
+            const uint64_t leftSide = totals[0] + totals[3];
+            const uint64_t sideRight = totals[3] + totals[1];
+            const uint64_t midSide = totals[2] + totals[3];
+            const uint64_t best = (std::min)((std::min)(independent, leftSide), (std::min)(sideRight, midSide));
+            if (best == midSide) {
+                assignment = 10;
+                pair[0] = 2;
+                pair[1] = 3;
+            } else if (best == leftSide) {
+                assignment = 8;
+                pair[1] = 3;
+            } else if (best == sideRight) {
+                assignment = 9;
+                pair[0] = 3;
+            }
+            for (int source : pair) {
+                PlanSubframe(source, frames, source == 3 ? bps + 1 : bps);
+            }
+        } else {
+            for (uint32_t c = 0; c < channels; c++) {
+                PlanSubframe(static_cast<int>(c), frames, bps);
+            }
+        }
+
+        Flac::BitWriter bits(out);
+        WriteFrameHeader(bits, frames, frameNumber, assignment);
+        // The header is whole bytes, all already in `out`
+        bits.Write(Flac::Crc8(out, bits.Bytes()), 8);
+
+        for (uint32_t c = 0; c < channels; c++) {
+            const int source = channels == 2 ? pair[c] : static_cast<int>(c);
+            WriteSubframe(bits, source, frames);
+        }
+        bits.AlignToByte();
+        const uint16_t crc = Flac::Crc16(out, bits.Bytes());
+        bits.Write(crc, 16);
+        return bits.Bytes();
+    }
+
+private:
+    enum class SubframeType : uint8_t { Constant, Verbatim, Fixed, Lpc };
+
+    struct SubframePlan {
+        SubframeType type = SubframeType::Verbatim;
+        uint32_t bps = 16;                          // After removing wasted bits
+        uint32_t wastedBits = 0;
+        uint32_t order = 0;
+        uint32_t precision = 0;
+        int32_t shift = 0;
+        int32_t coefficients[Flac::kMaxLpcOrder] = {};
+        uint32_t partitionOrder = 0;
+        bool rice2 = false;                         // 5-bit parameters
+        uint8_t parameters[size_t(1) << Flac::kMaxPartitionOrder] = {};
+    };
+
+    // Picks the cheapest subframe for source `s` and leaves its residual in
+    // m_residuals[s]; returns its size in bits
+    uint64_t PlanSubframe(int s, size_t n, uint32_t bps) {
+        SubframePlan& plan = m_plans[s];
+        const int32_t* samples = m_sources[s].data();
+
+        // Low bits that are zero in every sample are sent once
+        uint32_t any = 0;
+        for (size_t i = 0; i < n; i++) {
+            any |= static_cast<uint32_t>(samples[i]);
+        }
+        plan.wastedBits = 0;
+        plan.bps = bps;
+        if (any == 0) {
+            plan.type = SubframeType::Constant;
+            return 8 + bps;
+        }
+        while (((any >> plan.wastedBits) & 1) == 0 && plan.wastedBits + 1 < bps) {
+            plan.wastedBits++;
+        }
+        if (plan.wastedBits > 0) {
+            for (size_t i = 0; i < n; i++) {
+                m_shifted[i] = samples[i] >> plan.wastedBits;
+            }
+            samples = m_shifted.data();
+            plan.bps = bps - plan.wastedBits;
+        }
+        const uint64_t headerBits = 8 + plan.wastedBits;
+
+        bool constant = true;
+        for (size_t i = 1; i < n && constant; i++) {
+            constant = samples[i] == samples[0];
+        }
+        if (constant) {
+            plan.type = SubframeType::Constant;
+            return headerBits + plan.bps;
+        }
+
+        plan.type = SubframeType::Verbatim;
+        uint64_t best = headerBits + static_cast<uint64_t>(n) * plan.bps;
+
+        const uint32_t fixedOrder = BestFixedOrder(samples, n);
+        {
+            ComputeFixedResidual(samples, n, fixedOrder, m_trial.data());
+            SubframePlan trial = plan;
+            const uint64_t bits = headerBits + fixedOrder * plan.bps + PlanResidual(trial, m_trial.data(), n, fixedOrder);
+            if (bits < best) {
+                best = bits;
+                trial.type = SubframeType::Fixed;
+                trial.order = fixedOrder;
+                plan = trial;
+                std::swap(m_residuals[s], m_trial);
+            }
+        }
+
+        // LPC at the order the Levinson-Durbin errors predict is cheapest
+        if (m_lpcOrder > 0 && n > m_lpcOrder + 1) {
+            SubframePlan trial = plan;
+            if (PlanLpc(trial, samples, n)) {
+                const uint64_t bits = headerBits + trial.order * (plan.bps + trial.precision) + 9 +
+                                      PlanResidual(trial, m_trial.data(), n, trial.order);
+                if (bits < best) {
+                    best = bits;
+                    trial.type = SubframeType::Lpc;
+                    plan = trial;
+                    std::swap(m_residuals[s], m_trial);
+                }
+            }
+        }
+        return best;
+    }
+
+    // The fixed order with the smallest total absolute residual, and that total
+    static uint32_t BestFixedOrder(const int32_t* x, size_t n, uint64_t* total = nullptr) {
+        if (n < 5) {
+            if (total) {
+                *total = 0;
+                for (size_t i = 0; i < n; i++) {
+                    *total += static_cast<uint64_t>(x[i] < 0 ? -int64_t(x[i]) : int64_t(x[i]));
+                }
+            }
+            return 0;
+        }
+        uint64_t totals[5] = {};
+        int64_t last0 = x[3];
+        int64_t last1 = x[3] - x[2];
+        int64_t last2 = last1 - (x[2] - x[1]);
+        int64_t last3 = last2 - (x[2] - 2 * int64_t(x[1]) + x[0]);
+        for (size_t i = 4; i < n; i++) {
+            const int64_t e0 = x[i];
+            const int64_t e1 = e0 - last0;
+            const int64_t e2 = e1 - last1;
+            const int64_t e3 = e2 - last2;
+            const int64_t e4 = e3 - last3;
+            last0 = e0;
+            last1 = e1;
+            last2 = e2;
+            last3 = e3;
+            totals[0] += static_cast<uint64_t>(e0 < 0 ? -e0 : e0);
+            totals[1] += static_cast<uint64_t>(e1 < 0 ? -e1 : e1);
+            totals[2] += static_cast<uint64_t>(e2 < 0 ? -e2 : e2);
+            totals[3] += static_cast<uint64_t>(e3 < 0 ? -e3 : e3);
+            totals[4] += static_cast<uint64_t>(e4 < 0 ? -e4 : e4);
+        }
+        const uint32_t order = static_cast<uint32_t>(std::min_element(totals, totals + 5) - totals);
+        if (total) {
+            *total = totals[order];
+        }
+        return order;
+    }
+
+    static void ComputeFixedResidual(const int32_t* x, size_t n, uint32_t order, int32_t* residual) {
+        for (size_t i = order; i < n; i++) {
+            switch (order) {
+            case 0: residual[i] = x[i]; break;
+            case 1: residual[i] = x[i] - x[i - 1]; break;
+            case 2: residual[i] = x[i] - 2 * x[i - 1] + x[i - 2]; break;
+            case 3: residual[i] = x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3]; break;
+            default: residual[i] = x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4]; break;
+            }
+        }
+    }
+
+    // Windowed autocorrelation, Levinson-Durbin, then the order with the
+    // fewest expected bits is quantised and its residual left in m_trial.
+    // False if LPC does not apply (silence, a residual that overflows).
+    bool PlanLpc(SubframePlan& plan, const int32_t* x, size_t n) {
+        if (n != m_windowFrames) {
+            // Tukey(0.5): flat in the middle, cosine tapers over a quarter at each end
+            const size_t taper = (std::max<size_t>)(n / 4, 1);
+            for (size_t i = 0; i < n; i++) {
+                const size_t edge = (std::min)(i, n - 1 - i);
+                m_window[i] = edge >= taper ? 1.0 : 0.5 - 0.5 * std::cos(3.14159265358979323846 * edge / taper);
+            }
+            m_windowFrames = n;
+        }
+        for (size_t i = 0; i < n; i++) {
+            m_windowed[i] = x[i] * m_window[i];
+        }
+
+        const uint32_t maxOrder = m_lpcOrder;
+        double autocorrelation[Flac::kMaxLpcOrder + 1];
+        for (uint32_t lag = 0; lag <= maxOrder; lag++) {
+            double sum = 0.0;
+            for (size_t i = lag; i < n; i++) {
+                sum += m_windowed[i] * m_windowed[i - lag];
+            }
+            autocorrelation[lag] = sum;
+        }
+        if (autocorrelation[0] <= 0.0) {
+            return false;
+        }
+
+        // Levinson-Durbin; coefficients[o][j] predicts from the sample j + 1 back
+        double lpc[Flac::kMaxLpcOrder];
+        double error = autocorrelation[0];
+        uint32_t bestOrder = 0;
+        double bestBits = std::numeric_limits<double>::max();
+        const double errorScale = 0.5 / static_cast<double>(n);
+        for (uint32_t i = 0; i < maxOrder; i++) {
+            double reflection = -autocorrelation[i + 1];
+            for (uint32_t j = 0; j < i; j++) {
+                reflection -= lpc[j] * autocorrelation[i - j];
+            }
+            reflection /= error;
+            lpc[i] = reflection;
+            uint32_t j = 0;
+            for (; j < i / 2; j++) {
+                const double tmp = lpc[j];
+                lpc[j] += reflection * lpc[i - 1 - j];
+                lpc[i - 1 - j] += reflection * tmp;
+            }
+            if (i & 1) {
+                lpc[j] += lpc[j] * reflection;
+            }
+            error *= 1.0 - reflection * reflection;
+            for (j = 0; j <= i; j++) {
+                m_lpcCoefficients[i][j] = -lpc[j];
+            }
+
+            const uint32_t order = i + 1;
+            const double bitsPerResidual = error > 0.0 ? (std::max)(0.0, 0.5 * std::log2(errorScale * error)) : 0.0;
+            const double bits = bitsPerResidual * static_cast<double>(n - order) + order * static_cast<double>(m_precision + plan.bps);
+            if (bits < bestBits) {
+                bestBits = bits;
+                bestOrder = order;
+            }
+            if (error <= 0.0) {
+                break;
+            }
+        }
+
+        // Quantise, carrying each rounding error into the next coefficient
+        const double* coefficients = m_lpcCoefficients[bestOrder - 1];
+        double largest = 0.0;
+        for (uint32_t j = 0; j < bestOrder; j++) {
+            largest = (std::max)(largest, std::abs(coefficients[j]));
+        }
+        if (largest <= 0.0) {
+            return false;
+        }
+        int exponent = 0;
+        std::frexp(largest, &exponent);
+        // The largest coefficient scales to between a quarter and a half of the range
+        const int shift = (std::min)(static_cast<int>(m_precision) - exponent - 1, 15);
+        if (shift < 0) {
+            return false;
+        }
+        const int32_t qmax = (1 << (m_precision - 1)) - 1;
+        const int32_t qmin = -(1 << (m_precision - 1));
+        double carried = 0.0;
+        for (uint32_t j = 0; j < bestOrder; j++) {
+            carried += coefficients[j] * static_cast<double>(1 << shift);
+            const int32_t q = static_cast<int32_t>((std::max)(static_cast<double>(qmin), (std::min)(static_cast<double>(qmax), std::round(carried))));
+            carried -= q;
+            plan.coefficients[j] = q;
+        }
+        plan.order = bestOrder;
+        plan.precision = m_precision;
+        plan.shift = shift;
+
+        for (size_t i = bestOrder; i < n; i++) {
+            int64_t prediction = 0;
+            for (uint32_t j = 0; j < bestOrder; j++) {
+                prediction += static_cast<int64_t>(plan.coefficients[j]) * x[i - 1 - j];
+            }
+            const int64_t residual = x[i] - (prediction >> shift);
+            if (residual > INT32_MAX / 2 || residual < INT32_MIN / 2) {
+                return false;
+            }
+            m_trial[i] = static_cast<int32_t>(residual);
+        }
+        return true;
+    }
+
+    // Chooses the partition order and Rice parameters for residual[order, n)
+    // and returns its size in bits. The per-partition estimate count * (k + 1)
+    // + (sum >> k) never undercounts, so no plan exceeds what it claims.
+    uint64_t PlanResidual(SubframePlan& plan, const int32_t* residual, size_t n, uint32_t order) {
+        uint32_t maxOrder = (std::min)(m_config.maxPartitionOrder, Flac::kMaxPartitionOrder);
+        while (maxOrder > 0 && ((n & ((size_t(1) << maxOrder) - 1)) != 0 || (n >> maxOrder) <= order)) {
+            maxOrder--;
+        }
+
+        // Sums of folded residuals at the finest partitioning, merged upwards
+        const size_t finest = size_t(1) << maxOrder;
+        const size_t partitionSize = n >> maxOrder;
+        for (size_t p = 0; p < finest; p++) {
+            const size_t start = p == 0 ? order : p * partitionSize;
+            const size_t end = (p + 1) * partitionSize;
+            uint64_t sum = 0;
+            for (size_t i = start; i < end; i++) {
+                sum += Flac::ZigZag(residual[i]);
+            }
+            m_partitionSums[p] = sum;
+        }
+
+        uint64_t bestBits = std::numeric_limits<uint64_t>::max();
+        for (int partitionOrder = static_cast<int>(maxOrder); partitionOrder >= 0; partitionOrder--) {
+            const size_t partitions = size_t(1) << partitionOrder;
+            if (partitionOrder < static_cast<int>(maxOrder)) {
+                for (size_t p = 0; p < partitions; p++) {
+                    m_partitionSums[p] = m_partitionSums[2 * p] + m_partitionSums[2 * p + 1];
+                }
+            }
+            uint8_t parameters[size_t(1) << Flac::kMaxPartitionOrder];
+            uint64_t bits = 0;
+            uint32_t largest = 0;
+            for (size_t p = 0; p < partitions; p++) {
+                const uint64_t count = (n >> partitionOrder) - (p == 0 ? order : 0);
+                const uint64_t sum = m_partitionSums[p];
+                uint32_t k = 0;
+                while (k < 30 && (count << (k + 1)) < sum) {
+                    k++;
+                }
+                parameters[p] = static_cast<uint8_t>(k);
+                largest = (std::max)(largest, k);
+                bits += count * (k + 1) + (sum >> k);
+            }
+            const bool rice2 = largest > 14;
+            bits += 6 + partitions * (rice2 ? 5 : 4);
+            if (bits < bestBits) {
+                bestBits = bits;
+                plan.partitionOrder = static_cast<uint32_t>(partitionOrder);
+                plan.rice2 = rice2;
+                std::copy(parameters, parameters + partitions, plan.parameters);
+            }
+        }
+        return bestBits;
+    }
+
+    void WriteFrameHeader(Flac::BitWriter& bits, size_t frames, uint64_t frameNumber, uint32_t assignment) const {
+        uint32_t blockCode = frames <= 256 ? 6 : 7;
+        if (frames == 192) {
+            blockCode = 1;
+        } else {
+            for (uint32_t code = 2; code <= 5; code++) {
+                if (frames == (576u << (code - 2))) {
+                    blockCode = code;
+                }
+            }
+            for (uint32_t code = 8; code <= 15; code++) {
+                if (frames == (256u << (code - 8))) {
+                    blockCode = code;
+                }
+            }
+        }
+
+        static const uint32_t kRates[] = { 0, 88200, 176400, 192000, 8000, 16000, 22050, 24000, 32000, 44100, 48000, 96000 };
+        uint32_t rateCode = 0;
+        for (uint32_t code = 1; code < 12; code++) {
+            if (kRates[code] == m_config.sampleRate) {
+                rateCode = code;
+            }
+        }
+
+        uint32_t sizeCode = 0;
+        switch (m_config.bitsPerSample) {
+        case 8: sizeCode = 1; break;
+        case 12: sizeCode = 2; break;
+        case 16: sizeCode = 4; break;
+        case 20: sizeCode = 5; break;
+        case 24: sizeCode = 6; break;
+        default: break;
+        }
+
+        bits.Write(0x3FFE, 14);
+        bits.Write(0, 1);
+        bits.Write(0, 1);                           // Fixed block size: frames are numbered
+        bits.Write(blockCode, 4);
+        bits.Write(rateCode, 4);
+        bits.Write(assignment, 4);
+        bits.Write(sizeCode, 3);
+        bits.Write(0, 1);
+
+        // The frame number, coded like UTF-8 extended to 36 bits
+        if (frameNumber < 0x80) {
+            bits.Write(static_cast<uint32_t>(frameNumber), 8);
+        } else {
+            int continuation = 1;
+            while (continuation < 6 && frameNumber >= (uint64_t(1) << (5 * continuation + 6))) {
+                continuation++;
+            }
+            const uint32_t lead = (0xFF00u >> (continuation + 1)) & 0xFF;
+            bits.Write(lead | static_cast<uint32_t>(frameNumber >> (6 * continuation)), 8);
+            for (int i = continuation - 1; i >= 0; i--) {
+                bits.Write(0x80 | static_cast<uint32_t>((frameNumber >> (6 * i)) & 0x3F), 8);
+            }
+        }
+
+        if (blockCode == 6) {
+            bits.Write(static_cast<uint32_t>(frames - 1), 8);
+        } else if (blockCode == 7) {
+            bits.Write(static_cast<uint32_t>(frames - 1), 16);
+        }
+    }
+
+    void WriteSubframe(Flac::BitWriter& bits, int s, size_t n) const {
+        const SubframePlan& plan = m_plans[s];
+        const int32_t* samples = m_sources[s].data();
+        const uint32_t wasted = plan.wastedBits;
+        auto sample = [samples, wasted](size_t i) { return samples[i] >> wasted; };
+
+        // Zero pad bit, six type bits, then the wasted bits flag and count
+        uint32_t header = 0;
+        switch (plan.type) {
+        case SubframeType::Constant: header = 0x00; break;
+        case SubframeType::Verbatim: header = 0x02; break;
+        case SubframeType::Fixed: header = 0x10 | (plan.order << 1); break;
+        case SubframeType::Lpc: header = 0x40 | ((plan.order - 1) << 1); break;
+        }
+        bits.Write(header | (wasted > 0 ? 1 : 0), 8);
+        if (wasted > 0) {
+            bits.WriteUnary(wasted - 1);
+        }
+
+        switch (plan.type) {
+        case SubframeType::Constant:
+            bits.WriteSigned(sample(0), plan.bps);
+            return;
+        case SubframeType::Verbatim:
+            for (size_t i = 0; i < n; i++) {
+                bits.WriteSigned(sample(i), plan.bps);
+            }
+            return;
+        case SubframeType::Fixed:
+        case SubframeType::Lpc:
+            break;
+        }
+
+        for (uint32_t i = 0; i < plan.order; i++) {
+            bits.WriteSigned(sample(i), plan.bps);
+        }
+        if (plan.type == SubframeType::Lpc) {
+            bits.Write(plan.precision - 1, 4);
+            bits.WriteSigned(plan.shift, 5);
+            for (uint32_t j = 0; j < plan.order; j++) {
+                bits.WriteSigned(plan.coefficients[j], plan.precision);
+            }
+        }
+
+        const int32_t* residual = m_residuals[s].data();
+        bits.Write(plan.rice2 ? 1 : 0, 2);
+        bits.Write(plan.partitionOrder, 4);
+        const size_t partitions = size_t(1) << plan.partitionOrder;
+        const size_t partitionSize = n >> plan.partitionOrder;
+        for (size_t p = 0; p < partitions; p++) {
+            const unsigned k = plan.parameters[p];
+            bits.Write(k, plan.rice2 ? 5 : 4);
+            const size_t start = p == 0 ? plan.order : p * partitionSize;
+            const size_t end = (p + 1) * partitionSize;
+            for (size_t i = start; i < end; i++) {
+                bits.WriteRice(Flac::ZigZag(residual[i]), k);
+            }
+        }
+    }
+
+    FlacEncoderConfig m_config;
+    uint32_t m_lpcOrder;
+    uint32_t m_precision;                           // Bits per quantised LPC coefficient
+    std::vector<std::vector<int32_t>> m_sources;    // Per channel; left, right, mid, side for stereo
+    std::vector<std::vector<int32_t>> m_residuals;  // Of each source's chosen subframe
+    std::vector<SubframePlan> m_plans;
+    std::vector<int32_t> m_trial;                   // Residual being evaluated
+    std::vector<int32_t> m_shifted;                 // Source without its wasted bits
+    std::vector<double> m_window;
+    std::vector<double> m_windowed;
+    size_t m_windowFrames = 0;                      // Length m_window was built for
+    std::vector<uint64_t> m_partitionSums;
+    double m_lpcCoefficients[Flac::kMaxLpcOrder][Flac::kMaxLpcOrder] = {};
+};
+
+struct FlacFrameSizes {
+    uint32_t minBytes = UINT32_MAX;
+    uint32_t maxBytes = 0;
+
+    void Add(size_t bytes) {
+        minBytes = (std::min)(minBytes, static_cast<uint32_t>(bytes));
+        maxBytes = (std::max)(maxBytes, static_cast<uint32_t>(bytes));
+    }
+    void Add(const FlacFrameSizes& other) {
+        minBytes = (std::min)(minBytes, other.minBytes);
+        maxBytes = (std::max)(maxBytes, other.maxBytes);
+    }
+    // For STREAMINFO, where 0 means unknown
+    uint32_t Min() const { return maxBytes ? minBytes : 0; }
+};
+
+// Appends the frames for `frames` interleaved frames, the first of them
+// block number `firstBlock`, to `out`. All blocks but the stream's last must
+// be whole. Blocks are spread over `threads` (0 = one per core), each
+// encoding a run of consecutive blocks into its own buffer, so the output is
+// the same for any thread count. Throws std::bad_alloc.
+inline void EncodeFlacBlocks(const int32_t* samples, uint64_t frames, uint64_t firstBlock, const FlacEncoderConfig& config,
+                             unsigned threads, std::vector<uint8_t>& out, FlacFrameSizes& sizes) {
+    const uint64_t blocks = (frames + config.blockSize - 1) / config.blockSize;
+    if (threads == 0) {
+        threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+    }
+    threads = static_cast<unsigned>((std::max<uint64_t>)((std::min<uint64_t>)(threads, blocks), 1));
+
+    struct Run {
+        std::vector<uint8_t> bytes;
+        FlacFrameSizes sizes;
+    };
+    std::vector<Run> runs(threads);
+    auto encodeRun = [&](unsigned t) {
+        FlacFrameEncoder encoder(config);
+        Run& run = runs[t];
+        const uint64_t first = blocks * t / threads;
+        const uint64_t last = blocks * (t + 1) / threads;
+        run.bytes.resize((last - first) * encoder.MaxFrameBytes());
+        size_t used = 0;
+        for (uint64_t block = first; block < last; block++) {
+            const uint64_t start = block * config.blockSize;
+            const size_t count = static_cast<size_t>((std::min<uint64_t>)(config.blockSize, frames - start));
+            const size_t bytes = encoder.EncodeFrame(samples + start * config.channels, count, firstBlock + block,
+                                                     run.bytes.data() + used);
+            used += bytes;
+            run.sizes.Add(bytes);
+        }
+        run.bytes.resize(used);
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; t++) {
+        workers.emplace_back(encodeRun, t);
+    }
+    encodeRun(0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for (const Run& run : runs) {
+        out.insert(out.end(), run.bytes.begin(), run.bytes.end());
+        sizes.Add(run.sizes);
+    }
+}
+
+// Encodes a whole recording, `frames` interleaved frames, as a FLAC stream
+// on `threads` threads (0 = one per core). Throws std::bad_alloc.
+inline std::vector<uint8_t> EncodeFlac(const int32_t* samples, uint64_t frames, const FlacEncoderConfig& config,
+                                       unsigned threads = 0) {
+    std::vector<uint8_t> out(Flac::kStreamHeaderBytes);
+    FlacFrameSizes sizes;
+    EncodeFlacBlocks(samples, frames, 0, config, threads, out, sizes);
+    Flac::WriteStreamHeader(out.data(), config, frames, sizes.Min(), sizes.maxBytes);
+    return out;
+}
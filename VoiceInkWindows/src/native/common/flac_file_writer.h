@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "flac_encoder.h"
+#include "flac_reader.h"
+#include "recording_file_writer.h"
+
+// Writes a recording as FLAC, compressing on the writer thread.
+//
+// Whole blocks are encoded as they arrive and gathered into kWriteBytes
+// writes; every flush also brings STREAMINFO's sample count and frame
+// sizes up to date. Each frame carries its own CRCs, so a process that
+// dies mid-recording leaves every complete frame decodable, and Recover()
+// cuts the file back to them.
+class FlacFileWriter : public RecordingFileWriter {
+public:
+    static constexpr uint32_t kBlockSize = 4096;
+    static constexpr size_t kWriteBytes = 256 * 1024;
+
+    ~FlacFileWriter() override { Close(); }
+
+    // Cuts a FLAC file whose writer never finished back to its last intact
+    // frame and sets STREAMINFO's sample count to match. Returns the bytes
+    // of 16- or 24-bit PCM the kept frames decode to.
+    static bool Recover(const std::string& path, uint64_t& dataBytes, std::string& error) {
+        FlacReader reader;
+        if (!reader.Open(path, error)) {
+            return false;
+        }
+        std::vector<int32_t> scratch(static_cast<size_t>(kBlockSize) * reader.Format().channels);
+        while (reader.ReadSamples(scratch.data(), kBlockSize) > 0) {
+        }
+        const uint64_t frames = reader.Position();
+        const uint64_t goodEnd = reader.GoodEnd();
+        dataBytes = frames * reader.Format().BytesPerFrame();
+
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        uint8_t info[kStreamInfoFieldsBytes];
+        if (!file.seekg(kStreamInfoOffset) || !file.read(reinterpret_cast<char*>(info), sizeof(info))) {
+            error = "Cannot read " + path;
+            return false;
+        }
+        // Frame sizes become unknown rather than possibly wrong
+        std::memset(info + 4, 0, 6);
+        info[13] = static_cast<uint8_t>((info[13] & 0xF0) | ((frames >> 32) & 0xF));
+        for (int i = 0; i < 4; i++) {
+            info[14 + i] = static_cast<uint8_t>(frames >> (24 - 8 * i));
+        }
+        file.seekp(kStreamInfoOffset);
+        file.write(reinterpret_cast<const char*>(info), sizeof(info));
+        file.close();
+        if (!file) {
+            error = "Cannot write to " + path;
+            return false;
+        }
+
+        std::error_code ec;
+        if (std::filesystem::file_size(path, ec) > goodEnd) {
+            std::filesystem::resize_file(path, goodEnd, ec);
+        }
+        return true;
+    }
+
+protected:
+    bool Begin(const RecordingFileFormat& format, std::string& error) override {
+        if ((format.encoding != SampleEncoding::Int16 && format.encoding != SampleEncoding::Int24) || format.channels > 8) {
+            error = "FLAC recordings store 16- or 24-bit PCM, up to 8 channels";
+            return false;
+        }
+        m_config = FlacEncoderConfig{};
+        m_config.sampleRate = format.sampleRate;
+        m_config.channels = format.channels;
+        m_config.bitsPerSample = format.encoding == SampleEncoding::Int16 ? 16 : 24;
+        m_config.blockSize = kBlockSize;
+        if (!m_config.Valid()) {
+            error = "Unsupported FLAC format";
+            return false;
+        }
+        m_encoder = std::make_unique<FlacFrameEncoder>(m_config);
+        m_bytesPerFrame = format.BytesPerFrame();
+        m_pcm.assign(kBlockSize * m_bytesPerFrame, 0);
+        m_samples.assign(static_cast<size_t>(kBlockSize) * format.channels, 0);
+        m_staging.assign(kWriteBytes + m_encoder->MaxFrameBytes(), 0);
+        m_pcmFill = 0;
+        m_fill = 0;
+        m_pendingFrames = 0;
+        m_framesWritten = 0;
+        m_blocksEncoded = 0;
+        m_frameSizes = FlacFrameSizes();
+        m_headerFrames = 0;
+        return WriteHeader();
+    }
+
+    bool Drain(bool due) override {
+        for (;;) {
+            m_pcmFill += ReadSource(m_pcm.data() + m_pcmFill, m_pcm.size() - m_pcmFill);
+            if (m_pcmFill < m_pcm.size()) {
+                break;
+            }
+            if (!EncodeBlock(kBlockSize)) {
+                return false;
+            }
+        }
+        if (due) {
+            if (!Flush()) {
+                return false;
+            }
+            if (m_framesWritten != m_headerFrames) {
+                return WriteHeader();
+            }
+        }
+        return true;
+    }
+
+    bool Finish() override {
+        do {
+            if (!Drain(false)) {
+                return false;
+            }
+        } while (SourceAvailable() > 0);
+        // The last block may be short
+        if (m_pcmFill >= m_bytesPerFrame && !EncodeBlock(static_cast<uint32_t>(m_pcmFill / m_bytesPerFrame))) {
+            return false;
+        }
+        return Flush() && WriteHeader();
+    }
+
+private:
+    static constexpr uint64_t kStreamInfoOffset = 8;        // After "fLaC" and the block header
+    static constexpr size_t kStreamInfoFieldsBytes = 18;    // Block sizes through the sample count
+
+    bool EncodeBlock(uint32_t frames) {
+        const size_t count = static_cast<size_t>(frames) * m_config.channels;
+        const uint8_t* pcm = m_pcm.data();
+        if (m_config.bitsPerSample == 16) {
+            for (size_t i = 0; i < count; i++) {
+                m_samples[i] = static_cast<int16_t>(pcm[i * 2] | (pcm[i * 2 + 1] << 8));
+            }
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                m_samples[i] = SampleKernels::LoadInt24(pcm + i * 3);
+            }
+        }
+        const size_t bytes = m_encoder->EncodeFrame(m_samples.data(), frames, m_blocksEncoded, m_staging.data() + m_fill);
+        m_fill += bytes;
+        m_blocksEncoded++;
+        m_pendingFrames += frames;
+        m_frameSizes.Add(bytes);
+        // Whatever is left of a short block has been encoded
+        m_pcmFill -= (std::min)(m_pcmFill, static_cast<size_t>(frames) * m_bytesPerFrame);
+        return m_fill <= kWriteBytes || Flush();
+    }
+
+    bool Flush() {
+        if (m_fill > 0 && !Append(m_staging.data(), m_fill)) {
+            return false;
+        }
+        m_fill = 0;
+        m_framesWritten += m_pendingFrames;
+        m_pendingFrames = 0;
+        return true;
+    }
+
+    bool WriteHeader() {
+        uint8_t header[Flac::kStreamHeaderBytes];
+        Flac::WriteStreamHeader(header, m_config, m_framesWritten, m_frameSizes.Min(), m_frameSizes.maxBytes);
+        if (!Overwrite(0, header, sizeof(header))) {
+            return false;
+        }
+        m_headerFrames = m_framesWritten;
+        CountHeaderUpdate();
+        return true;
+    }
+
+    FlacEncoderConfig m_config;
+    std::unique_ptr<FlacFrameEncoder> m_encoder;
+    size_t m_bytesPerFrame = 0;
+    std::vector<uint8_t> m_pcm;                      // Writer thread: the block being gathered
+    size_t m_pcmFill = 0;
+    std::vector<int32_t> m_samples;
+    std::vector<uint8_t> m_staging;                  // Encoded frames waiting for a write
+    size_t m_fill = 0;
+    uint64_t m_blocksEncoded = 0;
+    uint64_t m_pendingFrames = 0;                    // Encoded into m_staging
+    uint64_t m_framesWritten = 0;                    // On disk
+    uint64_t m_headerFrames = 0;                     // As STREAMINFO last said
+    FlacFrameSizes m_frameSizes;
+};
@@ -0,0 +1,524 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "flac_encoder.h"
+#include "sample_format_converter.h"
+
+// Decodes a FLAC file frame by frame, with the same interface as WavReader.
+//
+// Handles every subframe type and stereo mode of fixed or variable block
+// size streams up to 24 bits, which covers what FlacFrameEncoder and common
+// encoders write. Samples come out as 16-bit PCM for streams of 16 bits or
+// fewer and packed 24-bit otherwise, shifted up to fill the container.
+// Every frame's CRCs are checked; reading stops at the first damaged or
+// truncated frame, and GoodEnd() says where the intact audio ends.
+//
+// All buffers are allocated by Open(), so reading does not allocate.
+class FlacReader {
+public:
+    bool Open(const std::string& path, std::string& error) {
+        m_file.close();
+        m_file.clear();
+        m_file.open(path, std::ios::binary);
+        if (!m_file) {
+            error = "Cannot open " + path;
+            return false;
+        }
+
+        uint8_t magic[4];
+        if (!m_file.read(reinterpret_cast<char*>(magic), sizeof(magic)) || std::memcmp(magic, "fLaC", 4) != 0) {
+            error = "Not a FLAC file: " + path;
+            return false;
+        }
+
+        bool haveInfo = false;
+        for (bool last = false; !last;) {
+            uint8_t header[4];
+            if (!m_file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+                error = "Truncated FLAC metadata in " + path;
+                return false;
+            }
+            last = (header[0] & 0x80) != 0;
+            const uint32_t length = (uint32_t(header[1]) << 16) | (uint32_t(header[2]) << 8) | header[3];
+            if ((header[0] & 0x7F) == 0) {
+                uint8_t info[34];
+                if (length < sizeof(info) || !m_file.read(reinterpret_cast<char*>(info), sizeof(info))) {
+                    error = "Truncated STREAMINFO in " + path;
+                    return false;
+                }
+                m_file.seekg(length - sizeof(info), std::ios::cur);
+                m_maxBlockSize = (uint32_t(info[2]) << 8) | info[3];
+                m_sampleRate = (uint32_t(info[10]) << 12) | (uint32_t(info[11]) << 4) | (info[12] >> 4);
+                m_channels = ((info[12] >> 1) & 0x7) + 1u;
+                m_bitsPerSample = (((info[12] & 1) << 4) | (info[13] >> 4)) + 1u;
+                m_frameCount = (uint64_t(info[13] & 0xF) << 32) | (uint64_t(info[14]) << 24) | (uint64_t(info[15]) << 16) |
+                               (uint64_t(info[16]) << 8) | info[17];
+                haveInfo = true;
+            } else {
+                m_file.seekg(length, std::ios::cur);
+            }
+        }
+        if (!haveInfo) {
+            error = "No STREAMINFO in " + path;
+            return false;
+        }
+        if (m_bitsPerSample < 4 || m_bitsPerSample > 24 || m_maxBlockSize < 16 || m_sampleRate == 0) {
+            error = "Unsupported FLAC stream: " + std::to_string(m_bitsPerSample) + " bits, blocks of " +
+                    std::to_string(m_maxBlockSize);
+            return false;
+        }
+        m_format = SampleFormat{ m_bitsPerSample <= 16 ? SampleEncoding::Int16 : SampleEncoding::Int24,
+                                 static_cast<uint16_t>(m_channels) };
+        m_containerShift = (m_bitsPerSample <= 16 ? 16 : 24) - m_bitsPerSample;
+        m_audioStart = m_file.tellg();
+
+        try {
+            // Nothing a valid encoder writes exceeds verbatim subframes with a bit to spare
+            m_frameBound = 32 + m_channels * ((m_maxBlockSize * (m_bitsPerSample + 1u) + 7) / 8 + 8);
+            m_buffer.assign((std::max)(m_frameBound * 2, kMinBufferBytes), 0);
+            m_subframes.assign(m_channels, std::vector<int32_t>(m_maxBlockSize));
+            m_block.assign(static_cast<size_t>(m_maxBlockSize) * m_channels, 0);
+        } catch (const std::bad_alloc&) {
+            error = "Failed to allocate the FLAC decoder";
+            return false;
+        }
+        return Rewind();
+    }
+
+    const SampleFormat& Format() const { return m_format; }
+    uint32_t SampleRate() const { return m_sampleRate; }
+    uint32_t BitsPerSample() const { return m_bitsPerSample; }
+    // As STREAMINFO says; 0 if the encoder did not know
+    uint64_t FrameCount() const { return m_frameCount; }
+    uint64_t Position() const { return m_position; }
+    // A frame failed its checks, as opposed to the file ending cleanly
+    bool Damaged() const { return m_damaged; }
+    // File offset just past the last frame decoded intact
+    uint64_t GoodEnd() const { return m_goodEnd; }
+
+    // Reads up to `frames` frames into `dst` in Format(); returns the number
+    // read, 0 at the end or at a damaged frame
+    size_t ReadFrames(uint8_t* dst, size_t frames) {
+        const bool packed24 = m_format.encoding == SampleEncoding::Int24;
+        const size_t bytesPerSample = packed24 ? 3 : 2;
+        const unsigned shift = m_containerShift;
+        return Read(frames, [&](const int32_t* samples, size_t count, size_t offset) {
+            uint8_t* out = dst + offset * m_channels * bytesPerSample;
+            for (size_t i = 0; i < count * m_channels; i++) {
+                const int32_t sample = static_cast<int32_t>(static_cast<uint32_t>(samples[i]) << shift);
+                out[i * bytesPerSample] = static_cast<uint8_t>(sample);
+                out[i * bytesPerSample + 1] = static_cast<uint8_t>(sample >> 8);
+                if (packed24) {
+                    out[i * bytesPerSample + 2] = static_cast<uint8_t>(sample >> 16);
+                }
+            }
+        });
+    }
+
+    // As ReadFrames(), as interleaved integers at the stream's own bit depth
+    size_t ReadSamples(int32_t* dst, size_t frames) {
+        return Read(frames, [&](const int32_t* samples, size_t count, size_t offset) {
+            std::copy(samples, samples + count * m_channels, dst + offset * m_channels);
+        });
+    }
+
+    bool Rewind() {
+        m_file.clear();
+        m_file.seekg(m_audioStart);
+        m_bufferStart = static_cast<uint64_t>(m_audioStart);
+        m_head = 0;
+        m_tail = 0;
+        m_endOfFile = false;
+        m_damaged = false;
+        m_goodEnd = m_bufferStart;
+        m_position = 0;
+        m_blockFrames = 0;
+        m_blockOffset = 0;
+        return static_cast<bool>(m_file);
+    }
+
+private:
+    static constexpr size_t kMinBufferBytes = 1 << 20;
+
+    // MSB-first reads from a byte range; reading past it sets Overrun()
+    class BitReader {
+    public:
+        BitReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+        // `count` up to 32
+        uint32_t Read(unsigned count) {
+            if (count == 0) {
+                return 0;
+            }
+            while (m_bits < count) {
+                if (m_next == m_size) {
+                    m_overrun = true;
+                    return 0;
+                }
+                m_cache = (m_cache << 8) | m_data[m_next++];
+                m_bits += 8;
+            }
+            m_bits -= count;
+            return static_cast<uint32_t>(m_cache >> m_bits) & (0xFFFFFFFFu >> (32 - count));
+        }
+        int32_t ReadSigned(unsigned count) {
+            if (count == 0) {
+                return 0;
+            }
+            const uint32_t value = Read(count);
+            const uint32_t sign = 1u << (count - 1);
+            return static_cast<int32_t>((value ^ sign) - sign);
+        }
+        uint32_t ReadUnary() {
+            uint32_t zeros = 0;
+            for (;;) {
+                while (m_bits <= 56 && m_next < m_size) {
+                    m_cache = (m_cache << 8) | m_data[m_next++];
+                    m_bits += 8;
+                }
+                if (m_bits == 0) {
+                    m_overrun = true;
+                    return 0;
+                }
+                const uint64_t window = m_cache & (~uint64_t(0) >> (64 - m_bits));
+                if (window == 0) {
+                    zeros += m_bits;
+                    m_bits = 0;
+                    continue;
+                }
+                const unsigned leading = m_bits - 1 - HighestBit(window);
+                zeros += leading;
+                m_bits -= leading + 1;
+                return zeros;
+            }
+        }
+        int32_t ReadRice(unsigned parameter) {
+            const uint32_t quotient = ReadUnary();
+            const uint32_t folded = (quotient << parameter) | Read(parameter);
+            return static_cast<int32_t>(folded >> 1) ^ -static_cast<int32_t>(folded & 1);
+        }
+        void AlignToByte() { m_bits -= m_bits % 8; }
+        // Whole bytes consumed; only meaningful when aligned
+        size_t Bytes() const { return m_next - m_bits / 8; }
+        bool Overrun() const { return m_overrun; }
+
+    private:
+        static unsigned HighestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+            return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+            unsigned bit = 0;
+            for (unsigned step = 32; step > 0; step /= 2) {
+                if (value >> step) {
+                    value >>= step;
+                    bit += step;
+                }
+            }
+            return bit;
+#endif
+        }
+
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_next = 0;
+        uint64_t m_cache = 0;
+        unsigned m_bits = 0;
+        bool m_overrun = false;
+    };
+
+    template <typename Sink>
+    size_t Read(size_t frames, Sink&& sink) {
+        size_t done = 0;
+        while (done < frames) {
+            if (m_blockOffset == m_blockFrames && !DecodeFrame()) {
+                break;
+            }
+            const size_t count = (std::min)(frames - done, m_blockFrames - m_blockOffset);
+            sink(m_block.data() + m_blockOffset * m_channels, count, done);
+            m_blockOffset += count;
+            done += count;
+        }
+        m_position += done;
+        return done;
+    }
+
+    // Keeps at least one frame's worth of bytes buffered unless the file ends
+    void Refill() {
+        if (m_tail - m_head >= m_frameBound || m_endOfFile) {
+            return;
+        }
+        std::memmove(m_buffer.data(), m_buffer.data() + m_head, m_tail - m_head);
+        m_bufferStart += m_head;
+        m_tail -= m_head;
+        m_head = 0;
+        m_file.read(reinterpret_cast<char*>(m_buffer.data() + m_tail), static_cast<std::streamsize>(m_buffer.size() - m_tail));
+        m_tail += static_cast<size_t>(m_file.gcount());
+        if (!m_file) {
+            m_endOfFile = true;
+        }
+    }
+
+    bool DecodeFrame() {
+        if (m_damaged) {
+            return false;
+        }
+        Refill();
+        if (m_head == m_tail) {
+            return false;
+        }
+        const uint8_t* frame = m_buffer.data() + m_head;
+        BitReader bits(frame, m_tail - m_head);
+        if (!DecodeFrameBody(bits)) {
+            m_damaged = true;
+            return false;
+        }
+        m_head += bits.Bytes();
+        m_goodEnd = m_bufferStart + m_head;
+        m_blockOffset = 0;
+        return true;
+    }
+
+    bool DecodeFrameBody(BitReader& bits) {
+        const uint8_t* frame = m_buffer.data() + m_head;
+        if (bits.Read(14) != 0x3FFE || bits.Read(1) != 0) {
+            return false;
+        }
+        bits.Read(1);                               // Blocking strategy: the header says the size either way
+        const uint32_t blockCode = bits.Read(4);
+        const uint32_t rateCode = bits.Read(4);
+        const uint32_t assignment = bits.Read(4);
+        const uint32_t sizeCode = bits.Read(3);
+        if (bits.Read(1) != 0 || blockCode == 0 || rateCode == 15 || sizeCode == 3) {
+            return false;
+        }
+
+        // Frame or sample number, coded like UTF-8
+        const uint32_t lead = bits.Read(8);
+        unsigned continuation = 0;
+        while (continuation < 8 && (lead & (0x80u >> continuation))) {
+            continuation++;
+        }
+        if (continuation == 1 || continuation == 8) {
+            return false;
+        }
+        for (unsigned i = 1; i < continuation; i++) {
+            if ((bits.Read(8) & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+
+        uint32_t frames = 0;
+        if (blockCode == 1) {
+            frames = 192;
+        } else if (blockCode <= 5) {
+            frames = 576u << (blockCode - 2);
+        } else if (blockCode == 6) {
+            frames = bits.Read(8) + 1;
+        } else if (blockCode == 7) {
+            frames = bits.Read(16) + 1;
+        } else {
+            frames = 256u << (blockCode - 8);
+        }
+        if (rateCode == 12) {
+            bits.Read(8);
+        } else if (rateCode == 13 || rateCode == 14) {
+            bits.Read(16);
+        }
+        static const uint32_t kSampleSizes[] = { 0, 8, 12, 0, 16, 20, 24, 32 };
+        const uint32_t bps = sizeCode == 0 ? m_bitsPerSample : kSampleSizes[sizeCode];
+        const uint32_t channels = assignment < 8 ? assignment + 1 : 2;
+        if (bits.Overrun() || frames > m_maxBlockSize || bps != m_bitsPerSample || channels != m_channels || assignment > 10) {
+            return false;
+        }
+        const size_t headerBytes = bits.Bytes();
+        if (bits.Read(8) != Flac::Crc8(frame, headerBytes)) {
+            return false;
+        }
+
+        for (uint32_t c = 0; c < channels; c++) {
+            const bool side = (assignment == 8 && c == 1) || (assignment == 9 && c == 0) || (assignment == 10 && c == 1);
+            if (!DecodeSubframe(bits, m_subframes[c].data(), frames, side ? bps + 1 : bps)) {
+                return false;
+            }
+        }
+        bits.AlignToByte();
+        const size_t bodyBytes = bits.Bytes();
+        if (bits.Read(16) != Flac::Crc16(frame, bodyBytes) || bits.Overrun()) {
+            return false;
+        }
+
+        int32_t* out = m_block.data();
+        const int32_t* first = m_subframes[0].data();
+        const int32_t* second = channels == 2 ? m_subframes[1].data() : nullptr;
+        for (uint32_t i = 0; i < frames; i++) {
+            switch (assignment) {
+            case 8:                                 // Left, side
+                out[2 * i] = first[i];
+                out[2 * i + 1] = first[i] - second[i];
+                break;
+            case 9:                                 // Side, right
+                out[2 * i] = first[i] + second[i];
+                out[2 * i + 1] = second[i];
+                break;
+            case 10: {                              // Mid, side
+                const int32_t mid = static_cast<int32_t>(static_cast<uint32_t>(first[i]) << 1) | (second[i] & 1);
+                out[2 * i] = (mid + second[i]) >> 1;
+                out[2 * i + 1] = (mid - second[i]) >> 1;
+                break;
+            }
+            default:
+                for (uint32_t c = 0; c < channels; c++) {
+                    out[i * channels + c] = m_subframes[c][i];
+                }
+                break;
+            }
+        }
+        m_blockFrames = frames;
+        return true;
+    }
+
+    bool DecodeSubframe(BitReader& bits, int32_t* out, uint32_t n, uint32_t bps) {
+        if (bits.Read(1) != 0) {
+            return false;
+        }
+        const uint32_t type = bits.Read(6);
+        uint32_t wasted = 0;
+        if (bits.Read(1)) {
+            wasted = bits.ReadUnary() + 1;
+            if (wasted >= bps) {
+                return false;
+            }
+            bps -= wasted;
+        }
+
+        if (type == 0) {
+            const int32_t value = bits.ReadSigned(bps);
+            std::fill(out, out + n, value);
+        } else if (type == 1) {
+            for (uint32_t i = 0; i < n; i++) {
+                out[i] = bits.ReadSigned(bps);
+            }
+        } else if (type >= 8 && type <= 12) {
+            const uint32_t order = type - 8;
+            if (order > n) {
+                return false;
+            }
+            for (uint32_t i = 0; i < order; i++) {
+                out[i] = bits.ReadSigned(bps);
+            }
+            if (!DecodeResidual(bits, out, n, order)) {
+                return false;
+            }
+            for (uint32_t i = order; i < n; i++) {
+                switch (order) {
+                case 1: out[i] += out[i - 1]; break;
+                case 2: out[i] += 2 * out[i - 1] - out[i - 2]; break;
+                case 3: out[i] += 3 * out[i - 1] - 3 * out[i - 2] + out[i - 3]; break;
+                case 4: out[i] += 4 * out[i - 1] - 6 * out[i - 2] + 4 * out[i - 3] - out[i - 4]; break;
+                default: break;
+                }
+            }
+        } else if (type >= 32) {
+            const uint32_t order = type - 31;
+            if (order > n) {
+                return false;
+            }
+            for (uint32_t i = 0; i < order; i++) {
+                out[i] = bits.ReadSigned(bps);
+            }
+            const uint32_t precision = bits.Read(4) + 1;
+            const int32_t shift = bits.ReadSigned(5);
+            if (precision == 16 || shift < 0) {
+                return false;
+            }
+            int32_t coefficients[Flac::kMaxLpcOrder];
+            for (uint32_t j = 0; j < order; j++) {
+                coefficients[j] = bits.ReadSigned(precision);
+            }
+            if (!DecodeResidual(bits, out, n, order)) {
+                return false;
+            }
+            for (uint32_t i = order; i < n; i++) {
+                int64_t prediction = 0;
+                for (uint32_t j = 0; j < order; j++) {
+                    prediction += static_cast<int64_t>(coefficients[j]) * out[i - 1 - j];
+                }
+                out[i] += static_cast<int32_t>(prediction >> shift);
+            }
+        } else {
+            return false;
+        }
+
+        if (wasted > 0) {
+            for (uint32_t i = 0; i < n; i++) {
+                out[i] = static_cast<int32_t>(static_cast<uint32_t>(out[i]) << wasted);
+            }
+        }
+        return !bits.Overrun();
+    }
+
+    // Rice coded residual into out[order, n)
+    static bool DecodeResidual(BitReader& bits, int32_t* out, uint32_t n, uint32_t order) {
+        const uint32_t method = bits.Read(2);
+        if (method > 1) {
+            return false;
+        }
+        const unsigned parameterBits = method == 0 ? 4 : 5;
+        const uint32_t escape = method == 0 ? 15 : 31;
+        const uint32_t partitionOrder = bits.Read(4);
+        const uint32_t partitionSize = n >> partitionOrder;
+        if ((partitionSize << partitionOrder) != n || partitionSize < order) {
+            return false;
+        }
+        uint32_t i = order;
+        for (uint32_t p = 0; p < (1u << partitionOrder); p++) {
+            const uint32_t end = (p + 1) * partitionSize;
+            const uint32_t parameter = bits.Read(parameterBits);
+            if (parameter == escape) {
+                const uint32_t rawBits = bits.Read(5);
+                for (; i < end; i++) {
+                    out[i] = bits.ReadSigned(rawBits);
+                }
+            } else {
+                for (; i < end; i++) {
+                    out[i] = bits.ReadRice(parameter);
+                }
+            }
+            if (bits.Overrun()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::ifstream m_file;
+    SampleFormat m_format;
+    uint32_t m_sampleRate = 0;
+    uint32_t m_channels = 0;
+    uint32_t m_bitsPerSample = 0;
+    uint32_t m_maxBlockSize = 0;
+    unsigned m_containerShift = 0;                  // From the stream's bit depth to Format()'s
+    uint64_t m_frameCount = 0;
+    uint64_t m_position = 0;
+    std::streamoff m_audioStart = 0;
+
+    std::vector<uint8_t> m_buffer;                  // File bytes [m_bufferStart, m_bufferStart + m_tail)
+    size_t m_frameBound = 0;
+    uint64_t m_bufferStart = 0;
+    size_t m_head = 0;
+    size_t m_tail = 0;
+    bool m_endOfFile = false;
+    bool m_damaged = false;
+    uint64_t m_goodEnd = 0;
+
+    std::vector<std::vector<int32_t>> m_subframes;
+    std::vector<int32_t> m_block;                   // The last frame decoded, interleaved
+    size_t m_blockFrames = 0;
+    size_t m_blockOffset = 0;
+};
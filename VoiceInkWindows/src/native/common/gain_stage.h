@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VOICEINK_GAIN_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VOICEINK_GAIN_NEON 1
+#endif
+
+// Tuning for GainStage. Levels are dBFS, gains dB.
+struct GainStageConfig {
+    uint32_t sampleRate = 16000;
+    float targetDb = -18.0f;            // AGC: RMS level it steers towards
+    float maxGainDb = 12.0f;
+    float minGainDb = -20.0f;
+    float gateDb = -50.0f;              // AGC holds its gain below this level
+    uint32_t attackMs = 20;             // Level detector rise...
+    uint32_t releaseMs = 400;           // ...and fall
+    float ceilingDb = -1.0f;            // Limiter: no output peak above this
+    uint32_t lookAheadMs = 5;
+    uint32_t limiterReleaseMs = 80;
+};
+
+// Manual gain, automatic gain control and a look-ahead peak limiter in one
+// pass over interleaved float audio.
+//
+// Audio moves through in blocks of kBlockFrames. As a block comes in, its
+// peak sets the largest gain it can take without passing the ceiling, and
+// its power adds to the AGC's level, which is read every kAgcPeriodMs and
+// smoothed with attack/release in dB (so the recovery after a loud passage
+// is a steady rate rather than a slow exponential). Blocks wait out the
+// look-ahead before they are played out, so the gain for each block is
+// already below the limit of every block in the window ahead of it. The gain
+// is then interpolated sample by sample from the previous block's, so
+// neither AGC nor limiter steps are audible and no sample passes the ceiling.
+// The oldest block is played out with that gain in the same pass that
+// stores the incoming samples over it and measures them.
+//
+// Output lags the input by LatencyFrames(). Everything is allocated in the
+// constructor; Process() is real-time safe. One thread at a time.
+class GainStage {
+public:
+    static constexpr size_t kBlockFrames = 32;
+    static constexpr uint32_t kAgcPeriodMs = 10;
+
+    // Throws std::bad_alloc
+    GainStage(const GainStageConfig& config, uint32_t channels)
+        : m_config(config)
+        , m_channels((std::max<uint32_t>)(channels, 1))
+        , m_blockSamples(kBlockFrames * m_channels)
+        , m_lookAheadBlocks((std::max<size_t>)(
+              (static_cast<size_t>(config.lookAheadMs) * config.sampleRate / 1000 + kBlockFrames - 1) / kBlockFrames, 1))
+        , m_slots(m_lookAheadBlocks + 1)
+        , m_agcPeriodBlocks((std::max<size_t>)(static_cast<size_t>(kAgcPeriodMs) * config.sampleRate / 1000 / kBlockFrames, 1))
+        , m_attack(Coefficient(config.attackMs, m_agcPeriodBlocks))
+        , m_release(Coefficient(config.releaseMs, m_agcPeriodBlocks))
+        , m_limiterRelease(Coefficient(config.limiterReleaseMs, 1))
+        , m_ceiling(DbToGain(config.ceilingDb))
+        , m_blocks(m_slots * m_blockSamples)
+        , m_limits(m_slots)
+        , m_ramp(m_blockSamples) {
+        for (size_t i = 0; i < m_blockSamples; i++) {
+            m_ramp[i] = static_cast<float>(i / m_channels + 1) / static_cast<float>(kBlockFrames);
+        }
+        Reset();
+    }
+
+    const GainStageConfig& Config() const { return m_config; }
+    uint32_t Channels() const { return m_channels; }
+    size_t LatencyFrames() const { return m_slots * kBlockFrames; }
+
+    // Either may change at any time; the gain glides to the new setting
+    void SetGain(float gain) { m_manualGain = (std::max)(gain, 0.0f); }
+    void SetAgcEnabled(bool enabled) { m_agcEnabled = enabled; }
+    // Current AGC gain, linear; 1 while AGC is off
+    float AgcGain() const { return m_agcEnabled ? m_agcGain : 1.0f; }
+
+    void Reset() {
+        std::fill(m_blocks.begin(), m_blocks.end(), 0.0f);
+        std::fill(m_limits.begin(), m_limits.end(), kNoLimit);
+        m_fill = 0;
+        m_newest = 0;
+        m_blockPeak = 0.0f;
+        m_blockSquares = 0.0f;
+        m_levelDb = m_config.targetDb;
+        m_periodPower = 0.0f;
+        m_periodBlocks = 0;
+        m_agcGain = 1.0f;
+        m_gain = (std::min)(m_manualGain, 1.0f);
+        m_rampFrom = m_gain;
+    }
+
+    // Processes `frameCount` interleaved frames in place, delayed by LatencyFrames()
+    void Process(float* samples, size_t frameCount) {
+        size_t offset = 0;
+        const size_t total = frameCount * m_channels;
+        while (offset < total) {
+            // The block being collected takes the slot of the block being played
+            const size_t count = (std::min)(m_blockSamples - m_fill, total - offset);
+            PlayOut(samples + offset, m_blocks.data() + m_newest * m_blockSamples + m_fill, m_fill, count);
+            offset += count;
+            m_fill += count;
+            if (m_fill == m_blockSamples) {
+                ProcessBlock();
+                m_fill = 0;
+            }
+        }
+    }
+
+private:
+    static constexpr float kNoLimit = (std::numeric_limits<float>::max)();
+
+    static float DbToGain(float db) { return std::pow(10.0f, db / 20.0f); }
+
+    // One-pole smoothing per update, every `blocks` blocks, for a time
+    // constant in milliseconds
+    float Coefficient(uint32_t ms, size_t blocks) const {
+        const double updates = static_cast<double>(ms) * m_config.sampleRate / 1000.0 / kBlockFrames / blocks;
+        return updates <= 1.0 ? 1.0f : static_cast<float>(1.0 - std::exp(-1.0 / updates));
+    }
+
+    void ProcessBlock() {
+        m_limits[m_newest] = m_blockPeak > 0.0f ? m_ceiling / m_blockPeak : kNoLimit;
+        if (m_agcEnabled) {
+            UpdateAgc(m_blockSquares / static_cast<float>(m_blockSamples));
+        }
+        m_blockPeak = 0.0f;
+        m_blockSquares = 0.0f;
+
+        // The oldest block plays out next. Its gain stays under the limit of
+        // every block still ahead of it, so the ramp into the next block's
+        // gain cannot overshoot either.
+        const size_t oldest = (m_newest + 1) % m_slots;
+        float limit = kNoLimit;
+        for (float blockLimit : m_limits) {
+            limit = (std::min)(limit, blockLimit);
+        }
+        const float desired = (std::min)(m_manualGain * AgcGain(), limit);
+        m_rampFrom = m_gain;
+        m_gain = desired < m_gain ? desired : m_gain + (desired - m_gain) * m_limiterRelease;
+        m_newest = oldest;
+    }
+
+    void UpdateAgc(float power) {
+        m_periodPower += power;
+        if (++m_periodBlocks < m_agcPeriodBlocks) {
+            return;
+        }
+        const float levelDb = 10.0f * std::log10((std::max)(m_periodPower / m_periodBlocks, 1e-12f));
+        m_periodPower = 0.0f;
+        m_periodBlocks = 0;
+
+        // Hold through pauses instead of pulling the noise floor up
+        if (levelDb < m_config.gateDb) {
+            return;
+        }
+        m_levelDb += (levelDb - m_levelDb) * (levelDb > m_levelDb ? m_attack : m_release);
+        const float gainDb = (std::max)(m_config.minGainDb, (std::min)(m_config.maxGainDb, m_config.targetDb - m_levelDb));
+        m_agcGain = DbToGain(gainDb);
+    }
+
+    // Swaps `count` samples of `io` with `slot`, which starts `first`
+    // samples into the block being played: `io` gets the played samples
+    // times the gain moving linearly from m_rampFrom (exclusive) to m_gain
+    // over the block, and `slot` the incoming ones. The incoming samples'
+    // peak and sum of squares are added to the block's.
+    void PlayOut(float* io, float* slot, size_t first, size_t count) {
+        const float from = m_rampFrom;
+        const float delta = m_gain - from;
+        const float* ramp = m_ramp.data() + first;
+        float peak = m_blockPeak;
+        float squares = m_blockSquares;
+        size_t i = 0;
+#if defined(VOICEINK_GAIN_SSE2)
+        if (i + 4 <= count) {
+            const __m128 base = _mm_set1_ps(from);
+            const __m128 slope = _mm_set1_ps(delta);
+            const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+            __m128 peaks = _mm_setzero_ps();
+            __m128 sums = _mm_setzero_ps();
+            for (; i + 4 <= count; i += 4) {
+                const __m128 gain = _mm_add_ps(base, _mm_mul_ps(slope, _mm_loadu_ps(ramp + i)));
+                const __m128 incoming = _mm_loadu_ps(io + i);
+                _mm_storeu_ps(io + i, _mm_mul_ps(_mm_loadu_ps(slot + i), gain));
+                _mm_storeu_ps(slot + i, incoming);
+                peaks = _mm_max_ps(peaks, _mm_and_ps(incoming, absMask));
+                sums = _mm_add_ps(sums, _mm_mul_ps(incoming, incoming));
+            }
+            float lanes[4];
+            _mm_storeu_ps(lanes, peaks);
+            peak = (std::max)((std::max)(peak, (std::max)(lanes[0], lanes[1])), (std::max)(lanes[2], lanes[3]));
+            _mm_storeu_ps(lanes, sums);
+            squares += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        }
+#elif defined(VOICEINK_GAIN_NEON)
+        if (i + 4 <= count) {
+            const float32x4_t base = vdupq_n_f32(from);
+            float32x4_t peaks = vdupq_n_f32(0.0f);
+            float32x4_t sums = vdupq_n_f32(0.0f);
+            for (; i + 4 <= count; i += 4) {
+                const float32x4_t gain = vmlaq_n_f32(base, vld1q_f32(ramp + i), delta);
+                const float32x4_t incoming = vld1q_f32(io + i);
+                vst1q_f32(io + i, vmulq_f32(vld1q_f32(slot + i), gain));
+                vst1q_f32(slot + i, incoming);
+                peaks = vmaxq_f32(peaks, vabsq_f32(incoming));
+                sums = vmlaq_f32(sums, incoming, incoming);
+            }
+            float lanes[4];
+            vst1q_f32(lanes, peaks);
+            peak = (std::max)((std::max)(peak, (std::max)(lanes[0], lanes[1])), (std::max)(lanes[2], lanes[3]));
+            vst1q_f32(lanes, sums);
+            squares += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        }
+#endif
+        for (; i < count; i++) {
+            const float incoming = io[i];
+            io[i] = slot[i] * (from + delta * ramp[i]);
+            slot[i] = incoming;
+            peak = (std::max)(peak, std::abs(incoming));
+            squares += incoming * incoming;
+        }
+        m_blockPeak = peak;
+        m_blockSquares = squares;
+    }
+
+    const GainStageConfig m_config;
+    const uint32_t m_channels;
+    const size_t m_blockSamples;
+    const size_t m_lookAheadBlocks;
+    const size_t m_slots;                    // Look-ahead blocks plus the one collecting
+    const size_t m_agcPeriodBlocks;
+    const float m_attack;
+    const float m_release;
+    const float m_limiterRelease;
+    const float m_ceiling;
+
+    std::vector<float> m_blocks;             // m_slots blocks of input, a ring
+    std::vector<float> m_limits;             // Largest gain each block can take
+    std::vector<float> m_ramp;               // (frame + 1) / kBlockFrames per sample
+    size_t m_fill;                           // Samples of the newest block collected
+    size_t m_newest;                         // Slot being collected
+    float m_blockPeak;                       // Its peak and sum of squares so far
+    float m_blockSquares;
+
+    float m_manualGain = 1.0f;
+    bool m_agcEnabled = false;
+    float m_levelDb;                         // Detector output
+    float m_periodPower;                     // Sum of block mean squares this period
+    size_t m_periodBlocks;
+    float m_agcGain;
+    float m_gain;                            // Gain at the end of the block being played
+    float m_rampFrom;                        // ...and at the end of the one before
+};
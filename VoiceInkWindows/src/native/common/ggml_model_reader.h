@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Progress of a model load, reported from the loading thread.
+struct ModelLoadProgress {
+    enum Stage { MAPPING, TENSORS, WARMUP, READY };
+
+    Stage stage = MAPPING;
+    uint64_t bytesMapped = 0;
+    uint64_t totalBytes = 0;
+    uint32_t tensorsInitialized = 0;
+    uint32_t totalTensors = 0;   // 0 when the file layout could not be scanned
+
+    static const char* StageName(Stage stage) {
+        switch (stage) {
+            case MAPPING: return "mapping";
+            case TENSORS: return "tensors";
+            case WARMUP: return "warmup";
+            case READY: return "ready";
+        }
+        return "mapping";
+    }
+};
+
+using ModelLoadProgressCallback = std::function<void(const ModelLoadProgress&)>;
+
+// Streams a whisper.cpp GGML model file to the model loader and turns its
+// reads into progress events.
+//
+// Open() walks the file once, reading only headers and seeking past tensor
+// data, to find where each tensor ends. As the loader then reads the file
+// front to back, every read advances bytesMapped and every tensor boundary
+// crossed advances tensorsInitialized. If the layout is not recognized
+// (unknown tensor type, mock model file) only byte progress is reported.
+//
+// A cancelled reader returns short reads and reports EOF, which makes the
+// loader fail cleanly; callers check Cancelled() to tell the two apart.
+class GgmlModelReader {
+public:
+    bool Open(const std::string& path, std::string& error) {
+        m_file.open(path, std::ios::binary);
+        if (!m_file.is_open()) {
+            error = "Model file not found: " + path;
+            return false;
+        }
+
+        m_file.seekg(0, std::ios::end);
+        m_progress.totalBytes = static_cast<uint64_t>(m_file.tellg());
+        m_file.seekg(0, std::ios::beg);
+
+        if (!ScanLayout()) {
+            m_tensorEnds.clear();
+            m_firstTensorOffset = 0;
+        }
+        m_progress.totalTensors = static_cast<uint32_t>(m_tensorEnds.size());
+        m_file.clear();
+        m_file.seekg(0, std::ios::beg);
+        m_position = 0;
+        return true;
+    }
+
+    void SetProgressCallback(ModelLoadProgressCallback callback) { m_onProgress = std::move(callback); }
+    void SetCancelCheck(std::function<bool()> cancelled) { m_cancelCheck = std::move(cancelled); }
+
+    size_t Read(void* output, size_t size) {
+        if (IsCancelled()) {
+            return 0;
+        }
+        if (!m_started) {
+            m_started = true;
+            Emit(); // MAPPING at zero bytes, so every load reports each stage
+        }
+        m_file.read(static_cast<char*>(output), static_cast<std::streamsize>(size));
+        const size_t got = static_cast<size_t>(m_file.gcount());
+        Advance(got);
+        return got;
+    }
+
+    bool Eof() {
+        return IsCancelled() || m_position >= m_progress.totalBytes;
+    }
+
+    void Close() { m_file.close(); }
+
+    // Reads the remainder of the file, for loaders that do not stream it
+    // themselves. Returns false if cancelled.
+    bool Drain() {
+        std::vector<char> chunk(1024 * 1024);
+        while (!Eof()) {
+            if (Read(chunk.data(), chunk.size()) == 0) {
+                break;
+            }
+        }
+        return !IsCancelled();
+    }
+
+    bool Cancelled() const { return m_cancelled; }
+    const ModelLoadProgress& Progress() const { return m_progress; }
+
+    // Reports a stage that happens after the file has been consumed.
+    void ReportStage(ModelLoadProgress::Stage stage) {
+        m_progress.stage = stage;
+        Emit();
+    }
+
+private:
+    bool IsCancelled() {
+        if (!m_cancelled && m_cancelCheck && m_cancelCheck()) {
+            m_cancelled = true;
+        }
+        return m_cancelled;
+    }
+
+    void Advance(size_t bytes) {
+        m_position += bytes;
+        m_progress.bytesMapped = m_position;
+
+        while (m_nextTensor < m_tensorEnds.size() && m_position >= m_tensorEnds[m_nextTensor]) {
+            m_nextTensor++;
+        }
+        m_progress.tensorsInitialized = static_cast<uint32_t>(m_nextTensor);
+
+        const ModelLoadProgress::Stage stage =
+            (m_firstTensorOffset > 0 && m_position > m_firstTensorOffset) ? ModelLoadProgress::TENSORS
+                                                                           : ModelLoadProgress::MAPPING;
+
+        // At most ~200 events per load, plus one per stage change
+        const uint64_t step = (std::max<uint64_t>)(m_progress.totalBytes / 200, 1);
+        if (stage != m_progress.stage || m_position >= m_lastReported + step || m_position >= m_progress.totalBytes) {
+            m_progress.stage = stage;
+            m_lastReported = m_position;
+            Emit();
+        }
+    }
+
+    void Emit() {
+        if (m_onProgress) {
+            m_onProgress(m_progress);
+        }
+    }
+
+    template <typename T>
+    bool ReadValue(T& value) {
+        m_file.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return m_file.gcount() == static_cast<std::streamsize>(sizeof(T));
+    }
+
+    bool Skip(uint64_t bytes) {
+        m_file.seekg(static_cast<std::streamoff>(bytes), std::ios::cur);
+        return static_cast<bool>(m_file);
+    }
+
+    // Bytes per block and elements per block of a ggml tensor type
+    static bool TypeSize(int32_t type, uint64_t& blockBytes, uint64_t& blockElements) {
+        switch (type) {
+            case 0:  blockBytes = 4;   blockElements = 1;   return true; // F32
+            case 1:  blockBytes = 2;   blockElements = 1;   return true; // F16
+            case 2:  blockBytes = 18;  blockElements = 32;  return true; // Q4_0
+            case 3:  blockBytes = 20;  blockElements = 32;  return true; // Q4_1
+            case 6:  blockBytes = 22;  blockElements = 32;  return true; // Q5_0
+            case 7:  blockBytes = 24;  blockElements = 32;  return true; // Q5_1
+            case 8:  blockBytes = 34;  blockElements = 32;  return true; // Q8_0
+            case 10: blockBytes = 84;  blockElements = 256; return true; // Q2_K
+            case 11: blockBytes = 110; blockElements = 256; return true; // Q3_K
+            case 12: blockBytes = 144; blockElements = 256; return true; // Q4_K
+            case 13: blockBytes = 176; blockElements = 256; return true; // Q5_K
+            case 14: blockBytes = 210; blockElements = 256; return true; // Q6_K
+            default: return false;
+        }
+    }
+
+    // whisper.cpp GGML layout: magic, 11 int32 hparams, mel filters, vocab,
+    // then tensors of { n_dims, name_len, type, ne[n_dims], name, data }.
+    bool ScanLayout() {
+        uint32_t magic = 0;
+        if (!ReadValue(magic) || magic != 0x67676d6c) {
+            return false;
+        }
+
+        int32_t hparams[11];
+        for (int32_t& value : hparams) {
+            if (!ReadValue(value)) {
+                return false;
+            }
+        }
+
+        int32_t melCount = 0;
+        int32_t fftCount = 0;
+        if (!ReadValue(melCount) || !ReadValue(fftCount) || melCount < 0 || fftCount < 0 ||
+            !Skip(static_cast<uint64_t>(melCount) * static_cast<uint64_t>(fftCount) * sizeof(float))) {
+            return false;
+        }
+
+        int32_t vocabCount = 0;
+        if (!ReadValue(vocabCount) || vocabCount < 0) {
+            return false;
+        }
+        for (int32_t i = 0; i < vocabCount; ++i) {
+            uint32_t length = 0;
+            if (!ReadValue(length) || !Skip(length)) {
+                return false;
+            }
+        }
+
+        m_firstTensorOffset = static_cast<uint64_t>(m_file.tellg());
+        uint64_t offset = m_firstTensorOffset;
+        while (offset < m_progress.totalBytes) {
+            int32_t dims = 0;
+            int32_t nameLength = 0;
+            int32_t type = 0;
+            if (!ReadValue(dims) || !ReadValue(nameLength) || !ReadValue(type) ||
+                dims < 1 || dims > 4 || nameLength < 0) {
+                return false;
+            }
+
+            uint64_t elements = 1;
+            for (int32_t d = 0; d < dims; ++d) {
+                int32_t extent = 0;
+                if (!ReadValue(extent) || extent < 0) {
+                    return false;
+                }
+                elements *= static_cast<uint64_t>(extent);
+            }
+
+            uint64_t blockBytes = 0;
+            uint64_t blockElements = 0;
+            if (!TypeSize(type, blockBytes, blockElements)) {
+                return false;
+            }
+            const uint64_t dataBytes = (elements / blockElements) * blockBytes;
+            if (!Skip(static_cast<uint64_t>(nameLength) + dataBytes)) {
+                return false;
+            }
+
+            offset = static_cast<uint64_t>(m_file.tellg());
+            if (offset > m_progress.totalBytes) {
+                return false;
+            }
+            m_tensorEnds.push_back(offset);
+        }
+        return !m_tensorEnds.empty();
+    }
+
+    std::ifstream m_file;
+    uint64_t m_position = 0;
+    uint64_t m_lastReported = 0;
+    uint64_t m_firstTensorOffset = 0;
+    std::vector<uint64_t> m_tensorEnds;
+    size_t m_nextTensor = 0;
+    bool m_started = false;
+    bool m_cancelled = false;
+    ModelLoadProgress m_progress;
+    ModelLoadProgressCallback m_onProgress;
+    std::function<bool()> m_cancelCheck;
+};
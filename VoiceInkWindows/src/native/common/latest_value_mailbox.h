@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// Single-slot mailbox that always holds the most recently published value.
+//
+// Triple-buffered: the producer writes into a private back slot and swaps it
+// with the shared middle slot in one atomic exchange, so Publish() never
+// blocks and never waits for readers. Readers swap the middle slot into their
+// front slot when it is fresh. Intermediate values that nobody read are simply
+// overwritten; that is the point. Readers serialize among themselves with a
+// mutex the producer never touches.
+template <typename T>
+class LatestValueMailbox {
+public:
+    LatestValueMailbox() = default;
+    LatestValueMailbox(const LatestValueMailbox&) = delete;
+    LatestValueMailbox& operator=(const LatestValueMailbox&) = delete;
+
+    // Producer thread only.
+    void Publish(const T& value) {
+        m_slots[m_back] = value;
+        const uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | kFreshBit), std::memory_order_acq_rel);
+        m_back = previous & kIndexMask;
+    }
+
+    // Copies the latest value into `out`. Returns true if it was published
+    // since the previous Read(); `out` is still filled with the last known
+    // value (or a default T) otherwise.
+    bool Read(T& out) {
+        std::lock_guard<std::mutex> lock(m_readMutex);
+
+        bool fresh = false;
+        if (m_middle.load(std::memory_order_relaxed) & kFreshBit) {
+            const uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+            m_front = previous & kIndexMask;
+            fresh = true;
+        }
+
+        out = m_slots[m_front];
+        return fresh;
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFreshBit = 0x4;
+
+    T m_slots[3] = {};
+    uint8_t m_back = 0;                       // Owned by the producer
+    alignas(64) std::atomic<uint8_t> m_middle{ 1 };
+    alignas(64) uint8_t m_front = 2;          // Owned by readers, under m_readMutex
+    std::mutex m_readMutex;
+};
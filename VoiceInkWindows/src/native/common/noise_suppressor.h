@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "stft.h"
+
+// Tuning for NoiseSuppressor
+struct NoiseSuppressorConfig {
+    uint32_t sampleRate = 16000;
+    uint32_t hopMs = 10;                // Frames are two hops long and overlap by half
+    float maxAttenuationDb = 18.0f;     // Gain floor; deeper cuts cause musical noise
+    uint32_t noiseWindowMs = 1500;      // Minimum search window; must span speech pauses
+    float noiseBias = 1.5f;             // Minimum of the smoothed power to mean noise power
+    float snrSmoothing = 0.98f;         // Decision-directed weight of the previous frame
+};
+
+// Spectral noise suppression for interleaved float audio.
+//
+// Each channel runs through a StftProcessor with square-root Hann frames at
+// 50% overlap. Each channel tracks its noise spectrum by minimum statistics
+// (the minimum of the smoothed power over the last `noiseWindowMs`, which
+// follows slowly changing noise through speech) and applies a Wiener gain
+// driven by the decision-directed a priori SNR, which keeps the residual
+// noise free of isolated tonal bursts.
+//
+// Output lags the input by LatencyFrames(). Everything is allocated in the
+// constructor; Process() is real-time safe. One thread at a time.
+class NoiseSuppressor {
+public:
+    // Throws std::bad_alloc
+    NoiseSuppressor(const NoiseSuppressorConfig& config, uint32_t channels)
+        : m_config(config)
+        , m_channels((std::max<uint32_t>)(channels, 1))
+        , m_hop((std::max<size_t>)(static_cast<size_t>(config.sampleRate) * config.hopMs / 1000, 2))
+        , m_gainFloor(std::pow(10.0f, -(std::max)(config.maxAttenuationDb, 0.0f) / 20.0f)) {
+        // The window is split into subwindows so the minimum can slide in steps
+        const size_t windowHops = (std::max<size_t>)(
+            static_cast<size_t>(config.noiseWindowMs) * config.sampleRate / 1000 / m_hop, kSubwindows);
+        m_subwindowHops = windowHops / kSubwindows;
+
+        m_state.reserve(m_channels);
+        for (uint32_t c = 0; c < m_channels; c++) {
+            m_state.emplace_back(2 * m_hop, m_hop);
+        }
+        Reset();
+    }
+
+    const NoiseSuppressorConfig& Config() const { return m_config; }
+    uint32_t Channels() const { return m_channels; }
+    size_t HopFrames() const { return m_hop; }
+    size_t LatencyFrames() const { return m_state[0].stft.LatencyFrames(); }
+
+    // Forgets the signal and the noise estimate
+    void Reset() {
+        for (ChannelState& state : m_state) {
+            state.stft.Reset();
+            std::fill(state.runningMin.begin(), state.runningMin.end(), kUnset);
+            std::fill(state.subwindowMins.begin(), state.subwindowMins.end(), kUnset);
+            std::fill(state.cleanPower.begin(), state.cleanPower.end(), 0.0f);
+            state.framesSeen = 0;
+            state.subwindow = 0;
+            state.subwindowFill = 0;
+        }
+    }
+
+    // Denoises `frameCount` interleaved frames in place, delayed by LatencyFrames()
+    void Process(float* samples, size_t frameCount) {
+        for (uint32_t c = 0; c < m_channels; c++) {
+            ChannelState& state = m_state[c];
+            state.stft.Process(samples + c, frameCount, m_channels, [this, &state](StftProcessor::Complex* spectrum, size_t bins) {
+                UpdateNoiseEstimate(state, spectrum, bins);
+                ApplyGains(state, spectrum, bins);
+                state.framesSeen++;
+            });
+        }
+    }
+
+private:
+    static constexpr size_t kSubwindows = 8;
+    static constexpr float kPowerSmoothing = 0.85f;
+    static constexpr float kUnset = (std::numeric_limits<float>::max)();
+    static constexpr float kMinPower = 1e-12f;
+
+    struct ChannelState {
+        ChannelState(size_t frameSize, size_t hop)
+            : stft(frameSize, hop)
+            , smoothedPower(stft.Bins())
+            , runningMin(stft.Bins())
+            , subwindowMins(kSubwindows * stft.Bins())
+            , windowMin(stft.Bins())
+            , cleanPower(stft.Bins()) {}
+
+        StftProcessor stft;
+        std::vector<float> smoothedPower;
+        std::vector<float> runningMin;      // Minimum over the current subwindow
+        std::vector<float> subwindowMins;   // kSubwindows rows of bins
+        std::vector<float> windowMin;       // Minimum over the finished subwindows
+        std::vector<float> cleanPower;      // Estimated speech power of the previous frame
+        uint64_t framesSeen = 0;
+        size_t subwindow = 0;
+        size_t subwindowFill = 0;
+    };
+
+    void UpdateNoiseEstimate(ChannelState& state, const StftProcessor::Complex* spectrum, size_t bins) {
+        const bool first = state.framesSeen == 0;
+        for (size_t k = 0; k < bins; k++) {
+            const float power = std::norm(spectrum[k]);
+            float& smoothed = state.smoothedPower[k];
+            smoothed = first ? power : kPowerSmoothing * smoothed + (1.0f - kPowerSmoothing) * power;
+            state.runningMin[k] = (std::min)(state.runningMin[k], smoothed);
+        }
+        if (first) {
+            // Until a subwindow has finished, the noise is what came first
+            std::copy(state.smoothedPower.begin(), state.smoothedPower.end(), state.windowMin.begin());
+        }
+
+        if (++state.subwindowFill < m_subwindowHops) {
+            return;
+        }
+        state.subwindowFill = 0;
+        float* row = state.subwindowMins.data() + state.subwindow * bins;
+        std::copy(state.runningMin.begin(), state.runningMin.end(), row);
+        std::fill(state.runningMin.begin(), state.runningMin.end(), kUnset);
+        state.subwindow = (state.subwindow + 1) % kSubwindows;
+
+        for (size_t k = 0; k < bins; k++) {
+            float minimum = kUnset;
+            for (size_t s = 0; s < kSubwindows; s++) {
+                minimum = (std::min)(minimum, state.subwindowMins[s * bins + k]);
+            }
+            state.windowMin[k] = minimum;
+        }
+    }
+
+    void ApplyGains(ChannelState& state, StftProcessor::Complex* spectrum, size_t bins) {
+        const float weight = m_config.snrSmoothing;
+        const float floor = m_gainFloor;
+        const float minPrioriSnr = floor * floor;
+        for (size_t k = 0; k < bins; k++) {
+            const float noise = m_config.noiseBias * (std::max)((std::min)(state.windowMin[k], state.runningMin[k]), kMinPower);
+            const float power = std::norm(spectrum[k]);
+            const float posterioriSnr = power / noise;
+
+            // Decision-directed: mostly the previous frame's speech estimate,
+            // so the gain cannot follow random peaks in the noise
+            float prioriSnr = weight * state.cleanPower[k] / noise + (1.0f - weight) * (std::max)(posterioriSnr - 1.0f, 0.0f);
+            prioriSnr = (std::max)(prioriSnr, minPrioriSnr);
+
+            const float gain = (std::max)(prioriSnr / (1.0f + prioriSnr), floor);
+            spectrum[k] *= gain;
+            state.cleanPower[k] = gain * gain * power;
+        }
+    }
+
+    const NoiseSuppressorConfig m_config;
+    const uint32_t m_channels;
+    const size_t m_hop;
+    const float m_gainFloor;
+    size_t m_subwindowHops;
+    std::vector<ChannelState> m_state;
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VOICEINK_STATS_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VOICEINK_STATS_NEON 1
+#endif
+
+// What one pass over a packet of interleaved samples yields. Everything that
+// reads a packet's level (meter, VAD, AGC, the recorder's level callback)
+// takes it from here rather than scanning the samples again.
+struct PacketStatistics {
+    size_t sampleCount = 0;             // All channels
+    size_t channels = 1;
+    float sumSquares = 0.0f;
+    float sum = 0.0f;
+    float peak = 0.0f;                  // Absolute
+    uint32_t zeroCrossings = 0;         // Sign changes between consecutive frames of each channel
+
+    float Rms() const {
+        return sampleCount ? std::sqrt(sumSquares / static_cast<float>(sampleCount)) : 0.0f;
+    }
+    float DcOffset() const {
+        return sampleCount ? sum / static_cast<float>(sampleCount) : 0.0f;
+    }
+    // Crossings per pair of consecutive samples of a channel, 0 to 1
+    float ZeroCrossingRate() const {
+        return sampleCount > channels
+            ? static_cast<float>(zeroCrossings) / static_cast<float>(sampleCount - channels) : 0.0f;
+    }
+};
+
+// Sum of squares, sum, peak and zero crossings in one SSE2 or NEON pass.
+//
+// A sample is compared with the one a frame before it (`channels` samples
+// back), so any channel count vectorises without de-interleaving. Crossings
+// are counted within the packet; the first frame has nothing to cross from.
+// Int16 input is accumulated unscaled and the totals scaled to [-1, 1) at
+// the end, as SampleConverter would scale the samples.
+namespace PacketKernels {
+
+constexpr float kInt16Scale = 1.0f / 32768.0f;
+
+inline float ToFloat(float sample) { return sample; }
+inline float ToFloat(int16_t sample) { return static_cast<float>(sample); }
+inline float Scale(const float*) { return 1.0f; }
+inline float Scale(const int16_t*) { return kInt16Scale; }
+
+#if defined(VOICEINK_STATS_SSE2)
+inline __m128 Load4(const float* p) { return _mm_loadu_ps(p); }
+inline __m128 Load4(const int16_t* p) {
+    const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    // Sign-extend by placing each sample in the high half and shifting back
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16));
+}
+#elif defined(VOICEINK_STATS_NEON)
+inline float32x4_t Load4(const float* p) { return vld1q_f32(p); }
+inline float32x4_t Load4(const int16_t* p) { return vcvtq_f32_s32(vmovl_s16(vld1_s16(p))); }
+#endif
+
+template <typename Sample>
+PacketStatistics Measure(const Sample* samples, size_t frameCount, size_t channels) {
+    PacketStatistics stats;
+    stats.channels = (std::max<size_t>)(channels, 1);
+    stats.sampleCount = samples ? frameCount * stats.channels : 0;
+    const size_t count = stats.sampleCount;
+    const size_t stride = stats.channels;
+
+    float sumSquares = 0.0f;
+    float sum = 0.0f;
+    float peak = 0.0f;
+    uint32_t crossings = 0;
+    size_t i = 0;
+    for (; i < (std::min)(stride, count); i++) {
+        const float x = ToFloat(samples[i]);
+        sumSquares += x * x;
+        sum += x;
+        peak = (std::max)(peak, std::abs(x));
+    }
+
+#if defined(VOICEINK_STATS_SSE2)
+    if (i + 4 <= count) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+        // Two sets of accumulators, so consecutive adds do not wait on each other
+        __m128 squares[2] = { zero, zero };
+        __m128 sums[2] = { zero, zero };
+        __m128 peaks[2] = { zero, zero };
+        __m128i flips = _mm_setzero_si128();
+        auto accumulate = [&](size_t at, int set) {
+            const __m128 x = Load4(samples + at);
+            const __m128 previous = Load4(samples + at - stride);
+            squares[set] = _mm_add_ps(squares[set], _mm_mul_ps(x, x));
+            sums[set] = _mm_add_ps(sums[set], x);
+            peaks[set] = _mm_max_ps(peaks[set], _mm_and_ps(x, absMask));
+            // All ones where the sign differs, which is -1 as an integer
+            const __m128 flipped = _mm_xor_ps(_mm_cmpge_ps(x, zero), _mm_cmpge_ps(previous, zero));
+            flips = _mm_sub_epi32(flips, _mm_castps_si128(flipped));
+        };
+        for (; i + 8 <= count; i += 8) {
+            accumulate(i, 0);
+            accumulate(i + 4, 1);
+        }
+        if (i + 4 <= count) {
+            accumulate(i, 0);
+            i += 4;
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, _mm_add_ps(squares[0], squares[1]));
+        sumSquares += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        _mm_storeu_ps(lanes, _mm_add_ps(sums[0], sums[1]));
+        sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        _mm_storeu_ps(lanes, _mm_max_ps(peaks[0], peaks[1]));
+        peak = (std::max)((std::max)(peak, (std::max)(lanes[0], lanes[1])), (std::max)(lanes[2], lanes[3]));
+        uint32_t counts[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(counts), flips);
+        crossings += counts[0] + counts[1] + counts[2] + counts[3];
+    }
+#elif defined(VOICEINK_STATS_NEON)
+    if (i + 4 <= count) {
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        float32x4_t squares[2] = { zero, zero };
+        float32x4_t sums[2] = { zero, zero };
+        float32x4_t peaks[2] = { zero, zero };
+        uint32x4_t flips = vdupq_n_u32(0);
+        auto accumulate = [&](size_t at, int set) {
+            const float32x4_t x = Load4(samples + at);
+            const float32x4_t previous = Load4(samples + at - stride);
+            squares[set] = vmlaq_f32(squares[set], x, x);
+            sums[set] = vaddq_f32(sums[set], x);
+            peaks[set] = vmaxq_f32(peaks[set], vabsq_f32(x));
+            flips = vsubq_u32(flips, veorq_u32(vcgeq_f32(x, zero), vcgeq_f32(previous, zero)));
+        };
+        for (; i + 8 <= count; i += 8) {
+            accumulate(i, 0);
+            accumulate(i + 4, 1);
+        }
+        if (i + 4 <= count) {
+            accumulate(i, 0);
+            i += 4;
+        }
+        float lanes[4];
+        vst1q_f32(lanes, vaddq_f32(squares[0], squares[1]));
+        sumSquares += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        vst1q_f32(lanes, vaddq_f32(sums[0], sums[1]));
+        sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        vst1q_f32(lanes, vmaxq_f32(peaks[0], peaks[1]));
+        peak = (std::max)((std::max)(peak, (std::max)(lanes[0], lanes[1])), (std::max)(lanes[2], lanes[3]));
+        uint32_t counts[4];
+        vst1q_u32(counts, flips);
+        crossings += counts[0] + counts[1] + counts[2] + counts[3];
+    }
+#endif
+
+    for (; i < count; i++) {
+        const float x = ToFloat(samples[i]);
+        const float previous = ToFloat(samples[i - stride]);
+        sumSquares += x * x;
+        sum += x;
+        peak = (std::max)(peak, std::abs(x));
+        crossings += (x >= 0.0f) != (previous >= 0.0f) ? 1 : 0;
+    }
+
+    const float scale = Scale(samples);
+    stats.sumSquares = sumSquares * scale * scale;
+    stats.sum = sum * scale;
+    stats.peak = peak * scale;
+    stats.zeroCrossings = crossings;
+    return stats;
+}
+
+} // namespace PacketKernels
+
+inline PacketStatistics MeasurePacket(const float* samples, size_t frameCount, size_t channels) {
+    return PacketKernels::Measure(samples, frameCount, channels);
+}
+
+inline PacketStatistics MeasurePacket(const int16_t* samples, size_t frameCount, size_t channels) {
+    return PacketKernels::Measure(samples, frameCount, channels);
+}
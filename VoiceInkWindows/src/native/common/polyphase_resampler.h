@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+// Streaming rational-ratio resampler for mono float audio.
+//
+// The rate ratio is reduced to L/M (e.g. 48 kHz -> 16 kHz is 1/3, 44.1 kHz
+// -> 16 kHz is 160/441). A Kaiser-windowed sinc low-pass is designed once at
+// L times the input rate and split into L phases of K taps; each output
+// sample is one K-tap dot product over contiguous input, with no
+// zero-stuffing and no work for discarded samples. The pass band reaches
+// `passband` of the lower Nyquist frequency and the stop band starts at that
+// Nyquist frequency with about 80 dB of attenuation.
+//
+// All memory is allocated in the constructor; Process() never allocates, so
+// it can run on the capture thread. State carries across calls, so a
+// stream split into packets of any size resamples exactly like one call.
+class PolyphaseResampler {
+public:
+    // Input is consumed in slices of this many samples
+    static constexpr size_t kSliceFrames = 1024;
+
+    PolyphaseResampler(uint32_t inputRate, uint32_t outputRate, float passband = 0.9f, float attenuationDb = 80.0f) {
+        // A zero rate cannot be resampled; it passes through like equal rates
+        const uint32_t divisor = inputRate && outputRate ? std::gcd(inputRate, outputRate) : 0;
+        m_up = divisor ? outputRate / divisor : 1;
+        m_down = divisor ? inputRate / divisor : 1;
+        m_taps = 1;
+        if (m_up == m_down) {
+            m_history.assign(kSliceFrames, 0.0f);
+            return;
+        }
+
+        // Band edges relative to the prototype rate, L * inputRate
+        const double prototypeRate = static_cast<double>(inputRate) * m_up;
+        const double nyquist = 0.5 * (std::min)(inputRate, outputRate);
+        const double passEdge = passband * nyquist / prototypeRate;
+        const double stopEdge = nyquist / prototypeRate;
+        const double cutoff = 0.5 * (passEdge + stopEdge);
+
+        // Kaiser's estimates for the window length and shape
+        const double transition = 2.0 * kPi * (stopEdge - passEdge);
+        const double beta = attenuationDb > 50.0 ? 0.1102 * (attenuationDb - 8.7)
+                                                 : 0.5842 * std::pow(attenuationDb - 21.0, 0.4) + 0.07886 * (attenuationDb - 21.0);
+        const size_t length = static_cast<size_t>(std::ceil((attenuationDb - 8.0) / (2.285 * transition))) + 1;
+        m_taps = (length + m_up - 1) / m_up;
+
+        // Phase p holds prototype taps p, p + L, p + 2L, ..., stored reversed
+        // so the dot product walks the input forwards. The prototype has odd
+        // length, zero-padded if needed, so its delay is a whole sample.
+        const size_t total = m_taps * m_up;
+        const size_t designed = total % 2 ? total : total - 1;
+        m_delay = (designed - 1) / 2;
+        const double center = static_cast<double>(m_delay);
+        const double i0Beta = BesselI0(beta);
+        m_coefficients.assign(total, 0.0f);
+        for (size_t n = 0; n < designed; ++n) {
+            const double t = n - center;
+            const double sinc = t == 0.0 ? 2.0 * cutoff : std::sin(2.0 * kPi * cutoff * t) / (kPi * t);
+            const double ratio = t / center;
+            const double window = BesselI0(beta * std::sqrt((std::max)(0.0, 1.0 - ratio * ratio))) / i0Beta;
+            const size_t phase = n % m_up;
+            const size_t tap = n / m_up;
+            // Gain L restores the level lost to the implicit zero-stuffing
+            m_coefficients[phase * m_taps + (m_taps - 1 - tap)] = static_cast<float>(m_up * sinc * window);
+        }
+
+        m_history.assign(m_taps - 1 + kSliceFrames, 0.0f);
+    }
+
+    uint32_t UpFactor() const { return m_up; }
+    uint32_t DownFactor() const { return m_down; }
+    size_t TapsPerPhase() const { return m_taps; }
+    bool Passthrough() const { return m_up == m_down; }
+
+    // Delay the filter adds, in output samples
+    size_t LatencyFrames() const { return (m_delay + m_down / 2) / m_down; }
+
+    // Upper bound on what Process() returns for `inputFrames` samples
+    size_t MaxOutputFrames(size_t inputFrames) const {
+        return static_cast<size_t>((static_cast<uint64_t>(inputFrames) * m_up) / m_down) + 1;
+    }
+
+    // Resamples `frames` input samples into `out`, which must have room for
+    // MaxOutputFrames(frames). Returns the number of samples written.
+    size_t Process(const float* in, size_t frames, float* out) {
+        if (Passthrough()) {
+            std::memcpy(out, in, frames * sizeof(float));
+            return frames;
+        }
+
+        size_t produced = 0;
+        while (frames > 0) {
+            const size_t slice = (std::min)(frames, kSliceFrames);
+            produced += ProcessSlice(in, slice, out + produced);
+            in += slice;
+            frames -= slice;
+        }
+        return produced;
+    }
+
+    // Forgets all past input
+    void Reset() {
+        std::fill(m_history.begin(), m_history.end(), 0.0f);
+        m_phase = 0;
+        m_nextInput = 0;
+    }
+
+    // Resamples a whole clip with the filter delay removed, so output sample
+    // n lines up exactly with input time n * inputRate / outputRate.
+    static std::vector<float> ResampleClip(const float* in, size_t frames, uint32_t inputRate, uint32_t outputRate) {
+        PolyphaseResampler resampler(inputRate, outputRate);
+        if (resampler.Passthrough()) {
+            return std::vector<float>(in, in + frames);
+        }
+
+        // Starting the filter one delay ahead centres every output on its
+        // input; trailing silence then flushes the last outputs
+        resampler.m_phase = resampler.m_delay % resampler.m_up;
+        resampler.m_nextInput = resampler.m_delay / resampler.m_up;
+
+        const size_t expected = static_cast<size_t>((static_cast<uint64_t>(frames) * resampler.m_up) / resampler.m_down);
+        const size_t flushFrames = resampler.m_delay / resampler.m_up + 2;
+        std::vector<float> out(resampler.MaxOutputFrames(frames + flushFrames));
+
+        size_t produced = resampler.Process(in, frames, out.data());
+        const std::vector<float> silence(flushFrames, 0.0f);
+        produced += resampler.Process(silence.data(), silence.size(), out.data() + produced);
+
+        out.resize((std::min)(expected, produced));
+        return out;
+    }
+
+private:
+    static constexpr double kPi = 3.14159265358979323846;
+
+    static double BesselI0(double x) {
+        double sum = 1.0;
+        double term = 1.0;
+        const double quarter = 0.25 * x * x;
+        for (int k = 1; k < 64 && term > 1e-12 * sum; ++k) {
+            term *= quarter / (static_cast<double>(k) * k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    size_t ProcessSlice(const float* in, size_t frames, float* out) {
+        // Input sample j of this slice lives at m_history[K - 1 + j]; output
+        // sample n needs inputs m_nextInput - K + 1 ... m_nextInput
+        std::memcpy(m_history.data() + m_taps - 1, in, frames * sizeof(float));
+
+        size_t produced = 0;
+        while (m_nextInput < frames) {
+            const float* x = m_history.data() + m_nextInput;
+            const float* h = m_coefficients.data() + m_phase * m_taps;
+            // Four independent sums let the compiler vectorize without -ffast-math
+            float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            size_t k = 0;
+            for (; k + 4 <= m_taps; k += 4) {
+                acc[0] += h[k] * x[k];
+                acc[1] += h[k + 1] * x[k + 1];
+                acc[2] += h[k + 2] * x[k + 2];
+                acc[3] += h[k + 3] * x[k + 3];
+            }
+            for (; k < m_taps; ++k) {
+                acc[0] += h[k] * x[k];
+            }
+            out[produced++] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+
+            m_phase += m_down;
+            m_nextInput += m_phase / m_up;
+            m_phase %= m_up;
+        }
+
+        m_nextInput -= frames;
+        std::memmove(m_history.data(), m_history.data() + frames, (m_taps - 1) * sizeof(float));
+        return produced;
+    }
+
+    uint32_t m_up = 1;
+    uint32_t m_down = 1;
+    size_t m_taps = 1;
+    size_t m_delay = 0;                  // Filter delay, in prototype-rate samples
+    std::vector<float> m_coefficients;   // L phases of K taps
+    std::vector<float> m_history;        // K - 1 past samples, then the current slice
+    size_t m_phase = 0;
+    size_t m_nextInput = 0;              // Relative to the current slice
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <napi.h>
+#include "abort_signal.h"
+
+// AsyncWorker that settles a Promise instead of invoking a JS callback.
+//
+// Execute() runs on a libuv pool thread and must not touch any Napi:: value.
+// Resolve() runs back on the JS thread once Execute() has returned, so native
+// results are only converted to JS objects at completion.
+class PromiseWorker : public Napi::AsyncWorker {
+public:
+    PromiseWorker(Napi::Env env, const char* resourceName, const Napi::Object& owner)
+        : Napi::AsyncWorker(env, resourceName)
+        , m_deferred(Napi::Promise::Deferred::New(env))
+        , m_owner(Napi::Persistent(owner)) {}
+
+    Napi::Promise GetPromise() const { return m_deferred.Promise(); }
+
+    // Cancels the work when `signal` aborts: `flag` is raised for Execute()
+    // to notice, and the promise rejects with an AbortError however
+    // Execute() ends. Call before Queue().
+    void LinkAbortSignal(const Napi::Object& signal, std::shared_ptr<std::atomic<bool>> flag,
+                         std::function<void()> onAbort = nullptr) {
+        m_abortSignal.Attach(Env(), signal, std::move(flag), std::move(onAbort));
+    }
+
+protected:
+    // Builds the resolution value on the JS thread.
+    virtual Napi::Value Resolve(Napi::Env env) = 0;
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::HandleScope scope(env);
+
+        if (RejectIfAborted(env)) {
+            return;
+        }
+        try {
+            m_deferred.Resolve(Resolve(env));
+        } catch (const Napi::Error& e) {
+            m_deferred.Reject(e.Value());
+        }
+    }
+
+    void OnError(const Napi::Error& error) override {
+        if (RejectIfAborted(Env())) {
+            return;
+        }
+        m_deferred.Reject(error.Value());
+    }
+
+private:
+    bool RejectIfAborted(Napi::Env env) {
+        const bool aborted = m_abortSignal.Fired();
+        if (aborted) {
+            m_deferred.Reject(m_abortSignal.Error(env).Value());
+        }
+        m_abortSignal.Detach();
+        return aborted;
+    }
+
+    Napi::Promise::Deferred m_deferred;
+    // Keeps the wrapping JS object (and therefore its native instance) alive
+    // while Execute() is still using it on the pool thread.
+    Napi::ObjectReference m_owner;
+    AbortSignalLink m_abortSignal;
+};
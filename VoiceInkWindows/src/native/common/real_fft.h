@@ -0,0 +1,305 @@
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VOICEINK_FFT_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VOICEINK_FFT_NEON 1
+#endif
+
+namespace fft_detail {
+
+// Lane operations the butterflies are written against; one float at a time...
+struct ScalarLanes {
+    using V = float;
+    static constexpr size_t kWidth = 1;
+    static V Load(const float* p) { return *p; }
+    static void Store(float* p, V v) { *p = v; }
+    static V Splat(float x) { return x; }
+    static V Add(V a, V b) { return a + b; }
+    static V Sub(V a, V b) { return a - b; }
+    static V Mul(V a, V b) { return a * b; }
+};
+
+// ...or four, for passes whose stride keeps four transforms side by side
+#if defined(VOICEINK_FFT_SSE2)
+struct VectorLanes {
+    using V = __m128;
+    static constexpr size_t kWidth = 4;
+    static V Load(const float* p) { return _mm_loadu_ps(p); }
+    static void Store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V Splat(float x) { return _mm_set1_ps(x); }
+    static V Add(V a, V b) { return _mm_add_ps(a, b); }
+    static V Sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V Mul(V a, V b) { return _mm_mul_ps(a, b); }
+};
+#elif defined(VOICEINK_FFT_NEON)
+struct VectorLanes {
+    using V = float32x4_t;
+    static constexpr size_t kWidth = 4;
+    static V Load(const float* p) { return vld1q_f32(p); }
+    static void Store(float* p, V v) { vst1q_f32(p, v); }
+    static V Splat(float x) { return vdupq_n_f32(x); }
+    static V Add(V a, V b) { return vaddq_f32(a, b); }
+    static V Sub(V a, V b) { return vsubq_f32(a, b); }
+    static V Mul(V a, V b) { return vmulq_f32(a, b); }
+};
+#else
+using VectorLanes = ScalarLanes;
+#endif
+
+// One radix-4 Stockham pass over `n`-point transforms interleaved at
+// `stride`, in split (real, imaginary) form. `twiddles` holds w, w², w³ per
+// p as (re, im) pairs.
+template <typename L>
+inline void Radix4Pass(const float* xr, const float* xi, float* yr, float* yi, size_t n, size_t stride,
+                       const float* twiddles) {
+    using V = typename L::V;
+    const size_t quarter = n / 4;
+    for (size_t p = 0; p < quarter; p++) {
+        const float* w = twiddles + 6 * p;
+        const V w1r = L::Splat(w[0]), w1i = L::Splat(w[1]);
+        const V w2r = L::Splat(w[2]), w2i = L::Splat(w[3]);
+        const V w3r = L::Splat(w[4]), w3i = L::Splat(w[5]);
+        const size_t in = stride * p;
+        const size_t step = stride * quarter;
+        const size_t out = stride * 4 * p;
+        for (size_t q = 0; q < stride; q += L::kWidth) {
+            const size_t a = in + q;
+            const V ar = L::Load(xr + a), ai = L::Load(xi + a);
+            const V br = L::Load(xr + a + step), bi = L::Load(xi + a + step);
+            const V cr = L::Load(xr + a + 2 * step), ci = L::Load(xi + a + 2 * step);
+            const V dr = L::Load(xr + a + 3 * step), di = L::Load(xi + a + 3 * step);
+
+            const V apcR = L::Add(ar, cr), apcI = L::Add(ai, ci);
+            const V amcR = L::Sub(ar, cr), amcI = L::Sub(ai, ci);
+            const V bpdR = L::Add(br, dr), bpdI = L::Add(bi, di);
+            const V bmdR = L::Sub(br, dr), bmdI = L::Sub(bi, di);
+
+            // (a - c) ∓ j(b - d)
+            const V t1r = L::Add(amcR, bmdI), t1i = L::Sub(amcI, bmdR);
+            const V t2r = L::Sub(apcR, bpdR), t2i = L::Sub(apcI, bpdI);
+            const V t3r = L::Sub(amcR, bmdI), t3i = L::Add(amcI, bmdR);
+
+            const size_t o = out + q;
+            L::Store(yr + o, L::Add(apcR, bpdR));
+            L::Store(yi + o, L::Add(apcI, bpdI));
+            L::Store(yr + o + stride, L::Sub(L::Mul(w1r, t1r), L::Mul(w1i, t1i)));
+            L::Store(yi + o + stride, L::Add(L::Mul(w1r, t1i), L::Mul(w1i, t1r)));
+            L::Store(yr + o + 2 * stride, L::Sub(L::Mul(w2r, t2r), L::Mul(w2i, t2i)));
+            L::Store(yi + o + 2 * stride, L::Add(L::Mul(w2r, t2i), L::Mul(w2i, t2r)));
+            L::Store(yr + o + 3 * stride, L::Sub(L::Mul(w3r, t3r), L::Mul(w3i, t3i)));
+            L::Store(yi + o + 3 * stride, L::Add(L::Mul(w3r, t3i), L::Mul(w3i, t3r)));
+        }
+    }
+}
+
+// The last pass when the size is not a power of four; no twiddles left
+template <typename L>
+inline void Radix2Pass(const float* xr, const float* xi, float* yr, float* yi, size_t stride) {
+    for (size_t q = 0; q < stride; q += L::kWidth) {
+        const typename L::V ar = L::Load(xr + q), ai = L::Load(xi + q);
+        const typename L::V br = L::Load(xr + q + stride), bi = L::Load(xi + q + stride);
+        L::Store(yr + q, L::Add(ar, br));
+        L::Store(yi + q, L::Add(ai, bi));
+        L::Store(yr + q + stride, L::Sub(ar, br));
+        L::Store(yi + q + stride, L::Sub(ai, bi));
+    }
+}
+
+} // namespace fft_detail
+
+// Precomputed tables for one real FFT size, shared by every RealFft of that
+// size.
+//
+// The real transform runs a complex FFT of half the size over the samples
+// packed as (even, odd) pairs. That FFT is mixed radix: Stockham radix-4
+// passes, which need no bit reversal, and a final radix-2 pass when the
+// half size is not a power of four. Data is kept in split form so that
+// every pass after the first runs four transforms per instruction with SSE2
+// or NEON.
+class FftPlan {
+public:
+    using Complex = std::complex<float>;
+
+    // Plans are immutable, so one per size is kept for the life of the process
+    static std::shared_ptr<const FftPlan> Get(size_t size) {
+        static std::mutex mutex;
+        static std::map<size_t, std::shared_ptr<const FftPlan>> plans;
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const FftPlan>& plan = plans[size];
+        if (!plan) {
+            plan = std::make_shared<const FftPlan>(size);
+        }
+        return plan;
+    }
+
+    // `size` must be a power of two, at least 4; throws std::invalid_argument
+    explicit FftPlan(size_t size)
+        : m_size(size)
+        , m_half(size / 2) {
+        if (size < 4 || (size & (size - 1)) != 0) {
+            throw std::invalid_argument("FFT size must be a power of two of at least 4");
+        }
+
+        const double pi = 3.14159265358979323846;
+        size_t n = m_half;
+        size_t stride = 1;
+        for (; n >= 4; n /= 4, stride *= 4) {
+            m_passes.push_back(Pass{ n, stride, m_twiddles.size() });
+            for (size_t p = 0; p < n / 4; p++) {
+                for (size_t power = 1; power <= 3; power++) {
+                    const double angle = -2.0 * pi * static_cast<double>(p * power) / static_cast<double>(n);
+                    m_twiddles.push_back(static_cast<float>(std::cos(angle)));
+                    m_twiddles.push_back(static_cast<float>(std::sin(angle)));
+                }
+            }
+        }
+        if (n == 2) {
+            m_passes.push_back(Pass{ 2, stride, 0 });
+        }
+
+        m_splitTwiddles.resize(m_half + 1);
+        for (size_t k = 0; k <= m_half; k++) {
+            const double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(m_size);
+            m_splitTwiddles[k] = Complex(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+        }
+    }
+
+    size_t Size() const { return m_size; }
+    size_t Half() const { return m_half; }
+    // e^(-2πik / Size()) for k <= Half()
+    const Complex* SplitTwiddles() const { return m_splitTwiddles.data(); }
+
+    // Forward complex DFT of Half() points held in `re`/`im`. The passes
+    // alternate between those and the scratch arrays; on return `re`/`im`
+    // point at the result and the scratch pointers at the other pair.
+    void Transform(float*& re, float*& im, float*& scratchRe, float*& scratchIm) const {
+        for (const Pass& pass : m_passes) {
+            if (pass.length == 2) {
+                if (pass.stride % fft_detail::VectorLanes::kWidth == 0) {
+                    fft_detail::Radix2Pass<fft_detail::VectorLanes>(re, im, scratchRe, scratchIm, pass.stride);
+                } else {
+                    fft_detail::Radix2Pass<fft_detail::ScalarLanes>(re, im, scratchRe, scratchIm, pass.stride);
+                }
+            } else {
+                const float* twiddles = m_twiddles.data() + pass.twiddleOffset;
+                if (pass.stride % fft_detail::VectorLanes::kWidth == 0) {
+                    fft_detail::Radix4Pass<fft_detail::VectorLanes>(re, im, scratchRe, scratchIm, pass.length, pass.stride, twiddles);
+                } else {
+                    fft_detail::Radix4Pass<fft_detail::ScalarLanes>(re, im, scratchRe, scratchIm, pass.length, pass.stride, twiddles);
+                }
+            }
+            std::swap(re, scratchRe);
+            std::swap(im, scratchIm);
+        }
+    }
+
+private:
+    struct Pass {
+        size_t length;          // Points per transform in this pass; 2 for the radix-2 pass
+        size_t stride;          // Transforms interleaved
+        size_t twiddleOffset;   // Into m_twiddles
+    };
+
+    const size_t m_size;
+    const size_t m_half;
+    std::vector<Pass> m_passes;
+    std::vector<float> m_twiddles;
+    std::vector<Complex> m_splitTwiddles;
+};
+
+// FFT of real input with a power-of-two size.
+//
+// Shares the FftPlan of its size and owns only its work buffers, so
+// construction after the first of a size is cheap and the transforms do not
+// allocate. Not thread-safe: use one instance per thread.
+class RealFft {
+public:
+    using Complex = FftPlan::Complex;
+
+    // `size` must be a power of two, at least 4; throws std::invalid_argument
+    explicit RealFft(size_t size)
+        : m_plan(FftPlan::Get(size))
+        , m_re(m_plan->Half())
+        , m_im(m_plan->Half())
+        , m_scratchRe(m_plan->Half())
+        , m_scratchIm(m_plan->Half()) {}
+
+    size_t Size() const { return m_plan->Size(); }
+    size_t Bins() const { return m_plan->Half() + 1; }
+
+    // `input` holds Size() samples; writes Bins() bins, DC to Nyquist
+    void Forward(const float* input, Complex* spectrum) {
+        const size_t half = m_plan->Half();
+        for (size_t n = 0; n < half; n++) {
+            m_re[n] = input[2 * n];
+            m_im[n] = input[2 * n + 1];
+        }
+        float* zr = m_re.data();
+        float* zi = m_im.data();
+        float* scratchRe = m_scratchRe.data();
+        float* scratchIm = m_scratchIm.data();
+        m_plan->Transform(zr, zi, scratchRe, scratchIm);
+
+        // Split into the transforms of the even and odd samples and combine
+        const Complex* twiddles = m_plan->SplitTwiddles();
+        spectrum[0] = Complex(zr[0] + zi[0], 0.0f);
+        spectrum[half] = Complex(zr[0] - zi[0], 0.0f);
+        for (size_t k = 1; k < half; k++) {
+            const Complex z(zr[k], zi[k]);
+            const Complex mirror(zr[half - k], -zi[half - k]);
+            const Complex even = 0.5f * (z + mirror);
+            const Complex odd = Complex(0.0f, -0.5f) * (z - mirror);
+            spectrum[k] = even + twiddles[k] * odd;
+        }
+    }
+
+    // Inverse of Forward(), scaled so that Inverse(Forward(x)) == x. Reads
+    // Bins() bins and writes Size() samples.
+    void Inverse(const Complex* spectrum, float* output) {
+        const size_t half = m_plan->Half();
+        const Complex* twiddles = m_plan->SplitTwiddles();
+        for (size_t k = 0; k < half; k++) {
+            const Complex x = spectrum[k];
+            const Complex mirror = std::conj(spectrum[half - k]);
+            const Complex even = 0.5f * (x + mirror);
+            const Complex odd = 0.5f * (x - mirror) * std::conj(twiddles[k]);
+            const Complex z = even + Complex(0.0f, 1.0f) * odd;
+            m_re[k] = z.real();
+            m_im[k] = z.imag();
+        }
+
+        // With real and imaginary parts swapped on the way in and out, the
+        // forward transform computes the inverse
+        float* zr = m_im.data();
+        float* zi = m_re.data();
+        float* scratchRe = m_scratchIm.data();
+        float* scratchIm = m_scratchRe.data();
+        m_plan->Transform(zr, zi, scratchRe, scratchIm);
+
+        const float scale = 1.0f / static_cast<float>(half);
+        for (size_t n = 0; n < half; n++) {
+            output[2 * n] = zi[n] * scale;
+            output[2 * n + 1] = zr[n] * scale;
+        }
+    }
+
+private:
+    std::shared_ptr<const FftPlan> m_plan;
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+    std::vector<float> m_scratchRe;
+    std::vector<float> m_scratchIm;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "flac_file_writer.h"
+#include "recording_file_writer.h"
+#include "wav_file_writer.h"
+
+enum class RecordingContainer : uint8_t {
+    Wav,        // 16/24-bit PCM or float, RF64 past 4 GiB
+    Flac,       // Lossless, 16/24-bit PCM
+};
+
+inline std::unique_ptr<RecordingFileWriter> CreateRecordingFileWriter(RecordingContainer container) {
+    if (container == RecordingContainer::Flac) {
+        return std::make_unique<FlacFileWriter>();
+    }
+    return std::make_unique<WavFileWriter>();
+}
+
+// Repairs a WAV/RF64 or FLAC recording whose writer never finished, telling
+// them apart by their first bytes. Returns the PCM bytes kept.
+inline bool RecoverRecordingFile(const std::string& path, uint64_t& dataBytes, std::string& error) {
+    char magic[4] = {};
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            error = "Cannot open " + path;
+            return false;
+        }
+        file.read(magic, sizeof(magic));
+    }
+    if (std::memcmp(magic, "fLaC", 4) == 0) {
+        return FlacFileWriter::Recover(path, dataBytes, error);
+    }
+    return WavFileWriter::Recover(path, dataBytes, error);
+}
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sample_format_converter.h"
+#include "spsc_ring_buffer.h"
+
+// What a recording file stores
+struct RecordingFileFormat {
+    SampleEncoding encoding = SampleEncoding::Int16;
+    uint16_t channels = 1;
+    uint32_t sampleRate = 16000;
+
+    size_t BytesPerFrame() const { return SampleFormat{ encoding, channels }.BytesPerFrame(); }
+    bool Valid() const { return SampleFormat{ encoding, channels }.Valid() && sampleRate > 0; }
+};
+
+struct RecordingFileStats {
+    uint64_t sourceBytes = 0;           // PCM taken from the capture thread
+    uint64_t bytesWritten = 0;          // Audio on disk, less than sourceBytes when compressed
+    uint64_t droppedBytes = 0;          // Lost because the disk fell behind
+    uint64_t headerUpdates = 0;
+    bool rf64 = false;                  // The sizes no longer fit a RIFF header
+    bool failed = false;                // A write failed; nothing more is stored
+};
+
+// Streams a recording into a file from a background thread, so its length
+// is limited only by the disk. The container (WAV, FLAC) is up to the
+// derived class.
+//
+// The capture thread Write()s PCM into a lock-free ring and never touches
+// the file. The writer thread calls Drain() until it takes nothing more,
+// then sleeps briefly; at least every kFlushIntervalMs the call is marked
+// `due`, for the container to flush and bring its header up to date.
+// Close() stops the thread and lets Finish() store what is left.
+//
+// Open() and Close() on one thread, Write() on one other (the capture
+// thread), never concurrently with Open() or Close(). Derived destructors
+// must call Close().
+class RecordingFileWriter {
+public:
+    static constexpr uint32_t kFlushIntervalMs = 1000;
+
+    RecordingFileWriter() = default;
+    virtual ~RecordingFileWriter() = default;
+
+    RecordingFileWriter(const RecordingFileWriter&) = delete;
+    RecordingFileWriter& operator=(const RecordingFileWriter&) = delete;
+
+    // Creates (or truncates) `path`, writes the header and starts the writer
+    // thread. The ring holds `bufferMs` of audio for the disk to catch up on.
+    bool Open(const std::string& path, const RecordingFileFormat& format, std::string& error, uint32_t bufferMs = 4000) {
+        Close();
+        if (!format.Valid()) {
+            error = "Unsupported recording format";
+            return false;
+        }
+
+        m_format = format;
+        const size_t bytesPerFrame = format.BytesPerFrame();
+        try {
+            const size_t bufferBytes = static_cast<size_t>(bufferMs) * format.sampleRate / 1000 * bytesPerFrame;
+            m_ring = std::make_unique<SpscRingBuffer<uint8_t>>((std::max)(bufferBytes, kMinBufferBytes),
+                                                               RingOverflowPolicy::DropNewest, bytesPerFrame);
+            m_encoded.assign(kEncodeSamples * SampleFormat{ format.encoding, 1 }.BytesPerSample(), 0);
+        } catch (const std::bad_alloc&) {
+            m_ring.reset();
+            error = "Failed to allocate the recording buffers";
+            return false;
+        }
+
+        // Unbuffered: writes reach the OS as the blocks the container makes
+        m_file.rdbuf()->pubsetbuf(nullptr, 0);
+        m_file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+        if (!m_file) {
+            m_ring.reset();
+            error = "Cannot create " + path;
+            return false;
+        }
+
+        m_fileBytes = 0;
+        m_sourceBytes = 0;
+        m_bytesWritten = 0;
+        m_headerUpdates = 0;
+        m_rf64 = false;
+        m_failed = false;
+        m_shouldStop = false;
+        bool begun = false;
+        try {
+            begun = Begin(format, error);
+        } catch (const std::bad_alloc&) {
+            error = "Failed to allocate the recording buffers";
+        }
+        if (!begun) {
+            m_file.close();
+            m_ring.reset();
+            if (error.empty()) {
+                error = "Cannot write to " + path;
+            }
+            return false;
+        }
+        m_path = path;
+        m_writer = std::thread(&RecordingFileWriter::Run, this);
+        return true;
+    }
+
+    // Stores what is queued, finalises the header and closes the file.
+    // Returns false if any write failed. Does nothing if not open.
+    bool Close() {
+        if (!m_writer.joinable()) {
+            return !m_failed;
+        }
+        m_shouldStop = true;
+        m_writer.join();
+        if (!m_failed) {
+            Finish();
+        }
+        m_file.close();
+        m_path.clear();
+        return !m_failed;
+    }
+
+    bool IsOpen() const { return m_writer.joinable(); }
+    const std::string& Path() const { return m_path; }
+    const RecordingFileFormat& Format() const { return m_format; }
+
+    // Writer side. Queues `bytes` of PCM in the file's format, whole frames
+    // only; returns the number stored. Never blocks or allocates.
+    size_t Write(const void* data, size_t bytes) {
+        if (!m_ring) {
+            return 0;
+        }
+        return m_ring->Write(static_cast<const uint8_t*>(data), bytes);
+    }
+
+    // Writer side. Queues interleaved float samples, converted to the file's
+    // encoding (Int16, Int24 or Float32). Never blocks or allocates.
+    size_t WriteSamples(const float* samples, size_t count) {
+        const SampleEncoding encoding = m_format.encoding;
+        if (!m_ring || (encoding != SampleEncoding::Int16 && encoding != SampleEncoding::Int24 &&
+                        encoding != SampleEncoding::Float32)) {
+            return 0;
+        }
+        const size_t bytesPerSample = SampleFormat{ encoding, 1 }.BytesPerSample();
+        size_t stored = 0;
+        for (size_t offset = 0; offset < count;) {
+            // Whole frames per chunk, so the ring never splits one
+            const size_t chunk = (std::min)(count - offset, kEncodeSamples - kEncodeSamples % m_format.channels);
+            Encode(samples + offset, chunk);
+            stored += m_ring->Write(m_encoded.data(), chunk * bytesPerSample) / bytesPerSample;
+            offset += chunk;
+        }
+        return stored;
+    }
+
+    RecordingFileStats Stats() const {
+        RecordingFileStats stats;
+        stats.sourceBytes = m_sourceBytes.load(std::memory_order_relaxed);
+        stats.bytesWritten = m_bytesWritten.load(std::memory_order_relaxed);
+        stats.droppedBytes = m_ring ? m_ring->Stats().droppedNewest : 0;
+        stats.headerUpdates = m_headerUpdates.load(std::memory_order_relaxed);
+        stats.rf64 = m_rf64.load(std::memory_order_relaxed);
+        stats.failed = m_failed.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+protected:
+    // On Open()'s thread, with the file created and empty: checks the
+    // format, allocates and writes the header. May throw std::bad_alloc.
+    virtual bool Begin(const RecordingFileFormat& format, std::string& error) = 0;
+    // Writer thread. Takes what it can from the ring with ReadSource().
+    virtual bool Drain(bool due) = 0;
+    // Once the writer thread has stopped, unless a write failed: stores the
+    // rest of the ring and finalises the header.
+    virtual bool Finish() = 0;
+
+    size_t ReadSource(uint8_t* out, size_t bytes) {
+        const size_t read = m_ring->Read(out, bytes);
+        m_sourceBytes.fetch_add(read, std::memory_order_relaxed);
+        return read;
+    }
+    size_t SourceAvailable() const { return m_ring->Available(); }
+
+    // Audio at the end of the file
+    bool Append(const void* data, size_t bytes) {
+        m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        if (!m_file) {
+            m_failed = true;
+            return false;
+        }
+        m_fileBytes += bytes;
+        m_bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Header bytes anywhere in the file; the next Append() still goes to the end
+    bool Overwrite(uint64_t offset, const void* data, size_t bytes) {
+        m_file.seekp(static_cast<std::streamoff>(offset));
+        m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        m_fileBytes = (std::max)(m_fileBytes, offset + bytes);
+        m_file.seekp(static_cast<std::streamoff>(m_fileBytes));
+        if (!m_file) {
+            m_failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    void CountHeaderUpdate() { m_headerUpdates.fetch_add(1, std::memory_order_relaxed); }
+    void SetRf64(bool rf64) { m_rf64.store(rf64, std::memory_order_relaxed); }
+    bool Failed() const { return m_failed; }
+
+private:
+    static constexpr size_t kEncodeSamples = 4096;
+    static constexpr size_t kMinBufferBytes = 512 * 1024;
+    static constexpr uint32_t kPollMs = 20;
+
+    void Encode(const float* samples, size_t count) {
+        uint8_t* out = m_encoded.data();
+        switch (m_format.encoding) {
+        case SampleEncoding::Float32:
+            std::memcpy(out, samples, count * sizeof(float));
+            break;
+        case SampleEncoding::Int24:
+            for (size_t i = 0; i < count; i++) {
+                const float clamped = (std::max)(-1.0f, (std::min)(1.0f, samples[i]));
+                const int32_t sample = static_cast<int32_t>(std::lrint(clamped * 8388607.0f));
+                out[i * 3] = static_cast<uint8_t>(sample);
+                out[i * 3 + 1] = static_cast<uint8_t>(sample >> 8);
+                out[i * 3 + 2] = static_cast<uint8_t>(sample >> 16);
+            }
+            break;
+        default:
+            for (size_t i = 0; i < count; i++) {
+                const float clamped = (std::max)(-1.0f, (std::min)(1.0f, samples[i]));
+                const int16_t sample = static_cast<int16_t>(std::lrint(clamped * 32767.0f));
+                std::memcpy(out + i * sizeof(sample), &sample, sizeof(sample));
+            }
+            break;
+        }
+    }
+
+    void Run() {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point lastFlush = Clock::now();
+        while (!m_failed) {
+            const bool stopping = m_shouldStop.load(std::memory_order_acquire);
+            const bool due = Clock::now() - lastFlush >= std::chrono::milliseconds(kFlushIntervalMs);
+            const uint64_t taken = m_sourceBytes.load(std::memory_order_relaxed);
+            if (!Drain(due)) {
+                m_failed = true;
+                break;
+            }
+            if (due) {
+                lastFlush = Clock::now();
+            }
+            if (m_sourceBytes.load(std::memory_order_relaxed) == taken) {
+                if (stopping) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+            }
+        }
+    }
+
+    RecordingFileFormat m_format;
+    std::string m_path;
+    std::ofstream m_file;                            // Writer thread while it runs
+    uint64_t m_fileBytes = 0;                        // Writer thread
+    std::unique_ptr<SpscRingBuffer<uint8_t>> m_ring;
+    std::vector<uint8_t> m_encoded;                  // Capture thread: one chunk of converted samples
+    std::thread m_writer;
+    std::atomic<bool> m_shouldStop{ false };
+    std::atomic<bool> m_failed{ false };
+    std::atomic<bool> m_rf64{ false };
+    std::atomic<uint64_t> m_sourceBytes{ 0 };
+    std::atomic<uint64_t> m_bytesWritten{ 0 };
+    std::atomic<uint64_t> m_headerUpdates{ 0 };
+};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VOICEINK_SAMPLE_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VOICEINK_SAMPLE_NEON 1
+#endif
+
+// Converters from device sample formats to interleaved float32 in [-1, 1).
+//
+// One kernel exists per source encoding and channel count (1, 2, or any
+// other count at run time). SelectSampleConverter() picks it once when a
+// stream opens, so the per-packet path is a single indirect call with no
+// format checks. Integer sources scale by a power of two, which is exact, so
+// every kernel produces the same bits as the scalar reference
+// `float(sample) / 2^(bits-1)`. Int16 and Int32 use SSE2 or NEON where
+// available; packed 24-bit and float32 are left to the compiler.
+
+enum class SampleEncoding : uint8_t {
+    Unknown,
+    Int16,
+    Int24,      // Packed, three bytes per sample
+    Int32,      // Also 24-bit samples in a 32-bit container (MSB-aligned)
+    Float32
+};
+
+struct SampleFormat {
+    SampleEncoding encoding = SampleEncoding::Unknown;
+    uint16_t channels = 0;
+
+    size_t BytesPerSample() const {
+        switch (encoding) {
+        case SampleEncoding::Int16: return 2;
+        case SampleEncoding::Int24: return 3;
+        case SampleEncoding::Int32:
+        case SampleEncoding::Float32: return 4;
+        default: return 0;
+        }
+    }
+    size_t BytesPerFrame() const { return BytesPerSample() * channels; }
+    bool Valid() const { return encoding != SampleEncoding::Unknown && channels > 0; }
+};
+
+// Wave format tags, as in mmreg.h / ksmedia.h
+constexpr uint16_t kWaveFormatPcm = 0x0001;
+constexpr uint16_t kWaveFormatIeeeFloat = 0x0003;
+constexpr uint16_t kWaveFormatExtensible = 0xFFFE;
+
+// Describes a WAVEFORMATEX(TENSIBLE) without depending on Windows headers.
+// For WAVE_FORMAT_EXTENSIBLE pass the first field (Data1) of SubFormat,
+// which carries the PCM or IEEE-float tag; it is ignored otherwise.
+inline SampleFormat SampleFormatFromWave(uint16_t formatTag, uint16_t channels, uint16_t bitsPerSample,
+                                         uint16_t blockAlign, uint32_t subFormatTag = 0) {
+    SampleFormat format;
+    format.channels = channels;
+    if (channels == 0 || blockAlign != channels * (bitsPerSample / 8)) {
+        return format;
+    }
+
+    const uint32_t tag = formatTag == kWaveFormatExtensible ? subFormatTag : formatTag;
+    if (tag == kWaveFormatIeeeFloat && bitsPerSample == 32) {
+        format.encoding = SampleEncoding::Float32;
+    } else if (tag == kWaveFormatPcm) {
+        switch (bitsPerSample) {
+        case 16: format.encoding = SampleEncoding::Int16; break;
+        case 24: format.encoding = SampleEncoding::Int24; break;
+        case 32: format.encoding = SampleEncoding::Int32; break;
+        default: break;
+        }
+    }
+    return format;
+}
+
+namespace SampleKernels {
+
+constexpr float kInt16Scale = 1.0f / 32768.0f;
+constexpr float kInt24Scale = 1.0f / 8388608.0f;
+constexpr float kInt32Scale = 1.0f / 2147483648.0f;
+
+// Device buffers carry no alignment guarantee, so every load goes through memcpy
+inline int32_t LoadInt24(const uint8_t* p) {
+    const uint32_t value = uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16);
+    return static_cast<int32_t>(value << 8) >> 8;
+}
+
+inline void Int16ToFloat(const uint8_t* src, float* dst, size_t count) {
+    size_t i = 0;
+#if defined(VOICEINK_SAMPLE_SSE2)
+    const __m128 scale = _mm_set1_ps(kInt16Scale);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+        // Sign-extend by placing each sample in the high half and shifting back
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+#elif defined(VOICEINK_SAMPLE_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int16_t block[8];
+        std::memcpy(block, src + i * 2, sizeof(block));
+        const int16x8_t packed = vld1q_s16(block);
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(packed))), kInt16Scale));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(packed))), kInt16Scale));
+    }
+#endif
+    for (; i < count; ++i) {
+        int16_t sample;
+        std::memcpy(&sample, src + i * 2, sizeof(sample));
+        dst[i] = static_cast<float>(sample) * kInt16Scale;
+    }
+}
+
+inline void Int24ToFloat(const uint8_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<float>(LoadInt24(src + i * 3)) * kInt24Scale;
+    }
+}
+
+inline void Int32ToFloat(const uint8_t* src, float* dst, size_t count) {
+    size_t i = 0;
+#if defined(VOICEINK_SAMPLE_SSE2)
+    const __m128 scale = _mm_set1_ps(kInt32Scale);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(packed), scale));
+    }
+#elif defined(VOICEINK_SAMPLE_NEON)
+    for (; i + 4 <= count; i += 4) {
+        int32_t block[4];
+        std::memcpy(block, src + i * 4, sizeof(block));
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(block)), kInt32Scale));
+    }
+#endif
+    for (; i < count; ++i) {
+        int32_t sample;
+        std::memcpy(&sample, src + i * 4, sizeof(sample));
+        dst[i] = static_cast<float>(sample) * kInt32Scale;
+    }
+}
+
+inline void Float32ToFloat(const uint8_t* src, float* dst, size_t count) {
+    std::memcpy(dst, src, count * sizeof(float));
+}
+
+// Channels == 0 takes the count at run time; otherwise the sample count is a
+// compile-time multiple of it, which lets the compiler unroll the tail.
+template <SampleEncoding Encoding, unsigned Channels>
+void ConvertFrames(const void* src, float* dst, size_t frames, unsigned channels) {
+    const size_t count = frames * (Channels ? Channels : channels);
+    const uint8_t* bytes = static_cast<const uint8_t*>(src);
+    if constexpr (Encoding == SampleEncoding::Int16) {
+        Int16ToFloat(bytes, dst, count);
+    } else if constexpr (Encoding == SampleEncoding::Int24) {
+        Int24ToFloat(bytes, dst, count);
+    } else if constexpr (Encoding == SampleEncoding::Int32) {
+        Int32ToFloat(bytes, dst, count);
+    } else if constexpr (Encoding == SampleEncoding::Float32) {
+        Float32ToFloat(bytes, dst, count);
+    }
+}
+
+template <SampleEncoding Encoding>
+auto SelectForChannels(unsigned channels) {
+    switch (channels) {
+    case 1: return &ConvertFrames<Encoding, 1>;
+    case 2: return &ConvertFrames<Encoding, 2>;
+    default: return &ConvertFrames<Encoding, 0>;
+    }
+}
+
+}  // namespace SampleKernels
+
+// A kernel bound to one stream format.
+class SampleConverter {
+public:
+    using Kernel = void (*)(const void* src, float* dst, size_t frames, unsigned channels);
+
+    SampleConverter() = default;
+    SampleConverter(const SampleFormat& format, Kernel kernel) : m_format(format), m_kernel(kernel) {}
+
+    bool Valid() const { return m_kernel != nullptr; }
+    const SampleFormat& Format() const { return m_format; }
+
+    // Writes frames * channels floats to `dst`
+    void Convert(const void* src, float* dst, size_t frames) const {
+        m_kernel(src, dst, frames, m_format.channels);
+    }
+
+private:
+    SampleFormat m_format;
+    Kernel m_kernel = nullptr;
+};
+
+// Picks the kernel for `format`; invalid if the encoding is not supported.
+inline SampleConverter SelectSampleConverter(const SampleFormat& format) {
+    using namespace SampleKernels;
+    if (!format.Valid()) {
+        return SampleConverter();
+    }
+
+    switch (format.encoding) {
+    case SampleEncoding::Int16: return SampleConverter(format, SelectForChannels<SampleEncoding::Int16>(format.channels));
+    case SampleEncoding::Int24: return SampleConverter(format, SelectForChannels<SampleEncoding::Int24>(format.channels));
+    case SampleEncoding::Int32: return SampleConverter(format, SelectForChannels<SampleEncoding::Int32>(format.channels));
+    case SampleEncoding::Float32: return SampleConverter(format, SelectForChannels<SampleEncoding::Float32>(format.channels));
+    default: return SampleConverter();
+    }
+}
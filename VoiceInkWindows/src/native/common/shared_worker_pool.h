@@ -0,0 +1,121 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed-size thread pool shared by every addon instance in the process.
+//
+// Node loads an addon once per environment (the main thread and each
+// worker_thread), so per-instance pools multiply with the number of workers.
+// Acquire() instead hands out references to a single pool, created by the
+// first caller and joined when the last reference is dropped.
+class SharedWorkerPool {
+public:
+    // `threadCount` only applies when the pool does not exist yet.
+    static std::shared_ptr<SharedWorkerPool> Acquire(size_t threadCount) {
+        static std::mutex mutex;
+        static std::weak_ptr<SharedWorkerPool> shared;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<SharedWorkerPool> pool = shared.lock();
+        if (!pool) {
+            pool.reset(new SharedWorkerPool(threadCount > 0 ? threadCount : 1));
+            shared = pool;
+        }
+        return pool;
+    }
+
+    ~SharedWorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    SharedWorkerPool(const SharedWorkerPool&) = delete;
+    SharedWorkerPool& operator=(const SharedWorkerPool&) = delete;
+
+    void Post(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_wake.notify_one();
+    }
+
+    size_t ThreadCount() const { return m_threads.size(); }
+
+    size_t PendingCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_tasks.size();
+    }
+
+private:
+    explicit SharedWorkerPool(size_t threadCount) {
+        m_threads.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            m_threads.emplace_back([this]() { Run(); });
+        }
+    }
+
+    void Run() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty()) {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+};
+
+// Lets tasks posted to a shared pool outlive the object that posted them.
+//
+// Tasks call Enter() and skip their work if it returns an empty lock; the
+// owner calls Close() before it is destroyed, which waits for tasks that
+// are already running and turns away any that start later.
+class TaskGate {
+public:
+    using Guard = std::shared_lock<std::shared_mutex>;
+
+    Guard Enter() {
+        Guard guard(m_mutex);
+        if (m_closed) {
+            guard.unlock();
+        }
+        return guard;
+    }
+
+    void Close() {
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        m_closed = true;
+    }
+
+private:
+    std::shared_mutex m_mutex;
+    bool m_closed = false;
+};
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+// What a full ring does with a write that does not fit.
+enum class RingOverflowPolicy {
+    DropOldest,   // Discard the oldest unread elements to make room
+    DropNewest,   // Store what fits and discard the rest of the write
+    Block         // Wait for the consumer (or Close())
+};
+
+struct RingBufferStats {
+    uint64_t written = 0;        // Elements stored by the producer
+    uint64_t read = 0;           // Elements consumed, including Discard()
+    uint64_t droppedOldest = 0;  // Unread elements discarded under DropOldest
+    uint64_t droppedNewest = 0;  // Incoming elements discarded under DropNewest (or after Close())
+    uint64_t blockedWrites = 0;  // Writes that had to wait under Block
+};
+
+// Single-producer/single-consumer ring of trivially copyable elements.
+//
+// One thread calls Write(); one other thread calls Read(), Discard() and
+// Clear(). Neither side takes a lock: each owns one cursor on its own cache
+// line, and every transfer is at most two memcpy spans. The capacity is
+// rounded up to a power of two, so wrapping is a mask, and the cursors are
+// 64-bit element counts that never wrap in practice.
+//
+// DropOldest lets the producer move the read cursor. The consumer marks the
+// cursor busy while it copies; a producer that finds it busy cannot take
+// those elements away, so it drops the newest ones instead for that write.
+// Either way Write() finishes in a bounded number of steps.
+//
+// `frameSize` keeps interleaved data aligned: elements are only dropped in
+// whole frames, assuming the producer writes whole frames.
+template <typename T>
+class SpscRingBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRingBuffer elements are copied with memcpy");
+
+public:
+    explicit SpscRingBuffer(size_t minCapacity, RingOverflowPolicy policy = RingOverflowPolicy::DropOldest,
+                            size_t frameSize = 1)
+        : m_capacity(RoundUpToPowerOfTwo((std::max)(minCapacity, frameSize)))
+        , m_mask(m_capacity - 1)
+        , m_frameSize((std::max)(frameSize, size_t(1)))
+        , m_policy(policy)
+        , m_data(new T[m_capacity]) {}
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // Producer only. Returns the number of elements stored, which is
+    // `count` unless some were dropped or the ring was closed.
+    size_t Write(const T* data, size_t count) {
+        if (m_closed.load(std::memory_order_relaxed)) {
+            m_droppedNewest.fetch_add(count, std::memory_order_relaxed);
+            return 0;
+        }
+
+        switch (m_policy) {
+        case RingOverflowPolicy::DropOldest:
+            return WriteDroppingOldest(data, count);
+        case RingOverflowPolicy::DropNewest:
+            return WriteDroppingNewest(data, count);
+        case RingOverflowPolicy::Block:
+        default:
+            return WriteBlocking(data, count);
+        }
+    }
+
+    // Producer only, DropOldest rings. Takes back the oldest unread element,
+    // e.g. to recycle the buffer it refers to. Fails if the ring is empty or
+    // the consumer is reading.
+    bool EvictOldest(T& out) {
+        if (m_policy != RingOverflowPolicy::DropOldest) {
+            return false;
+        }
+
+        const uint64_t write = m_write.load(std::memory_order_relaxed);
+        uint64_t read = m_read.load(std::memory_order_acquire);
+        if ((read & kBusy) || read == write) {
+            return false;
+        }
+
+        // Only the producer writes slots, so copying before the claim is safe
+        const T oldest = m_data[static_cast<size_t>(read) & m_mask];
+        if (!m_read.compare_exchange_strong(read, read + 1, std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+            return false;
+        }
+        m_droppedOldest.fetch_add(1, std::memory_order_relaxed);
+        out = oldest;
+        return true;
+    }
+
+    // Consumer only. Copies up to `count` elements into `out`.
+    size_t Read(T* out, size_t count) { return Consume(out, count); }
+
+    // Consumer only. Skips up to `count` unread elements.
+    size_t Discard(size_t count) { return Consume(nullptr, count); }
+
+    // Consumer only. Skips everything written so far.
+    void Clear() { Consume(nullptr, SIZE_MAX); }
+
+    // Unblocks a waiting producer; later writes are dropped.
+    void Close() { m_closed.store(true, std::memory_order_release); }
+
+    // Accepts writes again. Only while no write is in progress.
+    void Reopen() { m_closed.store(false, std::memory_order_release); }
+
+    bool Closed() const { return m_closed.load(std::memory_order_acquire); }
+
+    // Exact on the consumer thread; a lower bound on the producer thread.
+    size_t Available() const {
+        const uint64_t write = m_write.load(std::memory_order_acquire);
+        const uint64_t read = m_read.load(std::memory_order_acquire) & ~kBusy;
+        return static_cast<size_t>(write - read);
+    }
+
+    size_t Capacity() const { return m_capacity; }
+    RingOverflowPolicy Policy() const { return m_policy; }
+
+    RingBufferStats Stats() const {
+        RingBufferStats stats;
+        stats.written = m_written.load(std::memory_order_relaxed);
+        stats.read = m_consumed.load(std::memory_order_relaxed);
+        stats.droppedOldest = m_droppedOldest.load(std::memory_order_relaxed);
+        stats.droppedNewest = m_droppedNewest.load(std::memory_order_relaxed);
+        stats.blockedWrites = m_blockedWrites.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    // Set on the read cursor while the consumer copies out of the ring
+    static constexpr uint64_t kBusy = uint64_t(1) << 63;
+
+    static size_t RoundUpToPowerOfTwo(size_t value) {
+        size_t capacity = 1;
+        while (capacity < value) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    size_t WholeFrames(size_t count) const { return count - count % m_frameSize; }
+
+    size_t FreeSpace(uint64_t write, uint64_t read) const {
+        return m_capacity - static_cast<size_t>(write - (read & ~kBusy));
+    }
+
+    // Copies `count` elements in at `write` and publishes them
+    void Store(uint64_t write, const T* data, size_t count) {
+        const size_t offset = static_cast<size_t>(write) & m_mask;
+        const size_t first = (std::min)(count, m_capacity - offset);
+        std::memcpy(m_data.get() + offset, data, first * sizeof(T));
+        std::memcpy(m_data.get(), data + first, (count - first) * sizeof(T));
+
+        m_write.store(write + count, std::memory_order_release);
+        m_written.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    size_t WriteDroppingNewest(const T* data, size_t count) {
+        const uint64_t write = m_write.load(std::memory_order_relaxed);
+        size_t free = FreeSpace(write, m_readCache);
+        if (free < count) {
+            m_readCache = m_read.load(std::memory_order_acquire);
+            free = FreeSpace(write, m_readCache);
+        }
+
+        const size_t stored = count <= free ? count : WholeFrames(free);
+        if (stored > 0) {
+            Store(write, data, stored);
+        }
+        if (stored < count) {
+            m_droppedNewest.fetch_add(count - stored, std::memory_order_relaxed);
+        }
+        return stored;
+    }
+
+    size_t WriteDroppingOldest(const T* data, size_t count) {
+        // Only the tail of an oversized write can survive
+        if (count > m_capacity) {
+            const size_t skipped = count - WholeFrames(m_capacity);
+            m_droppedOldest.fetch_add(skipped, std::memory_order_relaxed);
+            data += skipped;
+            count -= skipped;
+        }
+
+        const uint64_t write = m_write.load(std::memory_order_relaxed);
+        uint64_t read = m_read.load(std::memory_order_acquire);
+        if (FreeSpace(write, read) < count && !(read & kBusy)) {
+            // Advance to a frame boundary past the elements being replaced
+            const uint64_t needed = count - FreeSpace(write, read);
+            uint64_t target = read + needed;
+            target += (m_frameSize - target % m_frameSize) % m_frameSize;
+            target = (std::min)(target, write);
+
+            if (m_read.compare_exchange_strong(read, target, std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+                m_droppedOldest.fetch_add(target - read, std::memory_order_relaxed);
+                read = target;
+            }
+            // On failure `read` holds the consumer's latest cursor
+        }
+
+        const size_t free = FreeSpace(write, read);
+        const size_t stored = count <= free ? count : WholeFrames(free);
+        if (stored > 0) {
+            Store(write, data, stored);
+        }
+        if (stored < count) {
+            m_droppedNewest.fetch_add(count - stored, std::memory_order_relaxed);
+        }
+        return stored;
+    }
+
+    size_t WriteBlocking(const T* data, size_t count) {
+        size_t stored = 0;
+        bool waited = false;
+        while (stored < count) {
+            const uint64_t write = m_write.load(std::memory_order_relaxed);
+            size_t free = FreeSpace(write, m_readCache);
+            if (free == 0) {
+                m_readCache = m_read.load(std::memory_order_acquire);
+                free = FreeSpace(write, m_readCache);
+            }
+
+            const size_t chunk = (std::min)(count - stored, free);
+            if (chunk > 0) {
+                Store(write, data + stored, chunk);
+                stored += chunk;
+                continue;
+            }
+
+            if (m_closed.load(std::memory_order_acquire)) {
+                m_droppedNewest.fetch_add(count - stored, std::memory_order_relaxed);
+                break;
+            }
+            if (!waited) {
+                waited = true;
+                m_blockedWrites.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::this_thread::yield();
+        }
+        return stored;
+    }
+
+    // Copies out (or skips, if `out` is null) up to `count` elements
+    size_t Consume(T* out, size_t count) {
+        uint64_t read = m_read.load(std::memory_order_relaxed);
+        if (m_policy == RingOverflowPolicy::DropOldest) {
+            // Claim the cursor so the producer cannot drop what we copy
+            while (!m_read.compare_exchange_weak(read, read | kBusy, std::memory_order_acquire,
+                                                 std::memory_order_relaxed)) {
+            }
+        }
+
+        // The cache can trail a read cursor the producer moved forward
+        uint64_t write = m_writeCache;
+        if (write < read || write - read < count) {
+            write = m_writeCache = m_write.load(std::memory_order_acquire);
+        }
+
+        const size_t taken = static_cast<size_t>((std::min)(static_cast<uint64_t>(count), write - read));
+        if (out && taken > 0) {
+            const size_t offset = static_cast<size_t>(read) & m_mask;
+            const size_t first = (std::min)(taken, m_capacity - offset);
+            std::memcpy(out, m_data.get() + offset, first * sizeof(T));
+            std::memcpy(out + first, m_data.get(), (taken - first) * sizeof(T));
+        }
+
+        m_read.store(read + taken, std::memory_order_release);
+        m_consumed.fetch_add(taken, std::memory_order_relaxed);
+        return taken;
+    }
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    const size_t m_frameSize;
+    const RingOverflowPolicy m_policy;
+    const std::unique_ptr<T[]> m_data;
+
+    // Producer line: its cursor, its view of the consumer and its counters
+    alignas(64) std::atomic<uint64_t> m_write{ 0 };
+    uint64_t m_readCache = 0;
+    std::atomic<uint64_t> m_written{ 0 };
+    std::atomic<uint64_t> m_droppedOldest{ 0 };
+    std::atomic<uint64_t> m_droppedNewest{ 0 };
+    std::atomic<uint64_t> m_blockedWrites{ 0 };
+
+    // Consumer line
+    alignas(64) std::atomic<uint64_t> m_read{ 0 };
+    uint64_t m_writeCache = 0;
+    std::atomic<uint64_t> m_consumed{ 0 };
+
+    alignas(64) std::atomic<bool> m_closed{ false };
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "real_fft.h"
+
+enum class StftWindow {
+    Hann,
+    SqrtHann,       // Analysis and synthesis both; their product is a Hann window
+    Hamming
+};
+
+// Periodic window of `size` samples. Tables are computed once per shape and
+// size and shared for the life of the process.
+inline std::shared_ptr<const std::vector<float>> GetStftWindow(StftWindow shape, size_t size) {
+    static std::mutex mutex;
+    static std::map<std::pair<int, size_t>, std::shared_ptr<const std::vector<float>>> tables;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const std::vector<float>>& table = tables[{ static_cast<int>(shape), size }];
+    if (!table) {
+        const double pi = 3.14159265358979323846;
+        std::vector<float> window(size);
+        for (size_t n = 0; n < size; n++) {
+            const double phase = 2.0 * pi * static_cast<double>(n) / static_cast<double>(size);
+            switch (shape) {
+            case StftWindow::Hann:
+                window[n] = static_cast<float>(0.5 - 0.5 * std::cos(phase));
+                break;
+            case StftWindow::SqrtHann:
+                window[n] = static_cast<float>(std::sin(phase / 2.0));
+                break;
+            case StftWindow::Hamming:
+                window[n] = static_cast<float>(0.54 - 0.46 * std::cos(phase));
+                break;
+            }
+        }
+        table = std::make_shared<const std::vector<float>>(std::move(window));
+    }
+    return table;
+}
+
+// Streaming short-time Fourier transform of one channel, with weighted
+// overlap-add resynthesis.
+//
+// Samples go in one at a time (at any stride, so one channel of interleaved
+// audio can be processed in place) and come back LatencyFrames() later.
+// Every `hop` samples the last `frameSize` are windowed, zero-padded to the
+// next power of two and transformed; the caller edits the spectrum, which is
+// transformed back, windowed again and overlap-added. The synthesis window
+// is normalised position by position so that an untouched spectrum
+// reconstructs the input, whatever the pair of windows.
+//
+// Allocates only in the constructor. One thread at a time.
+class StftProcessor {
+public:
+    using Complex = RealFft::Complex;
+
+    // `hop` must divide `frameSize`; throws std::invalid_argument otherwise,
+    // or std::bad_alloc
+    StftProcessor(size_t frameSize, size_t hop, StftWindow analysis = StftWindow::SqrtHann,
+                  StftWindow synthesis = StftWindow::SqrtHann)
+        : m_frameSize(frameSize)
+        , m_hop(hop)
+        , m_fft(FftSizeFor(frameSize))
+        , m_analysis(GetStftWindow(analysis, frameSize))
+        , m_synthesis(frameSize)
+        , m_input(frameSize)
+        , m_output(frameSize)
+        , m_ready(hop)
+        , m_timeBuffer(m_fft.Size())
+        , m_spectrum(m_fft.Bins())
+        , m_fill(0) {
+        if (hop == 0 || frameSize % hop != 0) {
+            throw std::invalid_argument("STFT hop must divide the frame size");
+        }
+
+        // Overlapping analysis * synthesis products must sum to one
+        const std::vector<float>& synthesisWindow = *GetStftWindow(synthesis, frameSize);
+        const std::vector<float>& analysisWindow = *m_analysis;
+        for (size_t n = 0; n < hop; n++) {
+            double sum = 0.0;
+            for (size_t i = n; i < frameSize; i += hop) {
+                sum += static_cast<double>(analysisWindow[i]) * synthesisWindow[i];
+            }
+            if (sum < 1e-6) {
+                throw std::invalid_argument("STFT windows leave samples uncovered");
+            }
+            for (size_t i = n; i < frameSize; i += hop) {
+                m_synthesis[i] = static_cast<float>(synthesisWindow[i] / sum);
+            }
+        }
+        Reset();
+    }
+
+    size_t FrameSize() const { return m_frameSize; }
+    size_t HopSize() const { return m_hop; }
+    size_t Bins() const { return m_fft.Bins(); }
+    size_t FftSize() const { return m_fft.Size(); }
+    size_t LatencyFrames() const { return m_frameSize; }
+
+    void Reset() {
+        std::fill(m_input.begin(), m_input.end(), 0.0f);
+        std::fill(m_output.begin(), m_output.end(), 0.0f);
+        std::fill(m_ready.begin(), m_ready.end(), 0.0f);
+        m_fill = 0;
+    }
+
+    // Runs `count` samples spaced `stride` apart through the transform in
+    // place. Calls process(Complex* spectrum, size_t bins) once per hop.
+    template <typename ProcessSpectrum>
+    void Process(float* samples, size_t count, size_t stride, ProcessSpectrum&& process) {
+        const size_t collected = m_frameSize - m_hop;
+        for (size_t i = 0; i < count; i++) {
+            float& sample = samples[i * stride];
+            const float input = sample;
+            sample = m_ready[m_fill];
+            m_input[collected + m_fill] = input;
+            if (++m_fill == m_hop) {
+                ProcessFrame(process);
+                m_fill = 0;
+            }
+        }
+    }
+
+private:
+    static size_t FftSizeFor(size_t frameSize) {
+        size_t size = 4;
+        while (size < frameSize) {
+            size *= 2;
+        }
+        return size;
+    }
+
+    template <typename ProcessSpectrum>
+    void ProcessFrame(ProcessSpectrum& process) {
+        const std::vector<float>& analysis = *m_analysis;
+        for (size_t n = 0; n < m_frameSize; n++) {
+            m_timeBuffer[n] = m_input[n] * analysis[n];
+        }
+        std::fill(m_timeBuffer.begin() + m_frameSize, m_timeBuffer.end(), 0.0f);
+        m_fft.Forward(m_timeBuffer.data(), m_spectrum.data());
+
+        process(m_spectrum.data(), m_spectrum.size());
+
+        m_fft.Inverse(m_spectrum.data(), m_timeBuffer.data());
+        for (size_t n = 0; n < m_frameSize; n++) {
+            m_output[n] += m_timeBuffer[n] * m_synthesis[n];
+        }
+
+        // The first hop is now complete; it plays out while the next is
+        // collected. Both buffers slide along by one hop.
+        std::copy(m_output.begin(), m_output.begin() + m_hop, m_ready.begin());
+        std::copy(m_output.begin() + m_hop, m_output.end(), m_output.begin());
+        std::fill(m_output.end() - m_hop, m_output.end(), 0.0f);
+        std::copy(m_input.begin() + m_hop, m_input.end(), m_input.begin());
+    }
+
+    const size_t m_frameSize;
+    const size_t m_hop;
+    RealFft m_fft;
+    std::shared_ptr<const std::vector<float>> m_analysis;
+    std::vector<float> m_synthesis;          // Normalised for overlap-add
+    std::vector<float> m_input;              // The last frame; its final hop is being collected
+    std::vector<float> m_output;             // Overlap-add of the frames so far
+    std::vector<float> m_ready;              // Output played out while the hop is collected
+    std::vector<float> m_timeBuffer;         // FFT input and output
+    std::vector<Complex> m_spectrum;
+    size_t m_fill;                           // Samples of the current hop collected
+};
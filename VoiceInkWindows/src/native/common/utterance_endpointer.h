@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Tuning for UtteranceEndpointer. Durations are rounded to whole frames.
+struct EndpointerConfig {
+    uint32_t sampleRate = 16000;
+    uint32_t frameMs = 10;
+    float thresholdDb = 9.0f;           // Speech starts this far above the noise floor
+    float releaseDb = 6.0f;             // ...and continues while this far above it
+    float minLevelDb = -50.0f;          // Never speech below this level (dBFS)
+    uint32_t onsetMs = 60;              // Consecutive speech that opens an utterance
+    uint32_t hangoverMs = 300;          // Non-speech that closes it
+    uint32_t minSpeechMs = 250;         // Shorter utterances are discarded
+    uint32_t maxUtteranceMs = 20000;    // Longer ones are cut here and continue as a new one
+    uint32_t preSpeechMs = 200;         // Audio kept before the onset
+    uint32_t postSpeechMs = 150;        // Audio kept after the last speech frame
+
+    uint32_t FrameSamples() const { return (std::max<uint32_t>)(sampleRate * frameMs / 1000, 1); }
+
+    // While a push-to-talk key is held every word counts, and the pauses
+    // only pick where to cut: short utterances are kept, cuts come sooner,
+    // and pieces stay short so little is left to decode on release
+    static EndpointerConfig PushToTalk() {
+        EndpointerConfig config;
+        config.hangoverMs = 200;
+        config.minSpeechMs = 60;
+        config.maxUtteranceMs = 8000;
+        return config;
+    }
+};
+
+enum class EndpointEvent {
+    None,
+    Start,      // An utterance opened; it began at UtteranceStart()
+    End,        // The utterance closed at UtteranceEnd()
+    Discard     // The utterance closed but was too short to keep
+};
+
+// Start- and end-of-speech detection on a mono stream.
+//
+// Classifies fixed frames by energy against an adaptive noise floor, with
+// hysteresis between the start and release thresholds. An utterance opens
+// after `onsetMs` of consecutive speech and closes after `hangoverMs` of
+// non-speech, so short pauses between words do not split it. Positions are
+// sample offsets from the last Reset(); the caller keeps the audio and cuts
+// the utterance from them, including the pre- and post-speech padding.
+//
+// Runs on one thread; allocation-free.
+class UtteranceEndpointer {
+public:
+    explicit UtteranceEndpointer(const EndpointerConfig& config = EndpointerConfig())
+        : m_config(config)
+        , m_frameSamples(config.FrameSamples())
+        , m_onsetFrames(FramesFor(config.onsetMs))
+        , m_hangoverFrames(FramesFor(config.hangoverMs))
+        , m_minSpeechSamples(SamplesFor(config.minSpeechMs))
+        , m_maxUtteranceSamples((std::max<uint64_t>)(SamplesFor(config.maxUtteranceMs), m_frameSamples))
+        , m_preSpeechSamples(SamplesFor(config.preSpeechMs))
+        , m_postSpeechSamples(SamplesFor((std::min)(config.postSpeechMs, config.hangoverMs))) {}
+
+    const EndpointerConfig& Config() const { return m_config; }
+    size_t FrameSamples() const { return m_frameSamples; }
+
+    void Reset() {
+        m_position = 0;
+        m_noiseFloorDb = kSilenceDb;
+        m_calibrated = false;
+        m_inUtterance = false;
+        m_continuation = false;
+        m_speechRun = 0;
+        m_silenceRun = 0;
+    }
+
+    // Classifies one frame of FrameSamples() samples that follows everything
+    // passed so far.
+    EndpointEvent ProcessFrame(const float* samples) {
+        const uint64_t frameStart = m_position;
+        m_position += m_frameSamples;
+
+        const float levelDb = FrameLevelDb(samples);
+        const bool speech = IsSpeech(levelDb);
+        UpdateNoiseFloor(levelDb, speech);
+
+        if (!m_inUtterance) {
+            m_speechRun = speech ? m_speechRun + 1 : 0;
+            // An utterance cut at the length limit continues without
+            // another onset or padding if the speech does
+            if (m_continuation) {
+                m_continuation = false;
+                if (speech) {
+                    return Open(frameStart, frameStart);
+                }
+            }
+            if (m_speechRun >= m_onsetFrames) {
+                const uint64_t onset = frameStart + m_frameSamples - m_speechRun * m_frameSamples;
+                return Open(onset, onset - (std::min)(onset, m_preSpeechSamples));
+            }
+            return EndpointEvent::None;
+        }
+
+        if (speech) {
+            m_silenceRun = 0;
+            m_lastSpeechEnd = m_position;
+        } else if (++m_silenceRun >= m_hangoverFrames) {
+            return Close((std::min)(m_lastSpeechEnd + m_postSpeechSamples, m_position));
+        }
+
+        if (m_position - m_utteranceStart >= m_maxUtteranceSamples) {
+            const EndpointEvent event = Close(m_position);
+            m_continuation = speech;
+            return event;
+        }
+        return EndpointEvent::None;
+    }
+
+    // End of stream: closes an open utterance at the current position.
+    EndpointEvent Finish() {
+        m_continuation = false;
+        m_speechRun = 0;
+        if (!m_inUtterance) {
+            return EndpointEvent::None;
+        }
+        return Close((std::min)(m_lastSpeechEnd + m_postSpeechSamples, m_position));
+    }
+
+    bool InUtterance() const { return m_inUtterance; }
+    uint64_t Position() const { return m_position; }
+    uint64_t UtteranceStart() const { return m_utteranceStart; }
+    uint64_t UtteranceEnd() const { return m_utteranceEnd; }
+    float NoiseFloorDb() const { return m_noiseFloorDb; }
+
+private:
+    static constexpr float kSilenceDb = -100.0f;
+
+    uint32_t FramesFor(uint32_t ms) const {
+        return (std::max<uint32_t>)((ms + m_config.frameMs / 2) / (std::max<uint32_t>)(m_config.frameMs, 1), 1);
+    }
+    uint64_t SamplesFor(uint32_t ms) const { return static_cast<uint64_t>(ms) * m_config.sampleRate / 1000; }
+
+    float FrameLevelDb(const float* samples) const {
+        float sumSquares = 0.0f;
+        for (size_t i = 0; i < m_frameSamples; ++i) {
+            sumSquares += samples[i] * samples[i];
+        }
+        const float meanSquare = sumSquares / static_cast<float>(m_frameSamples);
+        return meanSquare > 1e-10f ? 10.0f * std::log10(meanSquare) : kSilenceDb;
+    }
+
+    bool IsSpeech(float levelDb) const {
+        if (levelDb < m_config.minLevelDb) {
+            return false;
+        }
+        if (!m_calibrated) {
+            return false; // The first frame only calibrates
+        }
+        const float margin = m_inUtterance ? m_config.releaseDb : m_config.thresholdDb;
+        return levelDb > m_noiseFloorDb + margin;
+    }
+
+    // Falls to quiet frames quickly and creeps up slowly otherwise, so
+    // steady background noise is learned but speech does not pull the floor up
+    void UpdateNoiseFloor(float levelDb, bool speech) {
+        if (!m_calibrated) {
+            m_noiseFloorDb = levelDb;
+            m_calibrated = true;
+            return;
+        }
+        if (levelDb < m_noiseFloorDb) {
+            m_noiseFloorDb += 0.5f * (levelDb - m_noiseFloorDb);
+        } else if (!speech) {
+            m_noiseFloorDb += 0.02f * (levelDb - m_noiseFloorDb);
+        } else {
+            m_noiseFloorDb += 0.002f * (levelDb - m_noiseFloorDb);
+        }
+    }
+
+    EndpointEvent Open(uint64_t onset, uint64_t start) {
+        m_inUtterance = true;
+        m_utteranceStart = start;
+        m_speechStart = onset;
+        m_lastSpeechEnd = m_position;
+        m_speechRun = 0;
+        m_silenceRun = 0;
+        return EndpointEvent::Start;
+    }
+
+    EndpointEvent Close(uint64_t end) {
+        m_inUtterance = false;
+        m_utteranceEnd = end;
+        m_speechRun = 0;
+        m_silenceRun = 0;
+        return m_lastSpeechEnd - m_speechStart >= m_minSpeechSamples ? EndpointEvent::End : EndpointEvent::Discard;
+    }
+
+    const EndpointerConfig m_config;
+    const size_t m_frameSamples;
+    const uint32_t m_onsetFrames;
+    const uint32_t m_hangoverFrames;
+    const uint64_t m_minSpeechSamples;
+    const uint64_t m_maxUtteranceSamples;
+    const uint64_t m_preSpeechSamples;
+    const uint64_t m_postSpeechSamples;
+
+    uint64_t m_position = 0;
+    float m_noiseFloorDb = kSilenceDb;
+    bool m_calibrated = false;
+    bool m_inUtterance = false;
+    bool m_continuation = false;        // The last utterance was cut at the length limit
+    uint32_t m_speechRun = 0;
+    uint32_t m_silenceRun = 0;
+    uint64_t m_utteranceStart = 0;
+    uint64_t m_speechStart = 0;
+    uint64_t m_lastSpeechEnd = 0;
+    uint64_t m_utteranceEnd = 0;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Native hand-off of finished utterances from the capture addon to the
+// transcription addon.
+//
+// The two addons are separate shared libraries, so they share nothing but
+// this plain C interface. The transcription side creates a sink and hands
+// it to JS as an External tagged with VOICEINK_UTTERANCE_SINK_TAG; JS passes
+// that External to the recorder, which copies the struct, retains the
+// context and submits utterances on its endpointing thread. Audio never
+// passes through JS.
+
+#define VOICEINK_UTTERANCE_SINK_VERSION 1u
+
+// napi_type_tag for the External that carries a VoiceInkUtteranceSink
+#define VOICEINK_UTTERANCE_SINK_TAG_LOWER 0x5a3c1e9b7d2f4a61ull
+#define VOICEINK_UTTERANCE_SINK_TAG_UPPER 0x8e4b6d0f2c7a9135ull
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct VoiceInkUtterance {
+    const float* samples;           // Mono
+    size_t frameCount;
+    uint32_t sampleRate;
+    double startTime;               // Capture timestamps, in seconds
+    double endTime;
+    uint64_t sequence;              // Increments per utterance of one session
+    uint64_t session;               // One recording; unique within the process
+    // Owns `samples`. The sink takes ownership on submit, accepted or not,
+    // and calls releaseSamples(samplesOwner) exactly once, from any thread,
+    // when it no longer needs them.
+    void* samplesOwner;
+    void (*releaseSamples)(void* samplesOwner);
+} VoiceInkUtterance;
+
+typedef struct VoiceInkUtteranceSink {
+    uint32_t version;               // VOICEINK_UTTERANCE_SINK_VERSION
+    uint32_t size;                  // sizeof(VoiceInkUtteranceSink)
+    void* context;
+    // Must not block for long. Returns nonzero if the utterance was queued
+    // and writes a NUL-terminated job id into `jobId` if there is room.
+    int (*submit)(void* context, const VoiceInkUtterance* utterance, char* jobId, size_t jobIdSize);
+    void (*retain)(void* context);
+    void (*release)(void* context);
+    // The session's last utterance has been submitted; `utteranceCount`
+    // were submitted in all. Called once per session, from the same thread
+    // as submit, even if nothing was submitted.
+    void (*endSession)(void* context, uint64_t session, uint64_t utteranceCount);
+} VoiceInkUtteranceSink;
+
+#ifdef __cplusplus
+}
+
+#include <string>
+#include <utility>
+
+// Counted reference to a sink; copies retain, destruction releases.
+class UtteranceSinkRef {
+public:
+    UtteranceSinkRef() = default;
+
+    // Fails (leaving the reference empty) if `sink` is from an incompatible build
+    explicit UtteranceSinkRef(const VoiceInkUtteranceSink* sink) {
+        if (sink && sink->version == VOICEINK_UTTERANCE_SINK_VERSION && sink->size >= sizeof(VoiceInkUtteranceSink) &&
+            sink->submit && sink->retain && sink->release && sink->endSession) {
+            m_sink = *sink;
+            m_sink.retain(m_sink.context);
+            m_valid = true;
+        }
+    }
+
+    UtteranceSinkRef(const UtteranceSinkRef& other) : m_sink(other.m_sink), m_valid(other.m_valid) {
+        if (m_valid) {
+            m_sink.retain(m_sink.context);
+        }
+    }
+
+    UtteranceSinkRef& operator=(UtteranceSinkRef other) {
+        std::swap(m_sink, other.m_sink);
+        std::swap(m_valid, other.m_valid);
+        return *this;
+    }
+
+    ~UtteranceSinkRef() {
+        if (m_valid) {
+            m_sink.release(m_sink.context);
+        }
+    }
+
+    explicit operator bool() const { return m_valid; }
+
+    // Hands `utterance` and its samples to the sink; returns the job id, or
+    // an empty string if the sink refused it
+    std::string Submit(const VoiceInkUtterance& utterance) const {
+        if (!m_valid) {
+            utterance.releaseSamples(utterance.samplesOwner);
+            return std::string();
+        }
+        char jobId[64] = {};
+        if (!m_sink.submit(m_sink.context, &utterance, jobId, sizeof(jobId))) {
+            return std::string();
+        }
+        return jobId;
+    }
+
+    void EndSession(uint64_t session, uint64_t utteranceCount) const {
+        if (m_valid) {
+            m_sink.endSession(m_sink.context, session, utteranceCount);
+        }
+    }
+
+private:
+    VoiceInkUtteranceSink m_sink = {};
+    bool m_valid = false;
+};
+#endif
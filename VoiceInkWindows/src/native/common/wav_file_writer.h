@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "recording_file_writer.h"
+
+// Writes a recording as WAV, switching to RF64 past 4 GiB.
+//
+// Data goes out in page multiples: when kWriteBytes have gathered, and on
+// every flush. The header takes one page, so every write lands on a page
+// boundary, and it is rewritten after each flush. A process that dies
+// mid-recording therefore leaves a playable file missing at most the last
+// interval, and Recover() restores whatever reached the OS after the last
+// header update.
+//
+// For RF64 the JUNK chunk reserved right after WAVE becomes a ds64 chunk
+// holding the 64-bit sizes.
+class WavFileWriter : public RecordingFileWriter {
+public:
+    static constexpr size_t kHeaderBytes = 4096;
+    static constexpr size_t kPageBytes = 4096;
+    static constexpr size_t kWriteBytes = 256 * 1024;
+
+    ~WavFileWriter() override { Close(); }
+
+    // Repairs the header of a WAV or RF64 file whose writer never finished,
+    // such as a recording interrupted by a crash: the sizes are set from the
+    // file length, a trailing partial frame is cut off, and a file past 4 GiB
+    // becomes RF64 if it has a JUNK chunk to hold the sizes. The data chunk
+    // must be the last one, as recorders leave it. Returns the PCM bytes kept.
+    static bool Recover(const std::string& path, uint64_t& dataBytes, std::string& error) {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        if (!file) {
+            error = "Cannot open " + path;
+            return false;
+        }
+
+        uint8_t riff[12];
+        if (!file.read(reinterpret_cast<char*>(riff), sizeof(riff)) || std::memcmp(riff + 8, "WAVE", 4) != 0 ||
+            (std::memcmp(riff, "RIFF", 4) != 0 && std::memcmp(riff, "RF64", 4) != 0)) {
+            error = "Not a RIFF/WAVE file: " + path;
+            return false;
+        }
+
+        // Walk the chunks up to the data, noting where a ds64 chunk could go
+        uint64_t junkOffset = 0;
+        uint16_t blockAlign = 0;
+        uint64_t dataOffset = 0;
+        uint8_t header[8];
+        while (file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+            const uint64_t offset = static_cast<uint64_t>(file.tellg()) - sizeof(header);
+            const uint32_t size = ReadLE32(header + 4);
+            if (std::memcmp(header, "data", 4) == 0) {
+                dataOffset = offset + sizeof(header);
+                break;
+            }
+            if (offset == 12 && size >= kDs64Bytes &&
+                (std::memcmp(header, "JUNK", 4) == 0 || std::memcmp(header, "ds64", 4) == 0)) {
+                junkOffset = offset;
+            } else if (std::memcmp(header, "fmt ", 4) == 0 && size >= 16) {
+                uint8_t fmt[16];
+                if (!file.read(reinterpret_cast<char*>(fmt), sizeof(fmt))) {
+                    break;
+                }
+                blockAlign = ReadLE16(fmt + 12);
+            }
+            file.seekg(static_cast<std::streamoff>(offset + sizeof(header) + size + (size & 1)));
+        }
+        if (dataOffset == 0 || blockAlign == 0) {
+            error = blockAlign == 0 ? "No usable fmt chunk in " + path : "No data chunk in " + path;
+            return false;
+        }
+
+        file.clear();
+        file.seekg(0, std::ios::end);
+        const uint64_t length = static_cast<uint64_t>(file.tellg());
+        dataBytes = (length - dataOffset) / blockAlign * blockAlign;
+        const uint64_t riffBytes = dataOffset + dataBytes - 8;
+        const bool rf64 = riffBytes > UINT32_MAX;
+        if (rf64 && junkOffset == 0) {
+            error = "Recording too large for a RIFF header and no room for RF64: " + path;
+            return false;
+        }
+
+        uint8_t patch[4];
+        if (rf64) {
+            uint8_t ds64[8 + kDs64Bytes] = {};
+            std::memcpy(ds64, "ds64", 4);
+            WriteLE32(ds64 + 4, kDs64Bytes);
+            WriteLE64(ds64 + 8, riffBytes);
+            WriteLE64(ds64 + 16, dataBytes);
+            WriteLE64(ds64 + 24, dataBytes / blockAlign);
+            file.seekp(static_cast<std::streamoff>(junkOffset));
+            file.write(reinterpret_cast<const char*>(ds64), sizeof(ds64));
+            file.seekp(0);
+            file.write("RF64", 4);
+        } else {
+            file.seekp(0);
+            file.write("RIFF", 4);
+            if (junkOffset != 0) {
+                // A stale ds64 would contradict the RIFF sizes
+                file.seekp(static_cast<std::streamoff>(junkOffset));
+                file.write("JUNK", 4);
+            }
+        }
+        WriteLE32(patch, rf64 ? UINT32_MAX : static_cast<uint32_t>(riffBytes));
+        file.seekp(4);
+        file.write(reinterpret_cast<const char*>(patch), sizeof(patch));
+        WriteLE32(patch, rf64 ? UINT32_MAX : static_cast<uint32_t>(dataBytes));
+        file.seekp(static_cast<std::streamoff>(dataOffset - 4));
+        file.write(reinterpret_cast<const char*>(patch), sizeof(patch));
+        file.close();
+        if (!file) {
+            error = "Cannot write to " + path;
+            return false;
+        }
+
+        if (dataOffset + dataBytes < length) {
+            std::error_code ec;
+            std::filesystem::resize_file(path, dataOffset + dataBytes, ec);
+        }
+        return true;
+    }
+
+protected:
+    bool Begin(const RecordingFileFormat& format, std::string&) override {
+        m_staging.assign(kWriteBytes, 0);
+        m_header.assign(kHeaderBytes, 0);
+        m_fill = 0;
+        m_dataBytes = 0;
+        m_headerDataBytes = 0;
+        m_bytesPerFrame = static_cast<uint16_t>(format.BytesPerFrame());
+        return WriteHeader();
+    }
+
+    bool Drain(bool due) override {
+        m_fill += ReadSource(m_staging.data() + m_fill, m_staging.size() - m_fill);
+        if (m_fill == m_staging.size() || (due && m_fill >= kPageBytes)) {
+            const size_t pages = m_fill - m_fill % kPageBytes;
+            if (!WriteData(m_staging.data(), pages)) {
+                return false;
+            }
+            std::memmove(m_staging.data(), m_staging.data() + pages, m_fill - pages);
+            m_fill -= pages;
+        }
+        if (due && m_dataBytes != m_headerDataBytes) {
+            return WriteHeader();
+        }
+        return true;
+    }
+
+    bool Finish() override {
+        // The tail, less than a page once the ring is empty, goes out unaligned
+        do {
+            m_fill += ReadSource(m_staging.data() + m_fill, m_staging.size() - m_fill);
+            if (!WriteData(m_staging.data(), m_fill)) {
+                return false;
+            }
+            m_fill = 0;
+        } while (SourceAvailable() > 0);
+        return WriteHeader();
+    }
+
+private:
+    static constexpr uint32_t kDs64Bytes = 28;      // RIFF size, data size, frame count, empty table
+
+    static uint16_t ReadLE16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+    static uint32_t ReadLE32(const uint8_t* p) {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+    static void WriteLE16(uint8_t* p, uint16_t value) {
+        p[0] = static_cast<uint8_t>(value);
+        p[1] = static_cast<uint8_t>(value >> 8);
+    }
+    static void WriteLE32(uint8_t* p, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            p[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+    static void WriteLE64(uint8_t* p, uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            p[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    // RIFF (or RF64), the reserved JUNK/ds64 chunk, fmt, JUNK padding to
+    // the page, and the data chunk header, for `m_dataBytes` of PCM
+    bool WriteHeader() {
+        const RecordingFileFormat& format = Format();
+        uint8_t* h = m_header.data();
+        std::fill(m_header.begin(), m_header.end(), 0);
+        const uint64_t riffBytes = kHeaderBytes - 8 + m_dataBytes;
+        const bool rf64 = riffBytes > UINT32_MAX;
+        const uint16_t bytesPerFrame = m_bytesPerFrame;
+
+        std::memcpy(h, rf64 ? "RF64" : "RIFF", 4);
+        WriteLE32(h + 4, rf64 ? UINT32_MAX : static_cast<uint32_t>(riffBytes));
+        std::memcpy(h + 8, "WAVE", 4);
+
+        std::memcpy(h + 12, rf64 ? "ds64" : "JUNK", 4);
+        WriteLE32(h + 16, kDs64Bytes);
+        if (rf64) {
+            WriteLE64(h + 20, riffBytes);
+            WriteLE64(h + 28, m_dataBytes);
+            WriteLE64(h + 36, m_dataBytes / bytesPerFrame);
+        }
+
+        uint8_t* fmt = h + 20 + kDs64Bytes;
+        std::memcpy(fmt, "fmt ", 4);
+        WriteLE32(fmt + 4, 16);
+        WriteLE16(fmt + 8, format.encoding == SampleEncoding::Float32 ? kWaveFormatIeeeFloat : kWaveFormatPcm);
+        WriteLE16(fmt + 10, format.channels);
+        WriteLE32(fmt + 12, format.sampleRate);
+        WriteLE32(fmt + 16, format.sampleRate * bytesPerFrame);
+        WriteLE16(fmt + 20, bytesPerFrame);
+        WriteLE16(fmt + 22, static_cast<uint16_t>(bytesPerFrame / format.channels * 8));
+
+        uint8_t* padding = fmt + 24;
+        std::memcpy(padding, "JUNK", 4);
+        WriteLE32(padding + 4, static_cast<uint32_t>(h + kHeaderBytes - 8 - (padding + 8)));
+
+        std::memcpy(h + kHeaderBytes - 8, "data", 4);
+        WriteLE32(h + kHeaderBytes - 4, rf64 ? UINT32_MAX : static_cast<uint32_t>(m_dataBytes));
+
+        if (!Overwrite(0, h, kHeaderBytes)) {
+            return false;
+        }
+        m_headerDataBytes = m_dataBytes;
+        SetRf64(rf64);
+        CountHeaderUpdate();
+        return true;
+    }
+
+    bool WriteData(const uint8_t* data, size_t bytes) {
+        if (!Append(data, bytes)) {
+            return false;
+        }
+        m_dataBytes += bytes;
+        return true;
+    }
+
+    std::vector<uint8_t> m_staging;                  // Writer thread: data waiting for a whole page
+    std::vector<uint8_t> m_header;
+    size_t m_fill = 0;
+    uint64_t m_dataBytes = 0;                        // PCM on disk
+    uint64_t m_headerDataBytes = 0;                  // As the header last said
+    uint16_t m_bytesPerFrame = 0;
+};
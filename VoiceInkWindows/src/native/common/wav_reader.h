@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "sample_format_converter.h"
+
+// Streams sample frames out of a RIFF/WAVE or RF64 file.
+//
+// Accepts the encodings the capture path converts (16/24/32-bit PCM and
+// 32-bit float, plain or WAVE_FORMAT_EXTENSIBLE) and skips any chunks it
+// does not need. Frames are read straight into caller-owned memory, so
+// replaying a file on the capture thread does not allocate.
+class WavReader {
+public:
+    bool Open(const std::string& path, std::string& error) {
+        m_file.close();
+        m_file.clear();
+        m_file.open(path, std::ios::binary);
+        if (!m_file) {
+            error = "Cannot open " + path;
+            return false;
+        }
+
+        char riff[12];
+        if (!m_file.read(riff, sizeof(riff)) || std::memcmp(riff + 8, "WAVE", 4) != 0 ||
+            (std::memcmp(riff, "RIFF", 4) != 0 && std::memcmp(riff, "RF64", 4) != 0)) {
+            error = "Not a RIFF/WAVE file: " + path;
+            return false;
+        }
+
+        bool haveFormat = false;
+        uint64_t ds64DataSize = 0;      // RF64 keeps the real data size here
+        char header[8];
+        while (m_file.read(header, sizeof(header))) {
+            const uint32_t size = ReadLE32(reinterpret_cast<const uint8_t*>(header + 4));
+            const std::streamoff padded = size + (size & 1);
+
+            if (std::memcmp(header, "ds64", 4) == 0) {
+                uint8_t ds64[16];
+                if (size < 16 || !m_file.read(reinterpret_cast<char*>(ds64), sizeof(ds64))) {
+                    error = "Truncated ds64 chunk";
+                    return false;
+                }
+                ds64DataSize = ReadLE32(ds64 + 8) | (uint64_t(ReadLE32(ds64 + 12)) << 32);
+                m_file.seekg(padded - 16, std::ios::cur);
+            } else if (std::memcmp(header, "fmt ", 4) == 0) {
+                uint8_t fmt[40] = {};
+                if (size < 16 || !m_file.read(reinterpret_cast<char*>(fmt), (std::min<uint32_t>)(size, sizeof(fmt)))) {
+                    error = "Truncated fmt chunk";
+                    return false;
+                }
+                m_file.seekg(padded - (std::min<uint32_t>)(size, sizeof(fmt)), std::ios::cur);
+
+                const uint16_t formatTag = ReadLE16(fmt);
+                const uint16_t channels = ReadLE16(fmt + 2);
+                m_sampleRate = ReadLE32(fmt + 4);
+                const uint16_t blockAlign = ReadLE16(fmt + 12);
+                const uint16_t bitsPerSample = ReadLE16(fmt + 14);
+                // WAVEFORMATEXTENSIBLE: the SubFormat GUID starts at byte 24
+                const uint32_t subFormatTag = formatTag == kWaveFormatExtensible && size >= 40 ? ReadLE32(fmt + 24) : 0;
+                m_format = SampleFormatFromWave(formatTag, channels, bitsPerSample, blockAlign, subFormatTag);
+                if (!m_format.Valid() || m_sampleRate == 0) {
+                    error = "Unsupported WAV format: tag " + std::to_string(formatTag) + ", " +
+                            std::to_string(bitsPerSample) + " bits";
+                    return false;
+                }
+                haveFormat = true;
+            } else if (std::memcmp(header, "data", 4) == 0) {
+                if (!haveFormat) {
+                    error = "data chunk before fmt chunk";
+                    return false;
+                }
+                m_dataStart = m_file.tellg();
+                // Recorders that crash leave a zero or oversized length; trust the file size
+                m_file.seekg(0, std::ios::end);
+                const std::streamoff available = m_file.tellg() - m_dataStart;
+                const uint64_t length = size == UINT32_MAX && ds64DataSize != 0 ? ds64DataSize : size;
+                const std::streamoff declared = length == 0 ? available
+                    : (std::min<std::streamoff>)(static_cast<std::streamoff>(length), available);
+                m_frameCount = static_cast<uint64_t>(declared) / m_format.BytesPerFrame();
+                return Rewind();
+            } else {
+                m_file.seekg(padded, std::ios::cur);
+            }
+        }
+
+        error = "No data chunk in " + path;
+        return false;
+    }
+
+    const SampleFormat& Format() const { return m_format; }
+    uint32_t SampleRate() const { return m_sampleRate; }
+    uint64_t FrameCount() const { return m_frameCount; }
+    uint64_t Position() const { return m_position; }
+
+    // Reads up to `frames` frames into `dst`; returns the number read, 0 at the end
+    size_t ReadFrames(uint8_t* dst, size_t frames) {
+        const size_t count = static_cast<size_t>((std::min<uint64_t>)(frames, m_frameCount - m_position));
+        if (count == 0 || !m_file.read(reinterpret_cast<char*>(dst), count * m_format.BytesPerFrame())) {
+            return 0;
+        }
+        m_position += count;
+        return count;
+    }
+
+    bool Rewind() {
+        m_file.clear();
+        m_file.seekg(m_dataStart);
+        m_position = 0;
+        return static_cast<bool>(m_file);
+    }
+
+private:
+    static uint16_t ReadLE16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+    static uint32_t ReadLE32(const uint8_t* p) {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    std::ifstream m_file;
+    SampleFormat m_format;
+    uint32_t m_sampleRate = 0;
+    uint64_t m_frameCount = 0;
+    uint64_t m_position = 0;
+    std::streamoff m_dataStart = 0;
+};
@@ -0,0 +1,174 @@
+#include "echo_reference_stage.h"
+#include <algorithm>
+
+constexpr uint32_t REFERENCE_RING_MS = 1000;
+constexpr size_t MAX_SYNCHRONOUS_READS = 64;
+
+EchoReferenceStage::EchoReferenceStage(std::unique_ptr<CaptureSource> source)
+    : m_source(std::move(source))
+    , m_maxBacklog(0)
+    , m_realtime(true)
+    , m_running(false)
+    , m_ended(false)
+    , m_shouldStop(false)
+    , m_pulledFrames(0)
+    , m_underrunFrames(0)
+    , m_droppedFrames(0)
+{
+}
+
+EchoReferenceStage::~EchoReferenceStage() {
+    stop();
+}
+
+bool EchoReferenceStage::open(uint32_t bufferSizeMs) {
+    if (!m_source->open(bufferSizeMs)) {
+        m_lastError = m_source->getLastError();
+        return false;
+    }
+    return true;
+}
+
+bool EchoReferenceStage::prepare(uint32_t sampleRate, size_t maxPullFrames) {
+    m_format = m_source->format();
+    m_converter = SelectSampleConverter(m_format.sample);
+    if (!m_converter.Valid() || m_format.sampleRate == 0 || m_format.maxPacketFrames == 0) {
+        m_lastError = "Unsupported echo reference format";
+        return false;
+    }
+    m_realtime = m_source->isRealtime();
+
+    CaptureOutputFormat output;
+    output.sampleRate = sampleRate;
+    output.downmix = DownmixMode::Average;
+    try {
+        m_formatStage = std::make_unique<CaptureFormatStage>(m_format.sample.channels, m_format.sampleRate, output);
+        m_sourceSamples.assign(static_cast<size_t>(m_format.maxPacketFrames) * m_formatStage->InputChannels(), 0.0f);
+        const size_t packetFrames = m_formatStage->MaxOutputFrames(m_format.maxPacketFrames);
+        m_converted.assign(packetFrames, 0.0f);
+        // One reference packet may arrive just ahead of the microphone packet
+        // it belongs to; anything beyond that is stale
+        m_maxBacklog = packetFrames;
+        const size_t ringFrames = std::max<size_t>(static_cast<size_t>(sampleRate) * REFERENCE_RING_MS / 1000,
+                                                   4 * (maxPullFrames + packetFrames));
+        m_ring = std::make_unique<SpscRingBuffer<float>>(ringFrames, RingOverflowPolicy::DropOldest);
+    } catch (const std::bad_alloc&) {
+        m_lastError = "Failed to allocate the echo reference buffers";
+        return false;
+    }
+    return true;
+}
+
+bool EchoReferenceStage::start() {
+    if (m_running) {
+        return true;
+    }
+    if (!m_ring) {
+        m_lastError = "Echo reference not prepared";
+        return false;
+    }
+    if (!m_source->start()) {
+        m_lastError = m_source->getLastError();
+        return false;
+    }
+
+    m_ring->Clear();
+    m_pulledFrames = 0;
+    m_underrunFrames = 0;
+    m_droppedFrames = 0;
+    m_ended = false;
+    m_shouldStop = false;
+    m_running = true;
+    if (m_realtime) {
+        m_reader = std::thread(&EchoReferenceStage::run, this);
+    }
+    return true;
+}
+
+void EchoReferenceStage::stop() {
+    if (!m_running) {
+        return;
+    }
+    m_shouldStop = true;
+    if (m_reader.joinable()) {
+        m_reader.join();
+    }
+    m_source->stop();
+    m_running = false;
+}
+
+void EchoReferenceStage::onCaptureThreadStart() {
+    if (m_running && !m_realtime) {
+        m_source->onCaptureThreadStart();
+    }
+}
+
+void EchoReferenceStage::onCaptureThreadStop() {
+    if (m_running && !m_realtime) {
+        m_source->onCaptureThreadStop();
+    }
+}
+
+void EchoReferenceStage::pull(float* out, size_t frameCount) {
+    if (!m_realtime) {
+        // Read just far enough to cover the microphone
+        for (size_t reads = 0; reads < MAX_SYNCHRONOUS_READS && !m_ended && m_ring->Available() < frameCount; reads++) {
+            readPacket();
+        }
+    } else {
+        const size_t available = m_ring->Available();
+        if (available > frameCount + m_maxBacklog) {
+            m_droppedFrames += m_ring->Discard(available - frameCount - m_maxBacklog);
+        }
+    }
+
+    const size_t read = m_ring->Read(out, frameCount);
+    std::fill(out + read, out + frameCount, 0.0f);
+    m_pulledFrames += frameCount;
+    m_underrunFrames += frameCount - read;
+}
+
+EchoReferenceStage::Stats EchoReferenceStage::stats() const {
+    Stats stats;
+    stats.pulledFrames = m_pulledFrames;
+    stats.underrunFrames = m_underrunFrames;
+    stats.droppedFrames = m_droppedFrames + (m_ring ? m_ring->Stats().droppedOldest : 0);
+    return stats;
+}
+
+void EchoReferenceStage::run() {
+    m_source->onCaptureThreadStart();
+    while (!m_shouldStop && readPacket()) {
+    }
+    m_source->onCaptureThreadStop();
+}
+
+bool EchoReferenceStage::readPacket() {
+    CapturePacket packet;
+    const CaptureReadStatus status = m_source->readPacket(packet);
+    if (status == CaptureReadStatus::Timeout) {
+        return true;
+    }
+    if (status != CaptureReadStatus::Packet) {
+        // Failed or exhausted; the canceller carries on with silence
+        m_ended = true;
+        return false;
+    }
+
+    const size_t sourceChannels = m_formatStage->InputChannels();
+    const size_t bytesPerFrame = m_converter.Format().BytesPerFrame();
+    const size_t packetFrames = m_sourceSamples.size() / sourceChannels;
+    for (size_t offset = 0; packet.data && offset < packet.frameCount;) {
+        const size_t frames = std::min<size_t>(packet.frameCount - offset, packetFrames);
+        if (packet.silent) {
+            std::fill(m_sourceSamples.begin(), m_sourceSamples.begin() + frames * sourceChannels, 0.0f);
+        } else {
+            m_converter.Convert(packet.data + offset * bytesPerFrame, m_sourceSamples.data(), frames);
+        }
+        offset += frames;
+        const size_t converted = m_formatStage->Process(m_sourceSamples.data(), frames, m_converted.data());
+        m_ring->Write(m_converted.data(), converted);
+    }
+    m_source->releasePacket(packet);
+    return true;
+}
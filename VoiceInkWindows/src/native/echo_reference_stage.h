@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture_format_stage.h"
+#include "capture_source.h"
+#include "sample_format_converter.h"
+#include "spsc_ring_buffer.h"
+
+// Supplies the echo canceller's far-end reference: what the speakers play,
+// from a second CaptureSource (WASAPI loopback, or a file or synthetic
+// signal for tests), converted to mono at the capture output rate.
+//
+// A real-time reference runs on its own reader thread, which converts each
+// packet and writes it into a lock-free ring; the capture thread pull()s as
+// many frames as the microphone packet it is processing, zero-filling what
+// has not arrived and dropping backlog beyond one packet so the two streams
+// stay close. Whatever offset remains is the echo canceller's bulk delay to
+// find. An unclocked reference (file replay, benchmarks) is read on the
+// capture thread itself, exactly as far as the microphone has got, so an
+// unclocked pair stays sample-aligned however fast it runs.
+class EchoReferenceStage {
+public:
+    struct Stats {
+        uint64_t pulledFrames = 0;
+        uint64_t underrunFrames = 0;    // Zero-filled because the reference was late or ended
+        uint64_t droppedFrames = 0;     // Backlog dropped, or lost to a full ring
+    };
+
+    explicit EchoReferenceStage(std::unique_ptr<CaptureSource> source);
+    ~EchoReferenceStage();
+
+    EchoReferenceStage(const EchoReferenceStage&) = delete;
+    EchoReferenceStage& operator=(const EchoReferenceStage&) = delete;
+
+    // JS thread, while stopped. open() fixes the source format; prepare()
+    // allocates everything for references pulled at `sampleRate` in pieces
+    // of up to `maxPullFrames`. Both return false with getLastError() set.
+    bool open(uint32_t bufferSizeMs);
+    bool prepare(uint32_t sampleRate, size_t maxPullFrames);
+    bool start();
+    void stop();
+
+    CaptureSource* source() const { return m_source.get(); }
+    bool isRealtime() const { return m_realtime; }
+
+    // Capture thread, around the capture loop
+    void onCaptureThreadStart();
+    void onCaptureThreadStop();
+    // Capture thread. Fills `out` with the next `frameCount` mono frames.
+    // Never blocks or allocates.
+    void pull(float* out, size_t frameCount);
+
+    // Safe from any thread
+    Stats stats() const;
+    std::string getLastError() const { return m_lastError; }
+
+private:
+    void run();
+    // Reads and converts one packet into m_ring; false once the source has
+    // nothing more to give
+    bool readPacket();
+
+    std::unique_ptr<CaptureSource> m_source;
+    CaptureSourceFormat m_format;
+    SampleConverter m_converter;
+    std::unique_ptr<CaptureFormatStage> m_formatStage;   // To mono at the output rate
+    std::unique_ptr<SpscRingBuffer<float>> m_ring;
+    std::vector<float> m_sourceSamples;                  // One converted packet, source format
+    std::vector<float> m_converted;                      // The same packet, output format
+    size_t m_maxBacklog;                                 // Frames kept beyond one pull
+    bool m_realtime;
+    bool m_running;
+
+    std::atomic<bool> m_ended;
+    std::atomic<bool> m_shouldStop;
+    std::thread m_reader;
+
+    std::atomic<uint64_t> m_pulledFrames;
+    std::atomic<uint64_t> m_underrunFrames;
+    std::atomic<uint64_t> m_droppedFrames;
+
+    std::string m_lastError;
+};
@@ -0,0 +1,70 @@
+#include "file_capture_source.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+constexpr uint32_t PACKETS_PER_SECOND = 100;
+
+FileCaptureSource::FileCaptureSource(const Options& options)
+    : m_options(options)
+{
+}
+
+bool FileCaptureSource::open(uint32_t) {
+    char magic[4] = {};
+    std::ifstream(m_options.path, std::ios::binary).read(magic, sizeof(magic));
+    m_isFlac = std::memcmp(magic, "fLaC", 4) == 0;
+
+    std::string error;
+    const bool opened = m_isFlac ? m_flacReader.Open(m_options.path, error) : m_wavReader.Open(m_options.path, error);
+    if (!opened) {
+        setError(error);
+        return false;
+    }
+
+    m_format.sample = m_isFlac ? m_flacReader.Format() : m_wavReader.Format();
+    m_format.sampleRate = m_isFlac ? m_flacReader.SampleRate() : m_wavReader.SampleRate();
+    m_format.maxPacketFrames = std::max<uint32_t>(m_format.sampleRate / PACKETS_PER_SECOND, 1);
+    m_packet.assign(m_format.maxPacketFrames * m_format.sample.BytesPerFrame(), 0);
+    return true;
+}
+
+bool FileCaptureSource::start() {
+    // Every recording replays from the top
+    if (!rewind()) {
+        setError("Failed to rewind " + m_options.path);
+        return false;
+    }
+    m_clock.start(m_format.sampleRate, m_options.realtime);
+    return true;
+}
+
+CaptureReadStatus FileCaptureSource::readPacket(CapturePacket& packet) {
+    if (!m_clock.waitForPacket()) {
+        return CaptureReadStatus::Timeout;
+    }
+
+    // A FLAC file may not know its length, so an empty file shows as never having moved
+    size_t frames = readFrames(m_packet.data(), m_format.maxPacketFrames);
+    const uint64_t position = m_isFlac ? m_flacReader.Position() : m_wavReader.Position();
+    if (frames == 0 && m_options.loop && position > 0 && rewind()) {
+        frames = readFrames(m_packet.data(), m_format.maxPacketFrames);
+    }
+    if (frames == 0) {
+        return CaptureReadStatus::EndOfStream;
+    }
+
+    packet.data = m_packet.data();
+    packet.frameCount = static_cast<uint32_t>(frames);
+    packet.silent = false;
+    m_clock.delivered(packet.frameCount);
+    return CaptureReadStatus::Packet;
+}
+
+size_t FileCaptureSource::readFrames(uint8_t* dst, size_t frames) {
+    return m_isFlac ? m_flacReader.ReadFrames(dst, frames) : m_wavReader.ReadFrames(dst, frames);
+}
+
+bool FileCaptureSource::rewind() {
+    return m_isFlac ? m_flacReader.Rewind() : m_wavReader.Rewind();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "capture_source.h"
+#include "flac_reader.h"
+#include "wav_reader.h"
+
+// Replays a WAV or FLAC file as if it were a capture device.
+//
+// Packets carry 10 ms of the file's own encoding (FLAC decodes to 16- or
+// 24-bit PCM), so the core exercises the
+// same conversion path as a device. In real-time mode packets are paced at
+// the file's sample rate; otherwise the file is delivered as fast as the
+// pipeline consumes it, which makes capture-path benchmarks independent of
+// any audio hardware.
+class FileCaptureSource : public CaptureSource {
+public:
+    struct Options {
+        std::string path;
+        bool realtime = true;
+        bool loop = false;          // Restart at the end instead of ending the stream
+    };
+
+    explicit FileCaptureSource(const Options& options);
+
+    const char* name() const override { return "file"; }
+    bool open(uint32_t bufferSizeMs) override;
+    CaptureSourceFormat format() const override { return m_format; }
+    bool start() override;
+    void stop() override {}
+    bool isRealtime() const override { return m_options.realtime; }
+
+    CaptureReadStatus readPacket(CapturePacket& packet) override;
+    void releasePacket(const CapturePacket&) override {}
+
+private:
+    size_t readFrames(uint8_t* dst, size_t frames);
+    bool rewind();
+
+    Options m_options;
+    bool m_isFlac = false;
+    WavReader m_wavReader;
+    FlacReader m_flacReader;
+    CaptureSourceFormat m_format;
+    std::vector<uint8_t> m_packet;      // One packet in the file's encoding
+    PacketClock m_clock;
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "whisper_transcription.h"
+
+// Compact description of how a streaming transcript changed.
+//
+// A transcript is a list of committed segments, which never change once
+// sent, followed by an unstable tail that is replaced wholesale on every
+// update. `tailOffset` is the UTF-8 byte offset at which the tail starts in
+// the full transcript (the concatenated segment texts), i.e. the byte length
+// of everything committed so far; receivers use it to detect a missed delta.
+struct PartialSegment {
+    double startTime = 0.0;
+    double endTime = 0.0;
+    std::string text;
+};
+
+struct PartialResultDelta {
+    std::vector<PartialSegment> committed;  // Segments committed since the previous delta
+    size_t committedCount = 0;              // Total committed segments after this delta
+    size_t tailOffset = 0;
+    PartialSegment tail;                    // Empty text when there is no tail
+    bool isFinal = false;
+    uint64_t sequence = 0;
+
+    // Folds a newer delta into this one, as if both had been delivered.
+    void Merge(PartialResultDelta&& newer) {
+        committed.insert(committed.end(),
+                         std::make_move_iterator(newer.committed.begin()),
+                         std::make_move_iterator(newer.committed.end()));
+        committedCount = newer.committedCount;
+        tailOffset = newer.tailOffset;
+        tail = std::move(newer.tail);
+        isFinal = isFinal || newer.isFinal;
+        sequence = newer.sequence;
+    }
+};
+
+// Turns successive partial results of one stream into deltas.
+//
+// All segments but the last are treated as committed: once a later segment
+// exists, earlier ones are sent once and never revised. The last segment is
+// the tail until the stream finalizes, at which point it is committed too.
+class PartialResultDeltaTracker {
+public:
+    // Returns false (and leaves `delta` untouched) when nothing changed.
+    bool Update(const TranscriptionResult& result, bool isFinal, PartialResultDelta& delta) {
+        const size_t segmentCount = result.segments.size();
+        const size_t stableCount = isFinal ? segmentCount : (segmentCount > 0 ? segmentCount - 1 : 0);
+
+        PartialResultDelta next;
+        for (size_t i = m_committedCount; i < stableCount; ++i) {
+            const TranscriptionSegment& segment = result.segments[i];
+            next.committed.push_back({ segment.startTime, segment.endTime, segment.text });
+            m_committedBytes += segment.text.size();
+        }
+        m_committedCount = (std::max)(m_committedCount, stableCount);
+
+        if (m_committedCount < segmentCount) {
+            const TranscriptionSegment& last = result.segments.back();
+            next.tail = { last.startTime, last.endTime, last.text };
+        }
+
+        const bool tailChanged = next.tail.text != m_lastTail.text ||
+                                 next.tail.startTime != m_lastTail.startTime ||
+                                 next.tail.endTime != m_lastTail.endTime;
+        if (next.committed.empty() && !tailChanged && !isFinal) {
+            return false;
+        }
+
+        m_lastTail = next.tail;
+        next.committedCount = m_committedCount;
+        next.tailOffset = m_committedBytes;
+        next.isFinal = isFinal;
+        next.sequence = ++m_sequence;
+        delta = std::move(next);
+        return true;
+    }
+
+private:
+    size_t m_committedCount = 0;
+    size_t m_committedBytes = 0;
+    PartialSegment m_lastTail;
+    uint64_t m_sequence = 0;
+};
@@ -0,0 +1,117 @@
+#include "synthetic_capture_source.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+constexpr uint32_t PACKETS_PER_SECOND = 100;
+constexpr double TWO_PI = 6.283185307179586;
+
+// Speech-like pattern: voiced for SPEECH_BURST_MS, then quiet for SPEECH_PAUSE_MS
+constexpr uint32_t SPEECH_BURST_MS = 1200;
+constexpr uint32_t SPEECH_PAUSE_MS = 800;
+constexpr double SYLLABLE_RATE_HZ = 4.0;
+constexpr int SPEECH_HARMONICS = 8;
+
+SyntheticCaptureSource::SyntheticCaptureSource(const Options& options)
+    : m_options(options)
+    , m_framePosition(0)
+    , m_totalFrames(0)
+    , m_noiseState(options.seed ? options.seed : 1)
+{
+}
+
+bool SyntheticCaptureSource::open(uint32_t) {
+    if (m_options.sampleRate == 0 || m_options.channels == 0) {
+        setError("Synthetic source needs a sample rate and channel count");
+        return false;
+    }
+    if (m_options.encoding != SampleEncoding::Float32 && m_options.encoding != SampleEncoding::Int16) {
+        setError("Synthetic source supports float32 and int16 only");
+        return false;
+    }
+
+    m_format.sample.encoding = m_options.encoding;
+    m_format.sample.channels = m_options.channels;
+    m_format.sampleRate = m_options.sampleRate;
+    m_format.maxPacketFrames = std::max<uint32_t>(m_options.sampleRate / PACKETS_PER_SECOND, 1);
+    m_packet.assign(m_format.maxPacketFrames * m_format.sample.BytesPerFrame(), 0);
+    m_totalFrames = static_cast<uint64_t>(m_options.durationMs) * m_options.sampleRate / 1000;
+    return true;
+}
+
+bool SyntheticCaptureSource::start() {
+    m_framePosition = 0;
+    m_noiseState = m_options.seed ? m_options.seed : 1;
+    m_clock.start(m_format.sampleRate, m_options.realtime);
+    return true;
+}
+
+CaptureReadStatus SyntheticCaptureSource::readPacket(CapturePacket& packet) {
+    if (m_totalFrames > 0 && m_framePosition >= m_totalFrames) {
+        return CaptureReadStatus::EndOfStream;
+    }
+    if (!m_clock.waitForPacket()) {
+        return CaptureReadStatus::Timeout;
+    }
+
+    uint32_t frames = m_format.maxPacketFrames;
+    if (m_totalFrames > 0) {
+        frames = static_cast<uint32_t>(std::min<uint64_t>(frames, m_totalFrames - m_framePosition));
+    }
+
+    const uint16_t channels = m_format.sample.channels;
+    for (uint32_t frame = 0; frame < frames; ++frame) {
+        // Every channel carries the same signal
+        const float sample = nextSample();
+        for (uint16_t ch = 0; ch < channels; ++ch) {
+            const size_t index = static_cast<size_t>(frame) * channels + ch;
+            if (m_options.encoding == SampleEncoding::Int16) {
+                const int16_t value = static_cast<int16_t>(std::lround(std::clamp(sample, -1.0f, 1.0f) * 32767.0f));
+                std::memcpy(m_packet.data() + index * sizeof(int16_t), &value, sizeof(value));
+            } else {
+                std::memcpy(m_packet.data() + index * sizeof(float), &sample, sizeof(sample));
+            }
+        }
+        ++m_framePosition;
+    }
+
+    packet.data = m_packet.data();
+    packet.frameCount = frames;
+    packet.silent = m_options.signal == Signal::Silence;
+    m_clock.delivered(frames);
+    return CaptureReadStatus::Packet;
+}
+
+float SyntheticCaptureSource::nextSample() {
+    const double t = static_cast<double>(m_framePosition) / m_options.sampleRate;
+    switch (m_options.signal) {
+    case Signal::Sine:
+        return m_options.amplitude * static_cast<float>(std::sin(TWO_PI * m_options.frequency * t));
+    case Signal::Noise:
+        return m_options.amplitude * nextNoise();
+    case Signal::Speech: {
+        const uint64_t cycleMs = static_cast<uint64_t>(t * 1000.0) % (SPEECH_BURST_MS + SPEECH_PAUSE_MS);
+        if (cycleMs >= SPEECH_BURST_MS) {
+            // Room noise in the pauses, well below the voiced level
+            return 0.002f * nextNoise();
+        }
+        const double envelope = 0.5 - 0.5 * std::cos(TWO_PI * SYLLABLE_RATE_HZ * t);
+        double voiced = 0.0;
+        for (int harmonic = 1; harmonic <= SPEECH_HARMONICS; ++harmonic) {
+            voiced += std::sin(TWO_PI * m_options.frequency * harmonic * t) / harmonic;
+        }
+        return m_options.amplitude * static_cast<float>(0.5 * envelope * voiced);
+    }
+    case Signal::Silence:
+    default:
+        return 0.0f;
+    }
+}
+
+// xorshift32, uniform in [-1, 1)
+float SyntheticCaptureSource::nextNoise() {
+    m_noiseState ^= m_noiseState << 13;
+    m_noiseState ^= m_noiseState >> 17;
+    m_noiseState ^= m_noiseState << 5;
+    return static_cast<float>(m_noiseState) / 2147483648.0f - 1.0f;
+}
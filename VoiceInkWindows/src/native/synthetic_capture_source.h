@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "capture_source.h"
+
+// Generates test signals as if they came from a capture device.
+//
+// Deterministic for a given seed, so pipeline output can be compared across
+// runs and platforms. "speech" alternates voiced bursts (a harmonic-rich
+// tone with a syllable-rate envelope) with pauses, which gives VAD and
+// endpointing something realistic to switch on and off.
+class SyntheticCaptureSource : public CaptureSource {
+public:
+    enum class Signal { Sine, Noise, Silence, Speech };
+
+    struct Options {
+        Signal signal = Signal::Sine;
+        uint32_t sampleRate = 48000;
+        uint16_t channels = 2;
+        SampleEncoding encoding = SampleEncoding::Float32;   // Float32 or Int16
+        float frequency = 440.0f;       // Sine tone, or the speech fundamental
+        float amplitude = 0.5f;
+        uint32_t durationMs = 0;        // 0 runs until stopped
+        bool realtime = true;
+        uint32_t seed = 1;
+    };
+
+    explicit SyntheticCaptureSource(const Options& options);
+
+    const char* name() const override { return "synthetic"; }
+    bool open(uint32_t bufferSizeMs) override;
+    CaptureSourceFormat format() const override { return m_format; }
+    bool start() override;
+    void stop() override {}
+    bool isRealtime() const override { return m_options.realtime; }
+
+    CaptureReadStatus readPacket(CapturePacket& packet) override;
+    void releasePacket(const CapturePacket&) override {}
+
+private:
+    float nextSample();
+    float nextNoise();
+
+    Options m_options;
+    CaptureSourceFormat m_format;
+    std::vector<uint8_t> m_packet;      // One packet in the output encoding
+    PacketClock m_clock;
+    uint64_t m_framePosition;
+    uint64_t m_totalFrames;             // 0 = endless
+    uint32_t m_noiseState;
+};
@@ -0,0 +1,213 @@
+#include "utterance_endpoint_stage.h"
+#include <algorithm>
+#include <chrono>
+
+constexpr uint32_t INPUT_RING_MS = 2000;
+constexpr size_t CHUNK_FRAMES = 1024;
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(5);
+
+static std::atomic<uint64_t> s_nextSession{ 1 };
+
+static void releaseUtteranceSamples(void* owner) {
+    delete static_cast<std::vector<float>*>(owner);
+}
+
+UtteranceEndpointStage::UtteranceEndpointStage(const EndpointerConfig& config, uint32_t channels, size_t maxPushFrames)
+    : m_endpointer(config)
+    , m_session(s_nextSession.fetch_add(1))
+    , m_channels(std::max<uint32_t>(channels, 1))
+    , m_sampleRate(std::max<uint32_t>(config.sampleRate, 1))
+    , m_input(std::max<size_t>(static_cast<size_t>(m_sampleRate) * INPUT_RING_MS / 1000, 4 * maxPushFrames) * m_channels,
+              RingOverflowPolicy::DropNewest, m_channels)
+    , m_streamStart(0.0)
+    , m_haveStreamStart(false)
+    , m_chunk(CHUNK_FRAMES * m_channels)
+    , m_frame(m_endpointer.FrameSamples())
+    , m_frameFill(0)
+    // The utterance can open up to the onset plus the pre-speech padding
+    // before the frame that opens it
+    , m_lookback(static_cast<size_t>(config.preSpeechMs + config.onsetMs) * m_sampleRate / 1000 + 2 * m_frame.size(), 1, m_sampleRate)
+    , m_maxUtteranceSamples(static_cast<size_t>(config.maxUtteranceMs) * m_sampleRate / 1000 + 2 * m_frame.size())
+    , m_sequence(0)
+    , m_submitted(0)
+    , m_finishing(false)
+{
+    m_utterance.reserve(m_maxUtteranceSamples);
+}
+
+UtteranceEndpointStage::~UtteranceEndpointStage() {
+    finish();
+}
+
+void UtteranceEndpointStage::setSink(UtteranceSinkRef sink) {
+    std::lock_guard<std::mutex> lock(m_sinkMutex);
+    m_sink = std::move(sink);
+}
+
+void UtteranceEndpointStage::setEventCallback(EventCallback callback) {
+    std::lock_guard<std::mutex> lock(m_sinkMutex);
+    m_eventCallback = std::move(callback);
+}
+
+void UtteranceEndpointStage::start() {
+    if (!m_worker.joinable()) {
+        m_worker = std::thread(&UtteranceEndpointStage::run, this);
+    }
+}
+
+void UtteranceEndpointStage::push(const float* samples, size_t frameCount, double timestamp) {
+    if (!m_haveStreamStart) {
+        m_streamStart.store(timestamp);
+        m_haveStreamStart = true;
+    }
+    m_input.Write(samples, frameCount * m_channels);
+}
+
+bool UtteranceEndpointStage::hasRoom(size_t frameCount) const {
+    return m_input.Capacity() - m_input.Available() >= frameCount * m_channels;
+}
+
+void UtteranceEndpointStage::finish() {
+    m_finishing = true;
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+void UtteranceEndpointStage::run() {
+    const size_t frameSamples = m_frame.size();
+
+    for (;;) {
+        // Checked before reading, so everything pushed before finish() is processed
+        const bool finishing = m_finishing;
+        const size_t read = m_input.Read(m_chunk.data(), m_chunk.size());
+        if (read == 0) {
+            if (finishing) {
+                break;
+            }
+            std::this_thread::sleep_for(POLL_INTERVAL);
+            continue;
+        }
+
+        const size_t frames = read / m_channels;
+        for (size_t i = 0; i < frames; i++) {
+            const float* frame = m_chunk.data() + i * m_channels;
+            float sum = 0.0f;
+            for (uint32_t c = 0; c < m_channels; c++) {
+                sum += frame[c];
+            }
+            m_frame[m_frameFill++] = sum / m_channels;
+
+            if (m_frameFill == frameSamples) {
+                processFrame(m_frame.data());
+                m_frameFill = 0;
+            }
+        }
+    }
+
+    // A partial last frame is too short to change the outcome
+    handleEvent(m_endpointer.Finish());
+
+    UtteranceSinkRef sink;
+    {
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        sink = m_sink;
+    }
+    sink.EndSession(m_session, m_submitted);
+}
+
+void UtteranceEndpointStage::processFrame(const float* frame) {
+    const size_t frameSamples = m_frame.size();
+    m_lookback.Write(frame, frameSamples, 0.0);
+
+    // Every frame while open belongs to the utterance; the end is trimmed
+    // back to the post-speech padding when it closes
+    if (m_endpointer.InUtterance() && m_utterance.size() + frameSamples <= m_maxUtteranceSamples) {
+        m_utterance.insert(m_utterance.end(), frame, frame + frameSamples);
+    }
+
+    handleEvent(m_endpointer.ProcessFrame(frame));
+}
+
+void UtteranceEndpointStage::handleEvent(EndpointEvent event) {
+    if (event == EndpointEvent::None) {
+        return;
+    }
+
+    if (event == EndpointEvent::Start) {
+        // Pull the onset and the padding before it back out of the lookback
+        const uint64_t start = m_endpointer.UtteranceStart();
+        const AudioHistoryRing::Window window =
+            m_lookback.LatestFromWriter(static_cast<size_t>(m_endpointer.Position() - start));
+        m_utterance.assign(window.data, window.data + window.frames);
+        m_sequence++;
+    } else if (event == EndpointEvent::End) {
+        const uint64_t length = m_endpointer.UtteranceEnd() - m_endpointer.UtteranceStart();
+        m_utterance.resize(static_cast<size_t>(std::min<uint64_t>(length, m_utterance.size())));
+    }
+
+    UtteranceSinkRef sink;
+    {
+        std::lock_guard<std::mutex> lock(m_sinkMutex);
+        sink = m_sink;
+    }
+
+    UtteranceEvent utteranceEvent;
+    utteranceEvent.session = m_session;
+    utteranceEvent.sequence = m_sequence;
+    utteranceEvent.startTime = timeAt(m_endpointer.UtteranceStart());
+    utteranceEvent.endTime = utteranceEvent.startTime;
+    utteranceEvent.sampleCount = 0;
+
+    switch (event) {
+    case EndpointEvent::Start:
+        utteranceEvent.type = UtteranceEvent::START;
+        break;
+    case EndpointEvent::End:
+        utteranceEvent.type = UtteranceEvent::END;
+        utteranceEvent.endTime = timeAt(m_endpointer.UtteranceEnd());
+        utteranceEvent.sampleCount = m_utterance.size();
+        if (sink && !m_utterance.empty()) {
+            // The sink owns the samples from here on; the next utterance
+            // starts in fresh storage
+            auto* samples = new std::vector<float>(std::move(m_utterance));
+            m_utterance = std::vector<float>();
+            m_utterance.reserve(m_maxUtteranceSamples);
+
+            VoiceInkUtterance utterance = {};
+            utterance.samples = samples->data();
+            utterance.frameCount = samples->size();
+            utterance.sampleRate = m_sampleRate;
+            utterance.startTime = utteranceEvent.startTime;
+            utterance.endTime = utteranceEvent.endTime;
+            utterance.sequence = m_sequence;
+            utterance.session = m_session;
+            utterance.samplesOwner = samples;
+            utterance.releaseSamples = releaseUtteranceSamples;
+            utteranceEvent.jobId = sink.Submit(utterance);
+            if (!utteranceEvent.jobId.empty()) {
+                m_submitted++;
+            }
+        }
+        m_utterance.clear();
+        break;
+    case EndpointEvent::Discard:
+    default:
+        utteranceEvent.type = UtteranceEvent::DISCARD;
+        utteranceEvent.endTime = timeAt(m_endpointer.UtteranceEnd());
+        m_utterance.clear();
+        break;
+    }
+
+    // Under the lock, so a replaced callback is never called again once
+    // setEventCallback() returns
+    std::lock_guard<std::mutex> lock(m_sinkMutex);
+    if (m_eventCallback) {
+        m_eventCallback(utteranceEvent);
+    }
+}
+
+// Positions count pushed audio, so time spent paused is not included
+double UtteranceEndpointStage::timeAt(uint64_t position) const {
+    return m_streamStart.load() + static_cast<double>(position) / m_sampleRate;
+}
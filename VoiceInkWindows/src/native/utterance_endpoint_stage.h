@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_history_ring.h"
+#include "spsc_ring_buffer.h"
+#include "utterance_endpointer.h"
+#include "utterance_sink.h"
+
+struct UtteranceEvent {
+    enum Type { START, END, DISCARD };
+
+    Type type;
+    uint64_t session;           // The recording, see UtteranceEndpointStage::session()
+    uint64_t sequence;          // Same for the START and END/DISCARD of one utterance
+    double startTime;           // Capture time, in seconds
+    double endTime;             // Not known for START; equals startTime
+    size_t sampleCount;         // END only
+    std::string jobId;          // END only, if a sink accepted the utterance
+};
+
+// Splits one recording into utterances and hands each finished one to an
+// UtteranceSink, typically the transcription queue.
+//
+// The capture thread push()es output audio into a lock-free ring and moves
+// on; a worker thread downmixes it, runs UtteranceEndpointer over it and
+// cuts the utterances out, keeping just enough lookback for the pre-speech
+// padding. An utterance is submitted as soon as the hangover after its last
+// word has passed, so transcription starts while the recording goes on.
+// finish() submits the utterance still open and ends the session, so after
+// a push-to-talk release only that tail is left to transcribe.
+class UtteranceEndpointStage {
+public:
+    using EventCallback = std::function<void(const UtteranceEvent&)>;
+
+    // `config.sampleRate` must match the audio pushed. Allocates everything
+    // up front; throws std::bad_alloc.
+    UtteranceEndpointStage(const EndpointerConfig& config, uint32_t channels, size_t maxPushFrames);
+    ~UtteranceEndpointStage();
+
+    UtteranceEndpointStage(const UtteranceEndpointStage&) = delete;
+    UtteranceEndpointStage& operator=(const UtteranceEndpointStage&) = delete;
+
+    // Either may change while the stage runs. The callback runs on the
+    // worker and must not block.
+    void setSink(UtteranceSinkRef sink);
+    void setEventCallback(EventCallback callback);
+
+    void start();
+    // Capture thread. Never blocks or allocates; audio that does not fit is
+    // dropped and counted. `timestamp` is the capture time of the first frame.
+    void push(const float* samples, size_t frameCount, double timestamp);
+    // Capture thread. True if `frameCount` more frames fit; unclocked sources
+    // wait on this instead of dropping.
+    bool hasRoom(size_t frameCount) const;
+    // Processes everything pushed, closes the open utterance and stops the
+    // worker. Nothing is submitted after it returns.
+    void finish();
+
+    // Identifies this stage's recording to the sink; unique within the process
+    uint64_t session() const { return m_session; }
+    uint64_t droppedFrames() const { return m_input.Stats().droppedNewest / m_channels; }
+
+private:
+    void run();
+    void processFrame(const float* frame);
+    void handleEvent(EndpointEvent event);
+    void submitUtterance();
+    double timeAt(uint64_t position) const;
+
+    UtteranceEndpointer m_endpointer;
+    const uint64_t m_session;
+    const uint32_t m_channels;
+    const uint32_t m_sampleRate;
+
+    // Capture thread to worker
+    SpscRingBuffer<float> m_input;
+    std::atomic<double> m_streamStart;
+    bool m_haveStreamStart;                  // Capture thread only
+
+    // Worker only
+    std::vector<float> m_chunk;              // Interleaved audio read from m_input
+    std::vector<float> m_frame;              // One mono endpointer frame
+    size_t m_frameFill;
+    AudioHistoryRing m_lookback;             // Mono audio before the utterance opened
+    std::vector<float> m_utterance;          // Mono audio of the open utterance
+    size_t m_maxUtteranceSamples;
+    uint64_t m_sequence;
+    uint64_t m_submitted;
+
+    std::mutex m_sinkMutex;
+    UtteranceSinkRef m_sink;
+    EventCallback m_eventCallback;
+
+    std::atomic<bool> m_finishing;
+    std::thread m_worker;
+};
@@ -0,0 +1,407 @@
+#include "wasapi_capture_source.h"
+#include <combaseapi.h>
+#include <propvarutil.h>
+#include <algorithm>
+
+WasapiCaptureSource::WasapiCaptureSource(bool loopback)
+    : m_loopback(loopback)
+    , m_deviceEnumerator(nullptr)
+    , m_comInitialized(false)
+    , m_device(nullptr)
+    , m_audioClient(nullptr)
+    , m_captureClient(nullptr)
+    , m_captureEvent(nullptr)
+    , m_bufferSizeMs(0)
+    , m_bufferFrameCount(0)
+    , m_started(false)
+{
+    ZeroMemory(&m_deviceFormat, sizeof(m_deviceFormat));
+}
+
+WasapiCaptureSource::~WasapiCaptureSource() {
+    cleanup();
+}
+
+bool WasapiCaptureSource::open(uint32_t bufferSizeMs) {
+    m_bufferSizeMs = bufferSizeMs;
+
+    // Every environment (main thread or worker_thread) runs on its own
+    // thread, so COM is initialized per instance and only balanced when this
+    // call actually took a reference. RPC_E_CHANGED_MODE means the thread
+    // already has COM in another apartment, which we must not uninitialize.
+    HRESULT hr = S_OK;
+    if (!m_comInitialized) {
+        hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+        if (FAILED(hr) && hr != RPC_E_CHANGED_MODE) {
+            setError(L"Failed to initialize COM: " + std::to_wstring(hr));
+            return false;
+        }
+        m_comInitialized = SUCCEEDED(hr);
+    }
+
+    if (!m_deviceEnumerator) {
+        hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, 
+                             CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), 
+                             (void**)&m_deviceEnumerator);
+        if (FAILED(hr)) {
+            setError(L"Failed to create device enumerator: " + std::to_wstring(hr));
+            return false;
+        }
+    }
+
+    // Get the default device unless one was selected
+    if (!m_device) {
+        hr = m_deviceEnumerator->GetDefaultAudioEndpoint(dataFlow(), eConsole, &m_device);
+        if (FAILED(hr)) {
+            setError(std::wstring(m_loopback ? L"Failed to get default render device: " : L"Failed to get default capture device: ") +
+                     std::to_wstring(hr));
+            return false;
+        }
+    }
+
+    return initializeAudioClient();
+}
+
+bool WasapiCaptureSource::start() {
+    if (!m_audioClient) {
+        setError(L"Audio client not initialized");
+        return false;
+    }
+
+    HRESULT hr = m_audioClient->Start();
+    if (FAILED(hr)) {
+        setError(L"Failed to start audio client: " + std::to_wstring(hr));
+        return false;
+    }
+
+    m_started = true;
+    return true;
+}
+
+void WasapiCaptureSource::stop() {
+    if (m_audioClient && m_started) {
+        m_audioClient->Stop();
+        m_audioClient->Reset();
+    }
+    m_started = false;
+}
+
+void WasapiCaptureSource::onCaptureThreadStart() {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+}
+
+CaptureReadStatus WasapiCaptureSource::readPacket(CapturePacket& packet) {
+    UINT32 frameCount = 0;
+    HRESULT hr = m_captureClient->GetNextPacketSize(&frameCount);
+    if (SUCCEEDED(hr) && frameCount == 0) {
+        // Wait for 1/4 of buffer duration at most
+        const DWORD waitResult = WaitForSingleObject(m_captureEvent, (std::max<DWORD>)(m_bufferSizeMs / 4, 1));
+        if (waitResult != WAIT_OBJECT_0 && waitResult != WAIT_TIMEOUT) {
+            setError(L"Waiting for capture data failed");
+            return CaptureReadStatus::Failed;
+        }
+        hr = m_captureClient->GetNextPacketSize(&frameCount);
+    }
+    if (hr == AUDCLNT_E_DEVICE_INVALIDATED) {
+        setError(L"Capture device was removed");
+        return CaptureReadStatus::Failed;
+    }
+    if (FAILED(hr) || frameCount == 0) {
+        return CaptureReadStatus::Timeout;
+    }
+
+    BYTE* data = nullptr;
+    DWORD flags = 0;
+    UINT64 devicePosition = 0;
+    UINT64 qpcPosition = 0;
+    
+    hr = m_captureClient->GetBuffer(&data, &frameCount, &flags, &devicePosition, &qpcPosition);
+    if (FAILED(hr)) {
+        return CaptureReadStatus::Timeout;
+    }
+
+    packet.data = data;
+    packet.frameCount = frameCount;
+    packet.silent = (flags & AUDCLNT_BUFFERFLAGS_SILENT) != 0;
+    return CaptureReadStatus::Packet;
+}
+
+void WasapiCaptureSource::releasePacket(const CapturePacket& packet) {
+    m_captureClient->ReleaseBuffer(packet.frameCount);
+}
+
+std::vector<AudioDevice> WasapiCaptureSource::enumerateDevices() {
+    std::vector<AudioDevice> devices;
+    
+    if (!m_deviceEnumerator) {
+        setError(L"Device enumerator not initialized");
+        return devices;
+    }
+
+    IMMDeviceCollection* deviceCollection = nullptr;
+    HRESULT hr = m_deviceEnumerator->EnumAudioEndpoints(dataFlow(), DEVICE_STATE_ACTIVE, &deviceCollection);
+    if (FAILED(hr)) {
+        setError(L"Failed to enumerate devices: " + std::to_wstring(hr));
+        return devices;
+    }
+
+    UINT deviceCount;
+    hr = deviceCollection->GetCount(&deviceCount);
+    if (FAILED(hr)) {
+        deviceCollection->Release();
+        setError(L"Failed to get device count: " + std::to_wstring(hr));
+        return devices;
+    }
+
+    const std::wstring defaultDeviceId = getDefaultDeviceId();
+
+    for (UINT i = 0; i < deviceCount; i++) {
+        IMMDevice* device = nullptr;
+        hr = deviceCollection->Item(i, &device);
+        if (SUCCEEDED(hr)) {
+            devices.push_back(describeDevice(device, defaultDeviceId));
+            device->Release();
+        }
+    }
+
+    deviceCollection->Release();
+    return devices;
+}
+
+bool WasapiCaptureSource::selectDevice(const std::wstring& deviceId) {
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    
+    if (m_started) {
+        setError(L"Cannot change device while recording");
+        return false;
+    }
+
+    if (!m_deviceEnumerator && !open(m_bufferSizeMs)) {
+        return false;
+    }
+
+    // Release current device
+    if (m_device) {
+        m_device->Release();
+        m_device = nullptr;
+    }
+
+    HRESULT hr = m_deviceEnumerator->GetDevice(deviceId.c_str(), &m_device);
+    if (FAILED(hr)) {
+        setError(L"Failed to select device: " + std::to_wstring(hr));
+        return false;
+    }
+
+    return initializeAudioClient();
+}
+
+AudioDevice WasapiCaptureSource::getCurrentDevice() {
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    if (!m_device) {
+        return AudioDevice{ L"", L"", L"", false, false, 0 };
+    }
+    return describeDevice(m_device, getDefaultDeviceId());
+}
+
+AudioDevice WasapiCaptureSource::describeDevice(IMMDevice* device, const std::wstring& defaultDeviceId) {
+    AudioDevice audioDevice{ L"", L"", L"", false, false, 0 };
+    
+    // Get device ID
+    LPWSTR deviceId = nullptr;
+    if (SUCCEEDED(device->GetId(&deviceId))) {
+        audioDevice.id = deviceId;
+        audioDevice.isDefault = (audioDevice.id == defaultDeviceId);
+        CoTaskMemFree(deviceId);
+    }
+
+    // Get device state
+    DWORD state;
+    if (SUCCEEDED(device->GetState(&state))) {
+        audioDevice.state = state;
+        audioDevice.isActive = (state == DEVICE_STATE_ACTIVE);
+    }
+
+    // Get device properties
+    audioDevice.name = getDeviceProperty(device, PKEY_Device_FriendlyName);
+    audioDevice.description = getDeviceProperty(device, PKEY_Device_DeviceDesc);
+    return audioDevice;
+}
+
+std::wstring WasapiCaptureSource::getDefaultDeviceId() {
+    IMMDevice* defaultDevice = nullptr;
+    std::wstring defaultDeviceId;
+    if (m_deviceEnumerator && SUCCEEDED(m_deviceEnumerator->GetDefaultAudioEndpoint(dataFlow(), eConsole, &defaultDevice))) {
+        LPWSTR deviceId = nullptr;
+        if (SUCCEEDED(defaultDevice->GetId(&deviceId))) {
+            defaultDeviceId = deviceId;
+            CoTaskMemFree(deviceId);
+        }
+        defaultDevice->Release();
+    }
+    return defaultDeviceId;
+}
+
+bool WasapiCaptureSource::initializeAudioClient() {
+    if (!m_device) {
+        setError(L"No device selected");
+        return false;
+    }
+
+    // Release existing audio client
+    releaseAudioClient();
+
+    HRESULT hr = m_device->Activate(__uuidof(IAudioClient), CLSCTX_ALL, nullptr, (void**)&m_audioClient);
+    if (FAILED(hr)) {
+        setError(L"Failed to activate audio client: " + std::to_wstring(hr));
+        return false;
+    }
+
+    // Get device format. The mix format is normally WAVEFORMATEXTENSIBLE
+    // (32-bit float), so keep the whole structure, not just its header.
+    ZeroMemory(&m_deviceFormat, sizeof(m_deviceFormat));
+    WAVEFORMATEX* deviceFormat = nullptr;
+    hr = m_audioClient->GetMixFormat(&deviceFormat);
+    if (FAILED(hr)) {
+        setError(L"Failed to get mix format: " + std::to_wstring(hr));
+        return false;
+    }
+    memcpy(&m_deviceFormat, deviceFormat,
+           (std::min<size_t>)(sizeof(WAVEFORMATEX) + deviceFormat->cbSize, sizeof(m_deviceFormat)));
+    CoTaskMemFree(deviceFormat);
+
+    // Describe the stream for the core, which picks its converter from this
+    const WAVEFORMATEX& wave = m_deviceFormat.Format;
+    const bool extensible = wave.wFormatTag == WAVE_FORMAT_EXTENSIBLE &&
+                            wave.cbSize >= sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX);
+    m_format.sample = SampleFormatFromWave(wave.wFormatTag, wave.nChannels, wave.wBitsPerSample, wave.nBlockAlign,
+                                           extensible ? m_deviceFormat.SubFormat.Data1 : 0);
+    m_format.sampleRate = wave.nSamplesPerSec;
+    if (!m_format.sample.Valid()) {
+        setError(L"Unsupported capture format: tag " + std::to_wstring(wave.wFormatTag) + L", " +
+                 std::to_wstring(wave.wBitsPerSample) + L" bits");
+        return false;
+    }
+
+    // Initialize audio client
+    // Loopback captures what a render endpoint plays, in its mix format
+    REFERENCE_TIME bufferDuration = static_cast<REFERENCE_TIME>(m_bufferSizeMs) * 10000; // Convert to 100ns units
+    const DWORD streamFlags = AUDCLNT_STREAMFLAGS_EVENTCALLBACK | AUDCLNT_STREAMFLAGS_NOPERSIST |
+                              (m_loopback ? AUDCLNT_STREAMFLAGS_LOOPBACK : 0);
+    hr = m_audioClient->Initialize(AUDCLNT_SHAREMODE_SHARED,
+                                  streamFlags,
+                                  bufferDuration, 0, &m_deviceFormat.Format, nullptr);
+    if (FAILED(hr)) {
+        setError(L"Failed to initialize audio client: " + std::to_wstring(hr));
+        return false;
+    }
+
+    // Event-driven clients must register their event before Start()
+    if (!m_captureEvent) {
+        m_captureEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!m_captureEvent) {
+            setError(L"Failed to create event handle");
+            return false;
+        }
+    }
+    hr = m_audioClient->SetEventHandle(m_captureEvent);
+    if (FAILED(hr)) {
+        setError(L"Failed to set event handle: " + std::to_wstring(hr));
+        return false;
+    }
+
+    // Get buffer frame count; no packet is larger than the endpoint buffer
+    hr = m_audioClient->GetBufferSize(&m_bufferFrameCount);
+    if (FAILED(hr)) {
+        setError(L"Failed to get buffer size: " + std::to_wstring(hr));
+        return false;
+    }
+    m_format.maxPacketFrames = m_bufferFrameCount;
+
+    // Get capture client
+    hr = m_audioClient->GetService(__uuidof(IAudioCaptureClient), (void**)&m_captureClient);
+    if (FAILED(hr)) {
+        setError(L"Failed to get capture client: " + std::to_wstring(hr));
+        return false;
+    }
+
+    return true;
+}
+
+void WasapiCaptureSource::releaseAudioClient() {
+    if (m_captureClient) {
+        m_captureClient->Release();
+        m_captureClient = nullptr;
+    }
+
+    if (m_audioClient) {
+        m_audioClient->Release();
+        m_audioClient = nullptr;
+    }
+}
+
+void WasapiCaptureSource::cleanup() {
+    stop();
+    releaseAudioClient();
+
+    if (m_captureEvent) {
+        CloseHandle(m_captureEvent);
+        m_captureEvent = nullptr;
+    }
+
+    if (m_device) {
+        m_device->Release();
+        m_device = nullptr;
+    }
+
+    if (m_deviceEnumerator) {
+        m_deviceEnumerator->Release();
+        m_deviceEnumerator = nullptr;
+    }
+
+    if (m_comInitialized) {
+        CoUninitialize();
+        m_comInitialized = false;
+    }
+}
+
+void WasapiCaptureSource::setError(const std::wstring& error) {
+    CaptureSource::setError(WASAPIUtils::wstringToString(error));
+}
+
+std::wstring WasapiCaptureSource::getDeviceProperty(IMMDevice* device, const PROPERTYKEY& key) {
+    IPropertyStore* propertyStore = nullptr;
+    HRESULT hr = device->OpenPropertyStore(STGM_READ, &propertyStore);
+    if (FAILED(hr)) {
+        return L"";
+    }
+
+    PROPVARIANT prop;
+    PropVariantInit(&prop);
+    hr = propertyStore->GetValue(key, &prop);
+    
+    std::wstring result;
+    if (SUCCEEDED(hr) && prop.vt == VT_LPWSTR) {
+        result = prop.pwszVal;
+    }
+
+    PropVariantClear(&prop);
+    propertyStore->Release();
+    return result;
+}
+
+// Utility functions implementation
+std::string WASAPIUtils::wstringToString(const std::wstring& wstr) {
+    if (wstr.empty()) return std::string();
+    int size = WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), nullptr, 0, nullptr, nullptr);
+    std::string result(size, 0);
+    WideCharToMultiByte(CP_UTF8, 0, &wstr[0], (int)wstr.size(), &result[0], size, nullptr, nullptr);
+    return result;
+}
+
+std::wstring WASAPIUtils::stringToWstring(const std::string& str) {
+    if (str.empty()) return std::wstring();
+    int size = MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), nullptr, 0);
+    std::wstring result(size, 0);
+    MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &result[0], size);
+    return result;
+}
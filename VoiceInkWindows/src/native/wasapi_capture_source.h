@@ -0,0 +1,94 @@
+#pragma once
+
+#include <windows.h>
+#include <mmdeviceapi.h>
+#include <audioclient.h>
+#include <mmreg.h>
+#include <audiopolicy.h>
+#include <functiondiscoverykeys_devpkey.h>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+
+#include "capture_source.h"
+
+struct AudioDevice {
+    std::wstring id;
+    std::wstring name;
+    std::wstring description;
+    bool isDefault;
+    bool isActive;
+    DWORD state;
+};
+
+// Shared-mode WASAPI capture from the default or a selected endpoint.
+//
+// In loopback mode the endpoints are render devices and the stream is what
+// they play, which is the echo canceller's reference.
+//
+// Owns the COM objects and device selection; packets are the endpoint's mix
+// format exactly as GetBuffer() returns them, and are released back to the
+// device once CaptureCore has consumed them.
+class WasapiCaptureSource : public CaptureSource {
+public:
+    explicit WasapiCaptureSource(bool loopback = false);
+    ~WasapiCaptureSource() override;
+
+    const char* name() const override { return m_loopback ? "wasapi-loopback" : "wasapi"; }
+    bool isLoopback() const { return m_loopback; }
+    bool open(uint32_t bufferSizeMs) override;
+    CaptureSourceFormat format() const override { return m_format; }
+    bool start() override;
+    void stop() override;
+
+    void onCaptureThreadStart() override;
+    CaptureReadStatus readPacket(CapturePacket& packet) override;
+    void releasePacket(const CapturePacket& packet) override;
+
+    // Device management
+    std::vector<AudioDevice> enumerateDevices();
+    bool selectDevice(const std::wstring& deviceId);
+    AudioDevice getCurrentDevice();
+
+    using DeviceChangeCallback = std::function<void(const AudioDevice& device, bool connected)>;
+    void setDeviceChangeCallback(DeviceChangeCallback callback) { m_deviceChangeCallback = callback; }
+
+private:
+    const bool m_loopback;
+    EDataFlow dataFlow() const { return m_loopback ? eRender : eCapture; }
+
+    // COM interfaces
+    IMMDeviceEnumerator* m_deviceEnumerator;
+    bool m_comInitialized; // This instance owns one CoInitializeEx on its JS thread
+    IMMDevice* m_device;
+    IAudioClient* m_audioClient;
+    IAudioCaptureClient* m_captureClient;
+    HANDLE m_captureEvent;
+
+    // Audio format
+    WAVEFORMATEXTENSIBLE m_deviceFormat;   // Full mix format the stream was opened with
+    CaptureSourceFormat m_format;
+    uint32_t m_bufferSizeMs;
+    UINT32 m_bufferFrameCount;
+    std::atomic<bool> m_started;
+    std::mutex m_deviceMutex;
+
+    DeviceChangeCallback m_deviceChangeCallback;
+
+    bool initializeAudioClient();
+    void releaseAudioClient();
+    void cleanup();
+    void setError(const std::wstring& error);
+    std::wstring getDeviceProperty(IMMDevice* device, const PROPERTYKEY& key);
+    AudioDevice describeDevice(IMMDevice* device, const std::wstring& defaultDeviceId);
+    std::wstring getDefaultDeviceId();
+};
+
+// Utility functions
+class WASAPIUtils {
+public:
+    static std::string wstringToString(const std::wstring& wstr);
+    static std::wstring stringToWstring(const std::string& str);
+};
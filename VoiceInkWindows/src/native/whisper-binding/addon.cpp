@@ -5,9 +5,281 @@
 
 #include <napi.h>
 #include "whisper_transcriber.h"
+#include "promise_worker.h"
+#include "audio_input.h"
+#include "binary_result_builder.h"
+#include "external_buffer.h"
 #include <iostream>
 #include <memory>
 
+// Convert a transcription result to a JavaScript object
+static Napi::Object TranscriptionResultToJS(Napi::Env env, const TranscriptionResult& result) {
+    Napi::Object jsResult = Napi::Object::New(env);
+    jsResult.Set("success", Napi::Boolean::New(env, result.success));
+    jsResult.Set("text", Napi::String::New(env, result.text));
+    jsResult.Set("language", Napi::String::New(env, result.language));
+    jsResult.Set("confidence", Napi::Number::New(env, result.confidence));
+    jsResult.Set("duration", Napi::Number::New(env, result.duration));
+    
+    if (!result.success) {
+        jsResult.Set("error", Napi::String::New(env, result.error_message));
+    }
+    
+    // Add timestamps if available
+    if (!result.timestamps.empty()) {
+        Napi::Array timestamps = Napi::Array::New(env, result.timestamps.size());
+        for (size_t i = 0; i < result.timestamps.size(); ++i) {
+            Napi::Object timestamp = Napi::Object::New(env);
+            timestamp.Set("start", Napi::Number::New(env, result.timestamps[i].first));
+            timestamp.Set("end", Napi::Number::New(env, result.timestamps[i].second));
+            timestamps.Set(static_cast<uint32_t>(i), timestamp);
+        }
+        jsResult.Set("timestamps", timestamps);
+    }
+    
+    return jsResult;
+}
+
+// Binary form of a transcription result (see binary_result_builder.h). This
+// transcriber only reports segment timings, so segments carry no text and
+// there are no words; the full text is in the summary.
+static void EncodeTranscriptionResult(const TranscriptionResult& result, std::vector<uint8_t>& out) {
+    BinaryResultBuilder builder;
+    builder.Reserve(result.timestamps.size(), 0);
+    builder.SetSummary(result.text, result.language, result.duration, result.confidence, 0.0f);
+    for (const auto& timestamp : result.timestamps) {
+        builder.AddSegment(timestamp.first, timestamp.second, std::string_view(), result.language,
+                           result.confidence, 0);
+    }
+    builder.Finish(out);
+}
+
+// Runs WhisperTranscriber::Transcribe on a pool thread.
+//
+// The caller's buffer is pinned for the lifetime of the worker and read in
+// place; nothing is copied on the JS thread. 16-bit PCM is widened to float on
+// the pool thread. With `binary` set the result is also encoded there and
+// resolves as { success, error?, resultBuffer }.
+class TranscribeWorker : public PromiseWorker {
+public:
+    TranscribeWorker(Napi::Env env, const Napi::Object& owner, WhisperTranscriber* transcriber,
+                     const Napi::Float32Array& samples, const std::string& language, bool binary)
+        : PromiseWorker(env, "WhisperTranscribe", owner)
+        , transcriber_(transcriber)
+        , input_(Napi::Persistent(samples.As<Napi::Object>()))
+        , samples_(samples.Data())
+        , sampleCount_(samples.ElementLength())
+        , language_(language)
+        , binary_(binary) {}
+
+    TranscribeWorker(Napi::Env env, const Napi::Object& owner, WhisperTranscriber* transcriber,
+                     const Napi::Buffer<uint8_t>& pcm, const std::string& language, bool binary)
+        : PromiseWorker(env, "WhisperTranscribe", owner)
+        , transcriber_(transcriber)
+        , input_(Napi::Persistent(pcm.As<Napi::Object>()))
+        , pcm_(reinterpret_cast<const int16_t*>(pcm.Data()))
+        , sampleCount_(pcm.Length() / 2)
+        , language_(language)
+        , binary_(binary) {}
+
+    // Raised by an AbortSignal passed as options.signal
+    std::shared_ptr<std::atomic<bool>> CancelFlag() const { return cancelled_; }
+
+    void Execute() override {
+        if (pcm_) {
+            std::vector<float> audioData = WhisperTranscriber::ConvertInt16ToFloat(pcm_, sampleCount_);
+            result_ = transcriber_->Transcribe(audioData, language_, cancelled_.get());
+        } else {
+            result_ = transcriber_->Transcribe(samples_, sampleCount_, language_, cancelled_.get());
+        }
+        
+        if (binary_ && result_.success) {
+            EncodeTranscriptionResult(result_, encoded_);
+        }
+    }
+
+protected:
+    Napi::Value Resolve(Napi::Env env) override {
+        std::cout << "WhisperWrapper: Transcription " << (result_.success ? "completed" : "failed")
+                  << (result_.success ? (": \"" + result_.text + "\"") : (": " + result_.error_message)) << std::endl;
+        if (!binary_) {
+            return TranscriptionResultToJS(env, result_);
+        }
+        
+        Napi::Object jsResult = Napi::Object::New(env);
+        jsResult.Set("success", Napi::Boolean::New(env, result_.success));
+        if (result_.success) {
+            jsResult.Set("resultBuffer", MoveToArrayBuffer(env, std::move(encoded_)));
+        } else {
+            jsResult.Set("error", Napi::String::New(env, result_.error_message));
+        }
+        return jsResult;
+    }
+
+private:
+    WhisperTranscriber* transcriber_;
+    // Pins the caller's ArrayBuffer until the worker is deleted on the JS thread
+    Napi::ObjectReference input_;
+    const float* samples_ = nullptr;
+    const int16_t* pcm_ = nullptr;
+    size_t sampleCount_ = 0;
+    std::string language_;
+    bool binary_ = false;
+    std::shared_ptr<std::atomic<bool>> cancelled_ = std::make_shared<std::atomic<bool>>(false);
+    TranscriptionResult result_;
+    std::vector<uint8_t> encoded_;
+};
+
+// Runs WhisperTranscriber::TranscribeFile (WAV read + inference) on a pool thread
+class TranscribeFileWorker : public PromiseWorker {
+public:
+    TranscribeFileWorker(Napi::Env env, const Napi::Object& owner, WhisperTranscriber* transcriber,
+                         const std::string& filePath, const std::string& language)
+        : PromiseWorker(env, "WhisperTranscribeFile", owner)
+        , transcriber_(transcriber)
+        , filePath_(filePath)
+        , language_(language) {}
+
+    std::shared_ptr<std::atomic<bool>> CancelFlag() const { return cancelled_; }
+
+    void Execute() override {
+        result_ = transcriber_->TranscribeFile(filePath_, language_, cancelled_.get());
+    }
+
+protected:
+    Napi::Value Resolve(Napi::Env env) override {
+        return TranscriptionResultToJS(env, result_);
+    }
+
+private:
+    WhisperTranscriber* transcriber_;
+    std::string filePath_;
+    std::string language_;
+    std::shared_ptr<std::atomic<bool>> cancelled_ = std::make_shared<std::atomic<bool>>(false);
+    TranscriptionResult result_;
+};
+
+// A load started by loadModel(); repeated calls for the same path while it
+// runs share its promise.
+struct PendingModelLoad {
+    std::string modelPath;
+    std::shared_ptr<std::atomic<bool>> cancelled = std::make_shared<std::atomic<bool>>(false);
+    bool finished = false; // Set on the JS thread when the promise settles
+    Napi::Reference<Napi::Promise> promise;
+};
+
+// Runs WhisperTranscriber::LoadModel on a pool thread, forwarding progress
+// to an optional callback. Resolves with a boolean, or rejects with code
+// ERR_MODEL_LOAD_CANCELLED if the load was cancelled.
+class LoadModelWorker : public PromiseWorker {
+public:
+    LoadModelWorker(Napi::Env env, const Napi::Object& owner, WhisperTranscriber* transcriber,
+                    std::shared_ptr<PendingModelLoad> load, Napi::Function progressCallback)
+        : PromiseWorker(env, "WhisperLoadModel", owner)
+        , transcriber_(transcriber)
+        , load_(std::move(load)) {
+        if (!progressCallback.IsEmpty()) {
+            progress_ = Napi::ThreadSafeFunction::New(env, progressCallback, "ModelLoadProgress", 0, 1);
+        }
+    }
+
+    ~LoadModelWorker() {
+        if (progress_) {
+            progress_.Release();
+        }
+    }
+
+    void Execute() override {
+        ModelLoadProgressCallback onProgress;
+        if (progress_) {
+            Napi::ThreadSafeFunction tsfn = progress_;
+            onProgress = [tsfn](const ModelLoadProgress& progress) mutable {
+                tsfn.NonBlockingCall([progress](Napi::Env env, Napi::Function jsCallback) {
+                    Napi::Object jsProgress = Napi::Object::New(env);
+                    jsProgress.Set("stage", Napi::String::New(env, ModelLoadProgress::StageName(progress.stage)));
+                    jsProgress.Set("bytesMapped", Napi::Number::New(env, static_cast<double>(progress.bytesMapped)));
+                    jsProgress.Set("totalBytes", Napi::Number::New(env, static_cast<double>(progress.totalBytes)));
+                    jsProgress.Set("tensorsInitialized", Napi::Number::New(env, progress.tensorsInitialized));
+                    jsProgress.Set("totalTensors", Napi::Number::New(env, progress.totalTensors));
+                    jsCallback.Call({ jsProgress });
+                });
+            };
+        }
+        success_ = transcriber_->LoadModel(load_->modelPath, std::move(onProgress), load_->cancelled);
+    }
+
+protected:
+    void OnOK() override {
+        load_->finished = true;
+        PromiseWorker::OnOK();
+    }
+
+    void OnError(const Napi::Error& error) override {
+        load_->finished = true;
+        PromiseWorker::OnError(error);
+    }
+
+    Napi::Value Resolve(Napi::Env env) override {
+        std::cout << "WhisperWrapper: LoadModel(" << load_->modelPath << ") - "
+                  << (success_ ? "SUCCESS" : "FAILED") << std::endl;
+        if (!success_ && load_->cancelled->load()) {
+            Napi::Error error = Napi::Error::New(env, "Model load cancelled");
+            error.Set("code", Napi::String::New(env, "ERR_MODEL_LOAD_CANCELLED"));
+            throw error;
+        }
+        if (!success_) {
+            std::cout << "Error: " << transcriber_->GetLastError() << std::endl;
+        }
+        return Napi::Boolean::New(env, success_);
+    }
+
+private:
+    WhisperTranscriber* transcriber_;
+    std::shared_ptr<PendingModelLoad> load_;
+    Napi::ThreadSafeFunction progress_;
+    bool success_ = false;
+};
+
+// Runs WhisperTranscriber::UnloadModel on a pool thread
+class UnloadModelWorker : public PromiseWorker {
+public:
+    UnloadModelWorker(Napi::Env env, const Napi::Object& owner, WhisperTranscriber* transcriber)
+        : PromiseWorker(env, "WhisperUnloadModel", owner)
+        , transcriber_(transcriber) {}
+
+    void Execute() override {
+        success_ = transcriber_->UnloadModel();
+    }
+
+protected:
+    Napi::Value Resolve(Napi::Env env) override {
+        std::cout << "WhisperWrapper: UnloadModel - " << (success_ ? "SUCCESS" : "FAILED") << std::endl;
+        return Napi::Boolean::New(env, success_);
+    }
+
+private:
+    WhisperTranscriber* transcriber_;
+    bool success_ = false;
+};
+
+// Reads `{ signal }` from an optional options argument. Returns undefined if
+// absent; throws a TypeError if it is not AbortSignal-like.
+static Napi::Value AbortSignalOption(const Napi::CallbackInfo& info, size_t index) {
+    Napi::Env env = info.Env();
+    if (info.Length() <= index || !info[index].IsObject()) {
+        return env.Undefined();
+    }
+    Napi::Value signal = info[index].As<Napi::Object>().Get("signal");
+    if (signal.IsUndefined() || signal.IsNull()) {
+        return env.Undefined();
+    }
+    if (!AbortSignalLink::IsSignal(signal)) {
+        Napi::TypeError::New(env, "options.signal must be an AbortSignal").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    return signal;
+}
+
 class WhisperTranscriberWrapper : public Napi::ObjectWrap<WhisperTranscriberWrapper> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports) {
@@ -16,6 +288,7 @@ public:
         Napi::Function func = DefineClass(env, "WhisperTranscriberWrapper", {
             InstanceMethod("loadModel", &WhisperTranscriberWrapper::LoadModel),
             InstanceMethod("unloadModel", &WhisperTranscriberWrapper::UnloadModel),
+            InstanceMethod("cancelModelLoad", &WhisperTranscriberWrapper::CancelModelLoad),
             InstanceMethod("transcribe", &WhisperTranscriberWrapper::Transcribe),
             InstanceMethod("transcribeFile", &WhisperTranscriberWrapper::TranscribeFile),
             InstanceMethod("isModelLoaded", &WhisperTranscriberWrapper::IsModelLoaded),
@@ -48,8 +321,10 @@ public:
 
 private:
     std::unique_ptr<WhisperTranscriber> transcriber_;
+    std::shared_ptr<PendingModelLoad> pendingLoad_;
 
     // Step 18: Model loading and management
+    // loadModel(path, onProgress?, { signal }?) -> Promise<boolean>
     Napi::Value LoadModel(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
         
@@ -60,24 +335,67 @@ private:
 
         std::string modelPath = info[0].As<Napi::String>().Utf8Value();
         
-        bool success = transcriber_->LoadModel(modelPath);
-        std::cout << "WhisperWrapper: LoadModel(" << modelPath << ") - " 
-                  << (success ? "SUCCESS" : "FAILED") << std::endl;
+        Napi::Function progressCallback;
+        if (info.Length() > 1 && info[1].IsFunction()) {
+            progressCallback = info[1].As<Napi::Function>();
+        }
+        Napi::Value signal = AbortSignalOption(info, progressCallback.IsEmpty() ? 1 : 2);
+        if (env.IsExceptionPending()) {
+            return env.Null();
+        }
+        if (signal.IsObject() && AbortSignalLink::IsAborted(signal.As<Napi::Object>())) {
+            return AbortSignalLink::RejectedPromise(env, signal.As<Napi::Object>());
+        }
+        
+        // Share a load of the same model still in flight (unless this call
+        // brings its own signal); another model supersedes it
+        if (pendingLoad_ && !pendingLoad_->finished) {
+            if (pendingLoad_->modelPath == modelPath && !signal.IsObject()) {
+                return pendingLoad_->promise.Value();
+            }
+            pendingLoad_->cancelled->store(true);
+        }
         
-        if (!success) {
-            std::cout << "Error: " << transcriber_->GetLastError() << std::endl;
+        auto load = std::make_shared<PendingModelLoad>();
+        load->modelPath = modelPath;
+        
+        auto* worker = new LoadModelWorker(env, info.This().As<Napi::Object>(), transcriber_.get(),
+                                           load, progressCallback);
+        if (signal.IsObject()) {
+            worker->LinkAbortSignal(signal.As<Napi::Object>(), load->cancelled);
         }
+        Napi::Promise promise = worker->GetPromise();
+        load->promise = Napi::Persistent(promise);
+        pendingLoad_ = std::move(load);
+        worker->Queue();
         
-        return Napi::Boolean::New(env, success);
+        return promise;
     }
 
+    // unloadModel() -> Promise<boolean>; cancels a load still in flight
     Napi::Value UnloadModel(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
         
-        bool success = transcriber_->UnloadModel();
-        std::cout << "WhisperWrapper: UnloadModel - " << (success ? "SUCCESS" : "FAILED") << std::endl;
+        CancelPendingLoad();
+        
+        auto* worker = new UnloadModelWorker(env, info.This().As<Napi::Object>(), transcriber_.get());
+        Napi::Promise promise = worker->GetPromise();
+        worker->Queue();
         
-        return Napi::Boolean::New(env, success);
+        return promise;
+    }
+
+    Napi::Value CancelModelLoad(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        return Napi::Boolean::New(env, CancelPendingLoad());
+    }
+
+    bool CancelPendingLoad() {
+        if (!pendingLoad_ || pendingLoad_->finished) {
+            return false;
+        }
+        pendingLoad_->cancelled->store(true);
+        return true;
     }
 
     // Step 19: Transcription pipeline
@@ -94,71 +412,55 @@ private:
             return env.Null();
         }
 
-        std::vector<float> audioData;
         std::string language = "auto";
         
-        // Handle different audio input types
-        if (info[0].IsBuffer()) {
-            // Handle raw PCM buffer
-            auto buffer = info[0].As<Napi::Buffer<uint8_t>>();
-            
-            // Assume 16-bit PCM, convert to float
-            const int16_t* pcmData = reinterpret_cast<const int16_t*>(buffer.Data());
-            size_t sampleCount = buffer.Length() / 2;
-            
-            audioData = WhisperTranscriber::ConvertInt16ToFloat(pcmData, sampleCount);
-            
-        } else if (info[0].IsArray()) {
-            // Handle float array
-            auto array = info[0].As<Napi::Array>();
-            audioData.reserve(array.Length());
-            
-            for (uint32_t i = 0; i < array.Length(); ++i) {
-                audioData.push_back(array.Get(i).As<Napi::Number>().FloatValue());
-            }
-        } else {
-            Napi::TypeError::New(env, "Audio data must be Buffer or Array").ThrowAsJavaScriptException();
-            return env.Null();
-        }
-        
         // Optional language parameter
         if (info.Length() > 1 && info[1].IsString()) {
             language = info[1].As<Napi::String>().Utf8Value();
         }
         
-        std::cout << "WhisperWrapper: Transcribing " << audioData.size() 
-                  << " samples (language: " << language << ")" << std::endl;
+        // Optional { binary: true }: resolve with an encoded resultBuffer
+        bool binary = false;
+        if (info.Length() > 2 && info[2].IsObject()) {
+            Napi::Value binaryOption = info[2].As<Napi::Object>().Get("binary");
+            binary = binaryOption.IsBoolean() && binaryOption.As<Napi::Boolean>().Value();
+        }
         
-        TranscriptionResult result = transcriber_->Transcribe(audioData, language);
+        // Optional { signal }: aborting it stops inference and rejects with an AbortError
+        Napi::Value signal = AbortSignalOption(info, 2);
+        if (env.IsExceptionPending()) {
+            return env.Null();
+        }
+        if (signal.IsObject() && AbortSignalLink::IsAborted(signal.As<Napi::Object>())) {
+            return AbortSignalLink::RejectedPromise(env, signal.As<Napi::Object>());
+        }
         
-        // Convert result to JavaScript object
-        Napi::Object jsResult = Napi::Object::New(env);
-        jsResult.Set("success", Napi::Boolean::New(env, result.success));
-        jsResult.Set("text", Napi::String::New(env, result.text));
-        jsResult.Set("language", Napi::String::New(env, result.language));
-        jsResult.Set("confidence", Napi::Number::New(env, result.confidence));
-        jsResult.Set("duration", Napi::Number::New(env, result.duration));
-        
-        if (!result.success) {
-            jsResult.Set("error", Napi::String::New(env, result.error_message));
-        }
-        
-        // Add timestamps if available
-        if (!result.timestamps.empty()) {
-            Napi::Array timestamps = Napi::Array::New(env);
-            for (size_t i = 0; i < result.timestamps.size(); ++i) {
-                Napi::Object timestamp = Napi::Object::New(env);
-                timestamp.Set("start", Napi::Number::New(env, result.timestamps[i].first));
-                timestamp.Set("end", Napi::Number::New(env, result.timestamps[i].second));
-                timestamps.Set(static_cast<uint32_t>(i), timestamp);
-            }
-            jsResult.Set("timestamps", timestamps);
+        // Inference runs on a pool thread; the result object is built on completion
+        TranscribeWorker* worker = nullptr;
+        if (info[0].IsBuffer()) {
+            // Raw 16-bit PCM; converted to float on the pool thread
+            auto buffer = info[0].As<Napi::Buffer<uint8_t>>();
+            std::cout << "WhisperWrapper: Transcribing " << buffer.Length() / 2
+                      << " PCM samples (language: " << language << ")" << std::endl;
+            worker = new TranscribeWorker(env, info.This().As<Napi::Object>(), transcriber_.get(), buffer, language, binary);
+        } else if (info[0].IsTypedArray() || info[0].IsArray()) {
+            // Float32Array is used in place; plain arrays are converted in one bulk call
+            Napi::Float32Array samples = CoerceToFloat32Array(env, info[0]);
+            std::cout << "WhisperWrapper: Transcribing " << samples.ElementLength()
+                      << " samples (language: " << language << ")" << std::endl;
+            worker = new TranscribeWorker(env, info.This().As<Napi::Object>(), transcriber_.get(), samples, language, binary);
+        } else {
+            Napi::TypeError::New(env, "Audio data must be Buffer, Float32Array or Array").ThrowAsJavaScriptException();
+            return env.Null();
         }
         
-        std::cout << "WhisperWrapper: Transcription " << (result.success ? "completed" : "failed")
-                  << (result.success ? (": \"" + result.text + "\"") : (": " + result.error_message)) << std::endl;
+        if (signal.IsObject()) {
+            worker->LinkAbortSignal(signal.As<Napi::Object>(), worker->CancelFlag());
+        }
+        Napi::Promise promise = worker->GetPromise();
+        worker->Queue();
         
-        return jsResult;
+        return promise;
     }
 
     Napi::Value TranscribeFile(const Napi::CallbackInfo& info) {
@@ -176,23 +478,25 @@ private:
             language = info[1].As<Napi::String>().Utf8Value();
         }
         
-        std::cout << "WhisperWrapper: Transcribing file " << filePath << std::endl;
-        
-        TranscriptionResult result = transcriber_->TranscribeFile(filePath, language);
+        Napi::Value signal = AbortSignalOption(info, 2);
+        if (env.IsExceptionPending()) {
+            return env.Null();
+        }
+        if (signal.IsObject() && AbortSignalLink::IsAborted(signal.As<Napi::Object>())) {
+            return AbortSignalLink::RejectedPromise(env, signal.As<Napi::Object>());
+        }
         
-        // Convert result to JavaScript object (same as Transcribe method)
-        Napi::Object jsResult = Napi::Object::New(env);
-        jsResult.Set("success", Napi::Boolean::New(env, result.success));
-        jsResult.Set("text", Napi::String::New(env, result.text));
-        jsResult.Set("language", Napi::String::New(env, result.language));
-        jsResult.Set("confidence", Napi::Number::New(env, result.confidence));
-        jsResult.Set("duration", Napi::Number::New(env, result.duration));
+        std::cout << "WhisperWrapper: Transcribing file " << filePath << std::endl;
         
-        if (!result.success) {
-            jsResult.Set("error", Napi::String::New(env, result.error_message));
+        auto* worker = new TranscribeFileWorker(env, info.This().As<Napi::Object>(), transcriber_.get(),
+                                                filePath, language);
+        if (signal.IsObject()) {
+            worker->LinkAbortSignal(signal.As<Napi::Object>(), worker->CancelFlag());
         }
+        Napi::Promise promise = worker->GetPromise();
+        worker->Queue();
         
-        return jsResult;
+        return promise;
     }
 
     Napi::Value IsModelLoaded(const Napi::CallbackInfo& info) {
@@ -28,6 +28,8 @@ struct whisper_full_params {
     bool print_timestamps;
     void* progress_callback;
     void* progress_user_data;
+    bool (*abort_callback)(void* user_data);
+    void* abort_callback_user_data;
 };
 
 // Mock whisper functions (these would be real whisper.cpp calls in production)
@@ -64,8 +66,18 @@ namespace MockWhisper {
         
         std::cout << "Mock: Transcribing " << n_samples << " samples" << std::endl;
         
-        // Simulate processing time
-        std::this_thread::sleep_for(std::chrono::milliseconds(100 + n_samples / 1000));
+        // Simulate processing time, polling the abort callback between
+        // "decoder steps" like whisper.cpp does
+        auto remaining = std::chrono::milliseconds(100 + n_samples / 1000);
+        const auto step = std::chrono::milliseconds(10);
+        while (remaining.count() > 0) {
+            if (params.abort_callback && params.abort_callback(params.abort_callback_user_data)) {
+                std::cout << "Mock: Transcription aborted" << std::endl;
+                return -6;
+            }
+            std::this_thread::sleep_for((std::min)(remaining, step));
+            remaining -= step;
+        }
         
         return 0; // Success
     }
@@ -123,7 +135,9 @@ WhisperTranscriber::~WhisperTranscriber() {
     std::cout << "WhisperTranscriber: Destroyed instance" << std::endl;
 }
 
-bool WhisperTranscriber::LoadModel(const std::string& model_path) {
+bool WhisperTranscriber::LoadModel(const std::string& model_path,
+                                   ModelLoadProgressCallback on_progress,
+                                   std::shared_ptr<std::atomic<bool>> cancelled) {
     std::cout << "WhisperTranscriber: Loading model from " << model_path << std::endl;
     
     if (model_loaded_) {
@@ -135,14 +149,61 @@ bool WhisperTranscriber::LoadModel(const std::string& model_path) {
         return false;
     }
     
-    context_ = MockWhisper::whisper_init_from_file(model_path.c_str());
-    if (!context_) {
+    // The file is read without context_mutex_ held, so IsModelLoaded() and
+    // friends never wait on disk I/O
+    GgmlModelReader reader;
+    std::string error;
+    if (!reader.Open(model_path, error)) {
+        SetError(error);
+        return false;
+    }
+    reader.SetProgressCallback(std::move(on_progress));
+    if (cancelled) {
+        reader.SetCancelCheck([cancelled]() { return cancelled->load(); });
+    }
+    
+    const bool read = reader.Drain();
+    reader.Close();
+    if (!read) {
+        SetError("Model load cancelled");
+        return false;
+    }
+    
+    whisper_context* context = MockWhisper::whisper_init_from_file(model_path.c_str());
+    if (!context) {
         SetError("Failed to load model: " + model_path);
         return false;
     }
     
-    current_model_path_ = model_path;
-    model_loaded_ = true;
+    // One second of silence through inference, so the first real
+    // transcription does not pay for first-use allocations
+    reader.ReportStage(ModelLoadProgress::WARMUP);
+    std::vector<float> silence(16000, 0.0f);
+    MockWhisper::whisper_full(context, MockWhisper::whisper_full_default_params(),
+                              silence.data(), static_cast<int>(silence.size()));
+    
+    // Checked under the lock so an unload that cancels this load cannot be
+    // overtaken by it; a superseded load still running is replaced
+    whisper_context* previous = nullptr;
+    {
+        std::lock_guard<std::timed_mutex> lock(context_mutex_);
+        if (cancelled && cancelled->load()) {
+            previous = context;
+        } else {
+            previous = context_;
+            context_ = context;
+            current_model_path_ = model_path;
+            model_loaded_ = true;
+        }
+    }
+    if (previous) {
+        MockWhisper::whisper_free(previous);
+    }
+    if (previous == context) {
+        SetError("Model load cancelled");
+        return false;
+    }
+    reader.ReportStage(ModelLoadProgress::READY);
     
     std::cout << "WhisperTranscriber: Model loaded successfully" << std::endl;
     return true;
@@ -155,6 +216,7 @@ bool WhisperTranscriber::UnloadModel() {
     
     std::cout << "WhisperTranscriber: Unloading model" << std::endl;
     
+    std::lock_guard<std::timed_mutex> lock(context_mutex_);
     if (context_) {
         MockWhisper::whisper_free(context_);
         context_ = nullptr;
@@ -201,22 +263,37 @@ std::vector<ModelInfo> WhisperTranscriber::GetAvailableModels(const std::string&
 }
 
 TranscriptionResult WhisperTranscriber::Transcribe(const std::vector<float>& audio_data, 
-                                                  const std::string& language) {
+                                                  const std::string& language,
+                                                  const std::atomic<bool>* cancelled) {
+    return Transcribe(audio_data.data(), audio_data.size(), language, cancelled);
+}
+
+TranscriptionResult WhisperTranscriber::Transcribe(const float* audio_data, size_t sample_count,
+                                                  const std::string& language,
+                                                  const std::atomic<bool>* cancelled) {
     TranscriptionResult result = {};
     
-    if (!model_loaded_) {
+    // Transcribe may run on a worker thread; keep the context alive until done.
+    // A cancelled call stops waiting behind another transcription.
+    std::unique_lock<std::timed_mutex> lock = LockUnlessCancelled(context_mutex_, cancelled);
+    if (!lock.owns_lock()) {
+        result.success = false;
+        result.error_message = "Transcription cancelled";
+        return result;
+    }
+    if (!model_loaded_ || !context_) {
         result.success = false;
         result.error_message = "Model not loaded";
         return result;
     }
     
-    if (audio_data.empty()) {
+    if (!audio_data || sample_count == 0) {
         result.success = false;
         result.error_message = "Empty audio data";
         return result;
     }
     
-    std::cout << "WhisperTranscriber: Transcribing " << audio_data.size() << " audio samples" << std::endl;
+    std::cout << "WhisperTranscriber: Transcribing " << sample_count << " audio samples" << std::endl;
     
     auto start_time = std::chrono::high_resolution_clock::now();
     
@@ -227,10 +304,14 @@ TranscriptionResult WhisperTranscriber::Transcribe(const std::vector<float>& aud
         result.error_message = "Failed to initialize parameters";
         return result;
     }
+    if (cancelled) {
+        params.abort_callback = [](void* flag) { return IsCancelled(static_cast<const std::atomic<bool>*>(flag)); };
+        params.abort_callback_user_data = const_cast<std::atomic<bool>*>(cancelled);
+    }
     
     // Process audio
-    int ret = MockWhisper::whisper_full(context_, params, audio_data.data(), 
-                                       static_cast<int>(audio_data.size()));
+    int ret = MockWhisper::whisper_full(context_, params, audio_data, 
+                                       static_cast<int>(sample_count));
     
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
@@ -238,7 +319,8 @@ TranscriptionResult WhisperTranscriber::Transcribe(const std::vector<float>& aud
     
     if (ret != 0) {
         result.success = false;
-        result.error_message = "Transcription failed with error code: " + std::to_string(ret);
+        result.error_message = IsCancelled(cancelled) ? "Transcription cancelled"
+                                                      : "Transcription failed with error code: " + std::to_string(ret);
         return result;
     }
     
@@ -261,14 +343,15 @@ TranscriptionResult WhisperTranscriber::Transcribe(const std::vector<float>& aud
     result.text = full_text.str();
     result.language = (language == "auto") ? "en" : language;
     result.confidence = 0.85f + (static_cast<float>(rand()) / RAND_MAX) * 0.1f; // Mock confidence
-    result.duration = audio_data.size() / 16000.0; // Assuming 16kHz
+    result.duration = sample_count / 16000.0; // Assuming 16kHz
     
     std::cout << "WhisperTranscriber: Transcription completed: \"" << result.text << "\"" << std::endl;
     return result;
 }
 
 TranscriptionResult WhisperTranscriber::TranscribeFile(const std::string& wav_file_path, 
-                                                      const std::string& language) {
+                                                      const std::string& language,
+                                                      const std::atomic<bool>* cancelled) {
     TranscriptionResult result = {};
     
     std::vector<float> audio_data;
@@ -286,7 +369,7 @@ TranscriptionResult WhisperTranscriber::TranscribeFile(const std::string& wav_fi
         audio_data = ResampleAudio(audio_data, sample_rate, 16000);
     }
     
-    return Transcribe(audio_data, language);
+    return Transcribe(audio_data, language, cancelled);
 }
 
 void WhisperTranscriber::SetThreads(int num_threads) {
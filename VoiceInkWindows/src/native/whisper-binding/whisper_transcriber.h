@@ -7,6 +7,9 @@
 #include <mutex>
 #include <functional>
 
+#include "ggml_model_reader.h"
+#include "cancellation.h"
+
 // Forward declarations for whisper.cpp
 struct whisper_context;
 struct whisper_full_params;
@@ -49,7 +52,11 @@ public:
     ~WhisperTranscriber();
 
     // Model management
-    bool LoadModel(const std::string& model_path);
+    // Blocks until the model is loaded and warmed up. `on_progress` is called
+    // on the loading thread; setting `cancelled` abandons the load.
+    bool LoadModel(const std::string& model_path,
+                   ModelLoadProgressCallback on_progress = nullptr,
+                   std::shared_ptr<std::atomic<bool>> cancelled = nullptr);
     bool UnloadModel();
     bool IsModelLoaded() const;
     std::string GetCurrentModel() const;
@@ -59,11 +66,17 @@ public:
     bool DownloadModel(const std::string& model_name, const std::string& models_dir = "./models/");
     bool IsModelAvailable(const std::string& model_name, const std::string& models_dir = "./models/");
     
-    // Transcription
+    // Transcription. Raising `cancelled` from any thread stops inference at
+    // its next abort check, or gives up waiting for the model.
     TranscriptionResult Transcribe(const std::vector<float>& audio_data, 
-                                  const std::string& language = "auto");
+                                  const std::string& language = "auto",
+                                  const std::atomic<bool>* cancelled = nullptr);
+    TranscriptionResult Transcribe(const float* audio_data, size_t sample_count,
+                                  const std::string& language = "auto",
+                                  const std::atomic<bool>* cancelled = nullptr);
     TranscriptionResult TranscribeFile(const std::string& wav_file_path, 
-                                      const std::string& language = "auto");
+                                      const std::string& language = "auto",
+                                      const std::atomic<bool>* cancelled = nullptr);
     
     // Real-time transcription
     bool StartRealTimeTranscription(const std::string& language = "auto");
@@ -102,6 +115,7 @@ public:
 private:
     // Whisper context
     whisper_context* context_;
+    std::timed_mutex context_mutex_; // Held for load/unload and for the duration of inference
     
     // Model state
     std::string current_model_path_;
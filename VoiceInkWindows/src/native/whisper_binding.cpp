@@ -1,13 +1,333 @@
 #include <napi.h>
 #include <memory>
+#include <vector>
+#include <algorithm>
 #include "whisper_transcription.h"
+#include "promise_worker.h"
+#include "audio_input.h"
+#include "coalescing_channel.h"
+#include "partial_result_delta.h"
+#include "whisper_result_encoding.h"
+#include "external_buffer.h"
+#include "whisper_model_registry.h"
+#include "utterance_sink.h"
+
+#define NAPI_METHOD_PLACEHOLDER(name) \
+    Napi::Value name(const Napi::CallbackInfo& info) { \
+        Napi::Env env = info.Env(); \
+        return env.Undefined(); \
+    }
+
+// Runs WhisperTranscription::transcribeBuffer off the JS thread.
+class TranscribeBufferWorker : public PromiseWorker {
+public:
+    TranscribeBufferWorker(Napi::Env env, const Napi::Object& owner, WhisperTranscription* transcriber,
+                           AudioSampleView audio, int sampleRate, const AudioProcessingOptions& options)
+        : PromiseWorker(env, "WhisperTranscribeBuffer", owner)
+        , m_transcriber(transcriber)
+        , m_audio(std::move(audio))
+        , m_sampleRate(sampleRate)
+        , m_options(options) {}
+
+    // Raised by an AbortSignal passed as options.signal
+    std::shared_ptr<std::atomic<bool>> CancelFlag() const { return m_cancelled; }
+
+    void Execute() override {
+        if (!m_transcriber->isModelLoaded()) {
+            SetError("No model loaded. Please load a model first.");
+            return;
+        }
+        m_text = m_transcriber->transcribeBuffer(m_audio.data, m_audio.sampleCount, m_sampleRate, m_options,
+                                                 m_cancelled.get());
+    }
+
+protected:
+    Napi::Value Resolve(Napi::Env env) override {
+        return Napi::String::New(env, m_text);
+    }
+
+private:
+    WhisperTranscription* m_transcriber;
+    AudioSampleView m_audio;
+    int m_sampleRate;
+    AudioProcessingOptions m_options;
+    std::shared_ptr<std::atomic<bool>> m_cancelled = std::make_shared<std::atomic<bool>>(false);
+    std::string m_text;
+};
+
+// Runs WhisperTranscription::detectLanguage off the JS thread.
+class DetectLanguageWorker : public PromiseWorker {
+public:
+    DetectLanguageWorker(Napi::Env env, const Napi::Object& owner, WhisperTranscription* transcriber,
+                         AudioSampleView audio, int sampleRate)
+        : PromiseWorker(env, "WhisperDetectLanguage", owner)
+        , m_transcriber(transcriber)
+        , m_audio(std::move(audio))
+        , m_sampleRate(sampleRate) {}
+
+    std::shared_ptr<std::atomic<bool>> CancelFlag() const { return m_cancelled; }
+
+    void Execute() override {
+        if (!m_transcriber->isModelLoaded()) {
+            SetError("No model loaded. Please load a model first.");
+            return;
+        }
+        m_language = m_transcriber->detectLanguage(m_audio.data, m_audio.sampleCount, m_sampleRate,
+                                                   m_cancelled.get());
+    }
+
+protected:
+    Napi::Value Resolve(Napi::Env env) override {
+        return Napi::String::New(env, m_language);
+    }
+
+private:
+    WhisperTranscription* m_transcriber;
+    AudioSampleView m_audio;
+    int m_sampleRate;
+    std::shared_ptr<std::atomic<bool>> m_cancelled = std::make_shared<std::atomic<bool>>(false);
+    std::string m_language;
+};
+
+// Waits for WhisperTranscription::awaitDictation off the JS thread.
+class AwaitDictationWorker : public PromiseWorker {
+public:
+    AwaitDictationWorker(Napi::Env env, const Napi::Object& owner, WhisperTranscription* transcriber, uint64_t dictationId)
+        : PromiseWorker(env, "WhisperAwaitDictation", owner)
+        , m_transcriber(transcriber)
+        , m_dictationId(dictationId) {}
+
+    std::shared_ptr<std::atomic<bool>> CancelFlag() const { return m_cancelled; }
+
+    void Execute() override {
+        if (!m_transcriber->awaitDictation(m_dictationId, m_result, m_cancelled.get()) && !m_cancelled->load()) {
+            SetError("Unknown dictation session");
+        }
+    }
+
+protected:
+    Napi::Value Resolve(Napi::Env env) override;
+
+private:
+    WhisperTranscription* m_transcriber;
+    uint64_t m_dictationId;
+    std::shared_ptr<std::atomic<bool>> m_cancelled = std::make_shared<std::atomic<bool>>(false);
+    TranscriptionResult m_result;
+};
+
+// A model load started by loadModel(); a second call for the same model
+// while it runs gets the same promise back.
+struct InFlightModelLoad {
+    std::string modelId;
+    std::shared_ptr<std::atomic<bool>> cancelled = std::make_shared<std::atomic<bool>>(false);
+    bool finished = false; // Set on the JS thread when the promise settles
+    Napi::Reference<Napi::Promise> promise;
+};
+
+static Napi::Object modelLoadProgressToJS(Napi::Env env, const ModelLoadProgress& progress) {
+    Napi::Object progressObj = Napi::Object::New(env);
+    progressObj.Set("stage", Napi::String::New(env, ModelLoadProgress::StageName(progress.stage)));
+    progressObj.Set("bytesMapped", Napi::Number::New(env, static_cast<double>(progress.bytesMapped)));
+    progressObj.Set("totalBytes", Napi::Number::New(env, static_cast<double>(progress.totalBytes)));
+    progressObj.Set("tensorsInitialized", Napi::Number::New(env, progress.tensorsInitialized));
+    progressObj.Set("totalTensors", Napi::Number::New(env, progress.totalTensors));
+    return progressObj;
+}
+
+// Runs WhisperTranscription::loadModel off the JS thread. Resolves with the
+// same boolean loadModel used to return, or rejects with
+// code ERR_MODEL_LOAD_CANCELLED if the load was cancelled.
+class LoadModelWorker : public PromiseWorker {
+public:
+    LoadModelWorker(Napi::Env env, const Napi::Object& owner, WhisperTranscription* transcriber,
+                    std::shared_ptr<InFlightModelLoad> load, Napi::Function progressCallback)
+        : PromiseWorker(env, "WhisperLoadModel", owner)
+        , m_transcriber(transcriber)
+        , m_load(std::move(load)) {
+        m_request.cancelled = m_load->cancelled;
+        if (!progressCallback.IsEmpty()) {
+            m_progress = Napi::ThreadSafeFunction::New(env, progressCallback, "ModelLoadProgress", 0, 1);
+            Napi::ThreadSafeFunction tsfn = m_progress;
+            m_request.onProgress = [tsfn](const ModelLoadProgress& progress) mutable {
+                tsfn.NonBlockingCall([progress](Napi::Env env, Napi::Function jsCallback) {
+                    jsCallback.Call({ modelLoadProgressToJS(env, progress) });
+                });
+            };
+        }
+    }
+
+    ~LoadModelWorker() {
+        if (m_progress) {
+            m_progress.Release();
+        }
+    }
+
+    void Execute() override {
+        m_loaded = m_transcriber->loadModel(m_load->modelId, m_request);
+    }
+
+protected:
+    void OnOK() override {
+        m_load->finished = true;
+        PromiseWorker::OnOK();
+    }
+
+    void OnError(const Napi::Error& error) override {
+        m_load->finished = true;
+        PromiseWorker::OnError(error);
+    }
+
+    Napi::Value Resolve(Napi::Env env) override {
+        if (!m_loaded && m_load->cancelled->load()) {
+            Napi::Error error = Napi::Error::New(env, WhisperModelRegistry::kCancelledError);
+            error.Set("code", Napi::String::New(env, "ERR_MODEL_LOAD_CANCELLED"));
+            throw error;
+        }
+        return Napi::Boolean::New(env, m_loaded);
+    }
+
+private:
+    WhisperTranscription* m_transcriber;
+    std::shared_ptr<InFlightModelLoad> m_load;
+    ModelLoadRequest m_request;
+    Napi::ThreadSafeFunction m_progress;
+    bool m_loaded = false;
+};
+
+// Releases the model off the JS thread; freeing the weights can take a while.
+class UnloadModelWorker : public PromiseWorker {
+public:
+    UnloadModelWorker(Napi::Env env, const Napi::Object& owner, WhisperTranscription* transcriber)
+        : PromiseWorker(env, "WhisperUnloadModel", owner)
+        , m_transcriber(transcriber) {}
+
+    void Execute() override {
+        m_unloaded = m_transcriber->unloadModel();
+    }
+
+protected:
+    Napi::Value Resolve(Napi::Env env) override {
+        return Napi::Boolean::New(env, m_unloaded);
+    }
+
+private:
+    WhisperTranscription* m_transcriber;
+    bool m_unloaded = false;
+};
+
+// Delta tracking for streaming partial results. Shared with the native
+// callback, which runs on transcription worker threads.
+struct PartialResultStreams {
+    std::mutex mutex;
+    std::map<std::string, PartialResultDeltaTracker> trackers;
+    std::unique_ptr<CoalescingChannel<PartialResultDelta>> channel;
+};
+
+// Queues utterances from the recorder addon (see utterance_sink.h) as
+// pieces of the dictation named after their session; see awaitDictation().
+// Reference counted across both addons: the binding and every sink External
+// and recorder holding it keep one reference each. Once the binding is gone,
+// submissions are refused.
+class UtteranceSinkTarget {
+public:
+    UtteranceSinkTarget(WhisperTranscription* transcriber, const AudioProcessingOptions& options)
+        : m_transcriber(transcriber), m_options(options) {}
+
+    VoiceInkUtteranceSink Describe() {
+        VoiceInkUtteranceSink sink = {};
+        sink.version = VOICEINK_UTTERANCE_SINK_VERSION;
+        sink.size = sizeof(VoiceInkUtteranceSink);
+        sink.context = this;
+        sink.submit = &UtteranceSinkTarget::Submit;
+        sink.retain = &UtteranceSinkTarget::Retain;
+        sink.release = &UtteranceSinkTarget::Release;
+        sink.endSession = &UtteranceSinkTarget::EndSession;
+        return sink;
+    }
+
+    void Detach() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_transcriber = nullptr;
+    }
+
+    // Only the binding's own reference is left
+    bool Unused() const { return m_references.load() == 1; }
+
+    static void Retain(void* context) {
+        static_cast<UtteranceSinkTarget*>(context)->m_references.fetch_add(1);
+    }
+
+    static void Release(void* context) {
+        auto* target = static_cast<UtteranceSinkTarget*>(context);
+        if (target->m_references.fetch_sub(1) == 1) {
+            delete target;
+        }
+    }
+
+private:
+    static int Submit(void* context, const VoiceInkUtterance* utterance, char* jobId, size_t jobIdSize) {
+        auto* target = static_cast<UtteranceSinkTarget*>(context);
+        
+        // The job keeps the recorder's samples until it completes; no copy
+        AudioSampleView audio;
+        audio.data = utterance->samples;
+        audio.sampleCount = utterance->frameCount;
+        audio.owner = std::shared_ptr<void>(utterance->samplesOwner, utterance->releaseSamples);
+        
+        std::lock_guard<std::mutex> lock(target->m_mutex);
+        if (!target->m_transcriber) {
+            return 0;
+        }
+        std::string id = target->m_transcriber->addDictationAudio(utterance->session, std::move(audio),
+                                                                  static_cast<int>(utterance->sampleRate),
+                                                                  utterance->startTime, target->m_options);
+        if (id.empty()) {
+            return 0;
+        }
+        if (jobIdSize > 0) {
+            const size_t length = std::min(id.size(), jobIdSize - 1);
+            std::copy(id.begin(), id.begin() + length, jobId);
+            jobId[length] = '\0';
+        }
+        return 1;
+    }
+
+    static void EndSession(void* context, uint64_t session, uint64_t) {
+        auto* target = static_cast<UtteranceSinkTarget*>(context);
+        std::lock_guard<std::mutex> lock(target->m_mutex);
+        if (target->m_transcriber) {
+            target->m_transcriber->endDictation(session);
+        }
+    }
+
+    std::atomic<int> m_references{ 1 };
+    std::mutex m_mutex;
+    WhisperTranscription* m_transcriber;
+    const AudioProcessingOptions m_options;
+};
+
+// Per-environment state. Init runs once for the main thread and once for
+// every worker_thread that loads the addon; each copy is freed with its
+// environment. Models and the worker pool are process-wide instead, see
+// WhisperModelRegistry and SharedWorkerPool.
+struct WhisperAddonData {
+    Napi::FunctionReference constructor;
+    // Encoded result storage recycled across all instances in this environment
+    std::shared_ptr<BufferPool<uint8_t>> resultPool = std::make_shared<BufferPool<uint8_t>>(4);
+};
 
 class WhisperBinding : public Napi::ObjectWrap<WhisperBinding> {
+    friend class AwaitDictationWorker;
+
 private:
     std::unique_ptr<WhisperTranscription> m_transcriber;
+    std::unique_ptr<JsReferenceReleaser> m_audioReleaser;
     Napi::ThreadSafeFunction m_progressCallback;
     Napi::ThreadSafeFunction m_downloadCallback;
-    Napi::ThreadSafeFunction m_partialResultCallback;
+    std::shared_ptr<PartialResultStreams> m_partialResults;
+    std::shared_ptr<BufferPool<uint8_t>> m_resultPool;
+    std::shared_ptr<InFlightModelLoad> m_modelLoad;
+    std::vector<UtteranceSinkTarget*> m_utteranceTargets; // One reference each
 
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports) {
@@ -20,10 +340,13 @@ public:
             InstanceMethod("downloadModel", &WhisperBinding::DownloadModel),
             InstanceMethod("loadModel", &WhisperBinding::LoadModel),
             InstanceMethod("unloadModel", &WhisperBinding::UnloadModel),
+            InstanceMethod("cancelModelLoad", &WhisperBinding::CancelModelLoad),
             InstanceMethod("isModelLoaded", &WhisperBinding::IsModelLoaded),
             InstanceMethod("transcribeBuffer", &WhisperBinding::TranscribeBuffer),
             InstanceMethod("transcribeFile", &WhisperBinding::TranscribeFile),
             InstanceMethod("queueTranscription", &WhisperBinding::QueueTranscription),
+            InstanceMethod("createUtteranceSink", &WhisperBinding::CreateUtteranceSink),
+            InstanceMethod("awaitDictation", &WhisperBinding::AwaitDictation),
             InstanceMethod("getTranscriptionProgress", &WhisperBinding::GetTranscriptionProgress),
             InstanceMethod("getAllTranscriptionProgress", &WhisperBinding::GetAllTranscriptionProgress),
             InstanceMethod("cancelTranscription", &WhisperBinding::CancelTranscription),
@@ -43,18 +366,21 @@ public:
             InstanceMethod("setProgressCallback", &WhisperBinding::SetProgressCallback),
             InstanceMethod("setDownloadCallback", &WhisperBinding::SetDownloadCallback),
             InstanceMethod("setPartialResultCallback", &WhisperBinding::SetPartialResultCallback),
+            InstanceMethod("emitPartialResult", &WhisperBinding::EmitPartialResult),
             InstanceMethod("getLastError", &WhisperBinding::GetLastError),
             InstanceMethod("hasError", &WhisperBinding::HasError),
             InstanceMethod("clearError", &WhisperBinding::ClearError),
             InstanceMethod("setModelPath", &WhisperBinding::SetModelPath),
             InstanceMethod("getModelPath", &WhisperBinding::GetModelPath),
             InstanceMethod("setTempPath", &WhisperBinding::SetTempPath),
-            InstanceMethod("getTempPath", &WhisperBinding::GetTempPath)
+            InstanceMethod("getTempPath", &WhisperBinding::GetTempPath),
+            StaticMethod("encodeSyntheticResult", &WhisperBinding::EncodeSyntheticResult),
+            StaticMethod("getSharedResourceStats", &WhisperBinding::GetSharedResourceStats)
         });
 
-        Napi::FunctionReference* constructor = new Napi::FunctionReference();
-        *constructor = Napi::Persistent(func);
-        env.SetInstanceData(constructor);
+        auto* data = new WhisperAddonData();
+        data->constructor = Napi::Persistent(func);
+        env.SetInstanceData(data);
 
         exports.Set("WhisperTranscription", func);
         return exports;
@@ -62,18 +388,27 @@ public:
 
     WhisperBinding(const Napi::CallbackInfo& info) : Napi::ObjectWrap<WhisperBinding>(info) {
         m_transcriber = std::make_unique<WhisperTranscription>();
+        m_audioReleaser = std::make_unique<JsReferenceReleaser>(info.Env());
+        m_resultPool = info.Env().GetInstanceData<WhisperAddonData>()->resultPool;
     }
 
     ~WhisperBinding() {
+        // Recorders may still hold sinks; they stop queueing here
+        for (UtteranceSinkTarget* target : m_utteranceTargets) {
+            target->Detach();
+            UtteranceSinkTarget::Release(target);
+        }
+        // Waits for running jobs, which report through the callbacks until
+        // they settle, so those have to outlive it
+        m_transcriber->cleanup();
+        m_transcriber->setProgressCallback(nullptr);
+        m_transcriber->setPartialResultCallback(nullptr);
         if (m_progressCallback) {
             m_progressCallback.Release();
         }
         if (m_downloadCallback) {
             m_downloadCallback.Release();
         }
-        if (m_partialResultCallback) {
-            m_partialResultCallback.Release();
-        }
     }
 
     Napi::Value Initialize(const Napi::CallbackInfo& info) {
@@ -161,6 +496,7 @@ public:
         return Napi::Boolean::New(env, result);
     }
 
+    // loadModel(modelId, onProgress?, { signal }?) -> Promise<boolean>
     Napi::Value LoadModel(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
         
@@ -170,14 +506,73 @@ public:
         }
         
         std::string modelId = info[0].As<Napi::String>().Utf8Value();
-        bool result = m_transcriber->loadModel(modelId);
-        return Napi::Boolean::New(env, result);
+        
+        Napi::Function progressCallback;
+        if (info.Length() > 1 && info[1].IsFunction()) {
+            progressCallback = info[1].As<Napi::Function>();
+        }
+        Napi::Value signal = abortSignalOption(info, progressCallback.IsEmpty() ? 1 : 2);
+        if (env.IsExceptionPending()) {
+            return env.Null();
+        }
+        if (signal.IsObject() && AbortSignalLink::IsAborted(signal.As<Napi::Object>())) {
+            return AbortSignalLink::RejectedPromise(env, signal.As<Napi::Object>());
+        }
+        
+        // Join a load of the same model that is still running; a different
+        // model supersedes it. A call with its own signal gets its own
+        // promise, though it still shares the underlying load.
+        if (m_modelLoad && !m_modelLoad->finished) {
+            if (m_modelLoad->modelId == modelId && !signal.IsObject()) {
+                return m_modelLoad->promise.Value();
+            }
+            if (m_modelLoad->modelId != modelId) {
+                m_modelLoad->cancelled->store(true);
+            }
+        }
+        
+        auto load = std::make_shared<InFlightModelLoad>();
+        load->modelId = modelId;
+        
+        auto* worker = new LoadModelWorker(env, info.This().As<Napi::Object>(), m_transcriber.get(),
+                                           load, progressCallback);
+        if (signal.IsObject()) {
+            worker->LinkAbortSignal(signal.As<Napi::Object>(), load->cancelled);
+        }
+        Napi::Promise promise = worker->GetPromise();
+        load->promise = Napi::Persistent(promise);
+        m_modelLoad = std::move(load);
+        worker->Queue();
+        
+        return promise;
     }
 
+    // unloadModel() -> Promise<boolean>; cancels a load still in flight
     Napi::Value UnloadModel(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
-        bool result = m_transcriber->unloadModel();
-        return Napi::Boolean::New(env, result);
+        
+        cancelModelLoad();
+        
+        auto* worker = new UnloadModelWorker(env, info.This().As<Napi::Object>(), m_transcriber.get());
+        Napi::Promise promise = worker->GetPromise();
+        worker->Queue();
+        
+        return promise;
+    }
+
+    Napi::Value CancelModelLoad(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        return Napi::Boolean::New(env, cancelModelLoad());
+    }
+
+    // Returns true if a load was in flight. Loads of the same model by other
+    // instances carry on; the shared load stops once all of them cancel.
+    bool cancelModelLoad() {
+        if (!m_modelLoad || m_modelLoad->finished) {
+            return false;
+        }
+        m_modelLoad->cancelled->store(true);
+        return true;
     }
 
     Napi::Value IsModelLoaded(const Napi::CallbackInfo& info) {
@@ -189,13 +584,12 @@ public:
     Napi::Value TranscribeBuffer(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
         
-        if (info.Length() < 3 || !info[0].IsTypedArray() || !info[1].IsNumber() || !info[2].IsNumber()) {
+        if (info.Length() < 3 || !isAudioArgument(info[0]) || !info[1].IsNumber() || !info[2].IsNumber()) {
             Napi::TypeError::New(env, "Audio buffer, sample count, and sample rate required").ThrowAsJavaScriptException();
             return env.Null();
         }
         
-        Napi::Float32Array audioArray = info[0].As<Napi::Float32Array>();
-        size_t sampleCount = info[1].As<Napi::Number>().Uint32Value();
+        AudioSampleView audio = pinAudio(env, info[0], info[1].As<Napi::Number>().Uint32Value());
         int sampleRate = info[2].As<Napi::Number>().Int32Value();
         
         // Parse options if provided
@@ -205,22 +599,35 @@ public:
             parseAudioProcessingOptions(optionsObj, options);
         }
         
-        const float* audioData = audioArray.Data();
-        std::string result = m_transcriber->transcribeBuffer(audioData, sampleCount, sampleRate, options);
+        Napi::Value signal = abortSignalOption(info, 3);
+        if (env.IsExceptionPending()) {
+            return env.Null();
+        }
+        if (signal.IsObject() && AbortSignalLink::IsAborted(signal.As<Napi::Object>())) {
+            return AbortSignalLink::RejectedPromise(env, signal.As<Napi::Object>());
+        }
+        
+        // Inference runs on a pool thread; resolves with the transcribed text
+        auto* worker = new TranscribeBufferWorker(env, info.This().As<Napi::Object>(), m_transcriber.get(),
+                                                  std::move(audio), sampleRate, options);
+        if (signal.IsObject()) {
+            worker->LinkAbortSignal(signal.As<Napi::Object>(), worker->CancelFlag());
+        }
+        Napi::Promise promise = worker->GetPromise();
+        worker->Queue();
         
-        return Napi::String::New(env, result);
+        return promise;
     }
 
     Napi::Value QueueTranscription(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
         
-        if (info.Length() < 3 || !info[0].IsTypedArray() || !info[1].IsNumber() || !info[2].IsNumber()) {
+        if (info.Length() < 3 || !isAudioArgument(info[0]) || !info[1].IsNumber() || !info[2].IsNumber()) {
             Napi::TypeError::New(env, "Audio buffer, sample count, and sample rate required").ThrowAsJavaScriptException();
             return env.Null();
         }
         
-        Napi::Float32Array audioArray = info[0].As<Napi::Float32Array>();
-        size_t sampleCount = info[1].As<Napi::Number>().Uint32Value();
+        AudioSampleView audio = pinAudio(env, info[0], info[1].As<Napi::Number>().Uint32Value());
         int sampleRate = info[2].As<Napi::Number>().Int32Value();
         
         AudioProcessingOptions options;
@@ -229,12 +636,80 @@ public:
             parseAudioProcessingOptions(optionsObj, options);
         }
         
-        const float* audioData = audioArray.Data();
-        std::string jobId = m_transcriber->queueTranscription(audioData, sampleCount, sampleRate, options);
+        // The job borrows the caller's buffer; the pin is dropped when it completes
+        std::string jobId = m_transcriber->queueTranscription(std::move(audio), sampleRate, options);
         
         return Napi::String::New(env, jobId);
     }
 
+    // createUtteranceSink(options?) -> sink for the recorder's setUtteranceSink().
+    // Each utterance the recorder endpoints is queued here directly, with
+    // these processing options, as if passed to queueTranscription().
+    Napi::Value CreateUtteranceSink(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        AudioProcessingOptions options;
+        if (info.Length() > 0 && info[0].IsObject()) {
+            parseAudioProcessingOptions(info[0].As<Napi::Object>(), options);
+        }
+        
+        // Forget sinks nobody holds any more
+        m_utteranceTargets.erase(std::remove_if(m_utteranceTargets.begin(), m_utteranceTargets.end(),
+            [](UtteranceSinkTarget* target) {
+                if (!target->Unused()) {
+                    return false;
+                }
+                UtteranceSinkTarget::Release(target);
+                return true;
+            }), m_utteranceTargets.end());
+        
+        auto* target = new UtteranceSinkTarget(m_transcriber.get(), options);
+        m_utteranceTargets.push_back(target);
+        
+        // The External owns a copy of the description and one reference
+        UtteranceSinkTarget::Retain(target);
+        auto* sink = new VoiceInkUtteranceSink(target->Describe());
+        auto external = Napi::External<VoiceInkUtteranceSink>::New(env, sink, [](Napi::Env, VoiceInkUtteranceSink* sink) {
+            sink->release(sink->context);
+            delete sink;
+        });
+        
+        static const napi_type_tag kSinkTag = { VOICEINK_UTTERANCE_SINK_TAG_LOWER, VOICEINK_UTTERANCE_SINK_TAG_UPPER };
+        napi_type_tag_object(env, external, &kSinkTag);
+        return external;
+    }
+
+    // awaitDictation(sessionId, { signal? }) -> Promise<result>
+    // Settles once the recorder has ended session `sessionId` (see
+    // WASAPIRecorder.getSessionId()) and each of its pieces is transcribed;
+    // resolves with them merged onto one timeline. A session can be awaited once.
+    Napi::Value AwaitDictation(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Session ID required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        Napi::Value signal = abortSignalOption(info, 1);
+        if (env.IsExceptionPending()) {
+            return env.Null();
+        }
+        if (signal.IsObject() && AbortSignalLink::IsAborted(signal.As<Napi::Object>())) {
+            return AbortSignalLink::RejectedPromise(env, signal.As<Napi::Object>());
+        }
+        
+        const uint64_t sessionId = static_cast<uint64_t>(info[0].As<Napi::Number>().Int64Value());
+        auto* worker = new AwaitDictationWorker(env, info.This().As<Napi::Object>(), m_transcriber.get(), sessionId);
+        if (signal.IsObject()) {
+            worker->LinkAbortSignal(signal.As<Napi::Object>(), worker->CancelFlag());
+        }
+        Napi::Promise promise = worker->GetPromise();
+        worker->Queue();
+        
+        return promise;
+    }
+
     Napi::Value GetTranscriptionProgress(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
         
@@ -246,25 +721,62 @@ public:
         std::string jobId = info[0].As<Napi::String>().Utf8Value();
         TranscriptionProgress progress = m_transcriber->getTranscriptionProgress(jobId);
         
-        return transcriptionProgressToJS(env, progress);
+        if (wantsBinaryResult(info, 1) && progress.status == TranscriptionProgress::COMPLETED) {
+            std::vector<uint8_t> encoded = m_resultPool->Acquire();
+            EncodeTranscriptionResult(progress.result, encoded);
+            return transcriptionProgressToJS(env, progress, m_resultPool, &encoded);
+        }
+        return transcriptionProgressToJS(env, progress, m_resultPool);
+    }
+
+    // Safe to call while the job runs; its progress callback then reports
+    // status CANCELLED
+    Napi::Value CancelTranscription(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsString()) {
+            Napi::TypeError::New(env, "Job ID required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        bool cancelled = m_transcriber->cancelTranscription(info[0].As<Napi::String>().Utf8Value());
+        return Napi::Boolean::New(env, cancelled);
+    }
+
+    Napi::Value ClearTranscriptionQueue(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        m_transcriber->clearTranscriptionQueue();
+        return env.Undefined();
     }
 
     Napi::Value DetectLanguage(const Napi::CallbackInfo& info) {
         Napi::Env env = info.Env();
         
-        if (info.Length() < 3 || !info[0].IsTypedArray() || !info[1].IsNumber() || !info[2].IsNumber()) {
+        if (info.Length() < 3 || !isAudioArgument(info[0]) || !info[1].IsNumber() || !info[2].IsNumber()) {
             Napi::TypeError::New(env, "Audio buffer, sample count, and sample rate required").ThrowAsJavaScriptException();
             return env.Null();
         }
         
-        Napi::Float32Array audioArray = info[0].As<Napi::Float32Array>();
-        size_t sampleCount = info[1].As<Napi::Number>().Uint32Value();
+        AudioSampleView audio = pinAudio(env, info[0], info[1].As<Napi::Number>().Uint32Value());
         int sampleRate = info[2].As<Napi::Number>().Int32Value();
         
-        const float* audioData = audioArray.Data();
-        std::string language = m_transcriber->detectLanguage(audioData, sampleCount, sampleRate);
+        Napi::Value signal = abortSignalOption(info, 3);
+        if (env.IsExceptionPending()) {
+            return env.Null();
+        }
+        if (signal.IsObject() && AbortSignalLink::IsAborted(signal.As<Napi::Object>())) {
+            return AbortSignalLink::RejectedPromise(env, signal.As<Napi::Object>());
+        }
+        
+        auto* worker = new DetectLanguageWorker(env, info.This().As<Napi::Object>(), m_transcriber.get(),
+                                                std::move(audio), sampleRate);
+        if (signal.IsObject()) {
+            worker->LinkAbortSignal(signal.As<Napi::Object>(), worker->CancelFlag());
+        }
+        Napi::Promise promise = worker->GetPromise();
+        worker->Queue();
         
-        return Napi::String::New(env, language);
+        return promise;
     }
 
     Napi::Value GetPerformanceStats(const Napi::CallbackInfo& info) {
@@ -295,11 +807,7 @@ public:
             return env.Null();
         }
         
-        if (m_progressCallback) {
-            m_progressCallback.Release();
-        }
-        
-        m_progressCallback = Napi::ThreadSafeFunction::New(
+        Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
             env,
             info[0].As<Napi::Function>(),
             "ProgressCallback",
@@ -307,14 +815,101 @@ public:
             1
         );
         
-        m_transcriber->setProgressCallback([this](const TranscriptionProgress& progress) {
+        // With { binary: true } completed results are encoded here, on the
+        // transcription thread, and reach JS as a single ArrayBuffer. Queued
+        // calls may run after this object is collected, so they hold only
+        // the function and the pool.
+        const bool binary = wantsBinaryResult(info, 1);
+        std::shared_ptr<BufferPool<uint8_t>> pool = m_resultPool;
+        
+        m_transcriber->setProgressCallback([tsfn, pool, binary](const TranscriptionProgress& progress) {
+            auto encoded = std::make_shared<std::vector<uint8_t>>();
+            if (binary && progress.status == TranscriptionProgress::COMPLETED) {
+                *encoded = pool->Acquire();
+                EncodeTranscriptionResult(progress.result, *encoded);
+            }
+            
             auto callback = [=](Napi::Env env, Napi::Function jsCallback) {
-                jsCallback.Call({ transcriptionProgressToJS(env, progress) });
+                jsCallback.Call({ transcriptionProgressToJS(env, progress, pool, binary ? encoded.get() : nullptr) });
             };
             
-            m_progressCallback.NonBlockingCall(callback);
+            tsfn.NonBlockingCall(callback);
         });
         
+        // The old callback can no longer be running once the swap returns
+        if (m_progressCallback) {
+            m_progressCallback.Release();
+        }
+        m_progressCallback = tsfn;
+        
+        return env.Undefined();
+    }
+
+    // Streams partial results as deltas: callback(streamId, delta), where
+    // delta carries only newly committed segments plus the replacement tail.
+    // Deltas produced while the JS thread is busy are merged, not queued.
+    Napi::Value SetPartialResultCallback(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Callback function required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        auto streams = std::make_shared<PartialResultStreams>();
+        streams->channel = std::make_unique<CoalescingChannel<PartialResultDelta>>(
+            env, info[0].As<Napi::Function>(), "PartialResultCallback",
+            [](Napi::Env env, Napi::Function jsCallback, const std::string& streamId, PartialResultDelta&& delta) {
+                jsCallback.Call({ Napi::String::New(env, streamId), partialResultDeltaToJS(env, delta) });
+            });
+        
+        m_transcriber->setPartialResultCallback(
+            [streams](const std::string& streamId, const TranscriptionResult& result, bool isFinal) {
+                PartialResultDelta delta;
+                {
+                    std::lock_guard<std::mutex> lock(streams->mutex);
+                    if (!streams->trackers[streamId].Update(result, isFinal, delta)) {
+                        return;
+                    }
+                    if (isFinal) {
+                        streams->trackers.erase(streamId);
+                    }
+                }
+                streams->channel->Post(streamId, std::move(delta));
+            });
+        m_partialResults = std::move(streams);
+        
+        return env.Undefined();
+    }
+
+    // Test hook: emitPartialResult(streamId, segments, isFinal) feeds one
+    // partial result, given as [{ startTime, endTime, text }], through the
+    // path a streaming transcription takes, delta tracking and coalescing
+    // included, so it can be exercised without a model.
+    Napi::Value EmitPartialResult(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 2 || !info[0].IsString() || !info[1].IsArray()) {
+            Napi::TypeError::New(env, "Stream ID and segments required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        Napi::Array segments = info[1].As<Napi::Array>();
+        TranscriptionResult result{};
+        result.segments.reserve(segments.Length());
+        for (uint32_t i = 0; i < segments.Length(); i++) {
+            Napi::Object segmentObj = segments.Get(i).As<Napi::Object>();
+            TranscriptionSegment segment{};
+            segment.startTime = segmentObj.Get("startTime").ToNumber().DoubleValue();
+            segment.endTime = segmentObj.Get("endTime").ToNumber().DoubleValue();
+            segment.text = segmentObj.Get("text").ToString().Utf8Value();
+            result.text += segment.text;
+            result.segments.push_back(std::move(segment));
+        }
+        result.segmentCount = result.segments.size();
+        
+        m_transcriber->reportPartialResult(info[0].As<Napi::String>().Utf8Value(), result,
+                                           info.Length() > 2 && info[2].ToBoolean().Value());
         return env.Undefined();
     }
 
@@ -337,6 +932,23 @@ public:
     }
 
 private:
+    static bool isAudioArgument(const Napi::Value& value) {
+        return value.IsTypedArray() || value.IsArray();
+    }
+
+    // Pins the caller's samples and returns a view over the first
+    // `requestedSamples` of them. Float32Arrays are not copied; plain arrays
+    // are converted once in bulk.
+    AudioSampleView pinAudio(Napi::Env env, const Napi::Value& value, uint32_t requestedSamples) {
+        Napi::Float32Array array = CoerceToFloat32Array(env, value);
+
+        AudioSampleView audio;
+        audio.data = array.Data();
+        audio.sampleCount = std::min<size_t>(requestedSamples, array.ElementLength());
+        audio.owner = m_audioReleaser->Pin(array);
+        return audio;
+    }
+
     void parseAudioProcessingOptions(const Napi::Object& optionsObj, AudioProcessingOptions& options) {
         if (optionsObj.Has("enableVAD") && optionsObj.Get("enableVAD").IsBoolean()) {
             options.enableVAD = optionsObj.Get("enableVAD").As<Napi::Boolean>().Value();
@@ -375,7 +987,132 @@ private:
         }
     }
 
-    Napi::Object transcriptionProgressToJS(Napi::Env env, const TranscriptionProgress& progress) {
+    static Napi::Object partialSegmentToJS(Napi::Env env, const PartialSegment& segment) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("startTime", Napi::Number::New(env, segment.startTime));
+        obj.Set("endTime", Napi::Number::New(env, segment.endTime));
+        obj.Set("text", Napi::String::New(env, segment.text));
+        return obj;
+    }
+
+    static Napi::Object partialResultDeltaToJS(Napi::Env env, const PartialResultDelta& delta) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("sequence", Napi::Number::New(env, static_cast<double>(delta.sequence)));
+        
+        Napi::Array committed = Napi::Array::New(env, delta.committed.size());
+        for (size_t i = 0; i < delta.committed.size(); i++) {
+            committed.Set(static_cast<uint32_t>(i), partialSegmentToJS(env, delta.committed[i]));
+        }
+        obj.Set("committed", committed);
+        obj.Set("committedCount", Napi::Number::New(env, static_cast<double>(delta.committedCount)));
+        obj.Set("tailOffset", Napi::Number::New(env, static_cast<double>(delta.tailOffset)));
+        obj.Set("tail", delta.tail.text.empty() ? env.Null() : partialSegmentToJS(env, delta.tail));
+        obj.Set("isFinal", Napi::Boolean::New(env, delta.isFinal));
+        
+        return obj;
+    }
+
+    // Process-wide model cache, as seen from any environment.
+    static Napi::Value GetSharedResourceStats(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        WhisperModelRegistry::Stats stats = WhisperModelRegistry::instance().getStats();
+        Napi::Object statsObj = Napi::Object::New(env);
+        statsObj.Set("loadedModels", Napi::Number::New(env, static_cast<double>(stats.loadedModels)));
+        statsObj.Set("modelReferences", Napi::Number::New(env, static_cast<double>(stats.references)));
+        
+        return statsObj;
+    }
+
+    // Reads `{ signal }` from an optional options argument. Returns undefined
+    // if absent; throws a TypeError if it is not AbortSignal-like.
+    static Napi::Value abortSignalOption(const Napi::CallbackInfo& info, size_t index) {
+        Napi::Env env = info.Env();
+        if (info.Length() <= index || !info[index].IsObject()) {
+            return env.Undefined();
+        }
+        Napi::Value signal = info[index].As<Napi::Object>().Get("signal");
+        if (signal.IsUndefined() || signal.IsNull()) {
+            return env.Undefined();
+        }
+        if (!AbortSignalLink::IsSignal(signal)) {
+            Napi::TypeError::New(env, "options.signal must be an AbortSignal").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        return signal;
+    }
+
+    // Reads `{ binary: true }` from an optional options argument.
+    static bool wantsBinaryResult(const Napi::CallbackInfo& info, size_t index) {
+        if (info.Length() <= index || !info[index].IsObject()) {
+            return false;
+        }
+        Napi::Value binary = info[index].As<Napi::Object>().Get("binary");
+        return binary.IsBoolean() && binary.As<Napi::Boolean>().Value();
+    }
+
+    // Benchmark helper: builds a synthetic result covering `seconds` of audio
+    // and converts it as a transcription would, as an object or (binary = true)
+    // as an ArrayBuffer for src/main/whisper/binaryResultReader.js.
+    static Napi::Value EncodeSyntheticResult(const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Duration in seconds required").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        
+        TranscriptionResult result = MakeSyntheticTranscriptionResult(info[0].As<Napi::Number>().DoubleValue());
+        if (info.Length() > 1 && info[1].ToBoolean().Value()) {
+            std::vector<uint8_t> encoded;
+            EncodeTranscriptionResult(result, encoded);
+            return MoveToArrayBuffer(env, std::move(encoded));
+        }
+        return transcriptionResultToJS(env, result);
+    }
+
+    static Napi::Object transcriptionResultToJS(Napi::Env env, const TranscriptionResult& result) {
+        Napi::Object resultObj = Napi::Object::New(env);
+        resultObj.Set("text", Napi::String::New(env, result.text));
+        resultObj.Set("language", Napi::String::New(env, result.language));
+        resultObj.Set("duration", Napi::Number::New(env, result.duration));
+        resultObj.Set("confidence", Napi::Number::New(env, result.confidence));
+        resultObj.Set("processingTime", Napi::Number::New(env, result.processingTime));
+        
+        Napi::Array segments = Napi::Array::New(env, result.segments.size());
+        for (size_t i = 0; i < result.segments.size(); i++) {
+            const TranscriptionSegment& segment = result.segments[i];
+            Napi::Object segmentObj = Napi::Object::New(env);
+            segmentObj.Set("startTime", Napi::Number::New(env, segment.startTime));
+            segmentObj.Set("endTime", Napi::Number::New(env, segment.endTime));
+            segmentObj.Set("text", Napi::String::New(env, segment.text));
+            segmentObj.Set("language", Napi::String::New(env, segment.language));
+            segmentObj.Set("confidence", Napi::Number::New(env, segment.confidence));
+            segmentObj.Set("speakerId", Napi::Number::New(env, segment.speakerId));
+            
+            Napi::Array words = Napi::Array::New(env, segment.words.size());
+            for (size_t w = 0; w < segment.words.size(); w++) {
+                Napi::Object wordObj = Napi::Object::New(env);
+                wordObj.Set("startTime", Napi::Number::New(env, w < segment.wordStartTimes.size() ? segment.wordStartTimes[w] : segment.startTime));
+                wordObj.Set("endTime", Napi::Number::New(env, w < segment.wordEndTimes.size() ? segment.wordEndTimes[w] : segment.endTime));
+                wordObj.Set("text", Napi::String::New(env, segment.words[w]));
+                wordObj.Set("confidence", Napi::Number::New(env, w < segment.wordConfidences.size() ? segment.wordConfidences[w] : segment.confidence));
+                words.Set(static_cast<uint32_t>(w), wordObj);
+            }
+            segmentObj.Set("words", words);
+            segments.Set(static_cast<uint32_t>(i), segmentObj);
+        }
+        resultObj.Set("segments", segments);
+        
+        return resultObj;
+    }
+
+    // `encodedResult`, when given, replaces the `result` object with a
+    // `resultBuffer` ArrayBuffer holding the binary encoding; its storage
+    // goes back to `pool` once JS drops the buffer.
+    static Napi::Object transcriptionProgressToJS(Napi::Env env, const TranscriptionProgress& progress,
+                                                  const std::shared_ptr<BufferPool<uint8_t>>& pool,
+                                                  std::vector<uint8_t>* encodedResult = nullptr) {
         Napi::Object progressObj = Napi::Object::New(env);
         
         progressObj.Set("id", Napi::String::New(env, progress.id));
@@ -388,13 +1125,11 @@ private:
         
         // Add result if completed
         if (progress.status == TranscriptionProgress::COMPLETED) {
-            Napi::Object resultObj = Napi::Object::New(env);
-            resultObj.Set("text", Napi::String::New(env, progress.result.text));
-            resultObj.Set("language", Napi::String::New(env, progress.result.language));
-            resultObj.Set("duration", Napi::Number::New(env, progress.result.duration));
-            resultObj.Set("confidence", Napi::Number::New(env, progress.result.confidence));
-            resultObj.Set("processingTime", Napi::Number::New(env, progress.result.processingTime));
-            progressObj.Set("result", resultObj);
+            if (encodedResult) {
+                progressObj.Set("resultBuffer", MoveToArrayBuffer(env, std::move(*encodedResult), pool));
+            } else {
+                progressObj.Set("result", transcriptionResultToJS(env, progress.result));
+            }
         }
         
         return progressObj;
@@ -404,8 +1139,6 @@ private:
     NAPI_METHOD_PLACEHOLDER(GetCurrentModel)
     NAPI_METHOD_PLACEHOLDER(TranscribeFile)
     NAPI_METHOD_PLACEHOLDER(GetAllTranscriptionProgress)
-    NAPI_METHOD_PLACEHOLDER(CancelTranscription)
-    NAPI_METHOD_PLACEHOLDER(ClearTranscriptionQueue)
     NAPI_METHOD_PLACEHOLDER(GetLanguageProbabilities)
     NAPI_METHOD_PLACEHOLDER(GetSupportedLanguages)
     NAPI_METHOD_PLACEHOLDER(PreprocessAudio)
@@ -417,18 +1150,15 @@ private:
     NAPI_METHOD_PLACEHOLDER(ResetPerformanceStats)
     NAPI_METHOD_PLACEHOLDER(IsGPUAvailable)
     NAPI_METHOD_PLACEHOLDER(SetDownloadCallback)
-    NAPI_METHOD_PLACEHOLDER(SetPartialResultCallback)
     NAPI_METHOD_PLACEHOLDER(SetModelPath)
     NAPI_METHOD_PLACEHOLDER(GetModelPath)
     NAPI_METHOD_PLACEHOLDER(SetTempPath)
     NAPI_METHOD_PLACEHOLDER(GetTempPath)
 };
 
-#define NAPI_METHOD_PLACEHOLDER(name) \
-    Napi::Value name(const Napi::CallbackInfo& info) { \
-        Napi::Env env = info.Env(); \
-        return env.Undefined(); \
-    }
+Napi::Value AwaitDictationWorker::Resolve(Napi::Env env) {
+    return WhisperBinding::transcriptionResultToJS(env, m_result);
+}
 
 Napi::Object InitModule(Napi::Env env, Napi::Object exports) {
     return WhisperBinding::Init(env, exports);
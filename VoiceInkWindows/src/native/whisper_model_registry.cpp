@@ -0,0 +1,196 @@
+#include "whisper_model_registry.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#ifdef WHISPER_CPP_AVAILABLE
+#include "whisper.h"
+#endif
+
+namespace {
+
+bool isCancelled(const ModelLoadRequest& request) {
+    return request.cancelled && request.cancelled->load();
+}
+
+} // namespace
+
+SharedWhisperModel::~SharedWhisperModel() {
+    if (context) {
+#ifdef WHISPER_CPP_AVAILABLE
+        whisper_free(context);
+#endif
+        context = nullptr;
+        std::cout << "Whisper model released: " << path << std::endl;
+    }
+}
+
+WhisperModelRegistry& WhisperModelRegistry::instance() {
+    // Intentionally leaked: models may still be held by environments that
+    // are torn down after static destructors have run
+    static WhisperModelRegistry* registry = new WhisperModelRegistry();
+    return *registry;
+}
+
+std::shared_ptr<SharedWhisperModel> WhisperModelRegistry::acquire(const std::string& path, std::string& error,
+                                                                  const ModelLoadRequest& request) {
+    std::shared_ptr<SharedWhisperModel> model;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        model = m_models[path].lock();
+        if (!model) {
+            model = std::make_shared<SharedWhisperModel>();
+            model->path = path;
+            m_models[path] = model;
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(model->loadMutex);
+    model->waiters.push_back(&request);
+
+    for (;;) {
+        if (model->loadState == SharedWhisperModel::LOADED) {
+            if (request.onProgress) {
+                ModelLoadProgress ready = model->lastProgress;
+                ready.stage = ModelLoadProgress::READY;
+                request.onProgress(ready);
+            }
+            break;
+        }
+
+        if (model->loadState != SharedWhisperModel::LOADING) {
+            // Nobody is loading it (or the last attempt failed): this caller loads
+            model->loadState = SharedWhisperModel::LOADING;
+            model->lastProgress = ModelLoadProgress();
+            lock.unlock();
+
+            std::string loadError;
+            const bool loaded = loadInto(*model, loadError);
+
+            lock.lock();
+            model->loadState = loaded ? SharedWhisperModel::LOADED : SharedWhisperModel::FAILED;
+            model->loadError = loadError;
+            model->loadDone.notify_all();
+            break;
+        }
+
+        // Join the in-flight load, catching up on its progress so far
+        if (request.onProgress && model->lastProgress.totalBytes > 0) {
+            request.onProgress(model->lastProgress);
+        }
+        while (model->loadState == SharedWhisperModel::LOADING && !isCancelled(request)) {
+            model->loadDone.wait_for(lock, std::chrono::milliseconds(50));
+        }
+
+        // A load abandoned by everyone else is retried for a caller still waiting
+        const bool abandoned = model->loadState == SharedWhisperModel::FAILED &&
+                               model->loadError == kCancelledError;
+        if (!abandoned || isCancelled(request)) {
+            break;
+        }
+    }
+
+    model->waiters.erase(std::remove(model->waiters.begin(), model->waiters.end(), &request), model->waiters.end());
+
+    if (isCancelled(request)) {
+        error = kCancelledError;
+        return nullptr;
+    }
+    if (model->loadState != SharedWhisperModel::LOADED) {
+        error = model->loadError;
+        return nullptr;
+    }
+    return model;
+}
+
+bool WhisperModelRegistry::loadInto(SharedWhisperModel& model, std::string& error) {
+    GgmlModelReader reader;
+    if (!reader.Open(model.path, error)) {
+        return false;
+    }
+
+    // Progress goes to every request sharing the load, under the load mutex
+    // so a request cannot leave while it is being notified
+    reader.SetProgressCallback([&model](const ModelLoadProgress& progress) {
+        std::lock_guard<std::mutex> lock(model.loadMutex);
+        model.lastProgress = progress;
+        for (const ModelLoadRequest* waiter : model.waiters) {
+            if (waiter->onProgress && !isCancelled(*waiter)) {
+                waiter->onProgress(progress);
+            }
+        }
+    });
+    reader.SetCancelCheck([&model]() {
+        std::lock_guard<std::mutex> lock(model.loadMutex);
+        return std::all_of(model.waiters.begin(), model.waiters.end(),
+                           [](const ModelLoadRequest* waiter) { return isCancelled(*waiter); });
+    });
+
+#ifdef WHISPER_CPP_AVAILABLE
+    // whisper.cpp pulls the file through the reader, so its reads drive progress
+    whisper_model_loader loader = {};
+    loader.context = &reader;
+    loader.read = [](void* ctx, void* output, size_t size) { return static_cast<GgmlModelReader*>(ctx)->Read(output, size); };
+    loader.eof = [](void* ctx) { return static_cast<GgmlModelReader*>(ctx)->Eof(); };
+    loader.close = [](void* ctx) { static_cast<GgmlModelReader*>(ctx)->Close(); };
+    whisper_context* context = whisper_init_with_params(&loader, whisper_context_default_params());
+#else
+    // Mock loading for compilation without whisper.cpp; the file is still read
+    whisper_context* context = reader.Drain() ? reinterpret_cast<whisper_context*>(0x1) : nullptr; // Non-null pointer
+    reader.Close();
+    std::cout << "Mock: Loading Whisper model: " << model.path << std::endl;
+#endif
+
+    if (reader.Cancelled()) {
+#ifdef WHISPER_CPP_AVAILABLE
+        if (context) {
+            whisper_free(context);
+        }
+#endif
+        error = kCancelledError;
+        return false;
+    }
+    if (!context) {
+        error = "Failed to load Whisper model from: " + model.path;
+        return false;
+    }
+    model.context = context;
+
+    reader.ReportStage(ModelLoadProgress::WARMUP);
+#ifdef WHISPER_CPP_AVAILABLE
+    // One second of silence through the full pipeline, so the first real
+    // transcription does not pay for the compute buffers
+    {
+        std::lock_guard<std::timed_mutex> inferenceLock(model.inferenceMutex);
+        std::vector<float> silence(WHISPER_SAMPLE_RATE, 0.0f);
+        whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+        params.print_progress = false;
+        params.print_realtime = false;
+        params.print_timestamps = false;
+        params.single_segment = true;
+        params.no_context = true;
+        whisper_full(context, params, silence.data(), static_cast<int>(silence.size()));
+    }
+#endif
+    reader.ReportStage(ModelLoadProgress::READY);
+    return true;
+}
+
+WhisperModelRegistry::Stats WhisperModelRegistry::getStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats{ 0, 0 };
+    for (auto it = m_models.begin(); it != m_models.end();) {
+        long holders = it->second.use_count();
+        if (holders == 0) {
+            it = m_models.erase(it);
+            continue;
+        }
+        std::shared_ptr<SharedWhisperModel> model = it->second.lock();
+        if (model && model->context) {
+            stats.loadedModels++;
+            stats.references += static_cast<size_t>(holders);
+        }
+        ++it;
+    }
+    return stats;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ggml_model_reader.h"
+
+struct whisper_context;
+
+// One caller's interest in a model load. Requests for a model that is
+// already loading join that load and receive its progress from then on.
+struct ModelLoadRequest {
+    ModelLoadProgressCallback onProgress;           // Called on the loading thread
+    std::shared_ptr<std::atomic<bool>> cancelled;   // Set to abandon this request
+};
+
+// A Whisper model loaded once for the whole process. The context is freed
+// when the last holder drops its reference.
+struct SharedWhisperModel {
+    std::string path;
+    whisper_context* context = nullptr;
+    std::timed_mutex inferenceMutex; // whisper_context is not re-entrant; hold for every whisper_full call
+
+    ~SharedWhisperModel();
+
+private:
+    friend class WhisperModelRegistry;
+
+    enum LoadState { NOT_LOADED, LOADING, LOADED, FAILED };
+
+    std::mutex loadMutex;
+    std::condition_variable loadDone;
+    LoadState loadState = NOT_LOADED;
+    std::string loadError;
+    ModelLoadProgress lastProgress;
+    std::vector<const ModelLoadRequest*> waiters; // Requests sharing the in-flight load
+};
+
+// Process-wide, reference-counted cache of loaded models.
+//
+// Every WhisperTranscription, in every environment that loads the addon,
+// goes through here, so eight worker_threads loading the same model share
+// one copy of the weights instead of eight.
+class WhisperModelRegistry {
+public:
+    static WhisperModelRegistry& instance();
+
+    // Returns the model at `path`, loading it if no one holds it yet.
+    // Concurrent callers for the same path share a single load; it is only
+    // abandoned once every one of them has cancelled. Blocks until the model
+    // is ready, the load fails, or this request is cancelled. Returns null
+    // and fills `error` on failure.
+    std::shared_ptr<SharedWhisperModel> acquire(const std::string& path, std::string& error,
+                                                const ModelLoadRequest& request = ModelLoadRequest());
+
+    struct Stats {
+        size_t loadedModels;   // Distinct models currently in memory
+        size_t references;     // Sum of holders across all models
+    };
+    Stats getStats();
+
+    static constexpr const char* kCancelledError = "Model load cancelled";
+
+private:
+    WhisperModelRegistry() = default;
+
+    // Reads and initializes the model; runs without any registry lock held.
+    static bool loadInto(SharedWhisperModel& model, std::string& error);
+
+    std::mutex m_mutex;
+    std::map<std::string, std::weak_ptr<SharedWhisperModel>> m_models;
+};
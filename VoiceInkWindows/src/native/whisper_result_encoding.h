@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "whisper_transcription.h"
+#include "binary_result_builder.h"
+
+// Encodes a TranscriptionResult into the flat binary layout described in
+// binary_result_builder.h. Safe to call on any thread; `out` is overwritten.
+inline void EncodeTranscriptionResult(const TranscriptionResult& result, std::vector<uint8_t>& out) {
+    size_t wordCount = 0;
+    for (const TranscriptionSegment& segment : result.segments) {
+        wordCount += segment.words.size();
+    }
+
+    BinaryResultBuilder builder;
+    builder.Reserve(result.segments.size(), wordCount);
+    builder.SetSummary(result.text, result.language, result.duration, result.confidence,
+                       static_cast<float>(result.processingTime));
+
+    for (const TranscriptionSegment& segment : result.segments) {
+        builder.AddSegment(segment.startTime, segment.endTime, segment.text, segment.language,
+                           segment.confidence, segment.speakerId);
+
+        for (size_t i = 0; i < segment.words.size(); ++i) {
+            const double start = i < segment.wordStartTimes.size() ? segment.wordStartTimes[i] : segment.startTime;
+            const double end = i < segment.wordEndTimes.size() ? segment.wordEndTimes[i] : segment.endTime;
+            const float confidence = i < segment.wordConfidences.size() ? segment.wordConfidences[i] : segment.confidence;
+            builder.AddWord(start, end, segment.words[i], confidence);
+        }
+    }
+
+    builder.Finish(out);
+}
+
+// Deterministic result of roughly the shape whisper produces for `seconds` of
+// speech: 5 s segments at 2.5 words per second, with word timings and
+// distinct segment texts. Used to benchmark result conversion without a model.
+inline TranscriptionResult MakeSyntheticTranscriptionResult(double seconds) {
+    static const char* const kWords[] = {
+        "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog",
+        "meeting", "notes", "café", "résumé", "voice", "input", "today", "and"
+    };
+    constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+    constexpr double kSegmentSeconds = 5.0;
+    constexpr double kWordSeconds = 0.4;
+
+    TranscriptionResult result{};
+    result.language = "en";
+    result.duration = seconds;
+    result.confidence = 0.92f;
+    result.speakerCount = 1;
+    result.processingTime = seconds * 0.1;
+
+    uint32_t seed = 1;
+    for (double start = 0.0; start < seconds; start += kSegmentSeconds) {
+        TranscriptionSegment segment{};
+        segment.startTime = start;
+        segment.endTime = start + kSegmentSeconds < seconds ? start + kSegmentSeconds : seconds;
+        segment.language = "en";
+        segment.speakerId = 0;
+        segment.confidence = 0.9f;
+        segment.probability = 0.9f;
+
+        for (double t = segment.startTime; t + kWordSeconds <= segment.endTime; t += kWordSeconds) {
+            seed = seed * 1103515245u + 12345u;
+            const char* word = kWords[(seed >> 16) % kWordCount];
+            segment.text += ' ';
+            segment.text += word;
+            segment.words.emplace_back(word);
+            segment.wordStartTimes.push_back(t);
+            segment.wordEndTimes.push_back(t + kWordSeconds * 0.9);
+            segment.wordConfidences.push_back(0.85f + 0.01f * static_cast<float>(seed % 10));
+        }
+
+        result.text += segment.text;
+        result.segments.push_back(std::move(segment));
+    }
+
+    return result;
+}
@@ -1,14 +1,17 @@
 #include "whisper_transcription.h"
+#include "polyphase_resampler.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <chrono>
-#include <random>
+#include <cstdlib>
 #include <filesystem>
 #include <cmath>
 #include <iostream>
 #include <future>
 #include <regex>
+#include <set>
+#include <thread>
 
 // Include Whisper.cpp headers (would normally be from the whisper.cpp submodule)
 #ifdef WHISPER_CPP_AVAILABLE
@@ -59,16 +62,33 @@ extern "C" {
     int whisper_model_n_mels(whisper_context* ctx) { return 0; }
     int whisper_model_ftype(whisper_context* ctx) { return 0; }
 }
+
+// Stands in for inference time: VOICEINK_MOCK_INFERENCE_MS milliseconds,
+// none by default. Polls the cancel flag between steps the way whisper.cpp
+// polls its abort callback.
+static void SimulateInference(const std::atomic<bool>* cancelled) {
+    static const long durationMs = [] {
+        const char* value = std::getenv("VOICEINK_MOCK_INFERENCE_MS");
+        return value ? (std::max)(0L, std::strtol(value, nullptr, 10)) : 0L;
+    }();
+
+    const auto step = std::chrono::milliseconds(10);
+    auto remaining = std::chrono::milliseconds(durationMs);
+    while (remaining.count() > 0 && !IsCancelled(cancelled)) {
+        std::this_thread::sleep_for((std::min)(remaining, step));
+        remaining -= step;
+    }
+}
 #endif
 
 constexpr int WHISPER_SAMPLE_RATE = 16000;
 constexpr double WHISPER_CHUNK_LENGTH = 30.0; // 30 second chunks
 constexpr size_t MAX_COMPLETED_JOBS = 100;
+constexpr size_t MAX_UNCLAIMED_DICTATIONS = 8;
 constexpr int DEFAULT_THREADS = 4;
 
 WhisperTranscription::WhisperTranscription()
-    : m_currentModel(nullptr)
-    , m_loadedModelId("")
+    : m_loadedModelId("")
     , m_modelPath("models")
     , m_tempPath("temp")
     , m_shouldStop(false)
@@ -100,14 +120,24 @@ bool WhisperTranscription::initialize() {
     // Initialize GPU support
     m_gpuAvailable = initializeGPU();
 
-    // Start worker threads
+    // Join the process-wide worker pool; it is shared with instances in
+    // other environments (worker_threads) and sized by whoever created it
     m_shouldStop = false;
-    for (int i = 0; i < m_processingThreads; i++) {
-        m_workerThreads.emplace_back(&WhisperTranscription::workerThread, this);
-    }
+    m_taskGate = std::make_shared<TaskGate>();
+    m_workerPool = SharedWorkerPool::Acquire(m_processingThreads);
 
     m_initialized = true;
-    std::cout << "WhisperTranscription initialized with " << m_processingThreads << " threads" << std::endl;
+    std::cout << "WhisperTranscription initialized on a " << m_workerPool->ThreadCount() << " thread pool" << std::endl;
+
+    // Jobs queued before initialization
+    size_t queued = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        queued = m_transcriptionQueue.size();
+    }
+    for (size_t i = 0; i < queued; i++) {
+        scheduleNextJob();
+    }
     
     return true;
 }
@@ -117,14 +147,13 @@ void WhisperTranscription::cleanup() {
         return;
     }
 
-    // Stop worker threads
+    // Stop running jobs at their next abort check and wait for them; queued
+    // pool tasks become no-ops
+    clearTranscriptionQueue();
     m_shouldStop = true;
-    for (auto& thread : m_workerThreads) {
-        if (thread.joinable()) {
-            thread.join();
-        }
-    }
-    m_workerThreads.clear();
+    m_taskGate->Close();
+    m_taskGate.reset();
+    m_workerPool.reset();
 
     // Unload current model
     unloadModel();
@@ -140,7 +169,14 @@ void WhisperTranscription::cleanup() {
         }
         m_activeJobs.clear();
         m_completedJobs.clear();
+        m_completedOrder.clear();
     }
+    {
+        // Waiters see their dictation gone and give up
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        m_dictations.clear();
+    }
+    m_jobSettled.notify_all();
 
     {
         std::lock_guard<std::mutex> lock(m_streamingMutex);
@@ -271,8 +307,11 @@ bool WhisperTranscription::downloadModel(const std::string& modelId, std::functi
             progressCallback(1.0f, "Download completed");
         }
 
-        if (m_downloadCallback) {
-            m_downloadCallback(modelId, 1.0f, "Download completed");
+        {
+            std::lock_guard<std::mutex> lock(m_progressMutex);
+            if (m_downloadCallback) {
+                m_downloadCallback(modelId, 1.0f, "Download completed");
+            }
         }
 
         std::cout << "Model downloaded: " << modelId << " -> " << targetPath << std::endl;
@@ -284,77 +323,99 @@ bool WhisperTranscription::downloadModel(const std::string& modelId, std::functi
     }
 }
 
-bool WhisperTranscription::loadModel(const std::string& modelId) {
-    std::lock_guard<std::mutex> lock(m_modelMutex);
+bool WhisperTranscription::loadModel(const std::string& modelId, const ModelLoadRequest& request) {
+    std::string modelPath;
+    std::shared_ptr<SharedWhisperModel> previous;
+    {
+        std::lock_guard<std::mutex> lock(m_modelMutex);
 
-    if (m_loadedModelId == modelId && m_currentModel != nullptr) {
-        return true; // Already loaded
-    }
+        if (m_loadedModelId == modelId && m_model != nullptr) {
+            if (request.onProgress) {
+                ModelLoadProgress ready;
+                ready.stage = ModelLoadProgress::READY;
+                request.onProgress(ready);
+            }
+            return true; // Already loaded
+        }
 
-    // Unload current model if any
-    if (m_currentModel) {
-        unloadModel();
-    }
+        // Find model info
+        auto models = getAvailableModels();
+        auto modelIt = std::find_if(models.begin(), models.end(),
+            [&modelId](const WhisperModel& m) { return m.id == modelId; });
 
-    // Find model info
-    auto models = getAvailableModels();
-    auto modelIt = std::find_if(models.begin(), models.end(),
-        [&modelId](const WhisperModel& m) { return m.id == modelId; });
-
-    if (modelIt == models.end()) {
-        setError("Model not found: " + modelId);
-        return false;
-    }
+        if (modelIt == models.end()) {
+            setError("Model not found: " + modelId);
+            return false;
+        }
 
-    const WhisperModel& model = *modelIt;
-    std::string modelPath = m_modelPath + "/" + model.filename;
+        modelPath = m_modelPath + "/" + modelIt->filename;
+        if (!std::filesystem::exists(modelPath)) {
+            setError("Model file not found: " + modelPath + ". Please download the model first.");
+            return false;
+        }
 
-    if (!std::filesystem::exists(modelPath)) {
-        setError("Model file not found: " + modelPath + ". Please download the model first.");
-        return false;
+        // Unload current model if any, so two sets of weights are never held at once
+        previous = std::move(m_model);
+        m_loadedModelId = "";
     }
-
-    // Load the model with Whisper.cpp
-#ifdef WHISPER_CPP_AVAILABLE
-    m_currentModel = whisper_init_from_file(modelPath.c_str());
-    if (!m_currentModel) {
-        setError("Failed to load Whisper model from: " + modelPath);
+    previous.reset();
+
+    // Loads without m_modelMutex held, so isModelLoaded() and friends stay
+    // responsive. Reuses the model if any instance in the process already
+    // loaded it, or joins the load if one is in flight.
+    std::string error;
+    std::shared_ptr<SharedWhisperModel> loaded = WhisperModelRegistry::instance().acquire(modelPath, error, request);
+    if (!loaded) {
+        setError(error);
         return false;
     }
-#else
-    // Mock loading for compilation without whisper.cpp
-    m_currentModel = reinterpret_cast<whisper_context*>(0x1); // Non-null pointer
-    std::cout << "Mock: Loading Whisper model: " << modelPath << std::endl;
-#endif
 
-    m_loadedModelId = modelId;
+    {
+        std::lock_guard<std::mutex> lock(m_modelMutex);
+        // An unload issued while loading cancels the request; do not let the
+        // finished load resurrect the model afterwards
+        if (request.cancelled && request.cancelled->load()) {
+            setError(WhisperModelRegistry::kCancelledError);
+            return false;
+        }
+        previous = std::move(m_model);
+        m_model = std::move(loaded);
+        m_loadedModelId = modelId;
+    }
     std::cout << "Whisper model loaded: " << modelId << std::endl;
     return true;
 }
 
 bool WhisperTranscription::unloadModel() {
-    std::lock_guard<std::mutex> lock(m_modelMutex);
-
-    if (m_currentModel) {
-#ifdef WHISPER_CPP_AVAILABLE
-        whisper_free(m_currentModel);
-#endif
-        m_currentModel = nullptr;
+    std::shared_ptr<SharedWhisperModel> previous;
+    {
+        std::lock_guard<std::mutex> lock(m_modelMutex);
+        previous = std::move(m_model);
         m_loadedModelId = "";
+    }
+    // Freed by the registry once no other instance holds it; in-flight
+    // jobs keep their own reference
+    if (previous) {
+        previous.reset();
         std::cout << "Whisper model unloaded" << std::endl;
     }
-
     return true;
 }
 
-std::string WhisperTranscription::transcribeBuffer(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options) {
-    if (!m_currentModel) {
+std::shared_ptr<SharedWhisperModel> WhisperTranscription::currentModel() const {
+    std::lock_guard<std::mutex> lock(m_modelMutex);
+    return m_model;
+}
+
+std::string WhisperTranscription::transcribeBuffer(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options,
+                                                   const std::atomic<bool>* cancelled) {
+    if (!isModelLoaded()) {
         setError("No model loaded. Please load a model first.");
         return "";
     }
 
     try {
-        TranscriptionResult result = processAudio(audioData, sampleCount, sampleRate, options);
+        TranscriptionResult result = processAudio(audioData, sampleCount, sampleRate, options, cancelled);
         return result.text;
     } catch (const std::exception& e) {
         setError("Transcription failed: " + std::string(e.what()));
@@ -363,11 +424,23 @@ std::string WhisperTranscription::transcribeBuffer(const float* audioData, size_
 }
 
 std::string WhisperTranscription::queueTranscription(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options) {
+    // The caller's buffer is not guaranteed to outlive the job, so take a copy
+    auto samples = std::make_shared<std::vector<float>>(audioData, audioData + sampleCount);
+
+    AudioSampleView audio;
+    audio.data = samples->data();
+    audio.sampleCount = samples->size();
+    audio.owner = std::move(samples);
+
+    return queueTranscription(std::move(audio), sampleRate, options);
+}
+
+std::string WhisperTranscription::queueTranscription(AudioSampleView audio, int sampleRate, const AudioProcessingOptions& options) {
     std::string jobId = generateJobId();
     
     auto job = std::make_shared<TranscriptionJob>();
     job->id = jobId;
-    job->audioData.assign(audioData, audioData + sampleCount);
+    job->audio = std::move(audio);
     job->sampleRate = sampleRate;
     job->options = options;
     job->progress.id = jobId;
@@ -375,16 +448,139 @@ std::string WhisperTranscription::queueTranscription(const float* audioData, siz
     job->progress.progress = 0.0f;
     job->startTime = std::chrono::high_resolution_clock::now();
 
+    // Registered before it can be picked up, so cancel and completion find it
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        m_activeJobs[jobId] = job;
+    }
     {
         std::lock_guard<std::mutex> lock(m_queueMutex);
         m_transcriptionQueue.push(job);
-        m_activeJobs[jobId] = job;
     }
+    scheduleNextJob();
 
     std::cout << "Queued transcription job: " << jobId << std::endl;
     return jobId;
 }
 
+std::string WhisperTranscription::addDictationAudio(uint64_t dictationId, AudioSampleView audio, int sampleRate, double startTime,
+                                                   const AudioProcessingOptions& options) {
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        if (m_dictations[dictationId].ended) {
+            return "";
+        }
+    }
+
+    std::string jobId = queueTranscription(std::move(audio), sampleRate, options);
+
+    std::lock_guard<std::mutex> lock(m_progressMutex);
+    m_dictations[dictationId].pieces.push_back(DictationPiece{ jobId, startTime });
+    return jobId;
+}
+
+void WhisperTranscription::endDictation(uint64_t dictationId) {
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        m_dictations[dictationId].ended = true;
+
+        // Nobody awaited the oldest ones; keep a few for late callers
+        size_t ended = 0;
+        for (const auto& entry : m_dictations) {
+            ended += entry.second.ended ? 1 : 0;
+        }
+        for (auto it = m_dictations.begin(); it != m_dictations.end() && ended > MAX_UNCLAIMED_DICTATIONS;) {
+            if (it->second.ended) {
+                it = m_dictations.erase(it);
+                ended--;
+            } else {
+                ++it;
+            }
+        }
+    }
+    m_jobSettled.notify_all();
+}
+
+bool WhisperTranscription::awaitDictation(uint64_t dictationId, TranscriptionResult& result, const std::atomic<bool>* cancelled) {
+    std::unique_lock<std::mutex> lock(m_progressMutex);
+
+    for (;;) {
+        auto it = m_dictations.find(dictationId);
+        if (it == m_dictations.end()) {
+            return false;
+        }
+        const Dictation& dictation = it->second;
+        const bool settled = dictation.ended && std::all_of(dictation.pieces.begin(), dictation.pieces.end(),
+            [this](const DictationPiece& piece) { return m_activeJobs.count(piece.jobId) == 0; });
+        if (settled) {
+            result = mergeDictationLocked(dictation);
+            m_dictations.erase(it);
+            return true;
+        }
+        if (cancelled && cancelled->load()) {
+            return false;
+        }
+        // Woken when a job settles; the timeout only bounds the cancel check
+        m_jobSettled.wait_for(lock, std::chrono::milliseconds(50));
+    }
+}
+
+// Caller holds m_progressMutex. Pieces are in capture order; their segment
+// times are shifted onto one timeline that starts with the first piece.
+TranscriptionResult WhisperTranscription::mergeDictationLocked(const Dictation& dictation) {
+    TranscriptionResult merged;
+    merged.duration = 0.0;
+    merged.confidence = 0.0f;
+    merged.segmentCount = 0;
+    merged.hasMultipleSpeakers = false;
+    merged.speakerCount = 1;
+    merged.processingTime = 0.0;
+
+    const double origin = dictation.pieces.empty() ? 0.0 : dictation.pieces.front().startTime;
+    double confidenceWeight = 0.0;
+    for (const DictationPiece& piece : dictation.pieces) {
+        auto completed = m_completedJobs.find(piece.jobId);
+        if (completed == m_completedJobs.end() || completed->second.status != TranscriptionProgress::COMPLETED) {
+            continue; // Failed, cancelled or expired pieces leave a gap
+        }
+        const TranscriptionResult& part = completed->second.result;
+        const double offset = piece.startTime - origin;
+
+        if (!part.text.empty()) {
+            if (!merged.text.empty() && merged.text.back() != ' ' && part.text.front() != ' ') {
+                merged.text += ' ';
+            }
+            merged.text += part.text;
+        }
+        if (merged.language.empty()) {
+            merged.language = part.language;
+        }
+        for (TranscriptionSegment segment : part.segments) {
+            segment.startTime += offset;
+            segment.endTime += offset;
+            for (double& time : segment.wordStartTimes) {
+                time += offset;
+            }
+            for (double& time : segment.wordEndTimes) {
+                time += offset;
+            }
+            merged.segments.push_back(std::move(segment));
+        }
+
+        merged.duration = (std::max)(merged.duration, offset + part.duration);
+        merged.confidence += part.confidence * static_cast<float>(part.duration);
+        confidenceWeight += part.duration;
+        // Pieces overlap in time while recording; what counts is the last
+        merged.processingTime = part.processingTime;
+    }
+
+    merged.segmentCount = merged.segments.size();
+    if (confidenceWeight > 0.0) {
+        merged.confidence = static_cast<float>(merged.confidence / confidenceWeight);
+    }
+    return merged;
+}
+
 TranscriptionProgress WhisperTranscription::getTranscriptionProgress(const std::string& jobId) {
     std::lock_guard<std::mutex> lock(m_progressMutex);
     
@@ -408,8 +604,8 @@ TranscriptionProgress WhisperTranscription::getTranscriptionProgress(const std::
     return notFound;
 }
 
-std::string WhisperTranscription::detectLanguage(const float* audioData, size_t sampleCount, int sampleRate) {
-    if (!m_currentModel) {
+std::string WhisperTranscription::detectLanguage(const float* audioData, size_t sampleCount, int sampleRate, const std::atomic<bool>* cancelled) {
+    if (!isModelLoaded()) {
         setError("No model loaded. Please load a model first.");
         return "en";
     }
@@ -424,6 +620,18 @@ std::string WhisperTranscription::detectLanguage(const float* audioData, size_t
             processedAudio.resize(maxSamples);
         }
 
+        // whisper_context is not re-entrant; serialize with other inference
+        // calls on the same model, from any instance
+        std::shared_ptr<SharedWhisperModel> model = currentModel();
+        if (!model) {
+            setError("No model loaded. Please load a model first.");
+            return "en";
+        }
+        std::unique_lock<std::timed_mutex> inferenceLock = LockUnlessCancelled(model->inferenceMutex, cancelled);
+        if (!inferenceLock.owns_lock()) {
+            return "en";
+        }
+
 #ifdef WHISPER_CPP_AVAILABLE
         // Create parameters for language detection
         whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
@@ -433,9 +641,13 @@ std::string WhisperTranscription::detectLanguage(const float* audioData, size_t
         params.translate = false;
         params.language = nullptr; // Auto-detect
         params.n_threads = m_processingThreads;
+        if (cancelled) {
+            params.abort_callback = [](void* flag) { return IsCancelled(static_cast<const std::atomic<bool>*>(flag)); };
+            params.abort_callback_user_data = const_cast<std::atomic<bool>*>(cancelled);
+        }
 
         // Run transcription for language detection
-        if (whisper_full(m_currentModel, params, processedAudio.data(), processedAudio.size()) != 0) {
+        if (whisper_full(model->context, params, processedAudio.data(), processedAudio.size()) != 0) {
             setError("Language detection failed");
             return "en";
         }
@@ -446,6 +658,7 @@ std::string WhisperTranscription::detectLanguage(const float* audioData, size_t
 #else
         // Mock language detection
         std::cout << "Mock: Detecting language for " << processedAudio.size() << " samples" << std::endl;
+        SimulateInference(cancelled);
         return "en";
 #endif
 
@@ -455,7 +668,8 @@ std::string WhisperTranscription::detectLanguage(const float* audioData, size_t
     }
 }
 
-TranscriptionResult WhisperTranscription::processAudio(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options) {
+TranscriptionResult WhisperTranscription::processAudio(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options,
+                                                       const std::atomic<bool>* cancelled) {
     auto startTime = std::chrono::high_resolution_clock::now();
     
     TranscriptionResult result;
@@ -473,28 +687,11 @@ TranscriptionResult WhisperTranscription::processAudio(const float* audioData, s
             return result;
         }
 
-        // Language detection
-        if (options.enableLanguageDetection && options.forceLanguage.empty()) {
-            result.language = detectLanguageInternal(processedAudio.data(), processedAudio.size(), WHISPER_SAMPLE_RATE);
-        } else if (!options.forceLanguage.empty()) {
-            result.language = options.forceLanguage;
-        } else {
-            result.language = "en";
-        }
-
-        // Perform transcription
-        result = transcribeWithWhisper(processedAudio.data(), processedAudio.size(), WHISPER_SAMPLE_RATE, options);
-
-        // Post-processing
-        if (options.enablePunctuation || options.enableCapitalization) {
-            // Apply punctuation and capitalization restoration
-            result.text = applyPostProcessing(result.text, options);
-        }
-
-        // Speaker diarization
-        if (options.enableSpeakerDiarization && m_speakerDiarizationEnabled) {
-            result.segments = performSpeakerDiarizationInternal(processedAudio.data(), processedAudio.size(), WHISPER_SAMPLE_RATE, result.segments);
-            result.hasMultipleSpeakers = (result.speakerCount > 1);
+        // Perform transcription; whisper detects the language itself unless
+        // one is forced, and emits punctuated, capitalized text
+        result = transcribeWithWhisper(processedAudio.data(), processedAudio.size(), options, cancelled);
+        if (IsCancelled(cancelled)) {
+            return result;
         }
 
         auto endTime = std::chrono::high_resolution_clock::now();
@@ -510,9 +707,22 @@ TranscriptionResult WhisperTranscription::processAudio(const float* audioData, s
     }
 }
 
-TranscriptionResult WhisperTranscription::transcribeWithWhisper(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options) {
+TranscriptionResult WhisperTranscription::transcribeWithWhisper(const float* audioData, size_t sampleCount, const AudioProcessingOptions& options,
+                                                                const std::atomic<bool>* cancelled) {
     TranscriptionResult result;
 
+    // whisper_context is not re-entrant; serialize with other inference
+    // calls on the same model, from any instance
+    std::shared_ptr<SharedWhisperModel> model = currentModel();
+    if (!model) {
+        setError("No model loaded. Please load a model first.");
+        return result;
+    }
+    std::unique_lock<std::timed_mutex> inferenceLock = LockUnlessCancelled(model->inferenceMutex, cancelled);
+    if (!inferenceLock.owns_lock()) {
+        return result;
+    }
+
 #ifdef WHISPER_CPP_AVAILABLE
     // Create Whisper parameters
     whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
@@ -528,23 +738,32 @@ TranscriptionResult WhisperTranscription::transcribeWithWhisper(const float* aud
     params.compression_ratio_threshold = options.compressionRatio;
     params.logprob_threshold = options.logProbThreshold;
     params.suppress_non_speech_tokens = options.suppressNonSpeech;
+    params.token_timestamps = options.enableTimestamps;
+    // Checked between decoder steps; whisper_full returns early once raised
+    if (cancelled) {
+        params.abort_callback = [](void* flag) { return IsCancelled(static_cast<const std::atomic<bool>*>(flag)); };
+        params.abort_callback_user_data = const_cast<std::atomic<bool>*>(cancelled);
+    }
 
     // Run transcription
-    if (whisper_full(m_currentModel, params, audioData, sampleCount) != 0) {
-        setError("Whisper transcription failed");
+    if (whisper_full(model->context, params, audioData, sampleCount) != 0) {
+        if (!IsCancelled(cancelled)) {
+            setError("Whisper transcription failed");
+        }
         return result;
     }
 
     // Extract results
-    result = extractWhisperResult(m_currentModel, options);
+    result = extractWhisperResult(model->context, options);
 #else
     // Mock transcription for compilation without whisper.cpp
-    std::cout << "Mock: Transcribing " << sampleCount << " samples at " << sampleRate << "Hz" << std::endl;
+    std::cout << "Mock: Transcribing " << sampleCount << " samples at " << WHISPER_SAMPLE_RATE << "Hz" << std::endl;
+    SimulateInference(cancelled);
     
     result.text = "This is a mock transcription result. The actual implementation would use Whisper.cpp to process the audio and generate accurate transcriptions.";
     result.language = options.forceLanguage.empty() ? "en" : options.forceLanguage;
     result.confidence = 0.85f;
-    result.duration = static_cast<double>(sampleCount) / sampleRate;
+    result.duration = static_cast<double>(sampleCount) / WHISPER_SAMPLE_RATE;
     result.segmentCount = 1;
     result.hasMultipleSpeakers = false;
     result.speakerCount = 1;
@@ -564,114 +783,168 @@ TranscriptionResult WhisperTranscription::transcribeWithWhisper(const float* aud
     return result;
 }
 
-void WhisperTranscription::workerThread() {
-    std::cout << "Worker thread started" << std::endl;
-    
-    while (!m_shouldStop) {
-        std::shared_ptr<TranscriptionJob> job;
-        
-        // Get next job from queue
-        {
-            std::lock_guard<std::mutex> lock(m_queueMutex);
-            if (!m_transcriptionQueue.empty()) {
-                job = m_transcriptionQueue.front();
-                m_transcriptionQueue.pop();
+#ifdef WHISPER_CPP_AVAILABLE
+// Reads the output of the last whisper_full() call. Caller holds the model's
+// inference lock.
+TranscriptionResult WhisperTranscription::extractWhisperResult(whisper_context* ctx, const AudioProcessingOptions& options) {
+    TranscriptionResult result;
+    result.duration = 0.0;
+    result.confidence = 0.0f;
+    result.hasMultipleSpeakers = false;
+    result.speakerCount = 1;
+    result.processingTime = 0.0;
+    result.language = options.forceLanguage.empty() ? whisper_lang_str(whisper_full_lang_id(ctx)) : options.forceLanguage;
+
+    result.segments = extractWhisperSegments(ctx, options);
+    result.segmentCount = result.segments.size();
+
+    double confidenceWeight = 0.0;
+    for (TranscriptionSegment& segment : result.segments) {
+        segment.language = result.language;
+        result.text += segment.text;
+
+        const double length = segment.endTime - segment.startTime;
+        result.confidence += segment.confidence * static_cast<float>(length);
+        confidenceWeight += length;
+        result.duration = (std::max)(result.duration, segment.endTime);
+    }
+    if (confidenceWeight > 0.0) {
+        result.confidence = static_cast<float>(result.confidence / confidenceWeight);
+    }
+
+    // Segments carry their own leading space
+    const size_t first = result.text.find_first_not_of(' ');
+    result.text.erase(0, first == std::string::npos ? result.text.size() : first);
+    return result;
+}
+
+// Segment times are in 10 ms units. Word entries are whisper's text tokens;
+// special tokens (timestamps, end of text) are skipped.
+std::vector<TranscriptionSegment> WhisperTranscription::extractWhisperSegments(whisper_context* ctx, const AudioProcessingOptions& options) {
+    std::vector<TranscriptionSegment> segments;
+    const int segmentCount = whisper_full_n_segments(ctx);
+    const whisper_token endOfText = whisper_token_eot(ctx);
+    segments.reserve(segmentCount);
+
+    for (int i = 0; i < segmentCount; ++i) {
+        TranscriptionSegment segment;
+        segment.startTime = whisper_full_get_segment_t0(ctx, i) * 0.01;
+        segment.endTime = whisper_full_get_segment_t1(ctx, i) * 0.01;
+        segment.text = whisper_full_get_segment_text(ctx, i);
+        segment.speakerId = 0;
+
+        float probabilitySum = 0.0f;
+        int textTokens = 0;
+        const int tokenCount = whisper_full_n_tokens(ctx, i);
+        for (int t = 0; t < tokenCount; ++t) {
+            const whisper_token_data token = whisper_full_get_token_data(ctx, i, t);
+            if (token.id >= endOfText) {
+                continue;
             }
-        }
-        
-        if (!job) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            continue;
-        }
-        
-        // Process the job
-        updateProgress(job->id, 0.0f, "Starting transcription");
-        
-        try {
-            TranscriptionResult result;
-            
-            if (!job->filePath.empty()) {
-                // File-based transcription
-                result = transcribeFileInternal(job->filePath, job->options);
-            } else {
-                // Buffer-based transcription
-                updateProgress(job->id, 0.2f, "Processing audio");
-                result = processAudio(job->audioData.data(), job->audioData.size(), job->sampleRate, job->options);
+            probabilitySum += token.p;
+            textTokens++;
+
+            segment.words.push_back(whisper_full_get_token_text(ctx, i, t));
+            if (options.enableConfidenceScores) {
+                segment.wordConfidences.push_back(token.p);
+            }
+            if (options.enableTimestamps) {
+                segment.wordStartTimes.push_back(token.t0 * 0.01);
+                segment.wordEndTimes.push_back(token.t1 * 0.01);
             }
-            
-            updateProgress(job->id, 0.9f, "Finalizing results");
-            completeJob(job->id, result);
-            
-        } catch (const std::exception& e) {
-            failJob(job->id, e.what());
         }
+        segment.confidence = textTokens > 0 ? probabilitySum / textTokens : 0.0f;
+        segment.probability = segment.confidence;
+        segments.push_back(std::move(segment));
     }
-    
-    std::cout << "Worker thread stopped" << std::endl;
+    return segments;
 }
+#endif
 
-std::vector<float> WhisperTranscription::preprocessAudio(const float* audioData, size_t sampleCount, int sampleRate, int targetSampleRate) {
-    std::vector<float> result;
-    
-    if (sampleRate == targetSampleRate) {
-        // No resampling needed
-        result.assign(audioData, audioData + sampleCount);
-    } else {
-        // Simple resampling (in production, use a proper resampling algorithm)
-        result = resampleAudio(audioData, sampleCount, sampleRate, targetSampleRate);
+void WhisperTranscription::scheduleNextJob() {
+    std::shared_ptr<SharedWorkerPool> pool = m_workerPool;
+    std::shared_ptr<TaskGate> gate = m_taskGate;
+    if (!pool || !gate) {
+        return; // Picked up by initialize()
     }
-    
-    // Normalize audio
-    result = normalizeAudio(result.data(), result.size());
-    
-    return result;
+
+    // One task per queued job. The gate, not `this`, decides whether the
+    // task may run: the instance can be cleaned up while tasks are pending.
+    pool->Post([this, gate]() {
+        TaskGate::Guard guard = gate->Enter();
+        if (guard.owns_lock()) {
+            runNextJob();
+        }
+    });
 }
 
-std::vector<float> WhisperTranscription::resampleAudio(const float* audioData, size_t sampleCount, int fromRate, int toRate) {
-    if (fromRate == toRate) {
-        return std::vector<float>(audioData, audioData + sampleCount);
+void WhisperTranscription::runNextJob() {
+    std::shared_ptr<TranscriptionJob> job;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (m_shouldStop || m_transcriptionQueue.empty()) {
+            return;
+        }
+        job = m_transcriptionQueue.front();
+        m_transcriptionQueue.pop();
+    }
+    
+    // Cancelled while queued; already settled by cancelTranscription()
+    if (job->cancelled) {
+        return;
     }
     
-    // Simple linear interpolation resampling
-    double ratio = static_cast<double>(toRate) / fromRate;
-    size_t outputSize = static_cast<size_t>(sampleCount * ratio);
-    std::vector<float> result(outputSize);
+    // Process the job
+    updateProgress(job->id, 0.0f, "Starting transcription");
     
-    for (size_t i = 0; i < outputSize; i++) {
-        double sourceIndex = i / ratio;
-        size_t index = static_cast<size_t>(sourceIndex);
-        double fraction = sourceIndex - index;
+    try {
+        updateProgress(job->id, 0.2f, "Processing audio");
+        TranscriptionResult result = processAudio(job->audio.data, job->audio.sampleCount, job->sampleRate, job->options, &job->cancelled);
         
-        if (index + 1 < sampleCount) {
-            result[i] = audioData[index] * (1.0 - fraction) + audioData[index + 1] * fraction;
-        } else {
-            result[i] = audioData[std::min(index, sampleCount - 1)];
+        if (job->cancelled) {
+            std::lock_guard<std::mutex> lock(m_progressMutex);
+            cancelJobLocked(*job);
+            return;
         }
+        
+        updateProgress(job->id, 0.9f, "Finalizing results");
+        completeJob(job->id, result);
+        
+    } catch (const std::exception& e) {
+        failJob(job->id, e.what());
     }
-    
-    return result;
 }
 
-std::vector<float> WhisperTranscription::normalizeAudio(const float* audioData, size_t sampleCount) {
-    std::vector<float> result(audioData, audioData + sampleCount);
+std::vector<float> WhisperTranscription::preprocessAudio(const float* audioData, size_t sampleCount, int sampleRate, int targetSampleRate) {
+    // The recorder already delivers 16 kHz mono, so the usual path is a
+    // single copy; other rates go through the same polyphase filter the
+    // capture path uses
+    std::vector<float> result = resampleAudio(audioData, sampleCount, sampleRate, targetSampleRate);
     
-    // Find peak amplitude
+    // Normalize in place, only touching the samples when the peak clips
     float maxAmplitude = 0.0f;
-    for (size_t i = 0; i < sampleCount; i++) {
-        maxAmplitude = std::max(maxAmplitude, std::abs(audioData[i]));
+    for (float sample : result) {
+        maxAmplitude = std::max(maxAmplitude, std::abs(sample));
     }
-    
-    // Normalize to prevent clipping
-    if (maxAmplitude > 0.0f && maxAmplitude > 0.95f) {
-        float scale = 0.95f / maxAmplitude;
-        for (size_t i = 0; i < sampleCount; i++) {
-            result[i] *= scale;
+    if (maxAmplitude > 0.95f) {
+        const float scale = 0.95f / maxAmplitude;
+        for (float& sample : result) {
+            sample *= scale;
         }
     }
     
     return result;
 }
 
+std::vector<float> WhisperTranscription::resampleAudio(const float* audioData, size_t sampleCount, int fromRate, int toRate) {
+    if (fromRate == toRate) {
+        return std::vector<float>(audioData, audioData + sampleCount);
+    }
+    
+    // Kaiser-windowed polyphase low-pass; output is aligned with the input
+    return PolyphaseResampler::ResampleClip(audioData, sampleCount, fromRate, toRate);
+}
+
 bool WhisperTranscription::detectVoiceActivity(const float* audioData, size_t sampleCount, int sampleRate, float threshold) {
     // Simple VAD based on RMS energy
     float energy = 0.0f;
@@ -684,15 +957,22 @@ bool WhisperTranscription::detectVoiceActivity(const float* audioData, size_t sa
 }
 
 std::string WhisperTranscription::generateJobId() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(100000, 999999);
+    // Called from the JS thread and from every recorder's endpointing
+    // thread; a process-wide counter keeps IDs unique without a lock
+    static std::atomic<uint64_t> nextJob{ 1 };
     
     auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::system_clock::now().time_since_epoch()
     ).count();
     
-    return "job_" + std::to_string(now) + "_" + std::to_string(dis(gen));
+    return "job_" + std::to_string(now) + "_" + std::to_string(nextJob.fetch_add(1, std::memory_order_relaxed));
+}
+
+void WhisperTranscription::reportPartialResult(const std::string& streamId, const TranscriptionResult& result, bool isFinal) {
+    std::lock_guard<std::mutex> lock(m_progressMutex);
+    if (m_partialResultCallback) {
+        m_partialResultCallback(streamId, result, isFinal);
+    }
 }
 
 void WhisperTranscription::updateProgress(const std::string& jobId, float progress, const std::string& phase) {
@@ -732,19 +1012,23 @@ void WhisperTranscription::completeJob(const std::string& jobId, const Transcrip
         it->second->progress.elapsedTime = std::chrono::duration<double>(now - it->second->startTime).count();
         it->second->progress.estimatedRemainingTime = 0.0;
         
-        // Move to completed jobs
-        m_completedJobs[jobId] = it->second->progress;
-        m_activeJobs.erase(it);
-        
         // Update performance stats
         updatePerformanceStats(*it->second, result);
         
+        // Move to completed jobs; the job (and the audio it borrows) is
+        // released once the worker drops its reference
+        m_completedJobs[jobId] = it->second->progress;
+        m_completedOrder.push_back(jobId);
+        m_activeJobs.erase(it);
+        
         if (m_progressCallback) {
             m_progressCallback(m_completedJobs[jobId]);
         }
+        cleanupCompletedJobs();
         
         std::cout << "Transcription completed: " << jobId << std::endl;
     }
+    m_jobSettled.notify_all();
 }
 
 void WhisperTranscription::failJob(const std::string& jobId, const std::string& error) {
@@ -761,6 +1045,7 @@ void WhisperTranscription::failJob(const std::string& jobId, const std::string&
         
         // Move to completed jobs
         m_completedJobs[jobId] = it->second->progress;
+        m_completedOrder.push_back(jobId);
         m_activeJobs.erase(it);
         
         m_perfStats.failedTranscriptions++;
@@ -768,12 +1053,100 @@ void WhisperTranscription::failJob(const std::string& jobId, const std::string&
         if (m_progressCallback) {
             m_progressCallback(m_completedJobs[jobId]);
         }
+        cleanupCompletedJobs();
         
         std::cout << "Transcription failed: " << jobId << " - " << error << std::endl;
     }
+    m_jobSettled.notify_all();
+}
+
+bool WhisperTranscription::cancelTranscription(const std::string& jobId) {
+    std::lock_guard<std::mutex> lock(m_progressMutex);
+    
+    auto it = m_activeJobs.find(jobId);
+    if (it == m_activeJobs.end()) {
+        return false;
+    }
+    
+    std::shared_ptr<TranscriptionJob> job = it->second;
+    job->cancelled = true;
+    
+    // A running job is settled by its worker once whisper_full returns
+    if (job->progress.status == TranscriptionProgress::QUEUED) {
+        cancelJobLocked(*job);
+    }
+    return true;
+}
+
+void WhisperTranscription::clearTranscriptionQueue() {
+    std::vector<std::string> jobIds;
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        for (const auto& entry : m_activeJobs) {
+            jobIds.push_back(entry.first);
+        }
+    }
+    for (const std::string& jobId : jobIds) {
+        cancelTranscription(jobId);
+    }
+}
+
+// Caller holds m_progressMutex
+void WhisperTranscription::cancelJobLocked(TranscriptionJob& job) {
+    auto it = m_activeJobs.find(job.id);
+    if (it == m_activeJobs.end()) {
+        return;
+    }
+    
+    job.progress.status = TranscriptionProgress::CANCELLED;
+    job.progress.currentPhase = "Cancelled";
+    job.progress.estimatedRemainingTime = 0.0;
+    
+    auto now = std::chrono::high_resolution_clock::now();
+    job.progress.elapsedTime = std::chrono::duration<double>(now - job.startTime).count();
+    
+    // Move to completed jobs; the audio is released with the last reference
+    m_completedJobs[job.id] = job.progress;
+    m_completedOrder.push_back(job.id);
+    m_activeJobs.erase(it);
+    
+    if (m_progressCallback) {
+        m_progressCallback(m_completedJobs[job.id]);
+    }
+    cleanupCompletedJobs();
+    
+    std::cout << "Transcription cancelled: " << job.id << std::endl;
+    m_jobSettled.notify_all();
+}
+
+// Caller holds m_progressMutex. Forgets the oldest settled jobs beyond
+// MAX_COMPLETED_JOBS; pieces of dictations not merged yet are kept, since
+// awaitDictation() reads their results from here.
+void WhisperTranscription::cleanupCompletedJobs() {
+    if (m_completedJobs.size() <= MAX_COMPLETED_JOBS) {
+        return;
+    }
+
+    std::set<std::string> dictationPieces;
+    for (const auto& entry : m_dictations) {
+        for (const DictationPiece& piece : entry.second.pieces) {
+            dictationPieces.insert(piece.jobId);
+        }
+    }
+
+    for (auto it = m_completedOrder.begin();
+         it != m_completedOrder.end() && m_completedJobs.size() > MAX_COMPLETED_JOBS;) {
+        if (dictationPieces.count(*it) != 0) {
+            ++it;
+            continue;
+        }
+        m_completedJobs.erase(*it);
+        it = m_completedOrder.erase(it);
+    }
 }
 
 void WhisperTranscription::setError(const std::string& error) {
+    std::lock_guard<std::mutex> lock(m_errorMutex);
     m_lastError = error;
     std::cerr << "WhisperTranscription Error: " << error << std::endl;
 }
@@ -783,7 +1156,7 @@ WhisperTranscription::PerformanceStats WhisperTranscription::getPerformanceStats
     
     // Update queue length
     m_perfStats.queueLength = m_transcriptionQueue.size();
-    m_perfStats.activeThreads = m_workerThreads.size();
+    m_perfStats.activeThreads = m_workerPool ? static_cast<int>(m_workerPool->ThreadCount()) : 0;
     
     return m_perfStats;
 }
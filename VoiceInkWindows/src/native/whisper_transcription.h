@@ -7,9 +7,15 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
 #include <queue>
+#include <deque>
 #include <map>
 
+#include "whisper_model_registry.h"
+#include "shared_worker_pool.h"
+#include "cancellation.h"
+
 // Forward declarations for Whisper.cpp types
 struct whisper_context;
 struct whisper_full_params;
@@ -70,6 +76,14 @@ struct TranscriptionProgress {
     std::string errorMessage;   // Only valid when status == ERROR
 };
 
+// Borrowed view over caller-owned samples. `owner` keeps the storage alive
+// until every holder of the view (typically a queued job) has dropped it.
+struct AudioSampleView {
+    const float* data = nullptr;
+    size_t sampleCount = 0;
+    std::shared_ptr<const void> owner;
+};
+
 struct AudioProcessingOptions {
     bool enableVAD = true;              // Voice Activity Detection
     bool enableSpeakerDiarization = false; // Speaker separation
@@ -110,57 +124,57 @@ public:
 
     // Model management
     std::vector<WhisperModel> getAvailableModels();
-    WhisperModel getCurrentModel();
     bool downloadModel(const std::string& modelId, std::function<void(float, const std::string&)> progressCallback = nullptr);
-    bool loadModel(const std::string& modelId);
+    // Blocks until the model is ready; run it off the JS thread. Progress
+    // and cancellation go through `request`, see WhisperModelRegistry.
+    bool loadModel(const std::string& modelId, const ModelLoadRequest& request = ModelLoadRequest());
     bool unloadModel();
-    bool isModelLoaded() const { return m_currentModel != nullptr; }
-    std::string getLoadedModelId() const { return m_loadedModelId; }
-    
-    // Model validation
-    bool validateModel(const std::string& modelPath);
-    std::string getModelChecksum(const std::string& modelPath);
+    bool isModelLoaded() const { std::lock_guard<std::mutex> lock(m_modelMutex); return m_model != nullptr; }
+    std::string getLoadedModelId() const { std::lock_guard<std::mutex> lock(m_modelMutex); return m_loadedModelId; }
     
     // GPU support
-    bool isGPUAvailable();
-    std::vector<std::string> getAvailableGPUDevices();
-    bool setGPUDevice(int deviceIndex);
     int getCurrentGPUDevice() const { return m_currentGPUDevice; }
 
-    // Transcription methods
-    std::string transcribeFile(const std::string& audioFile, const AudioProcessingOptions& options = AudioProcessingOptions());
-    std::string transcribeBuffer(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options = AudioProcessingOptions());
-    
-    // Streaming transcription
-    std::string startStreamingTranscription(const AudioProcessingOptions& options = AudioProcessingOptions());
-    bool addAudioChunk(const std::string& streamId, const float* audioData, size_t sampleCount, int sampleRate);
-    TranscriptionResult getStreamingResult(const std::string& streamId, bool partial = true);
-    bool stopStreamingTranscription(const std::string& streamId);
+    // Transcription methods. Raising `cancelled` (from any thread) stops the
+    // call at its next abort check; it then returns an empty result.
+    std::string transcribeBuffer(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options = AudioProcessingOptions(),
+                                 const std::atomic<bool>* cancelled = nullptr);
     
     // Queue-based transcription
     std::string queueTranscription(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options = AudioProcessingOptions());
-    std::string queueFileTranscription(const std::string& audioFile, const AudioProcessingOptions& options = AudioProcessingOptions());
+    std::string queueTranscription(AudioSampleView audio, int sampleRate, const AudioProcessingOptions& options = AudioProcessingOptions());
     TranscriptionProgress getTranscriptionProgress(const std::string& jobId);
-    std::vector<TranscriptionProgress> getAllTranscriptionProgress();
+    // Both are safe to call from any thread. A queued job is settled as
+    // CANCELLED immediately; a running one stops inside whisper_full and is
+    // settled by its worker. Returns false if the job is unknown or finished.
     bool cancelTranscription(const std::string& jobId);
     void clearTranscriptionQueue();
     
+    // Dictation: one recording transcribed piece by piece while it is still
+    // being captured. Each piece is queued as an ordinary job as soon as it
+    // arrives, so when the recording ends only the last one is left to
+    // decode; awaitDictation() then merges them in order. Ids are the
+    // caller's (the recorder's session numbers). Safe from any thread.
+    std::string addDictationAudio(uint64_t dictationId, AudioSampleView audio, int sampleRate, double startTime,
+                                  const AudioProcessingOptions& options = AudioProcessingOptions());
+    // No more pieces will be added
+    void endDictation(uint64_t dictationId);
+    // Blocks until the dictation has ended and every piece has settled, then
+    // merges and forgets it; run it off the JS thread. Returns false if the
+    // dictation is unknown or `cancelled` was raised.
+    bool awaitDictation(uint64_t dictationId, TranscriptionResult& result, const std::atomic<bool>* cancelled = nullptr);
+    
     // Language detection
-    std::string detectLanguage(const float* audioData, size_t sampleCount, int sampleRate);
-    std::map<std::string, float> getLanguageProbabilities(const float* audioData, size_t sampleCount, int sampleRate);
-    std::vector<std::string> getSupportedLanguages();
+    std::string detectLanguage(const float* audioData, size_t sampleCount, int sampleRate, const std::atomic<bool>* cancelled = nullptr);
     
     // Speaker diarization
-    std::vector<TranscriptionSegment> performSpeakerDiarization(const TranscriptionResult& result, const float* audioData, size_t sampleCount, int sampleRate);
     bool enableSpeakerDiarization(bool enable) { m_speakerDiarizationEnabled = enable; return true; }
     
     // Audio preprocessing
     std::vector<float> preprocessAudio(const float* audioData, size_t sampleCount, int sampleRate, int targetSampleRate = 16000);
     bool detectVoiceActivity(const float* audioData, size_t sampleCount, int sampleRate, float threshold = 0.02f);
-    std::vector<std::pair<double, double>> getVoiceSegments(const float* audioData, size_t sampleCount, int sampleRate);
     
     // Performance optimization
-    void setProcessingThreads(int threadCount);
     int getProcessingThreads() const { return m_processingThreads; }
     void enableMemoryOptimization(bool enable) { m_memoryOptimizationEnabled = enable; }
     void setMaxMemoryUsage(size_t maxMemoryMB) { m_maxMemoryUsage = maxMemoryMB; }
@@ -168,11 +182,26 @@ public:
     // Callbacks
     using ProgressCallback = std::function<void(const TranscriptionProgress&)>;
     using ModelDownloadCallback = std::function<void(const std::string&, float, const std::string&)>;
-    using PartialResultCallback = std::function<void(const std::string&, const TranscriptionResult&)>;
-    
-    void setProgressCallback(ProgressCallback callback) { m_progressCallback = callback; }
-    void setModelDownloadCallback(ModelDownloadCallback callback) { m_downloadCallback = callback; }
-    void setPartialResultCallback(PartialResultCallback callback) { m_partialResultCallback = callback; }
+    // (streamId, result so far, isFinal). Invoked from transcription worker threads.
+    using PartialResultCallback = std::function<void(const std::string&, const TranscriptionResult&, bool)>;
+    
+    // Callbacks run under m_progressMutex, so once a setter returns the
+    // previous callback is neither running nor called again
+    void setProgressCallback(ProgressCallback callback) {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        m_progressCallback = std::move(callback);
+    }
+    void setModelDownloadCallback(ModelDownloadCallback callback) {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        m_downloadCallback = std::move(callback);
+    }
+    void setPartialResultCallback(PartialResultCallback callback) {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        m_partialResultCallback = std::move(callback);
+    }
+    // Hands one update of a streaming transcript to the partial result
+    // callback; `isFinal` ends the stream. Safe from any thread.
+    void reportPartialResult(const std::string& streamId, const TranscriptionResult& result, bool isFinal);
     
     // Statistics and monitoring
     struct PerformanceStats {
@@ -189,12 +218,11 @@ public:
     };
     
     PerformanceStats getPerformanceStats();
-    void resetPerformanceStats();
     
     // Error handling
-    std::string getLastError() const { return m_lastError; }
-    bool hasError() const { return !m_lastError.empty(); }
-    void clearError() { m_lastError.clear(); }
+    std::string getLastError() const { std::lock_guard<std::mutex> lock(m_errorMutex); return m_lastError; }
+    bool hasError() const { std::lock_guard<std::mutex> lock(m_errorMutex); return !m_lastError.empty(); }
+    void clearError() { std::lock_guard<std::mutex> lock(m_errorMutex); m_lastError.clear(); }
     
     // Configuration
     void setModelPath(const std::string& path) { m_modelPath = path; }
@@ -203,16 +231,19 @@ public:
     std::string getTempPath() const { return m_tempPath; }
 
 private:
-    // Core Whisper context
-    whisper_context* m_currentModel;
+    // Loaded model, shared with every other instance (in any environment)
+    // that loaded the same file; see WhisperModelRegistry
+    std::shared_ptr<SharedWhisperModel> m_model;
     std::string m_loadedModelId;
     std::string m_modelPath;
     std::string m_tempPath;
     
-    // Threading and synchronization
-    std::vector<std::thread> m_workerThreads;
+    // Threading and synchronization. Jobs run on the process-wide worker
+    // pool; m_taskGate keeps tasks from touching this instance after cleanup()
+    std::shared_ptr<SharedWorkerPool> m_workerPool;
+    std::shared_ptr<TaskGate> m_taskGate;
     std::mutex m_queueMutex;
-    std::mutex m_modelMutex;
+    mutable std::mutex m_modelMutex; // Guards m_model and m_loadedModelId; inference locks the model itself
     std::mutex m_progressMutex;
     std::atomic<bool> m_shouldStop;
     std::atomic<bool> m_initialized;
@@ -220,17 +251,30 @@ private:
     // Transcription queue
     struct TranscriptionJob {
         std::string id;
-        std::vector<float> audioData;
+        AudioSampleView audio; // Released when the job is destroyed after completion
         int sampleRate;
         AudioProcessingOptions options;
-        std::string filePath; // For file-based jobs
         TranscriptionProgress progress;
         std::chrono::high_resolution_clock::time_point startTime;
+        std::atomic<bool> cancelled{false}; // Polled by whisper_full's abort callback
     };
     
     std::queue<std::shared_ptr<TranscriptionJob>> m_transcriptionQueue;
     std::map<std::string, std::shared_ptr<TranscriptionJob>> m_activeJobs;
     std::map<std::string, TranscriptionProgress> m_completedJobs;
+    std::deque<std::string> m_completedOrder; // m_completedJobs keys, oldest first
+    std::condition_variable m_jobSettled; // With m_progressMutex; a job or dictation settled
+    
+    // Dictations, under m_progressMutex
+    struct DictationPiece {
+        std::string jobId;
+        double startTime;
+    };
+    struct Dictation {
+        std::vector<DictationPiece> pieces;
+        bool ended = false;
+    };
+    std::map<uint64_t, Dictation> m_dictations;
     
     // Streaming transcription
     struct StreamingSession {
@@ -263,49 +307,39 @@ private:
     ModelDownloadCallback m_downloadCallback;
     PartialResultCallback m_partialResultCallback;
     
-    // Error handling
+    // Error handling (written from worker and pool threads)
     std::string m_lastError;
+    mutable std::mutex m_errorMutex;
     
     // Private methods
-    void workerThread();
-    TranscriptionResult processAudio(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options);
-    TranscriptionResult transcribeWithWhisper(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options);
-    
-    // Model management
-    WhisperModel getModelInfo(const std::string& modelId);
-    std::string downloadModelFile(const std::string& url, const std::string& filename, std::function<void(float, const std::string&)> progressCallback);
-    bool verifyModelFile(const std::string& path, const std::string& expectedChecksum);
+    void scheduleNextJob();
+    void runNextJob();
+    std::shared_ptr<SharedWhisperModel> currentModel() const;
+    TranscriptionResult processAudio(const float* audioData, size_t sampleCount, int sampleRate, const AudioProcessingOptions& options,
+                                     const std::atomic<bool>* cancelled = nullptr);
+    // Audio must already be resampled to Whisper's 16 kHz
+    TranscriptionResult transcribeWithWhisper(const float* audioData, size_t sampleCount, const AudioProcessingOptions& options,
+                                              const std::atomic<bool>* cancelled = nullptr);
     
     // Audio processing
     std::vector<float> resampleAudio(const float* audioData, size_t sampleCount, int fromRate, int toRate);
-    std::vector<float> normalizeAudio(const float* audioData, size_t sampleCount);
-    std::vector<std::pair<double, double>> detectSilence(const float* audioData, size_t sampleCount, int sampleRate, float threshold, double minDuration);
-    
-    // Language detection
-    std::string detectLanguageInternal(const float* audioData, size_t sampleCount, int sampleRate);
-    std::map<std::string, float> getLanguageProbabilitiesInternal(const float* audioData, size_t sampleCount, int sampleRate);
-    
-    // Speaker diarization
-    std::vector<TranscriptionSegment> performSpeakerDiarizationInternal(const float* audioData, size_t sampleCount, int sampleRate, const std::vector<TranscriptionSegment>& segments);
     
     // Utility methods
     std::string generateJobId();
-    std::string generateStreamId();
     void updateProgress(const std::string& jobId, float progress, const std::string& phase);
     void completeJob(const std::string& jobId, const TranscriptionResult& result);
     void failJob(const std::string& jobId, const std::string& error);
+    void cancelJobLocked(TranscriptionJob& job);
+    TranscriptionResult mergeDictationLocked(const Dictation& dictation);
     void setError(const std::string& error);
     void cleanupCompletedJobs();
     void updatePerformanceStats(const TranscriptionJob& job, const TranscriptionResult& result);
     
     // Whisper.cpp integration helpers
-    whisper_full_params createWhisperParams(const AudioProcessingOptions& options);
     TranscriptionResult extractWhisperResult(whisper_context* ctx, const AudioProcessingOptions& options);
     std::vector<TranscriptionSegment> extractWhisperSegments(whisper_context* ctx, const AudioProcessingOptions& options);
     
     // GPU management
     bool initializeGPU();
     void cleanupGPU();
-    bool isGPUSupported();
-    std::vector<int> getAvailableGPUDevices();
 };
\ No newline at end of file
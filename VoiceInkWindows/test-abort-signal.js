@@ -0,0 +1,186 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies AbortSignal cancellation across the JS/native boundary.
+ *
+ * A ten minute transcription is aborted 50 ms after it starts. The promise
+ * must reject with an AbortError almost immediately, and a short
+ * transcription issued right after must not wait behind the aborted one,
+ * i.e. the native worker and the model are free again. A job waiting behind
+ * another one must give up as soon as it is aborted, an already aborted
+ * signal must reject without running anything, and no 'abort' listeners may
+ * be left on the signal once a call settles. Queued jobs are cancelled
+ * through cancelTranscription().
+ *
+ * Run from the VoiceInkWindows directory after `npm run build:native`.
+ */
+
+const path = require('path');
+const { getEventListeners } = require('events');
+const { addonPath, loadAddon } = require('./tests/test-utils');
+
+process.chdir(__dirname);
+
+const SAMPLE_RATE = 16000;
+const LONG_AUDIO_SECONDS = 10 * 60;
+const ABORT_AFTER_MS = 50;
+const MAX_REJECT_LATENCY_MS = 100;
+const MAX_FOLLOW_UP_MS = 1000;
+
+console.log('🔍 VoiceInk Windows - AbortSignal Cancellation Test');
+console.log('='.repeat(50));
+
+const elapsedMs = (start) => Number(process.hrtime.bigint() - start) / 1e6;
+
+// Aborts `start(signal)` after `afterMs` and reports how long the rejection took
+async function abortAfter(start, afterMs) {
+    const controller = new AbortController();
+    const pending = start(controller.signal);
+    await new Promise((resolve) => setTimeout(resolve, afterMs));
+
+    const abortedAt = process.hrtime.bigint();
+    controller.abort(new Error('user closed the window'));
+    let error = null;
+    try {
+        await pending;
+    } catch (e) {
+        error = e;
+    }
+    return {
+        latencyMs: elapsedMs(abortedAt),
+        typed: Boolean(error) && error.name === 'AbortError' && error.code === 'ABORT_ERR',
+        listenersLeft: getEventListeners(controller.signal, 'abort').length,
+    };
+}
+
+function report(label, outcome) {
+    const ok = outcome.typed && outcome.latencyMs < MAX_REJECT_LATENCY_MS && outcome.listenersLeft === 0;
+    console.log(`   ${label}: ${outcome.latencyMs.toFixed(1)} ms ${ok ? '✅' : '❌'}`);
+    return ok;
+}
+
+async function rejectsWhenPreAborted(start) {
+    const signal = AbortSignal.abort();
+    try {
+        await start(signal);
+        return false;
+    } catch (error) {
+        return error.name === 'AbortError';
+    }
+}
+
+async function testWhisperWrapper() {
+    console.log(`\n📦 whisper-binding (Whisper):`);
+    const addon = loadAddon(path.join(__dirname, 'src/native/build/Release/whisper-binding.node'));
+    if (!addon) return null;
+
+    const whisper = new addon.Whisper();
+    if (!(await whisper.loadModel(path.join(__dirname, 'models/ggml-tiny.en.bin')))) {
+        console.log(`   ❌ loadModel failed: ${whisper.getLastError()}`);
+        return false;
+    }
+
+    const longAudio = new Float32Array(SAMPLE_RATE * LONG_AUDIO_SECONDS);
+    const shortAudio = new Float32Array(SAMPLE_RATE);
+
+    const running = await abortAfter((signal) => whisper.transcribe(longAudio, 'en', { signal }), ABORT_AFTER_MS);
+    const runningOk = report('Running job rejects', running);
+
+    // Would wait for the aborted inference to finish if it still held the model
+    const followUpStart = process.hrtime.bigint();
+    const followUp = await whisper.transcribe(shortAudio, 'en');
+    const followUpMs = elapsedMs(followUpStart);
+    const freeOk = followUp.success && followUpMs < MAX_FOLLOW_UP_MS;
+    console.log(`   Worker free after abort: ${followUpMs.toFixed(0)} ms ${freeOk ? '✅' : '❌'}`);
+
+    // A job queued behind a long one stops waiting once aborted
+    const blocker = new AbortController();
+    const blocking = whisper.transcribe(longAudio, 'en', { signal: blocker.signal }).catch(() => null);
+    const waiting = await abortAfter((signal) => whisper.transcribe(shortAudio, 'en', { signal }), ABORT_AFTER_MS);
+    const waitingOk = report('Waiting job rejects', waiting);
+    blocker.abort();
+    await blocking;
+
+    const preAborted = await rejectsWhenPreAborted((signal) => whisper.transcribe(shortAudio, 'en', { signal }));
+    console.log(`   Pre-aborted signal rejects: ${preAborted ? '✅' : '❌'}`);
+
+    let rejectsBadSignal = false;
+    try {
+        whisper.transcribe(shortAudio, 'en', { signal: {} });
+    } catch (error) {
+        rejectsBadSignal = error instanceof TypeError;
+    }
+    console.log(`   Rejects non-signal: ${rejectsBadSignal ? '✅' : '❌'}`);
+
+    await whisper.unloadModel();
+    return runningOk && freeOk && waitingOk && preAborted && rejectsBadSignal;
+}
+
+async function testWhisperTranscription() {
+    console.log(`\n📦 whisperbinding (WhisperTranscription):`);
+    const addon = loadAddon(addonPath('whisperbinding'));
+    if (!addon) return null;
+
+    const whisper = new addon.WhisperTranscription();
+    whisper.initialize();
+    if (!(await whisper.loadModel('tiny.en'))) {
+        console.log(`   ⚠️  tiny.en model not available - skipping: ${whisper.getLastError()}`);
+        whisper.cleanup();
+        return null;
+    }
+
+    const longAudio = new Float32Array(SAMPLE_RATE * LONG_AUDIO_SECONDS);
+    const shortAudio = new Float32Array(SAMPLE_RATE);
+    const options = { enableVAD: false };
+
+    const running = await abortAfter((signal) =>
+        whisper.transcribeBuffer(longAudio, longAudio.length, SAMPLE_RATE, { ...options, signal }), ABORT_AFTER_MS);
+    const runningOk = report('Running job rejects', running);
+
+    const followUpStart = process.hrtime.bigint();
+    await whisper.transcribeBuffer(shortAudio, shortAudio.length, SAMPLE_RATE, options);
+    const followUpMs = elapsedMs(followUpStart);
+    const freeOk = followUpMs < MAX_FOLLOW_UP_MS;
+    console.log(`   Worker free after abort: ${followUpMs.toFixed(0)} ms ${freeOk ? '✅' : '❌'}`);
+
+    const preAborted = await rejectsWhenPreAborted((signal) =>
+        whisper.detectLanguage(shortAudio, shortAudio.length, SAMPLE_RATE, { signal }));
+    console.log(`   Pre-aborted signal rejects: ${preAborted ? '✅' : '❌'}`);
+
+    // Queued jobs: cancel one, then clear the rest
+    // (the first may already have finished by the time the queue is cleared)
+    const COMPLETED = 2;
+    const CANCELLED = 4;
+    const jobs = [0, 1, 2].map(() => whisper.queueTranscription(longAudio, longAudio.length, SAMPLE_RATE, options));
+    const cancelled = whisper.cancelTranscription(jobs[2]) === true;
+    whisper.clearTranscriptionQueue();
+    await new Promise((resolve) => setTimeout(resolve, MAX_REJECT_LATENCY_MS));
+    const statuses = jobs.map((id) => whisper.getTranscriptionProgress(id).status);
+    const queueOk = cancelled && statuses[2] === CANCELLED &&
+        statuses.every((status) => status === CANCELLED || status === COMPLETED) &&
+        whisper.cancelTranscription(jobs[2]) === false;
+    console.log(`   Queued jobs cancelled: ${queueOk ? '✅' : '❌'} (${statuses.join(', ')})`);
+
+    whisper.cleanup();
+    return runningOk && freeOk && preAborted && queueOk;
+}
+
+(async () => {
+    const results = [await testWhisperWrapper(), await testWhisperTranscription()];
+    const ran = results.filter((r) => r !== null);
+
+    console.log(`\n📋 Summary:`);
+    console.log('='.repeat(30));
+    if (ran.length === 0) {
+        console.log('   ⚠️  No native Whisper modules built - skipping');
+        console.log('   Run: npm run build:native');
+        return;
+    }
+
+    const allPassed = ran.every(Boolean);
+    console.log(`   ${allPassed ? '✅ All cancellation checks passed' : '❌ Cancellation checks failed'}`);
+    process.exitCode = allPassed ? 0 : 1;
+})().catch((error) => {
+    console.error('❌ Test crashed:', error);
+    process.exitCode = 1;
+});
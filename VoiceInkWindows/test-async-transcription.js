@@ -0,0 +1,151 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies that native transcription runs off the JS thread.
+ *
+ * Each Whisper addon is asked to transcribe 30 seconds of audio while a 5 ms
+ * interval timer runs. With Promise-based bindings the timer keeps firing
+ * during inference; a blocking binding would produce zero ticks and one long
+ * event loop stall. It also checks that queueing an hour of audio returns in
+ * well under a millisecond, i.e. the caller's buffer is pinned, not copied.
+ *
+ * Builds without whisper.cpp answer from a mock; VOICEINK_MOCK_INFERENCE_MS
+ * gives it enough inference time for the timer to tick.
+ *
+ * Run from the VoiceInkWindows directory after `npm run build:native`.
+ */
+
+const path = require('path');
+const { monitorEventLoopDelay } = require('perf_hooks');
+const { addonPath, loadAddon } = require('./tests/test-utils');
+
+process.chdir(__dirname);
+
+const SAMPLE_RATE = 16000;
+const AUDIO_SECONDS = 30;
+const TICK_INTERVAL_MS = 5;
+const MAX_ALLOWED_STALL_MS = 50;
+const LONG_AUDIO_SECONDS = 60 * 60;
+const MOCK_INFERENCE_MS = 200;
+
+// Read by the addon's mock inference when it first runs
+process.env.VOICEINK_MOCK_INFERENCE_MS = String(MOCK_INFERENCE_MS);
+
+console.log('🔍 VoiceInk Windows - Async Transcription Test');
+console.log('='.repeat(50));
+
+async function measureWhileRunning(label, start) {
+    const histogram = monitorEventLoopDelay({ resolution: 1 });
+    let ticks = 0;
+    const timer = setInterval(() => { ticks++; }, TICK_INTERVAL_MS);
+
+    histogram.enable();
+    const startedAt = Date.now();
+    const pending = start();
+    const isPromise = pending && typeof pending.then === 'function';
+    const result = await pending;
+    const elapsed = Date.now() - startedAt;
+    histogram.disable();
+    clearInterval(timer);
+
+    const maxStallMs = histogram.max / 1e6;
+    console.log(`\n📊 ${label}`);
+    console.log(`   Returned a Promise:  ${isPromise ? '✅' : '❌'}`);
+    console.log(`   Inference time:      ${elapsed} ms`);
+    console.log(`   Timer ticks:         ${ticks}`);
+    console.log(`   Max loop stall:      ${maxStallMs.toFixed(1)} ms`);
+
+    const passed = isPromise && ticks > 0 && maxStallMs < MAX_ALLOWED_STALL_MS;
+    console.log(`   Event loop responsive: ${passed ? '✅' : '❌'}`);
+    return { passed, result };
+}
+
+async function testWhisperTranscription() {
+    console.log(`\n📦 whisperbinding (WhisperTranscription):`);
+    const addon = loadAddon(addonPath('whisperbinding'));
+    if (!addon) return null;
+
+    const whisper = new addon.WhisperTranscription();
+    whisper.initialize();
+    if (!(await whisper.loadModel('tiny.en'))) {
+        console.log(`   ❌ loadModel failed: ${whisper.getLastError()}`);
+        return false;
+    }
+
+    const audio = new Float32Array(SAMPLE_RATE * AUDIO_SECONDS);
+    const transcribe = await measureWhileRunning('transcribeBuffer', () =>
+        whisper.transcribeBuffer(audio, audio.length, SAMPLE_RATE, { enableVAD: false }));
+    const detect = await measureWhileRunning('detectLanguage', () =>
+        whisper.detectLanguage(audio, audio.length, SAMPLE_RATE));
+
+    // Submitting an hour of audio must not scale with its length: the binding
+    // pins the caller's buffer instead of copying it
+    const longAudio = new Float32Array(SAMPLE_RATE * LONG_AUDIO_SECONDS);
+    const submitStart = process.hrtime.bigint();
+    const jobId = whisper.queueTranscription(longAudio, longAudio.length, SAMPLE_RATE, { enableVAD: false });
+    const submitMs = Number(process.hrtime.bigint() - submitStart) / 1e6;
+    whisper.cancelTranscription(jobId);
+
+    // What submitting would cost if it copied
+    const copyStart = process.hrtime.bigint();
+    new Float32Array(longAudio);
+    const copyMs = Number(process.hrtime.bigint() - copyStart) / 1e6;
+
+    const submitPassed = typeof jobId === 'string' && submitMs < copyMs / 10;
+    console.log(`\n📊 queueTranscription (${LONG_AUDIO_SECONDS / 60} min of audio)`);
+    console.log(`   Submit time:         ${(submitMs * 1000).toFixed(0)} µs (a copy takes ${copyMs.toFixed(0)} ms)`);
+    console.log(`   Zero-copy submit:    ${submitPassed ? '✅' : '❌'}`);
+
+    whisper.cleanup();
+    return transcribe.passed && detect.passed && submitPassed;
+}
+
+async function testWhisperWrapper() {
+    console.log(`\n📦 whisper-binding (Whisper):`);
+    const addon = loadAddon(path.join(__dirname, 'src/native/build/Release/whisper-binding.node'));
+    if (!addon) return null;
+
+    const whisper = new addon.Whisper();
+    if (!(await whisper.loadModel(path.join(__dirname, 'models/ggml-tiny.en.bin')))) {
+        console.log(`   ❌ loadModel failed: ${whisper.getLastError()}`);
+        return false;
+    }
+
+    const pcm = Buffer.alloc(SAMPLE_RATE * AUDIO_SECONDS * 2);
+    const { passed, result } = await measureWhileRunning('transcribe', () => whisper.transcribe(pcm, 'en'));
+    console.log(`   Result success:      ${result && result.success ? '✅' : '❌'}`);
+
+    const samples = new Float32Array(SAMPLE_RATE * AUDIO_SECONDS);
+    const float32 = await measureWhileRunning('transcribe (Float32Array)', () => whisper.transcribe(samples, 'en'));
+
+    let rejectsBadInput = false;
+    try {
+        whisper.transcribe({ length: 4 }, 'en');
+    } catch (error) {
+        rejectsBadInput = error instanceof TypeError;
+    }
+    console.log(`   Rejects non-array input: ${rejectsBadInput ? '✅' : '❌'}`);
+
+    await whisper.unloadModel();
+    return passed && float32.passed && rejectsBadInput && Boolean(result && result.success);
+}
+
+(async () => {
+    const results = [await testWhisperTranscription(), await testWhisperWrapper()];
+    const ran = results.filter((r) => r !== null);
+
+    console.log(`\n📋 Summary:`);
+    console.log('='.repeat(30));
+    if (ran.length === 0) {
+        console.log('   ⚠️  No native Whisper modules built - skipping');
+        console.log('   Run: npm run build:native');
+        return;
+    }
+
+    const allPassed = ran.every(Boolean);
+    console.log(`   ${allPassed ? '✅ All async transcription checks passed' : '❌ Async transcription checks failed'}`);
+    process.exitCode = allPassed ? 0 : 1;
+})().catch((error) => {
+    console.error('❌ Test crashed:', error);
+    process.exitCode = 1;
+});
@@ -0,0 +1,74 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies batched audio-data delivery from the recorder.
+ *
+ * Records synthetic speech for a few seconds with 100 ms batches, then deliberately blocks the
+ * JS thread. Capture must keep running: batches that cannot be queued are
+ * counted in getPerformanceStats().droppedBatches instead of stalling the
+ * capture thread, and every delivered batch carries 100 ms of output-format
+ * frames.
+ *
+ * Run from the VoiceInkWindows directory after `npm run build:native`.
+ */
+
+const { check, finish, requireAddons, sleep } = require('./tests/test-utils');
+
+const BATCH_MS = 100;
+const MAX_QUEUED_BATCHES = 4;
+const RECORD_MS = 3000;
+const BLOCK_JS_MS = 1500;
+
+console.log('🔍 VoiceInk Windows - Audio Batching Test');
+console.log('='.repeat(50));
+
+const [{ WASAPIRecorder }] = requireAddons(['audiorecorder']);
+
+function busyWait(ms) {
+    const until = Date.now() + ms;
+    while (Date.now() < until) { /* keep the JS thread busy */ }
+}
+
+(async () => {
+    const recorder = new WASAPIRecorder();
+    // 48 kHz stereo, so batches differ from the device format
+    recorder.setSource({ type: 'synthetic', signal: 'speech', sampleRate: 48000, channels: 2 });
+    if (!recorder.initialize()) {
+        console.log(`   ❌ initialize failed: ${recorder.getLastError()}`);
+        process.exitCode = 1;
+        return;
+    }
+
+    const batches = [];
+    recorder.setAudioDataCallback((samples, frameCount, timestamp, channels) => {
+        batches.push({ length: samples.length, frameCount, timestamp, channels });
+    }, { batchMs: BATCH_MS, maxQueuedBatches: MAX_QUEUED_BATCHES });
+
+    // Batches are cut from the output stream, not the device's
+    const { sampleRate } = recorder.getOutputFormat();
+    const expectedFrames = Math.floor(sampleRate * BATCH_MS / 1000);
+
+    recorder.startRecording();
+    await sleep((RECORD_MS - BLOCK_JS_MS) / 2);
+    busyWait(BLOCK_JS_MS);
+    await sleep((RECORD_MS - BLOCK_JS_MS) / 2);
+    recorder.stopRecording();
+    await new Promise((resolve) => setImmediate(resolve));
+
+    const stats = recorder.getPerformanceStats();
+    const fullBatches = batches.slice(0, -1);
+    const wholeFrames = fullBatches.every((b) => b.frameCount === expectedFrames);
+    const interleaved = batches.every((b) => b.length === b.frameCount * b.channels);
+
+    console.log(`\n📊 Results:`);
+    check('Batches delivered', batches.length > 0 && stats.deliveredBatches >= batches.length,
+        `${batches.length} (native ${stats.deliveredBatches})`);
+    check('Batches dropped while blocked', stats.droppedBatches > 0, `${stats.droppedBatches} (${stats.droppedBatchFrames} frames)`);
+    check(`${BATCH_MS} ms batches`, wholeFrames, `${expectedFrames} frames`);
+    check('Interleaved lengths', interleaved);
+
+    finish('Audio batching');
+})().catch((error) => {
+    console.error('❌ Test crashed:', error);
+    process.exitCode = 1;
+});
@@ -0,0 +1,59 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies the rate-limited level/meter channel of the recorder, recording
+ * synthetic speech.
+ *
+ * The level callback must fire at (at most) the requested rate regardless of
+ * the capture packet rate, and getMeter() must return the latest snapshot
+ * with RMS, peak and an 8-band spectrum summary.
+ *
+ * Run from the VoiceInkWindows directory after `npm run build:native`.
+ */
+
+const { check, finish, requireAddons, sleep } = require('./tests/test-utils');
+
+const RATE_HZ = 20;
+const RECORD_MS = 2000;
+
+console.log('🔍 VoiceInk Windows - Audio Meter Test');
+console.log('='.repeat(50));
+
+const [{ WASAPIRecorder }] = requireAddons(['audiorecorder']);
+
+(async () => {
+    const recorder = new WASAPIRecorder();
+    recorder.setSource({ type: 'synthetic', signal: 'speech' });
+    if (!recorder.initialize()) {
+        console.log(`   ❌ initialize failed: ${recorder.getLastError()}`);
+        process.exitCode = 1;
+        return;
+    }
+
+    let callbacks = 0;
+    let lastMeter = null;
+    recorder.setLevelCallback((level, peak, meter) => {
+        callbacks++;
+        lastMeter = meter;
+    }, { rateHz: RATE_HZ });
+
+    recorder.startRecording();
+    await sleep(RECORD_MS);
+    const polled = recorder.getMeter();
+    recorder.stopRecording();
+
+    const maxCallbacks = Math.ceil(RECORD_MS / 1000 * RATE_HZ) + 1;
+    const rateLimited = callbacks > 0 && callbacks <= maxCallbacks;
+    const shaped = polled.bands instanceof Float32Array && polled.bands.length === 8 &&
+        typeof polled.rms === 'number' && typeof polled.peakHold === 'number' && polled.sequence > 0;
+
+    console.log(`\n📊 Results:`);
+    check('Level callbacks rate limited', rateLimited, `${callbacks} (limit ${maxCallbacks})`);
+    check('Meter snapshot', shaped, `sequence ${polled.sequence}`);
+    check('Callback meter', Boolean(lastMeter));
+
+    finish('Audio meter');
+})().catch((error) => {
+    console.error('❌ Test crashed:', error);
+    process.exitCode = 1;
+});
@@ -0,0 +1,200 @@
+#!/usr/bin/env node
+
+/**
+ * Benchmarks transcription result conversion: object path vs binary buffer.
+ *
+ * With the native binding built, a synthetic 2 hour transcript is converted
+ * by WhisperTranscription.encodeSyntheticResult() both ways and consumed the
+ * way the renderer does (full text, every segment). The binary result must
+ * decode to the same transcript. Without a native build the layout is encoded
+ * by a JS mirror of BinaryResultBuilder (src/native/common/binary_result_builder.h)
+ * so the reader is still checked.
+ *
+ * Run from the VoiceInkWindows directory after `npm run build:native`.
+ */
+
+const { performance } = require('perf_hooks');
+const { BinaryTranscriptionResult } = require('./src/main/whisper/binaryResultReader');
+const { addonPath, loadAddon } = require('./tests/test-utils');
+
+process.chdir(__dirname);
+
+const TRANSCRIPT_SECONDS = 2 * 60 * 60;
+const ITERATIONS = 5;
+
+console.log('🔍 VoiceInk Windows - Binary Result Encoding Test');
+console.log('='.repeat(50));
+
+// Mirror of BinaryResultBuilder::Finish
+function encode(result) {
+    const strings = [];
+    const index = new Map();
+    const intern = (s) => {
+        let i = index.get(s);
+        if (i === undefined) {
+            i = strings.length;
+            strings.push(Buffer.from(s, 'utf8'));
+            index.set(s, i);
+        }
+        return i;
+    };
+
+    const text = intern(result.text);
+    const language = intern(result.language);
+    const segments = [];
+    const words = [];
+    for (const s of result.segments) {
+        segments.push([s.startTime, s.endTime, intern(s.text), intern(s.language), s.confidence, s.speakerId, words.length, s.words.length]);
+        for (const w of s.words) words.push([w.startTime, w.endTime, intern(w.text), w.confidence]);
+    }
+
+    const stringBytes = strings.reduce((n, b) => n + b.length, 0);
+    const segmentsOffset = 64;
+    const wordsOffset = segmentsOffset + 40 * segments.length;
+    const stringOffsetsOffset = wordsOffset + 24 * words.length;
+    const stringDataOffset = stringOffsetsOffset + 4 * (strings.length + 1);
+    const buffer = Buffer.alloc(stringDataOffset + stringBytes);
+
+    buffer.writeUInt32LE(0x52524956, 0);
+    buffer.writeUInt16LE(1, 4);
+    buffer.writeUInt16LE(64, 6);
+    [buffer.length, segments.length, words.length, strings.length, segmentsOffset, wordsOffset,
+        stringOffsetsOffset, stringDataOffset, text, language].forEach((v, i) => buffer.writeUInt32LE(v, 8 + 4 * i));
+    buffer.writeDoubleLE(result.duration, 48);
+    buffer.writeFloatLE(result.confidence, 56);
+    buffer.writeFloatLE(result.processingTime, 60);
+
+    segments.forEach((s, i) => {
+        const o = segmentsOffset + 40 * i;
+        buffer.writeDoubleLE(s[0], o);
+        buffer.writeDoubleLE(s[1], o + 8);
+        buffer.writeUInt32LE(s[2], o + 16);
+        buffer.writeUInt32LE(s[3], o + 20);
+        buffer.writeFloatLE(s[4], o + 24);
+        buffer.writeInt32LE(s[5], o + 28);
+        buffer.writeUInt32LE(s[6], o + 32);
+        buffer.writeUInt32LE(s[7], o + 36);
+    });
+    words.forEach((w, i) => {
+        const o = wordsOffset + 24 * i;
+        buffer.writeDoubleLE(w[0], o);
+        buffer.writeDoubleLE(w[1], o + 8);
+        buffer.writeUInt32LE(w[2], o + 16);
+        buffer.writeFloatLE(w[3], o + 20);
+    });
+
+    let offset = 0;
+    strings.forEach((b, i) => {
+        buffer.writeUInt32LE(offset, stringOffsetsOffset + 4 * i);
+        b.copy(buffer, stringDataOffset + offset);
+        offset += b.length;
+    });
+    buffer.writeUInt32LE(offset, stringOffsetsOffset + 4 * strings.length);
+    return buffer;
+}
+
+// Same shape as MakeSyntheticTranscriptionResult (src/native/whisper_result_encoding.h)
+function syntheticResult(seconds) {
+    const WORDS = ['the', 'quick', 'brown', 'fox', 'jumps', 'over', 'lazy', 'dog',
+        'meeting', 'notes', 'café', 'résumé', 'voice', 'input', 'today', 'and'];
+    const segments = [];
+    let seed = 1;
+    for (let start = 0; start < seconds; start += 5) {
+        const segment = { startTime: start, endTime: Math.min(start + 5, seconds), text: '', language: 'en', confidence: Math.fround(0.9), speakerId: 0, words: [] };
+        for (let t = start; t + 0.4 <= segment.endTime; t += 0.4) {
+            seed = (Math.imul(seed, 1103515245) + 12345) >>> 0;
+            const word = WORDS[(seed >>> 16) % WORDS.length];
+            segment.text += ' ' + word;
+            segment.words.push({ startTime: t, endTime: t + 0.4 * 0.9, text: word, confidence: Math.fround(Math.fround(0.85) + Math.fround(Math.fround(0.01) * (seed % 10))) });
+        }
+        segments.push(segment);
+    }
+    return {
+        text: segments.map((s) => s.text).join(''),
+        language: 'en',
+        duration: seconds,
+        confidence: Math.fround(0.92),
+        processingTime: Math.fround(seconds * 0.1),
+        segments
+    };
+}
+
+// What the renderer does with a finished result: show the text, list segments
+function consume(result) {
+    let chars = result.text.length;
+    for (const segment of result.segments) chars += segment.text.length;
+    return chars;
+}
+
+function consumeBinary(buffer) {
+    const result = new BinaryTranscriptionResult(buffer);
+    let chars = result.text.length;
+    for (let i = 0; i < result.segmentCount; i++) chars += result.segment(i).text.length;
+    return chars;
+}
+
+function time(fn) {
+    let best = Infinity;
+    let value;
+    for (let i = 0; i < ITERATIONS; i++) {
+        const start = performance.now();
+        value = fn();
+        best = Math.min(best, performance.now() - start);
+    }
+    return { ms: best, value };
+}
+
+function sameTranscript(a, b) {
+    if (a.text !== b.text || a.segments.length !== b.segments.length) return false;
+    return a.segments.every((s, i) => {
+        const t = b.segments[i];
+        return s.text === t.text && s.startTime === t.startTime && s.endTime === t.endTime &&
+            s.words.length === t.words.length && s.words.every((w, j) => w.text === t.words[j].text && w.startTime === t.words[j].startTime);
+    });
+}
+
+const binding = loadAddon(addonPath('whisperbinding'));
+let objectOf;
+let bufferOf;
+if (binding) {
+    const { WhisperTranscription } = binding;
+    objectOf = (seconds) => WhisperTranscription.encodeSyntheticResult(seconds, false);
+    bufferOf = (seconds) => WhisperTranscription.encodeSyntheticResult(seconds, true);
+    console.log('   Using native binding');
+} else {
+    console.log('   Using JS encoder mirror');
+    objectOf = (seconds) => syntheticResult(seconds);
+    bufferOf = (seconds) => encode(syntheticResult(seconds));
+}
+
+const reference = objectOf(TRANSCRIPT_SECONDS);
+const buffer = bufferOf(TRANSCRIPT_SECONDS);
+const decoded = new BinaryTranscriptionResult(buffer).toObject();
+const roundTrip = sameTranscript(reference, decoded);
+
+const objectRun = time(() => consume(objectOf(TRANSCRIPT_SECONDS)));
+const binaryRun = time(() => consumeBinary(bufferOf(TRANSCRIPT_SECONDS)));
+const decodeOnly = time(() => consumeBinary(buffer));
+
+let versionRejected = false;
+try {
+    const copy = Buffer.from(new Uint8Array(buffer));
+    copy.writeUInt16LE(2, 4);
+    new BinaryTranscriptionResult(copy);
+} catch (error) {
+    versionRejected = true;
+}
+
+const wordCount = reference.segments.reduce((n, s) => n + s.words.length, 0);
+console.log(`\n📊 ${TRANSCRIPT_SECONDS / 3600} h transcript: ${reference.segments.length} segments, ${wordCount} words`);
+console.log(`   Binary size:              ${(buffer.byteLength / 1024).toFixed(0)} KB`);
+console.log(`   Object path:              ${objectRun.ms.toFixed(2)} ms`);
+console.log(`   Binary path:              ${binaryRun.ms.toFixed(2)} ms`);
+console.log(`   Binary decode only:       ${decodeOnly.ms.toFixed(2)} ms`);
+console.log(`   Same content consumed:    ${objectRun.value === binaryRun.value ? '✅' : '❌'}`);
+console.log(`   Decodes to same result:   ${roundTrip ? '✅' : '❌'}`);
+console.log(`   Unknown version rejected: ${versionRejected ? '✅' : '❌'}`);
+
+const passed = roundTrip && versionRejected && objectRun.value === binaryRun.value;
+console.log(`\n${passed ? '✅ Binary result checks passed' : '❌ Binary result checks failed'}`);
+process.exitCode = passed ? 0 : 1;
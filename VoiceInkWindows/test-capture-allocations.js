@@ -0,0 +1,100 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies that the capture thread stops allocating once warmed up.
+ *
+ * The recorder counts operator new calls on its capture thread after the
+ * first packets; the count must stay at zero both while JS drains audio
+ * with getAudioData() and while nobody reads and the recorder has to
+ * recycle its oldest queued blocks. An audio data callback is set
+ * throughout, so batching is covered too, and the JS thread is blocked for
+ * part of the stall so full batch queues are as well. Allocation jitter on
+ * the capture thread is what turns into dropouts.
+ *
+ * As a positive control the counter must first see the allocations of
+ * creating a recorder on the JS thread; otherwise the zeros prove nothing.
+ *
+ * Records from the default WASAPI device on Windows and from a real-time
+ * synthetic source elsewhere. Requires an allocation-counting build:
+ *   npx node-gyp rebuild -- -Dcount_allocations=1
+ * Skips otherwise.
+ */
+
+const { check, finish, requireAddons, sleep } = require('./tests/test-utils');
+
+const DRAIN_MS = 2000;
+const STALL_MS = 3000;
+const BLOCK_JS_MS = 1000;
+const DRAIN_INTERVAL_MS = 20;
+const BATCH_MS = 20;
+
+console.log('🔍 VoiceInk Windows - Capture Thread Allocation Test');
+console.log('='.repeat(50));
+
+const [{ WASAPIRecorder }] = requireAddons(['audiorecorder']);
+
+function busyWait(ms) {
+    const until = Date.now() + ms;
+    while (Date.now() < until) { /* keep the JS thread busy */ }
+}
+
+(async () => {
+    const before = WASAPIRecorder.getThreadAllocations();
+    if (before === null) {
+        console.log('   ⚠️  Built without allocation counting - skipping');
+        console.log('   Run: npx node-gyp rebuild -- -Dcount_allocations=1');
+        return;
+    }
+
+    const recorder = new WASAPIRecorder();
+    const controlAllocations = WASAPIRecorder.getThreadAllocations() - before;
+    if (process.platform !== 'win32') {
+        recorder.setSource({ type: 'synthetic', signal: 'speech' });
+    }
+    if (!recorder.initialize()) {
+        console.log(`   ❌ initialize failed: ${recorder.getLastError()}`);
+        process.exitCode = 1;
+        return;
+    }
+
+    let batches = 0;
+    recorder.setAudioDataCallback(() => { batches++; }, { batchMs: BATCH_MS, maxQueuedBatches: 4 });
+
+    const { channels } = recorder.getOutputFormat();
+    recorder.startRecording();
+
+    // Reader keeps up
+    let drainedFrames = 0;
+    const drainUntil = Date.now() + DRAIN_MS;
+    while (Date.now() < drainUntil) {
+        drainedFrames += recorder.getAudioData().length / channels;
+        await sleep(DRAIN_INTERVAL_MS);
+    }
+    const afterDrain = recorder.getPerformanceStats();
+    const drainBatches = batches;
+
+    // Reader stalls: every block ends up queued and the oldest are recycled.
+    // Blocking JS as well fills the batch queue.
+    await sleep(STALL_MS - BLOCK_JS_MS);
+    busyWait(BLOCK_JS_MS);
+    await sleep(DRAIN_INTERVAL_MS);
+    const afterStall = recorder.getPerformanceStats();
+    const backlog = recorder.getAudioData().length;
+
+    recorder.stopRecording();
+
+    console.log(`\n📊 Results:`);
+    check('Counter sees allocations', controlAllocations > 0, `${controlAllocations} for a recorder`);
+    check('No allocations while draining', drainedFrames > 0 && afterDrain.captureAllocations === 0,
+        `${afterDrain.captureAllocations}, ${drainBatches} batches`);
+    check('No allocations while stalled', afterStall.captureAllocations === 0, `${afterStall.captureAllocations}`);
+    check('Oldest blocks recycled', afterStall.bufferOverruns > afterDrain.bufferOverruns && backlog > 0,
+        `${afterStall.bufferOverruns - afterDrain.bufferOverruns} blocks`);
+    check('Batches delivered and dropped', batches > drainBatches && afterStall.droppedBatches > 0,
+        `${batches}/${afterStall.droppedBatches}`);
+
+    finish('Capture allocation');
+})().catch((error) => {
+    console.error('❌ Test crashed:', error);
+    process.exitCode = 1;
+});
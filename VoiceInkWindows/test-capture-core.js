@@ -0,0 +1,127 @@
+#!/usr/bin/env node
+
+/**
+ * Drives the capture core from its platform-neutral sources.
+ *
+ * A synthetic signal and a replayed WAV file go through the same
+ * conversion, resampling and queueing path as a WASAPI device, so the
+ * pipeline can be checked on any OS: finite sources must end the stream,
+ * deliver exactly their duration at the 16 kHz output rate and keep their
+ * level; real-time replay must take as long as the audio lasts.
+ *
+ * Platform-neutral; run after `npm run build:native`.
+ */
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { check, finish, requireAddons, sleep, rms } = require('./tests/test-utils');
+
+console.log('🔍 VoiceInk Windows - Capture Core Test');
+console.log('='.repeat(50));
+
+const [{ WASAPIRecorder }] = requireAddons(['audiorecorder']);
+
+// 16-bit PCM stereo with a 1 kHz tone at half scale and an extra chunk
+// before the data, which the reader has to skip
+function writeTestWav(filename, sampleRate, seconds) {
+    const frames = Math.round(sampleRate * seconds);
+    const dataBytes = frames * 4;
+    const buffer = Buffer.alloc(12 + 24 + 12 + 8 + dataBytes);
+    let offset = 0;
+    offset += buffer.write('RIFF', offset);
+    offset = buffer.writeUInt32LE(buffer.length - 8, offset);
+    offset += buffer.write('WAVE', offset);
+    offset += buffer.write('fmt ', offset);
+    offset = buffer.writeUInt32LE(16, offset);
+    offset = buffer.writeUInt16LE(1, offset);
+    offset = buffer.writeUInt16LE(2, offset);
+    offset = buffer.writeUInt32LE(sampleRate, offset);
+    offset = buffer.writeUInt32LE(sampleRate * 4, offset);
+    offset = buffer.writeUInt16LE(4, offset);
+    offset = buffer.writeUInt16LE(16, offset);
+    offset += buffer.write('LIST', offset);
+    offset = buffer.writeUInt32LE(4, offset);
+    offset += buffer.write('INFO', offset);
+    offset += buffer.write('data', offset);
+    offset = buffer.writeUInt32LE(dataBytes, offset);
+    for (let i = 0; i < frames; i++) {
+        const sample = Math.round(16384 * Math.sin(2 * Math.PI * 1000 * i / sampleRate));
+        offset = buffer.writeInt16LE(sample, offset);
+        offset = buffer.writeInt16LE(sample, offset);
+    }
+    fs.writeFileSync(filename, buffer);
+}
+
+// Reads until the source ends (or the timeout passes) and returns everything captured
+async function captureAll(recorder, timeoutMs) {
+    const chunks = [];
+    const startedAt = Date.now();
+    recorder.startRecording();
+    while (!recorder.hasEnded() && Date.now() - startedAt < timeoutMs) {
+        chunks.push(recorder.getAudioData());
+        await sleep(10);
+    }
+    const elapsedMs = Date.now() - startedAt;
+    recorder.stopRecording();
+    chunks.push(recorder.getAudioData());
+
+    const samples = new Float32Array(chunks.reduce((total, chunk) => total + chunk.length, 0));
+    let offset = 0;
+    for (const chunk of chunks) {
+        samples.set(chunk, offset);
+        offset += chunk.length;
+    }
+    return { samples, elapsedMs };
+}
+
+(async () => {
+    console.log('\n📦 Synthetic source:');
+    const synthetic = new WASAPIRecorder();
+    check('setSource(synthetic)', synthetic.setSource({
+        type: 'synthetic', signal: 'sine', sampleRate: 48000, channels: 2, durationMs: 2000, realtime: false
+    }), synthetic.getLastError());
+    const source = synthetic.getSource();
+    check('Source format', source.type === 'synthetic' && source.sampleRate === 48000 && source.channels === 2 &&
+        source.encoding === 'float32', `${source.sampleRate} Hz x${source.channels}`);
+
+    const generated = await captureAll(synthetic, 10000);
+    check('Stream ends', synthetic.hasEnded());
+    check('2 s at 16 kHz mono', generated.samples.length === 32000, `${generated.samples.length} frames`);
+    check('Sine level kept', Math.abs(rms(generated.samples) - 0.5 / Math.SQRT2) < 0.005, `rms ${rms(generated.samples).toFixed(4)}`);
+    check('Meter follows the signal', synthetic.getPeakLevel() > 0.4, `peak ${synthetic.getPeakLevel().toFixed(3)}`);
+
+    console.log('\n📦 WAV file replay:');
+    const filename = path.join(os.tmpdir(), `voiceink-capture-core-${process.pid}.wav`);
+    writeTestWav(filename, 44100, 1.5);
+    try {
+        const replay = new WASAPIRecorder();
+        check('setSource(file, fast)', replay.setSource({ type: 'file', path: filename, realtime: false }), replay.getLastError());
+        const replayFormat = replay.getSource();
+        check('File format', replayFormat.sampleRate === 44100 && replayFormat.channels === 2 &&
+            replayFormat.encoding === 'int16', `${replayFormat.sampleRate} Hz ${replayFormat.encoding}`);
+
+        const fast = await captureAll(replay, 10000);
+        check('Fast replay ends', replay.hasEnded(), `${fast.elapsedMs} ms`);
+        check('1.5 s at 16 kHz mono', fast.samples.length === 24000, `${fast.samples.length} frames`);
+        check('Tone level kept', Math.abs(rms(fast.samples) - 0.5 / Math.SQRT2) < 0.005, `rms ${rms(fast.samples).toFixed(4)}`);
+
+        check('setSource(file, realtime)', replay.setSource({ type: 'file', path: filename, realtime: true }), replay.getLastError());
+        const paced = await captureAll(replay, 10000);
+        check('Real-time replay is paced', paced.elapsedMs >= 1400 && paced.elapsedMs < 2500, `${paced.elapsedMs} ms`);
+        check('Real-time replay is complete', paced.samples.length === 24000, `${paced.samples.length} frames`);
+
+        check('Missing file rejected', !replay.setSource({ type: 'file', path: `${filename}.missing` }), replay.getLastError());
+    } finally {
+        fs.unlinkSync(filename);
+    }
+
+    if (process.platform !== 'win32') {
+        console.log('\n📦 Without WASAPI:');
+        const plain = new WASAPIRecorder();
+        check('initialize() needs a source', !plain.initialize(), plain.getLastError());
+        check('No devices', plain.enumerateDevices().length === 0);
+    }
+
+    finish('Capture core');
+})();
@@ -0,0 +1,198 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies and benchmarks the acoustic echo canceller on synthetic echo.
+ *
+ * A speech-like far end is played through a simulated room (a 40 ms decaying
+ * impulse response) with a bulk delay, as loopback and microphone buffering
+ * would add. cancelEcho() must find that delay, remove most of the echo in
+ * single talk, keep a near-end talker intact over the far end (double talk)
+ * without losing what it had learnt, and stay cheap enough for the capture
+ * thread. The recorder must do the same with the microphone and the
+ * reference both replayed from files.
+ *
+ * Platform-neutral; run after `npm run build:native`.
+ */
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { check, finish, requireAddons, sleep, toDb, rms, makeNoise } = require('./tests/test-utils');
+
+const RATE = 16000;
+const MS = RATE / 1000;
+const DELAY_MS = 120;
+
+console.log('🔍 VoiceInk Windows - Echo Cancellation Test');
+console.log('='.repeat(50));
+
+const [dsp, { WASAPIRecorder }] = requireAddons(['audiodsp', 'audiorecorder']);
+
+// Voiced bursts with a wandering pitch and some breath noise, 1.2 s on and
+// 0.5 s off, like the far end of a call
+function makeTalker(seconds, basePitch, seed) {
+    const noise = makeNoise(seed);
+    const samples = new Float32Array(seconds * RATE);
+    let phase = 0;
+    for (let i = 0; i < samples.length; i++) {
+        const t = i / RATE;
+        const voiced = (t % 1.7) < 1.2;
+        phase += 2 * Math.PI * (basePitch + 30 * Math.sin(2 * Math.PI * 0.4 * t)) / RATE;
+        let harmonics = 0;
+        for (let h = 1; h <= 10; h++) {
+            harmonics += Math.sin(h * phase) / h;
+        }
+        const envelope = 0.5 - 0.5 * Math.cos(2 * Math.PI * 3.3 * t);
+        samples[i] = voiced ? 0.2 * envelope * (0.6 * harmonics + 0.3 * noise()) : 0.001 * noise();
+    }
+    return samples;
+}
+
+// The far end as the microphone hears it: delayed, then through a room
+function makeEcho(far) {
+    const noise = makeNoise(7);
+    const room = new Float32Array(40 * MS);
+    for (let k = 0; k < room.length; k++) {
+        room[k] = 0.5 * noise() * Math.exp(-k / (8 * MS));
+    }
+    room[0] = 0.6;
+    const delay = DELAY_MS * MS;
+    const echo = new Float32Array(far.length);
+    for (let i = delay; i < far.length; i++) {
+        let sum = 0;
+        for (let k = 0; k < room.length && k <= i - delay; k++) {
+            sum += room[k] * far[i - delay - k];
+        }
+        echo[i] = sum;
+    }
+    return echo;
+}
+
+// 16-bit PCM mono
+function writeWav(filename, samples) {
+    const buffer = Buffer.alloc(44 + samples.length * 2);
+    let offset = buffer.write('RIFF', 0);
+    offset = buffer.writeUInt32LE(buffer.length - 8, offset);
+    offset += buffer.write('WAVE', offset);
+    offset += buffer.write('fmt ', offset);
+    offset = buffer.writeUInt32LE(16, offset);
+    offset = buffer.writeUInt16LE(1, offset);
+    offset = buffer.writeUInt16LE(1, offset);
+    offset = buffer.writeUInt32LE(RATE, offset);
+    offset = buffer.writeUInt32LE(RATE * 2, offset);
+    offset = buffer.writeUInt16LE(2, offset);
+    offset = buffer.writeUInt16LE(16, offset);
+    offset += buffer.write('data', offset);
+    offset = buffer.writeUInt32LE(samples.length * 2, offset);
+    for (const sample of samples) {
+        offset = buffer.writeInt16LE(Math.round(32767 * Math.max(-1, Math.min(1, sample))), offset);
+    }
+    fs.writeFileSync(filename, buffer);
+}
+
+(async () => {
+    const far = makeTalker(20, 140, 1);
+    const echo = makeEcho(far);
+
+    console.log('\n📦 Single talk:');
+    const single = dsp.cancelEcho(echo, far, { sampleRate: RATE });
+    check('Delay found', single.delayLocked && single.delayMs <= DELAY_MS && single.delayMs >= DELAY_MS - 40,
+        `${single.delayMs.toFixed(0)} of ${DELAY_MS} ms`);
+    const settledErle = toDb(rms(echo, 12000 * MS) / rms(single.samples, 12000 * MS));
+    check('Echo removed once settled', settledErle > 20, `${settledErle.toFixed(1)} dB`);
+    const earlyErle = toDb(rms(echo, 3000 * MS, 5000 * MS) / rms(single.samples, 3000 * MS, 5000 * MS));
+    check('Converges within seconds', earlyErle > 6, `${earlyErle.toFixed(1)} dB at 3-5 s`);
+    check('Reported ERLE agrees', Math.abs(single.erleDb - settledErle) < 10, `${single.erleDb.toFixed(1)} dB`);
+
+    const silent = dsp.cancelEcho(echo, new Float32Array(far.length), { sampleRate: RATE });
+    let untouched = 0;
+    for (let i = 0; i < echo.length; i++) {
+        untouched = Math.max(untouched, Math.abs(silent.samples[i] - echo[i]));
+    }
+    check('Silent reference leaves mic alone', untouched === 0, untouched.toExponential(1));
+
+    console.log('\n📦 Double talk:');
+    // A near-end talker as loud as the echo from 12 to 15 s
+    const talker = makeTalker(20, 210, 99);
+    const near = new Float32Array(far.length);
+    for (let i = 12000 * MS; i < 15000 * MS; i++) {
+        near[i] = talker[i];
+    }
+    const mic = echo.map((sample, i) => sample + near[i]);
+    const both = dsp.cancelEcho(mic, far, { sampleRate: RATE });
+    // The canceller only subtracts, so whatever is not near end is residual echo
+    const residual = both.samples.map((sample, i) => sample - near[i]);
+    const doubleTalkErle = toDb(rms(echo, 12000 * MS, 15000 * MS) / rms(residual, 12000 * MS, 15000 * MS));
+    check('Echo still removed', doubleTalkErle > 10, `${doubleTalkErle.toFixed(1)} dB`);
+    const nearKept = toDb(rms(both.samples, 12000 * MS, 15000 * MS) / rms(near, 12000 * MS, 15000 * MS));
+    check('Near end preserved', Math.abs(nearKept) < 1, `${nearKept.toFixed(2)} dB`);
+    const afterErle = toDb(rms(echo, 15500 * MS) / rms(residual, 15500 * MS));
+    check('Filter survives double talk', afterErle > 18, `${afterErle.toFixed(1)} dB after`);
+
+    console.log('\n📦 Recorder with file reference:');
+    const micFile = path.join(os.tmpdir(), `voiceink-echo-mic-${process.pid}.wav`);
+    const referenceFile = path.join(os.tmpdir(), `voiceink-echo-reference-${process.pid}.wav`);
+    writeWav(micFile, echo);
+    writeWav(referenceFile, far);
+    try {
+        const recorder = new WASAPIRecorder();
+        recorder.setSource({ type: 'file', path: micFile, realtime: false });
+        check('Reference accepted', recorder.setEchoReference({ type: 'file', path: referenceFile, realtime: false }) === true);
+        recorder.enableEchoCancellation(true);
+        const chunks = [];
+        let total = 0;
+        if (recorder.startRecording()) {
+            while (!recorder.hasEnded()) {
+                const data = recorder.getAudioData();
+                chunks.push(data);
+                total += data.length;
+                await sleep(5);
+            }
+            const data = recorder.getAudioData();
+            chunks.push(data);
+            total += data.length;
+        }
+        const stats = recorder.getEchoCancellerStats();
+        recorder.stopRecording();
+
+        const recorded = new Float32Array(total);
+        let offset = 0;
+        for (const chunk of chunks) {
+            recorded.set(chunk, offset);
+            offset += chunk.length;
+        }
+        const recordedErle = toDb(rms(echo, 14000 * MS, 19000 * MS) / rms(recorded, 14000 * MS, 19000 * MS));
+        check('Echo removed in the recorder', recordedErle > 20, `${recordedErle.toFixed(1)} dB`);
+        check('Stats report the lock', stats.running && stats.delayLocked && Math.abs(stats.delayMs - single.delayMs) <= 16,
+            `${stats.delayMs.toFixed(0)} ms, ${stats.erleDb.toFixed(0)} dB`);
+        check('Reference kept pace', stats.referenceUnderrunFrames === 0 && stats.referenceDroppedFrames === 0,
+            `${stats.referenceUnderrunFrames}/${stats.referenceDroppedFrames}`);
+        check('Reference can be removed', recorder.setEchoReference(null) === true && !recorder.getEchoCancellerStats().reference);
+    } finally {
+        fs.unlinkSync(micFile);
+        fs.unlinkSync(referenceFile);
+    }
+
+    console.log('\n📦 Benchmark (µs per second of audio):');
+    for (const [sampleRate, channels] of [[16000, 1], [16000, 2], [48000, 1]]) {
+        const seconds = 10;
+        const farEnd = new Float32Array(seconds * sampleRate);
+        const noise = makeNoise(3);
+        for (let i = 0; i < farEnd.length; i++) {
+            farEnd[i] = 0.1 * noise();
+        }
+        const micSamples = new Float32Array(farEnd.length * channels);
+        for (let i = 0; i < farEnd.length; i++) {
+            for (let c = 0; c < channels; c++) {
+                micSamples[i * channels + c] = i >= 800 ? 0.5 * farEnd[i - 800] : 0;
+            }
+        }
+        const result = dsp.cancelEcho(micSamples, farEnd, { sampleRate, channels });
+        const label = `${sampleRate / 1000} kHz x${channels}`;
+        // Under 1% of a core
+        check(`${label} is cheap`, result.nanosPerSecond < 1e7,
+            `${(result.nanosPerSecond / 1000).toFixed(0)} µs (${(result.nanosPerSecond / 1e7).toFixed(2)}%)`);
+    }
+
+    finish('Echo cancellation');
+})();
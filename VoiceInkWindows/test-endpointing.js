@@ -0,0 +1,160 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies utterance endpointing in the capture core.
+ *
+ * The endpointer must open an utterance shortly after speech starts, keep
+ * it open across the short dips between syllables, close it once the
+ * hangover has passed, and drop blips shorter than the minimum length.
+ * During a recording each finished utterance is reported (and, with a sink
+ * from the transcription addon, queued) while capture goes on. In
+ * push-to-talk mode, releasing the key (stopRecording) must submit the open
+ * tail and end the session before it returns, so awaitDictation() only
+ * waits for that last piece.
+ *
+ * Uses the audiodsp module and a synthetic source, so it runs on any
+ * platform after `npm run build:native`.
+ */
+
+const fs = require('fs');
+const path = require('path');
+const { check, finish, requireAddons, sleep } = require('./tests/test-utils');
+
+const RATE = 16000;
+const MS = RATE / 1000;
+
+console.log('🔍 VoiceInk Windows - Utterance Endpointing Test');
+console.log('='.repeat(50));
+
+const [dsp, { WASAPIRecorder }] = requireAddons(['audiodsp', 'audiorecorder']);
+
+// Quiet noise with voiced stretches [startMs, endMs), each pulsing at a
+// syllable rate so the level dips between "words"
+function makeClip(totalMs, bursts) {
+    const samples = new Float32Array(totalMs * MS);
+    let seed = 12345;
+    for (let i = 0; i < samples.length; i++) {
+        seed = (seed * 1103515245 + 12345) >>> 0;
+        samples[i] = 0.002 * (seed / 2147483648 - 1);
+    }
+    for (const [startMs, endMs] of bursts) {
+        for (let i = startMs * MS; i < endMs * MS; i++) {
+            const t = i / RATE;
+            const syllable = 0.5 - 0.5 * Math.cos(2 * Math.PI * 4 * (t - startMs / 1000));
+            samples[i] += 0.3 * syllable * Math.sin(2 * Math.PI * 180 * t);
+        }
+    }
+    return samples;
+}
+
+(async () => {
+    console.log('\n📦 Endpointer:');
+    const clip = makeClip(6000, [[500, 1700], [2500, 2600], [3000, 4800]]);
+    const segments = dsp.segmentUtterances(clip, { sampleRate: RATE });
+    check('Two utterances, blip dropped', segments.length === 2, `${segments.length} found`);
+    if (segments.length === 2) {
+        // Opens within the pre-speech padding before the onset...
+        const startMs = segments.map((segment) => segment.start / MS);
+        check('Starts before the speech', startMs[0] <= 500 && startMs[0] >= 250 && startMs[1] <= 3000 && startMs[1] >= 2750,
+            startMs.map((ms) => ms.toFixed(0)).join(', '));
+        // ...and closes within the post-speech padding after it
+        const endMs = segments.map((segment) => segment.end / MS);
+        check('Ends after the speech', endMs[0] >= 1600 && endMs[0] <= 1900 && endMs[1] >= 4700 && endMs[1] <= 5000,
+            endMs.map((ms) => ms.toFixed(0)).join(', '));
+    }
+    const split = dsp.segmentUtterances(makeClip(6000, [[500, 5500]]), { sampleRate: RATE, maxUtteranceMs: 2000 });
+    check('Long speech is cut at the limit', split.length === 3 && split[1].start === split[0].end,
+        `${split.length} pieces`);
+    check('Silence gives nothing', dsp.segmentUtterances(new Float32Array(RATE), { sampleRate: RATE }).length === 0);
+
+    console.log('\n📦 Recorder:');
+    // Speech source: 1200 ms voiced, 800 ms of room noise, repeating
+    const recorder = new WASAPIRecorder();
+    recorder.setSource({ type: 'synthetic', signal: 'speech', durationMs: 6000, realtime: false });
+    recorder.enableEndpointing({ hangoverMs: 300 });
+    const events = [];
+    recorder.setUtteranceCallback((event) => events.push(event));
+
+    let transcriber = null;
+    const whisperPath = path.join(__dirname, 'build/Release/whisperbinding.node');
+    if (fs.existsSync(whisperPath)) {
+        const { WhisperTranscription } = require(whisperPath);
+        transcriber = new WhisperTranscription();
+        transcriber.initialize();
+        recorder.setUtteranceSink(transcriber.createUtteranceSink({ forceLanguage: 'en' }));
+    }
+    const sinkAttached = transcriber !== null;
+    let rejected = false;
+    try {
+        recorder.setUtteranceSink({});
+    } catch (error) {
+        rejected = true;
+    }
+    check('Rejects a non-sink', rejected);
+
+    check('startRecording()', recorder.startRecording(), recorder.getLastError());
+    while (!recorder.hasEnded()) {
+        recorder.getAudioData();
+        await sleep(5);
+    }
+    recorder.stopRecording();
+    await sleep(50);
+
+    const ends = events.filter((event) => event.type === 'end');
+    check('One utterance per burst', ends.length === 3, `${ends.length} utterances`);
+    check('Starts and ends pair up', events.every((event, i) =>
+        event.type === (i % 2 === 0 ? 'start' : 'end') && event.sequence === Math.floor(i / 2) + 1));
+    if (ends.length === 3) {
+        // The first utterance opens at the stream start, with no audio to pad
+        // it from, so space them by where they close
+        const gaps = [ends[1].endTime - ends[0].endTime, ends[2].endTime - ends[1].endTime];
+        check('Spaced like the bursts', gaps.every((gap) => Math.abs(gap - 2.0) < 0.05),
+            gaps.map((gap) => gap.toFixed(3)).join(', '));
+        const lengths = ends.map((event) => event.sampleCount / MS);
+        check('Burst plus padding', lengths.slice(1).every((ms) => ms > 1200 && ms < 1700),
+            lengths.map((ms) => ms.toFixed(0)).join(', '));
+        check(sinkAttached ? 'Queued for transcription' : 'No sink, no job',
+            ends.every((event) => sinkAttached ? typeof event.jobId === 'string' : event.jobId === null));
+    }
+
+    console.log('\n📦 Push-to-talk:');
+    // Key held for 4.5 s of real-time speech, released in the middle of the third burst
+    recorder.setSource({ type: 'synthetic', signal: 'speech', realtime: true });
+    recorder.enableEndpointing({ mode: 'push-to-talk' });
+    events.length = 0;
+    check('Key down', recorder.startRecording(), recorder.getLastError());
+    const session = recorder.getSessionId();
+    await sleep(4500);
+    const beforeRelease = events.filter((event) => event.type === 'end').length;
+    const releasedAt = Date.now();
+    recorder.stopRecording();
+    const releaseMs = Date.now() - releasedAt;
+    await sleep(50);
+
+    const pieces = events.filter((event) => event.type === 'end');
+    check('Pieces cut while held', beforeRelease === 2, `${beforeRelease} before release`);
+    check('Tail submitted on release', pieces.length === 3 && pieces.every((event) => event.session === session),
+        `${pieces.length} pieces`);
+    check('Release is quick', releaseMs < 100, `${releaseMs} ms`);
+    if (transcriber) {
+        // Without a model every piece fails; the merge still settles
+        const merged = await transcriber.awaitDictation(session);
+        check('Dictation settles', typeof merged.text === 'string' && Array.isArray(merged.segments));
+
+        // Only the newest 100 settled jobs are kept
+        const audio = new Float32Array(100 * MS);
+        const jobIds = Array.from({ length: 110 }, () => transcriber.queueTranscription(audio, audio.length, RATE));
+        const COMPLETED = 2;
+        for (let waited = 0; waited < 5000 && transcriber.getTranscriptionProgress(jobIds[109]).status !== COMPLETED; waited += 10) {
+            await sleep(10);
+        }
+        check('Oldest settled jobs forgotten',
+            transcriber.getTranscriptionProgress(jobIds[0]).errorMessage === 'Job not found' &&
+            transcriber.getTranscriptionProgress(jobIds[109]).status === COMPLETED);
+    }
+
+    recorder.setUtteranceCallback(null);
+    recorder.setUtteranceSink(null);
+
+    finish('Endpointing');
+})();
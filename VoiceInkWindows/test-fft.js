@@ -0,0 +1,98 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies and benchmarks the native FFT shared by the DSP stages.
+ *
+ * The real FFT must match a double-precision DFT computed here, invert back
+ * to its input, and put a pure tone in its bin. benchmarkFft() then times it
+ * against a textbook radix-2 complex FFT on the same input for the frame
+ * sizes the DSP stages use (256-4096); the planned radix-4 transform must
+ * win at every size.
+ *
+ * Platform-neutral; run after `npm run build:native`.
+ */
+
+const { check, finish, requireAddons } = require('./tests/test-utils');
+
+console.log('🔍 VoiceInk Windows - FFT Test');
+console.log('='.repeat(50));
+
+const [dsp] = requireAddons(['audiodsp']);
+
+function noise(length, seed = 12345) {
+    const samples = new Float32Array(length);
+    for (let i = 0; i < length; i++) {
+        seed = (seed * 1103515245 + 12345) >>> 0;
+        samples[i] = seed / 2147483648 - 1;
+    }
+    return samples;
+}
+
+// Bins 0..n/2 as interleaved (re, im), in double precision
+function dft(samples) {
+    const n = samples.length;
+    const result = new Float64Array(n + 2);
+    for (let k = 0; k <= n / 2; k++) {
+        let re = 0;
+        let im = 0;
+        for (let t = 0; t < n; t++) {
+            const angle = -2 * Math.PI * ((k * t) % n) / n;
+            re += samples[t] * Math.cos(angle);
+            im += samples[t] * Math.sin(angle);
+        }
+        result[2 * k] = re;
+        result[2 * k + 1] = im;
+    }
+    return result;
+}
+
+console.log('\n📦 Accuracy:');
+for (const size of [4, 8, 32, 128, 512, 1024]) {
+    const input = noise(size, size);
+    const spectrum = dsp.fft(input);
+    const expected = dft(input);
+    let error = 0;
+    let peak = 0;
+    for (let i = 0; i < expected.length; i++) {
+        error = Math.max(error, Math.abs(spectrum[i] - expected[i]));
+        peak = Math.max(peak, Math.abs(expected[i]));
+    }
+    const restored = dsp.ifft(spectrum);
+    let roundTrip = 0;
+    for (let i = 0; i < size; i++) {
+        roundTrip = Math.max(roundTrip, Math.abs(restored[i] - input[i]));
+    }
+    check(`${size} points`, spectrum.length === size + 2 && error / peak < 1e-5 && roundTrip < 1e-5,
+        `${(error / peak).toExponential(1)} / ${roundTrip.toExponential(1)}`);
+}
+
+const tone = new Float32Array(1024).map((_, i) => Math.cos(2 * Math.PI * 37 * i / 1024));
+const toneSpectrum = dsp.fft(tone);
+let loudest = 0;
+for (let k = 1; k <= 512; k++) {
+    if (Math.hypot(toneSpectrum[2 * k], toneSpectrum[2 * k + 1]) > Math.hypot(toneSpectrum[2 * loudest], toneSpectrum[2 * loudest + 1])) {
+        loudest = k;
+    }
+}
+check('Tone lands in its bin', loudest === 37 && Math.abs(toneSpectrum[74] - 512) < 1e-2, `bin ${loudest}`);
+
+let rejected = false;
+try {
+    dsp.fft(new Float32Array(1000));
+} catch (error) {
+    rejected = true;
+}
+check('Rejects other sizes', rejected);
+
+console.log('\n📦 Benchmark (ns per transform):');
+console.log(`   ${'size'.padEnd(8)}${'native'.padStart(10)}${'radix-2'.padStart(10)}${'speedup'.padStart(10)}`);
+for (const size of [256, 512, 1024, 2048, 4096]) {
+    const iterations = Math.round(4e6 / size);
+    const result = dsp.benchmarkFft(size, iterations);
+    const speedup = result.referenceNanosPerTransform / result.nanosPerTransform;
+    console.log(`   ${String(size).padEnd(8)}${result.nanosPerTransform.toFixed(0).padStart(10)}` +
+        `${result.referenceNanosPerTransform.toFixed(0).padStart(10)}${(speedup.toFixed(1) + 'x').padStart(10)}`);
+    check(`${size} faster than radix-2`, speedup > 1.5 && result.maxError < 1e-4, result.maxError.toExponential(1));
+}
+
+finish('FFT');
@@ -0,0 +1,237 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies and benchmarks the native FLAC encoder and decoder.
+ *
+ * encodeFlac() and decodeFlac() must round-trip 16- and 24-bit audio bit for
+ * bit, whatever the channel count, length or thread count, and speech must
+ * shrink to well under two thirds of its PCM size. On the capture sink a
+ * FLAC recording must hold exactly what getAudioData() returned, replay
+ * through a file source, and survive a truncated tail through
+ * recoverRecordingFile(). convertToFlac() is the batch job for WAV
+ * recordings already stored and runs off the JS thread. Throughput is reported in MB of PCM per second
+ * per core.
+ *
+ * Platform-neutral; run after `npm run build:native`.
+ */
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { check, finish, requireAddons, sleep, makeNoise } = require('./tests/test-utils');
+
+const RATE = 16000;
+
+console.log('🔍 VoiceInk Windows - FLAC Test');
+console.log('='.repeat(50));
+
+const [dsp, { WASAPIRecorder }] = requireAddons(['audiodsp', 'audiorecorder']);
+
+// Voiced harmonics under a syllable envelope over a -60 dBFS noise floor,
+// interleaved, scaled to `bits`
+function makeSpeech(frames, channels, rate, bits, seed = 1) {
+    const Type = bits <= 16 ? Int16Array : Int32Array;
+    const samples = new Type(frames * channels);
+    const noise = makeNoise(seed);
+    const scale = 2 ** (bits - 1) - 1;
+    for (let i = 0; i < frames; i++) {
+        const t = i / rate;
+        const envelope = 0.5 + 0.5 * Math.sin(2 * Math.PI * 4 * t);
+        const pitch = 140 + 20 * Math.sin(2 * Math.PI * 0.7 * t);
+        for (let c = 0; c < channels; c++) {
+            let voiced = 0;
+            for (let h = 1; h <= 6; h++) {
+                voiced += Math.sin(2 * Math.PI * pitch * h * t + c) / h;
+            }
+            const sample = 0.25 * envelope * voiced + 0.001 * noise();
+            samples[i * channels + c] = Math.round(Math.max(-1, Math.min(1, sample)) * scale);
+        }
+    }
+    return samples;
+}
+
+function makeWhiteNoise(frames, channels, bits, seed) {
+    const samples = new Int32Array(frames * channels);
+    const noise = makeNoise(seed);
+    const scale = 2 ** (bits - 1) - 1;
+    for (let i = 0; i < samples.length; i++) {
+        samples[i] = Math.round(0.5 * noise() * scale);
+    }
+    return samples;
+}
+
+function sameSamples(a, b) {
+    if (a.length !== b.length) {
+        return false;
+    }
+    for (let i = 0; i < a.length; i++) {
+        if (a[i] !== b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A 16-bit PCM WAV holding `samples`
+function makeWav(samples, channels, rate) {
+    const header = Buffer.alloc(44);
+    header.write('RIFF', 0);
+    header.writeUInt32LE(36 + samples.length * 2, 4);
+    header.write('WAVEfmt ', 8);
+    header.writeUInt32LE(16, 16);
+    header.writeUInt16LE(1, 20);
+    header.writeUInt16LE(channels, 22);
+    header.writeUInt32LE(rate, 24);
+    header.writeUInt32LE(rate * channels * 2, 28);
+    header.writeUInt16LE(channels * 2, 32);
+    header.writeUInt16LE(16, 34);
+    header.write('data', 36);
+    header.writeUInt32LE(samples.length * 2, 40);
+    return Buffer.concat([header, Buffer.from(samples.buffer, samples.byteOffset, samples.length * 2)]);
+}
+
+async function record(recorder) {
+    const chunks = [];
+    let total = 0;
+    const drain = () => {
+        const data = recorder.getAudioData();
+        chunks.push(data);
+        total += data.length;
+    };
+    if (!recorder.startRecording()) {
+        return new Float32Array(0);
+    }
+    while (!recorder.hasEnded()) {
+        drain();
+        await sleep(5);
+    }
+    drain();
+    recorder.stopRecording();
+
+    const samples = new Float32Array(total);
+    let offset = 0;
+    for (const chunk of chunks) {
+        samples.set(chunk, offset);
+        offset += chunk.length;
+    }
+    return samples;
+}
+
+(async () => {
+    const scratch = path.join(os.tmpdir(), `voiceink-flac-${process.pid}.flac`);
+    const recordingFile = path.join(os.tmpdir(), `voiceink-flac-recording-${process.pid}.flac`);
+    const wavFile = path.join(os.tmpdir(), `voiceink-flac-source-${process.pid}.wav`);
+    const convertedFile = path.join(os.tmpdir(), `voiceink-flac-converted-${process.pid}.flac`);
+    const roundTrip = (samples, options) => {
+        fs.writeFileSync(scratch, dsp.encodeFlac(samples, options));
+        return dsp.decodeFlac(scratch);
+    };
+    try {
+        console.log('\n📦 Round trips:');
+        const cases = [
+            { label: 'Speech, 16-bit mono', samples: makeSpeech(RATE * 3, 1, RATE, 16), channels: 1, bits: 16 },
+            { label: 'Speech, 16-bit stereo', samples: makeSpeech(48000 * 2, 2, 48000, 16), channels: 2, bits: 16 },
+            { label: 'Speech, 24-bit stereo', samples: makeSpeech(48000, 2, 48000, 24, 2), channels: 2, bits: 24 },
+            { label: 'Noise, 24-bit, 3 channels', samples: makeWhiteNoise(12345, 3, 24, 3), channels: 3, bits: 24 },
+            { label: 'Silence, odd length', samples: new Int16Array(4097), channels: 1, bits: 16 },
+            { label: 'Single frame', samples: Int16Array.of(-32768, 32767), channels: 2, bits: 16 },
+        ];
+        for (const { label, samples, channels, bits } of cases) {
+            const decoded = roundTrip(samples, { sampleRate: 48000, channels, bitsPerSample: bits });
+            check(label, decoded.channels === channels && decoded.bitsPerSample === bits && !decoded.damaged &&
+                sameSamples(decoded.samples, samples), `${samples.length / channels} frames`);
+        }
+
+        const speech = makeSpeech(48000 * 10, 2, 48000, 16);
+        const single = dsp.encodeFlac(speech, { sampleRate: 48000, channels: 2, threads: 1 });
+        const threaded = dsp.encodeFlac(speech, { sampleRate: 48000, channels: 2, threads: 4 });
+        check('Threads do not change the stream', single.equals(threaded), `${single.length} bytes`);
+        const ratio = single.length / (speech.length * 2);
+        check('Speech compresses to under 60%', ratio < 0.6, `${(100 * ratio).toFixed(1)}% of PCM`);
+        let threw = false;
+        try {
+            dsp.encodeFlac(Int32Array.of(1 << 20), { sampleRate: 48000, bitsPerSample: 16 });
+        } catch (error) {
+            threw = true;
+        }
+        check('Out-of-range samples throw', threw);
+
+        console.log('\n📦 Recording to FLAC:');
+        const recorder = new WASAPIRecorder();
+        recorder.setSource({ type: 'synthetic', signal: 'speech', sampleRate: RATE, channels: 1, durationMs: 20000, realtime: false });
+        check('setRecordingFile(flac)', recorder.setRecordingFile(recordingFile, { container: 'flac' }) === true);
+        const recorded = await record(recorder);
+        const stats = recorder.getRecordingFileStats();
+        const stored = dsp.decodeFlac(recordingFile);
+        let largestError = 0;
+        for (let i = 0; i < recorded.length; i++) {
+            const expected = Math.round(32767 * Math.max(-1, Math.min(1, recorded[i])));
+            largestError = Math.max(largestError, Math.abs(stored.samples[i] - expected));
+        }
+        check('File holds the whole recording', stored.samples.length === recorded.length && stored.sampleRate === RATE &&
+            !stored.damaged, `${(stored.samples.length / RATE).toFixed(1)} s`);
+        check('Samples match getAudioData()', recorded.length > 0 && largestError <= 1, `within ${largestError} LSB`);
+        check('Disk writes shrink', stats.sourceBytes === recorded.length * 2 && stats.bytesWritten < 0.7 * stats.sourceBytes &&
+            stats.droppedBytes === 0 && !stats.failed, `${(100 * stats.bytesWritten / stats.sourceBytes).toFixed(1)}% of PCM`);
+        let rejected = false;
+        try {
+            rejected = recorder.setRecordingFile(recordingFile, { container: 'flac', encoding: 'float32' }) === false;
+        } catch (error) {
+            rejected = true;
+        }
+        check('Float FLAC is refused', rejected);
+
+        console.log('\n📦 Replaying FLAC:');
+        recorder.setRecordingFile(null);
+        recorder.setSource({ type: 'file', path: recordingFile, realtime: false });
+        const replayed = await record(recorder);
+        let replayError = 0;
+        for (let i = 0; i < replayed.length; i++) {
+            replayError = Math.max(replayError, Math.abs(replayed[i] - stored.samples[i] / 32768));
+        }
+        check('File source decodes FLAC', replayed.length === stored.samples.length && replayError < 1e-6,
+            `${replayed.length} samples`);
+
+        console.log('\n📦 Converting stored WAV:');
+        const wavSamples = makeSpeech(RATE * 30, 1, RATE, 16, 4);
+        fs.writeFileSync(wavFile, makeWav(wavSamples, 1, RATE));
+        const conversion = dsp.convertToFlac(wavFile, convertedFile, { threads: 2 });
+        check('convertToFlac() returns a Promise', conversion instanceof Promise);
+        const converted = await conversion;
+        const convertedBack = dsp.decodeFlac(convertedFile);
+        check('convertToFlac() is lossless', converted.frames === wavSamples.length && sameSamples(convertedBack.samples, wavSamples),
+            `${(100 * converted.flacBytes / converted.pcmBytes).toFixed(1)}% of PCM`);
+        check('Output size is reported', converted.flacBytes === fs.statSync(convertedFile).size);
+
+        console.log('\n📦 Crash recovery:');
+        const intact = fs.statSync(recordingFile).size;
+        fs.truncateSync(recordingFile, Math.floor(intact * 0.6));
+        const truncated = dsp.decodeFlac(recordingFile);
+        check('Truncated tail is detected', truncated.damaged);
+        const recoveredBytes = WASAPIRecorder.recoverRecordingFile(recordingFile);
+        const recovered = dsp.decodeFlac(recordingFile);
+        check('Recovery keeps every whole frame', !recovered.damaged && recoveredBytes === recovered.samples.length * 2 &&
+            recovered.samples.length >= truncated.samples.length &&
+            sameSamples(recovered.samples, stored.samples.subarray(0, recovered.samples.length)),
+            `${(recovered.samples.length / RATE).toFixed(1)} of ${(stored.samples.length / RATE).toFixed(1)} s`);
+
+        console.log('\n📦 Throughput (48 kHz stereo speech):');
+        const benchmark = dsp.benchmarkFlac({ sampleRate: 48000, channels: 2, seconds: 20 });
+        // 48 kHz stereo 16-bit PCM is 0.192 MB per second of audio
+        const realtime = 0.192;
+        check('Encode per core', benchmark.encodeMBPerSecondPerCore > 20 * realtime,
+            `${benchmark.encodeMBPerSecondPerCore.toFixed(1)} MB/s`);
+        check(`Encode on ${benchmark.threads} threads`, benchmark.threadedEncodeMBPerSecond > 20 * realtime,
+            `${benchmark.threadedEncodeMBPerSecond.toFixed(1)} MB/s`);
+        check('Decode', benchmark.decodeMBPerSecond > 20 * realtime, `${benchmark.decodeMBPerSecond.toFixed(1)} MB/s`);
+        check('Compression', benchmark.ratio < 0.6, `${(100 * benchmark.ratio).toFixed(1)}% of PCM`);
+    } finally {
+        for (const filename of [scratch, recordingFile, wavFile, convertedFile]) {
+            if (fs.existsSync(filename)) {
+                fs.unlinkSync(filename);
+            }
+        }
+    }
+
+    finish('FLAC');
+})();
@@ -0,0 +1,139 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies and benchmarks the capture gain stage: manual gain, AGC and the
+ * look-ahead limiter.
+ *
+ * At unity the stage must be transparent. With gain pushing peaks past full
+ * scale, no sample may pass the -1 dBFS ceiling while quiet passages still
+ * get the full gain. With AGC on, loud and quiet passages must both be
+ * steered towards the target without the gain jumping within a passage. The
+ * recorder must apply the same stage. benchmarkGainStage() reports CPU per
+ * channel-second, which must not exceed that of the per-packet chain it
+ * replaced.
+ *
+ * Platform-neutral; run after `npm run build:native`.
+ */
+
+const { check, finish, requireAddons, sleep, toDb, rms } = require('./tests/test-utils');
+
+const RATE = 16000;
+const MS = RATE / 1000;
+const CEILING = Math.pow(10, -1 / 20);
+
+console.log('🔍 VoiceInk Windows - Gain Stage Test');
+console.log('='.repeat(50));
+
+const [dsp, { WASAPIRecorder }] = requireAddons(['audiodsp', 'audiorecorder']);
+
+function peak(samples, start = 0, end = samples.length) {
+    let result = 0;
+    for (let i = start; i < end; i++) {
+        result = Math.max(result, Math.abs(samples[i]));
+    }
+    return result;
+}
+
+// A 220 Hz tone pulsing at a syllable rate; `levels` gives its amplitude for
+// each two-second passage
+function makePassages(levels) {
+    const samples = new Float32Array(levels.length * 2000 * MS);
+    for (let i = 0; i < samples.length; i++) {
+        const t = i / RATE;
+        const level = levels[Math.floor(i / (2000 * MS))];
+        samples[i] = level * (0.6 + 0.4 * Math.cos(2 * Math.PI * 4 * t)) * Math.sin(2 * Math.PI * 220 * t);
+    }
+    return samples;
+}
+
+(async () => {
+    console.log('\n📦 Manual gain and limiter:');
+    const passages = makePassages([0.5, 0.05, 0.5, 0.05]);
+    const unity = dsp.applyGainStage(passages, { sampleRate: RATE });
+    let unityError = 0;
+    for (let i = 0; i < passages.length; i++) {
+        unityError = Math.max(unityError, Math.abs(unity[i] - passages[i]));
+    }
+    check('Unity gain is transparent', unity.length === passages.length && unityError === 0, unityError.toExponential(1));
+
+    const halved = dsp.applyGainStage(passages, { sampleRate: RATE, gain: 0.5 });
+    const halvedDb = toDb(rms(halved, 500 * MS) / rms(passages, 500 * MS));
+    check('Gain 0.5 is -6 dB', Math.abs(halvedDb + 6.02) < 0.05, `${halvedDb.toFixed(2)} dB`);
+
+    const boosted = dsp.applyGainStage(passages, { sampleRate: RATE, gain: 8 });
+    check('Peaks stay under -1 dBFS', peak(boosted) <= CEILING + 1e-6, `${peak(boosted).toFixed(4)}`);
+    const quietGainDb = toDb(rms(boosted, 2500 * MS, 4000 * MS) / rms(passages, 2500 * MS, 4000 * MS));
+    check('Quiet passage gets the full gain', Math.abs(quietGainDb - toDb(8)) < 0.1, `${quietGainDb.toFixed(2)} dB`);
+
+    // The limiter ramps gain sample by sample; no step between neighbours
+    // may be larger than the signal itself can produce
+    let largestStep = 0;
+    for (let i = 1; i < boosted.length; i++) {
+        largestStep = Math.max(largestStep, Math.abs(boosted[i] - boosted[i - 1]));
+    }
+    const toneStep = 2 * Math.PI * 220 / RATE;
+    check('Limiting is click-free', largestStep < CEILING * toneStep * 1.1, `${largestStep.toFixed(4)}`);
+
+    console.log('\n📦 Automatic gain control:');
+    const levelled = dsp.applyGainStage(passages, { sampleRate: RATE, agc: true });
+    // The second loud and quiet passages, skipping the first half second of each
+    const loudDb = toDb(rms(levelled, 4500 * MS, 6000 * MS));
+    const quietDb = toDb(rms(levelled, 6500 * MS, 8000 * MS));
+    const inputSpread = toDb(rms(passages, 4500 * MS, 6000 * MS) / rms(passages, 6500 * MS, 8000 * MS));
+    check('Loud passage near -18 dBFS', Math.abs(loudDb + 18) < 3, `${loudDb.toFixed(1)} dBFS`);
+    check('Quiet passage lifted', quietDb - toDb(rms(passages, 6500 * MS, 8000 * MS)) > 9, `${quietDb.toFixed(1)} dBFS`);
+    check('Spread between passages shrinks', loudDb - quietDb < inputSpread - 9,
+        `${inputSpread.toFixed(0)} → ${(loudDb - quietDb).toFixed(0)} dB`);
+    check('No output over the ceiling', peak(levelled) <= CEILING + 1e-6, `${peak(levelled).toFixed(4)}`);
+
+    // No pumping: quarter-second windows of a steady passage stay within a
+    // couple of dB of each other once the AGC has settled
+    let lowest = Infinity;
+    let highest = -Infinity;
+    for (let start = 5000 * MS; start + 250 * MS <= 6000 * MS; start += 250 * MS) {
+        const level = toDb(rms(levelled, start, start + 250 * MS));
+        lowest = Math.min(lowest, level);
+        highest = Math.max(highest, level);
+    }
+    check('Gain is steady within a passage', highest - lowest < 2, `${(highest - lowest).toFixed(2)} dB`);
+
+    console.log('\n📦 Recorder:');
+    const recordedPeak = async (gain) => {
+        const recorder = new WASAPIRecorder();
+        recorder.setSource({ type: 'synthetic', signal: 'sine', durationMs: 2000, realtime: false });
+        recorder.setGainLevel(gain);
+        if (!recorder.startRecording()) {
+            return NaN;
+        }
+        let loudest = 0;
+        while (!recorder.hasEnded()) {
+            loudest = Math.max(loudest, peak(recorder.getAudioData()));
+            await sleep(5);
+        }
+        loudest = Math.max(loudest, peak(recorder.getAudioData()));
+        recorder.stopRecording();
+        return loudest;
+    };
+    const plainPeak = await recordedPeak(1);
+    const limitedPeak = await recordedPeak(8);
+    check('Gain is limited in the recorder', limitedPeak <= CEILING + 1e-6 && limitedPeak > plainPeak,
+        `${plainPeak.toFixed(3)} → ${limitedPeak.toFixed(3)}`);
+
+    console.log('\n📦 Benchmark (µs per channel-second):');
+    console.log(`   ${'format'.padEnd(22)}${'stage'.padStart(10)}${'per-packet'.padStart(12)}`);
+    for (const [sampleRate, channels, packetFrames] of [[16000, 1, 160], [48000, 2, 480], [48000, 2, 64]]) {
+        // Best of three, so a descheduled run does not decide
+        const runs = Array.from({ length: 3 }, () =>
+            dsp.benchmarkGainStage({ sampleRate, channels, packetFrames, seconds: 20, gain: 1.5, agc: true }));
+        const stage = Math.min(...runs.map((run) => run.nanosPerChannelSecond));
+        const reference = Math.min(...runs.map((run) => run.referenceNanosPerChannelSecond));
+        const label = `${sampleRate / 1000} kHz x${channels}, ${packetFrames}`;
+        console.log(`   ${label.padEnd(22)}${(stage / 1000).toFixed(0).padStart(10)}${(reference / 1000).toFixed(0).padStart(12)}`);
+        // Well under a thousandth of a core per channel...
+        check(`${label} is cheap`, stage < 1e6, `${(stage / 1e7).toFixed(4)}% CPU`);
+        // ...and no dearer than the chain it replaced
+        check(`${label} vs per-packet`, stage <= reference, `${(stage / reference).toFixed(2)}x`);
+    }
+
+    finish('Gain stage');
+})();
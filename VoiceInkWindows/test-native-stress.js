@@ -0,0 +1,64 @@
+#!/usr/bin/env node
+
+/**
+ * Builds and runs the standalone native tests in tests/native.
+ *
+ * The lock-free containers in src/native/common only depend on the
+ * standard library, so they are tested outside the addons: the stress tests
+ * are built with ThreadSanitizer and must finish without a report, the
+ * benchmark is built optimized. Each program prints its own checks.
+ *
+ * Needs a g++ or clang++ with -fsanitize=thread (set CXX to pick one);
+ * skips otherwise.
+ */
+
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { check, finish } = require('./tests/test-utils');
+
+const NATIVE_DIR = path.join(__dirname, 'tests', 'native');
+const COMMON_DIR = path.join(__dirname, 'src', 'native', 'common');
+
+const SANITIZED = ['-std=c++17', '-O1', '-g', '-fsanitize=thread', '-pthread'];
+const OPTIMIZED = ['-std=c++17', '-O2', '-pthread'];
+
+const PROGRAMS = [
+    { source: 'spsc_ring_buffer_stress.cpp', flags: SANITIZED },
+    { source: 'fixed_block_pool_stress.cpp', flags: SANITIZED },
+    { source: 'spsc_ring_buffer_benchmark.cpp', flags: OPTIMIZED }
+];
+
+console.log('🔍 VoiceInk Windows - Native Stress Tests');
+console.log('='.repeat(50));
+
+// The first compiler that can build and link a sanitized program
+const probe = path.join(os.tmpdir(), `voiceink-tsan-probe-${process.pid}`);
+const compiler = [process.env.CXX, 'g++', 'clang++'].find((cxx) => cxx &&
+    spawnSync(cxx, ['-x', 'c++', '-', '-fsanitize=thread', '-o', probe], { input: 'int main() { return 0; }' }).status === 0);
+fs.rmSync(probe, { force: true });
+if (!compiler) {
+    console.log('   ⚠️  No C++ compiler with ThreadSanitizer - skipping');
+    console.log('   Run: CXX=<g++ or clang++> node test-native-stress.js');
+    process.exit(0);
+}
+
+for (const { source, flags } of PROGRAMS) {
+    const binary = path.join(os.tmpdir(), `voiceink-${path.basename(source, '.cpp')}-${process.pid}`);
+    const build = spawnSync(compiler, [...flags, '-I', COMMON_DIR, path.join(NATIVE_DIR, source), '-o', binary],
+        { encoding: 'utf8' });
+    if (build.status !== 0) {
+        console.log(build.stderr);
+        check(`Build ${source}`, false);
+        continue;
+    }
+
+    console.log('');
+    // TSan reports go to stderr and fail the run with exit code 66
+    const run = spawnSync(binary, [], { stdio: 'inherit', timeout: 120000 });
+    check(source, run.status === 0, run.status === null ? 'timed out' : `exit ${run.status}`);
+    fs.rmSync(binary, { force: true });
+}
+
+finish('Native stress');
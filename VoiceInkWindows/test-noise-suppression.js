@@ -0,0 +1,146 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies the spectral noise suppressor.
+ *
+ * With no attenuation allowed the STFT must reconstruct the input exactly,
+ * lined up with it. On speech-like bursts in white noise the pauses must
+ * drop by well over 10 dB while the bursts keep their level, and the SNR
+ * against the clean signal must improve. In the recorder, steady noise must
+ * settle near the attenuation floor once the noise estimate has converged.
+ *
+ * Platform-neutral; run after `npm run build:native`.
+ */
+
+const { check, finish, requireAddons, sleep, toDb, rms } = require('./tests/test-utils');
+
+const RATE = 16000;
+const MS = RATE / 1000;
+
+console.log('🔍 VoiceInk Windows - Noise Suppression Test');
+console.log('='.repeat(50));
+
+const [dsp, { WASAPIRecorder }] = requireAddons(['audiodsp', 'audiorecorder']);
+
+// Harmonic bursts, 1200 ms on and 800 ms off, pulsing at a syllable rate
+function makeSpeech(totalMs) {
+    const samples = new Float32Array(totalMs * MS);
+    for (let i = 0; i < samples.length; i++) {
+        if ((i / MS) % 2000 >= 1200) {
+            continue;
+        }
+        const t = i / RATE;
+        let voiced = 0;
+        for (let harmonic = 1; harmonic <= 8; harmonic++) {
+            voiced += Math.sin(2 * Math.PI * 150 * harmonic * t) / harmonic;
+        }
+        samples[i] = 0.25 * (0.5 - 0.5 * Math.cos(2 * Math.PI * 4 * t)) * voiced;
+    }
+    return samples;
+}
+
+// Roughly Gaussian white noise from a seeded generator
+function makeNoise(length, level, seed = 12345) {
+    const samples = new Float32Array(length);
+    for (let i = 0; i < length; i++) {
+        let sum = 0;
+        for (let j = 0; j < 4; j++) {
+            seed = (seed * 1103515245 + 12345) >>> 0;
+            sum += seed / 4294967296 - 0.5;
+        }
+        samples[i] = level * sum * Math.sqrt(3);
+    }
+    return samples;
+}
+
+(async () => {
+    console.log('\n📦 Reconstruction:');
+    const noise = makeNoise(RATE, 0.3);
+    const passthrough = dsp.suppressNoise(noise, { sampleRate: RATE, maxAttenuationDb: 0 });
+    let maxError = 0;
+    for (let i = 0; i < noise.length; i++) {
+        maxError = Math.max(maxError, Math.abs(passthrough[i] - noise[i]));
+    }
+    check('Unity gain is transparent', passthrough.length === noise.length && maxError < 1e-5, maxError.toExponential(1));
+
+    console.log('\n📦 Speech in noise:');
+    const clean = makeSpeech(8000);
+    const noisy = Float32Array.from(clean);
+    const background = makeNoise(clean.length, 0.03);
+    for (let i = 0; i < noisy.length; i++) {
+        noisy[i] += background[i];
+    }
+    const started = process.hrtime.bigint();
+    const denoised = dsp.suppressNoise(noisy, { sampleRate: RATE });
+    const elapsedMs = Number(process.hrtime.bigint() - started) / 1e6;
+
+    // Seconds 4-8, after the noise estimate has settled
+    let noiseIn = 0;
+    let noiseOut = 0;
+    let speechIn = 0;
+    let speechOut = 0;
+    for (const burst of [4000, 6000]) {
+        noiseIn += rms(noisy, (burst + 1300) * MS, (burst + 1900) * MS);
+        noiseOut += rms(denoised, (burst + 1300) * MS, (burst + 1900) * MS);
+        speechIn += rms(clean, (burst + 200) * MS, (burst + 1100) * MS);
+        speechOut += rms(denoised, (burst + 200) * MS, (burst + 1100) * MS);
+    }
+    check('Pauses are cleaned up', toDb(noiseOut / noiseIn) < -12, `${toDb(noiseOut / noiseIn).toFixed(1)} dB`);
+    check('Speech keeps its level', Math.abs(toDb(speechOut / speechIn)) < 1, `${toDb(speechOut / speechIn).toFixed(2)} dB`);
+
+    let signal = 0;
+    let errorIn = 0;
+    let errorOut = 0;
+    for (let i = 4000 * MS; i < 8000 * MS; i++) {
+        signal += clean[i] * clean[i];
+        errorIn += (noisy[i] - clean[i]) ** 2;
+        errorOut += (denoised[i] - clean[i]) ** 2;
+    }
+    const snrIn = 10 * Math.log10(signal / errorIn);
+    const snrOut = 10 * Math.log10(signal / errorOut);
+    check('SNR improves', snrOut - snrIn > 6, `${snrIn.toFixed(1)} → ${snrOut.toFixed(1)} dB`);
+    check('Faster than real time', elapsedMs < 8000 / 20, `${elapsedMs.toFixed(1)} ms for 8 s`);
+
+    // Each channel of interleaved audio is suppressed on its own
+    const stereo = new Float32Array(noisy.length * 2);
+    for (let i = 0; i < noisy.length; i++) {
+        stereo[2 * i] = noisy[i];
+        stereo[2 * i + 1] = background[i];
+    }
+    const stereoOut = dsp.suppressNoise(stereo, { sampleRate: RATE, channels: 2 });
+    let channelMatch = true;
+    for (let i = 0; i < noisy.length; i++) {
+        channelMatch = channelMatch && stereoOut[2 * i] === denoised[i];
+    }
+    check('Channels are independent', channelMatch);
+
+    console.log('\n📦 Recorder:');
+    // Steady white noise; the last two seconds are compared
+    const tailLevel = async (enable) => {
+        const recorder = new WASAPIRecorder();
+        recorder.setSource({ type: 'synthetic', signal: 'noise', durationMs: 4000, realtime: false });
+        recorder.enableNoiseSupression(enable, { maxAttenuationDb: 18 });
+        if (!recorder.startRecording()) {
+            return NaN;
+        }
+        const chunks = [];
+        while (!recorder.hasEnded()) {
+            chunks.push(recorder.getAudioData());
+            await sleep(5);
+        }
+        chunks.push(recorder.getAudioData());
+        recorder.stopRecording();
+
+        const all = new Float32Array(chunks.reduce((total, chunk) => total + chunk.length, 0));
+        let offset = 0;
+        for (const chunk of chunks) {
+            all.set(chunk, offset);
+            offset += chunk.length;
+        }
+        return rms(all, all.length / 2, all.length);
+    };
+    const reduction = toDb((await tailLevel(true)) / (await tailLevel(false)));
+    check('Steady noise reaches the floor', reduction < -12 && reduction > -20, `${reduction.toFixed(1)} dB`);
+
+    finish('Noise suppression');
+})();
@@ -0,0 +1,113 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies and benchmarks the fused packet statistics kernel.
+ *
+ * measurePacket() must agree with sums, peaks, means and per-channel zero
+ * crossings computed here, for float and int16 samples, any channel count,
+ * and packet lengths that leave a scalar tail. benchmarkPacketStatistics()
+ * then times it against the separate scans it replaced (the meter's RMS and
+ * peak, VAD's RMS and AGC's RMS for float blocks; the recorder's
+ * double-precision RMS for int16) at 48 kHz stereo with small packets.
+ *
+ * Platform-neutral; run after `npm run build:native`.
+ */
+
+const { check, finish, requireAddons, makeNoise } = require('./tests/test-utils');
+
+console.log('🔍 VoiceInk Windows - Packet Statistics Test');
+console.log('='.repeat(50));
+
+const [dsp] = requireAddons(['audiodsp']);
+
+// Interleaved tones, a different frequency and offset per channel, with noise
+function makeSignal(frames, channels, sampleRate, seed) {
+    const noise = makeNoise(seed);
+    const samples = new Float32Array(frames * channels);
+    for (let i = 0; i < frames; i++) {
+        for (let c = 0; c < channels; c++) {
+            const tone = Math.sin(2 * Math.PI * 300 * (c + 1) * i / sampleRate);
+            samples[i * channels + c] = 0.4 * tone + 0.05 * noise() + 0.01 * c;
+        }
+    }
+    return samples;
+}
+
+function toInt16(samples) {
+    return Int16Array.from(samples, (sample) => Math.round(32767 * Math.max(-1, Math.min(1, sample))));
+}
+
+function expected(samples, channels, scale = 1) {
+    let sumSquares = 0;
+    let sum = 0;
+    let peak = 0;
+    let zeroCrossings = 0;
+    for (let i = 0; i < samples.length; i++) {
+        const x = samples[i] * scale;
+        sumSquares += x * x;
+        sum += x;
+        peak = Math.max(peak, Math.abs(x));
+        if (i >= channels && (samples[i] >= 0) !== (samples[i - channels] >= 0)) {
+            zeroCrossings++;
+        }
+    }
+    const count = samples.length;
+    return {
+        rms: count ? Math.sqrt(sumSquares / count) : 0,
+        peak,
+        dcOffset: count ? sum / count : 0,
+        zeroCrossings,
+        zeroCrossingRate: count > channels ? zeroCrossings / (count - channels) : 0
+    };
+}
+
+function agrees(actual, wanted) {
+    return actual.zeroCrossings === wanted.zeroCrossings &&
+        Math.abs(actual.rms - wanted.rms) <= 1e-5 + 1e-5 * wanted.rms &&
+        Math.abs(actual.peak - wanted.peak) <= 1e-6 &&
+        Math.abs(actual.dcOffset - wanted.dcOffset) <= 1e-5 &&
+        Math.abs(actual.zeroCrossingRate - wanted.zeroCrossingRate) <= 1e-6;
+}
+
+console.log('\n📦 Accuracy:');
+for (const channels of [1, 2, 6]) {
+    let floatOk = true;
+    let int16Ok = true;
+    for (const frames of [0, 1, 3, 7, 64, 480, 1001]) {
+        const samples = makeSignal(frames, channels, 48000, frames + channels);
+        floatOk = floatOk && agrees(dsp.measurePacket(samples, channels), expected(samples, channels));
+        const int16 = toInt16(samples);
+        int16Ok = int16Ok && agrees(dsp.measurePacket(int16, channels), expected(int16, channels, 1 / 32768));
+    }
+    check(`Float, ${channels} channel(s)`, floatOk);
+    check(`Int16, ${channels} channel(s)`, int16Ok);
+}
+
+// A 1 kHz tone crosses zero twice per cycle
+const tone = new Float32Array(48000).map((_, i) => Math.sin(2 * Math.PI * 1000 * (i + 0.5) / 48000));
+const toneStats = dsp.measurePacket(tone, 1);
+check('Crossing rate of a 1 kHz tone', Math.abs(toneStats.zeroCrossingRate * 48000 - 2000) <= 2,
+    `${(toneStats.zeroCrossingRate * 48000).toFixed(0)} per second`);
+const offset = new Float32Array(480).fill(0.25);
+check('DC offset', Math.abs(dsp.measurePacket(offset, 2).dcOffset - 0.25) < 1e-6 && dsp.measurePacket(offset, 2).zeroCrossings === 0);
+
+console.log('\n📦 Benchmark (µs per channel-second):');
+console.log(`   ${'format'.padEnd(22)}${'fused'.padStart(8)}${'scans'.padStart(8)}${'int16'.padStart(8)}${'double'.padStart(8)}`);
+for (const [sampleRate, channels, packetFrames] of [[48000, 2, 64], [48000, 2, 128], [48000, 2, 480], [16000, 1, 160]]) {
+    // Best of three, so a descheduled run does not decide
+    const runs = Array.from({ length: 3 }, () => dsp.benchmarkPacketStatistics({ sampleRate, channels, packetFrames, seconds: 20 }));
+    const result = {};
+    for (const key of Object.keys(runs[0])) {
+        result[key] = Math.min(...runs.map((run) => run[key]));
+    }
+    const label = `${sampleRate / 1000} kHz x${channels}, ${packetFrames}`;
+    const us = (nanos) => (nanos / 1000).toFixed(1).padStart(8);
+    console.log(`   ${label.padEnd(22)}${us(result.nanosPerChannelSecond)}${us(result.referenceNanosPerChannelSecond)}` +
+        `${us(result.int16NanosPerChannelSecond)}${us(result.int16ReferenceNanosPerChannelSecond)}`);
+    const speedup = result.referenceNanosPerChannelSecond / result.nanosPerChannelSecond;
+    check(`${label} beats the scans`, speedup > 2, `${speedup.toFixed(1)}x`);
+    const int16Speedup = result.int16ReferenceNanosPerChannelSecond / result.int16NanosPerChannelSecond;
+    check(`${label} int16 beats double`, int16Speedup > 1, `${int16Speedup.toFixed(1)}x`);
+}
+
+finish('Packet statistics');
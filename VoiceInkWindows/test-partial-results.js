@@ -0,0 +1,177 @@
+#!/usr/bin/env node
+
+/**
+ * Drives diff-only partial result streaming through the native binding.
+ *
+ * emitPartialResult() feeds a simulated 30 minute dictation session, one
+ * partial update every 200 ms, through the native PartialResultDeltaTracker
+ * and CoalescingChannel to the setPartialResultCallback() callback. The
+ * deltas are fed through PartialResultAssembler, which must rebuild exactly
+ * the same transcript, and their payload bytes and JS values (objects,
+ * strings, numbers) are compared with the full result object the binding
+ * used to send per update. Updates posted while the JS thread is busy must
+ * arrive merged, one delivery per stream, and a lost delta must be detected.
+ *
+ * Platform-neutral; run after `npm run build:native`.
+ */
+
+const { PartialResultAssembler } = require('./src/main/whisper/partialResultAssembler');
+const { check, finish, requireAddons, sleep } = require('./tests/test-utils');
+
+const SESSION_SECONDS = 30 * 60;
+const UPDATE_MS = 200;
+const SEGMENT_SECONDS = 5;
+const WORDS = ['the', 'quick', 'brown', 'fox', 'jumps', 'over', 'lazy', 'dog', 'café', 'naïve', 'résumé', 'voice'];
+
+console.log('🔍 VoiceInk Windows - Partial Result Streaming Test');
+console.log('='.repeat(50));
+
+const [{ WhisperTranscription }] = requireAddons(['whisperbinding']);
+
+// Partial result at time `t`: completed segments plus the one being spoken
+function partialAt(t) {
+    const segments = [];
+    const completed = Math.floor(t / SEGMENT_SECONDS);
+    for (let i = 0; i <= completed; i++) {
+        const start = i * SEGMENT_SECONDS;
+        const end = Math.min(start + SEGMENT_SECONDS, t);
+        const wordCount = Math.max(1, Math.round((end - start) * 2.4));
+        let text = '';
+        for (let w = 0; w < wordCount; w++) text += ' ' + WORDS[(i * 7 + w) % WORDS.length];
+        segments.push({ startTime: start, endTime: end, text, confidence: 0.9, speakerId: 0, language: 'en', probability: 0.9 });
+    }
+    return segments;
+}
+
+// Shape of the full result object the binding would otherwise send
+function snapshotOf(segments, t) {
+    return {
+        text: segments.map((s) => s.text).join(''),
+        language: 'en',
+        duration: t,
+        confidence: 0.9,
+        segmentCount: segments.length,
+        segments
+    };
+}
+
+// Objects + strings + numbers a binding materializes for a payload
+function countValues(value) {
+    if (Array.isArray(value)) return 1 + value.reduce((n, v) => n + countValues(v), 0);
+    if (value && typeof value === 'object') return 1 + Object.values(value).reduce((n, v) => n + countValues(v), 0);
+    return 1;
+}
+
+const whisper = new WhisperTranscription();
+const deliveries = [];
+let onDelivery = null;
+whisper.setPartialResultCallback((streamId, delta) => {
+    deliveries.push({ streamId, delta });
+    if (onDelivery) onDelivery();
+});
+
+// Resolves once `count` deltas have reached JS in total
+function delivered(count) {
+    return new Promise((resolve, reject) => {
+        const timer = setTimeout(() => reject(new Error(`Delivery ${count} never arrived`)), 1000);
+        onDelivery = () => {
+            if (deliveries.length >= count) {
+                clearTimeout(timer);
+                onDelivery = null;
+                resolve();
+            }
+        };
+        onDelivery();
+    });
+}
+
+async function runSession() {
+    const assembler = new PartialResultAssembler();
+    const snapshot = { bytes: 0, values: 0, deliveries: 0 };
+    const delta = { bytes: 0, values: 0, deliveries: 0 };
+    let finalText = '';
+
+    deliveries.length = 0;
+    const steps = (SESSION_SECONDS * 1000) / UPDATE_MS;
+    for (let step = 1; step <= steps; step++) {
+        const t = (step * UPDATE_MS) / 1000;
+        const segments = partialAt(t);
+
+        const full = snapshotOf(segments, t);
+        snapshot.bytes += Buffer.byteLength(JSON.stringify(full), 'utf8');
+        snapshot.values += countValues(full);
+        snapshot.deliveries++;
+
+        // The JS thread is idle between updates, so none are merged
+        whisper.emitPartialResult('session', segments, step === steps);
+        await delivered(step);
+        const payload = deliveries[step - 1].delta;
+        finalText = PartialResultAssembler.textOf(assembler.apply('session', payload));
+        delta.bytes += Buffer.byteLength(JSON.stringify(payload), 'utf8');
+        delta.values += countValues(payload);
+        delta.deliveries++;
+    }
+
+    return { snapshot, delta, finalText };
+}
+
+(async () => {
+    const { snapshot, delta, finalText } = await runSession();
+    const expectedText = snapshotOf(partialAt(SESSION_SECONDS), SESSION_SECONDS).text;
+    const byteRatio = delta.bytes / snapshot.bytes;
+    const valueRatio = delta.values / snapshot.values;
+
+    const mb = (n) => (n / 1024 / 1024).toFixed(2);
+    console.log(`\n📊 ${SESSION_SECONDS / 60} min session, update every ${UPDATE_MS} ms:`);
+    console.log(`   Full snapshots:  ${snapshot.deliveries} deliveries, ${mb(snapshot.bytes)} MB, ${snapshot.values} JS values`);
+    console.log(`   Deltas:          ${delta.deliveries} deliveries, ${mb(delta.bytes)} MB, ${delta.values} JS values`);
+    check('Transcript rebuilt exactly', finalText === expectedText);
+    check('Bytes below 5%', byteRatio < 0.05, `${(byteRatio * 100).toFixed(2)}%`);
+    check('JS values below 5%', valueRatio < 0.05, `${(valueRatio * 100).toFixed(2)}%`);
+
+    console.log('\n📦 Busy JS thread:');
+    // Posted in one go, so the channel folds each stream's updates together
+    deliveries.length = 0;
+    const BURST = 50;
+    for (let step = 1; step <= BURST; step++) {
+        const t = (step * UPDATE_MS * 10) / 1000;
+        whisper.emitPartialResult('first', partialAt(t), step === BURST);
+        whisper.emitPartialResult('second', partialAt(t / 2), false);
+    }
+    await sleep(100);
+    const streams = deliveries.map((entry) => entry.streamId).sort();
+    check('One delivery per stream', streams.join() === 'first,second', `${deliveries.length} deliveries`);
+    const merged = deliveries.find((entry) => entry.streamId === 'first');
+    let mergedText = null;
+    try {
+        mergedText = merged && PartialResultAssembler.textOf(new PartialResultAssembler().apply('first', merged.delta));
+    } catch (error) {
+        mergedText = null;
+    }
+    const lastT = (BURST * UPDATE_MS * 10) / 1000;
+    check('Merged delta holds every update', mergedText === snapshotOf(partialAt(lastT), lastT).text &&
+        merged.delta.sequence === BURST && merged.delta.isFinal === true);
+
+    console.log('\n📦 Lost delta:');
+    deliveries.length = 0;
+    for (const [i, t] of [6, 11, 16].entries()) {
+        whisper.emitPartialResult('lossy', partialAt(t), false);
+        await delivered(i + 1);
+    }
+    const assembler = new PartialResultAssembler();
+    let outOfSyncDetected = false;
+    try {
+        assembler.apply('lossy', deliveries[0].delta);
+        assembler.apply('lossy', deliveries[2].delta); // deliveries[1] lost
+    } catch (error) {
+        outOfSyncDetected = true;
+    }
+    check('Lost delta detected', outOfSyncDetected);
+
+    whisper.emitPartialResult('lossy', partialAt(16), true);
+    await delivered(4);
+    finish('Partial result streaming');
+})().catch((error) => {
+    console.error('❌ Test crashed:', error);
+    process.exitCode = 1;
+});
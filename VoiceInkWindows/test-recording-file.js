@@ -0,0 +1,183 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies streaming recordings to disk.
+ *
+ * With setRecordingFile() each recording is written to a WAV file by a
+ * background writer as it is captured. A recording far longer than the old
+ * 1 MB in-memory buffer must land on disk sample for sample as getAudioData()
+ * returned it, in 16-bit or float. A recorder killed mid-recording must
+ * leave a file that is already playable up to its last header update, and
+ * recoverRecordingFile() must restore all but the last second or so.
+ *
+ * Uses a synthetic source, so it runs on any platform after
+ * `npm run build:native`.
+ */
+
+const { spawn } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { check, finish, requireAddons, addonPath, sleep } = require('./tests/test-utils');
+
+const RATE = 16000;
+
+console.log('🔍 VoiceInk Windows - Recording File Test');
+console.log('='.repeat(50));
+
+const [{ WASAPIRecorder }] = requireAddons(['audiorecorder']);
+
+// The chunks this needs from a RIFF/WAVE or RF64 file, plus the raw data
+function readWav(filename) {
+    const buffer = fs.readFileSync(filename);
+    const wav = { magic: buffer.toString('ascii', 0, 4), declaredBytes: 0, data: null };
+    for (let offset = 12; offset + 8 <= buffer.length;) {
+        const id = buffer.toString('ascii', offset, offset + 4);
+        const size = buffer.readUInt32LE(offset + 4);
+        if (id === 'fmt ') {
+            wav.formatTag = buffer.readUInt16LE(offset + 8);
+            wav.channels = buffer.readUInt16LE(offset + 10);
+            wav.sampleRate = buffer.readUInt32LE(offset + 12);
+            wav.bitsPerSample = buffer.readUInt16LE(offset + 22);
+        } else if (id === 'data') {
+            wav.dataOffset = offset + 8;
+            wav.declaredBytes = size;
+            wav.data = buffer.subarray(offset + 8);
+            break;
+        }
+        offset += 8 + size + (size & 1);
+    }
+    return wav;
+}
+
+async function record(recorder) {
+    const chunks = [];
+    let total = 0;
+    const drain = () => {
+        const data = recorder.getAudioData();
+        chunks.push(data);
+        total += data.length;
+    };
+    if (!recorder.startRecording()) {
+        return new Float32Array(0);
+    }
+    while (!recorder.hasEnded()) {
+        drain();
+        await sleep(5);
+    }
+    drain();
+    recorder.stopRecording();
+
+    const samples = new Float32Array(total);
+    let offset = 0;
+    for (const chunk of chunks) {
+        samples.set(chunk, offset);
+        offset += chunk.length;
+    }
+    return samples;
+}
+
+// Runs in a child process: records from a realtime source, then dies
+// without stopping, as a crash would
+const CHILD = `
+const { WASAPIRecorder } = require(${JSON.stringify(addonPath('audiorecorder'))});
+const recorder = new WASAPIRecorder();
+recorder.setSource({ type: 'synthetic', signal: 'sine', frequency: 100, sampleRate: ${RATE}, channels: 1, realtime: true });
+recorder.setRecordingFile(process.argv[1]);
+if (recorder.startRecording()) {
+    const started = Date.now();
+    const timer = setInterval(() => {
+        recorder.getAudioData();
+        if (Date.now() - started >= Number(process.argv[2])) {
+            process.kill(process.pid, 'SIGKILL');
+        }
+    }, 10);
+}
+`;
+
+function recordAndCrash(filename, durationMs) {
+    return new Promise((resolve) => {
+        const child = spawn(process.execPath, ['-e', CHILD, filename, String(durationMs)], { stdio: 'ignore' });
+        child.on('exit', (code, signal) => resolve(signal));
+    });
+}
+
+(async () => {
+    const int16File = path.join(os.tmpdir(), `voiceink-recording-${process.pid}.wav`);
+    const floatFile = path.join(os.tmpdir(), `voiceink-recording-float-${process.pid}.wav`);
+    const crashFile = path.join(os.tmpdir(), `voiceink-recording-crash-${process.pid}.wav`);
+    try {
+        console.log('\n📦 Long recording, 16-bit:');
+        const recorder = new WASAPIRecorder();
+        recorder.setSource({ type: 'synthetic', signal: 'speech', sampleRate: RATE, channels: 1, durationMs: 60000, realtime: false });
+        check('setRecordingFile()', recorder.setRecordingFile(int16File) === true);
+        const samples = await record(recorder);
+        const stats = recorder.getRecordingFileStats();
+        const wav = readWav(int16File);
+        const seconds = wav.data.length / 2 / RATE;
+        check('File holds the whole recording', wav.data.length === samples.length * 2 && wav.declaredBytes === wav.data.length,
+            `${seconds.toFixed(1)} s, ${(wav.data.length / 1048576).toFixed(1)} MB`);
+        check('Format is 16 kHz mono PCM', wav.formatTag === 1 && wav.channels === 1 && wav.sampleRate === RATE && wav.bitsPerSample === 16);
+        check('Data starts on a page', wav.dataOffset % 4096 === 0, `offset ${wav.dataOffset}`);
+        let largestError = 0;
+        for (let i = 0; i < samples.length; i++) {
+            const expected = Math.round(32767 * Math.max(-1, Math.min(1, samples[i])));
+            largestError = Math.max(largestError, Math.abs(wav.data.readInt16LE(i * 2) - expected));
+        }
+        check('Samples match getAudioData()', samples.length > 0 && largestError <= 1, `within ${largestError} LSB`);
+        check('Writer kept up', stats.bytesWritten === wav.data.length && stats.droppedBytes === 0 && !stats.failed,
+            `${stats.headerUpdates} header updates`);
+
+        console.log('\n📦 Float recording:');
+        recorder.setSource({ type: 'synthetic', signal: 'noise', sampleRate: RATE, channels: 1, durationMs: 5000, realtime: false });
+        recorder.setRecordingFile(floatFile, { encoding: 'float32' });
+        const floats = await record(recorder);
+        const floatWav = readWav(floatFile);
+        const stored = new Float32Array(floatWav.data.buffer.slice(floatWav.data.byteOffset, floatWav.data.byteOffset + floatWav.data.length));
+        check('Format is IEEE float', floatWav.formatTag === 3 && floatWav.bitsPerSample === 32);
+        check('Samples are bit-exact', stored.length === floats.length && stored.every((sample, i) => sample === floats[i]),
+            `${stored.length} samples`);
+
+        console.log('\n📦 Turning it off:');
+        recorder.setRecordingFile(null);
+        const before = fs.statSync(floatFile).mtimeMs;
+        recorder.setSource({ type: 'synthetic', signal: 'noise', sampleRate: RATE, channels: 1, durationMs: 500, realtime: false });
+        await record(recorder);
+        check('Earlier file left alone', fs.statSync(floatFile).mtimeMs === before && recorder.getRecordingFileStats().path === null);
+
+        console.log('\n📦 Crash recovery:');
+        const crashMs = 3500;
+        const signal = await recordAndCrash(crashFile, crashMs);
+        check('Recorder was killed', signal === 'SIGKILL', String(signal));
+        const crashed = readWav(crashFile);
+        const headerSeconds = crashed.declaredBytes / 2 / RATE;
+        check('Header already covers most of it', headerSeconds >= (crashMs - 2000) / 1000, `${headerSeconds.toFixed(2)} s`);
+        const recoveredBytes = WASAPIRecorder.recoverRecordingFile(crashFile);
+        const recovered = readWav(crashFile);
+        const recoveredSeconds = recovered.declaredBytes / 2 / RATE;
+        check('Recovery restores the rest', recoveredBytes === recovered.declaredBytes && recovered.data.length === recoveredBytes &&
+            recoveredSeconds >= (crashMs - 1000) / 1000 && recoveredSeconds <= crashMs / 1000 + 0.1,
+            `${recoveredSeconds.toFixed(2)} of ${(crashMs / 1000).toFixed(1)} s`);
+        let clean = true;
+        for (let i = 1; i < recovered.data.length / 2; i++) {
+            // A 100 Hz sine at 0.5 moves under 0.02 full scale per sample
+            clean = clean && Math.abs(recovered.data.readInt16LE(i * 2) - recovered.data.readInt16LE(i * 2 - 2)) < 1000;
+        }
+        check('Recovered audio is continuous', clean);
+        let threw = false;
+        try {
+            WASAPIRecorder.recoverRecordingFile(path.join(os.tmpdir(), 'voiceink-no-such-recording.wav'));
+        } catch (error) {
+            threw = true;
+        }
+        check('Missing file throws', threw);
+    } finally {
+        for (const filename of [int16File, floatFile, crashFile]) {
+            if (fs.existsSync(filename)) {
+                fs.unlinkSync(filename);
+            }
+        }
+    }
+
+    finish('Recording file');
+})();
@@ -0,0 +1,104 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies the polyphase resampler and the capture format stage.
+ *
+ * Tones inside the pass band must come through at unity gain and line up
+ * with the input; tones above the output Nyquist frequency must be
+ * attenuated instead of aliasing into the speech band. The capture stage
+ * must downmix by averaging or channel selection, and splitting a stream
+ * into device-sized packets must give exactly the same samples as one call.
+ *
+ * Platform-neutral; run after `npm run build:native`.
+ */
+
+const { check, finish, requireAddons, toDb } = require('./tests/test-utils');
+
+console.log('🔍 VoiceInk Windows - Resampler Test');
+console.log('='.repeat(50));
+
+const [dsp] = requireAddons(['audiodsp']);
+
+function tone(frequency, rate, seconds, amplitude = 0.5) {
+    const samples = new Float32Array(Math.round(rate * seconds));
+    for (let i = 0; i < samples.length; i++) {
+        samples[i] = amplitude * Math.sin(2 * Math.PI * frequency * i / rate);
+    }
+    return samples;
+}
+
+// RMS of the middle half, away from the edges of the clip
+function middleRms(samples) {
+    let sum = 0;
+    const start = Math.floor(samples.length / 4);
+    const end = Math.floor(samples.length * 3 / 4);
+    for (let i = start; i < end; i++) {
+        sum += samples[i] * samples[i];
+    }
+    return Math.sqrt(sum / (end - start));
+}
+
+
+console.log('\n📦 Clip resampling:');
+for (const inputRate of [48000, 44100, 96000, 8000]) {
+    const input = tone(1000, inputRate, 1);
+    const output = dsp.resample(input, inputRate, 16000);
+    const gain = middleRms(output) / middleRms(input);
+    check(`${inputRate} -> 16000 length`, output.length === 16000, `${output.length}`);
+    check(`${inputRate} -> 16000 1 kHz gain`, Math.abs(toDb(gain)) < 0.05, `${toDb(gain).toFixed(3)} dB`);
+
+    // Delay compensation keeps the tone in phase with the ideal output
+    let maxError = 0;
+    for (let i = 200; i < output.length - 200; i++) {
+        maxError = Math.max(maxError, Math.abs(output[i] - 0.5 * Math.sin(2 * Math.PI * 1000 * i / 16000)));
+    }
+    check(`${inputRate} -> 16000 alignment`, maxError < 0.01, `max error ${maxError.toFixed(3)}`);
+
+    if (inputRate > 16000) {
+        for (const frequency of [8500, 12000]) {
+            const rejected = middleRms(dsp.resample(tone(frequency, inputRate, 1), inputRate, 16000)) / middleRms(input);
+            check(`${inputRate} -> 16000 ${frequency} Hz rejected`, toDb(rejected) < -70, `${toDb(rejected).toFixed(1)} dB`);
+        }
+    }
+}
+const native = tone(440, 16000, 0.1);
+const copied = dsp.resample(native, 16000, 16000);
+check('16000 -> 16000 passthrough', copied.length === native.length && copied.every((value, i) => value === native[i]));
+
+console.log('\n📦 Capture stage:');
+const frames = 48000;
+const stereo = new Float32Array(frames * 2);
+const left = tone(440, 48000, 1);
+for (let i = 0; i < frames; i++) {
+    stereo[i * 2] = left[i];
+    stereo[i * 2 + 1] = 0;
+}
+
+const averaged = dsp.formatCapture(stereo, { inputRate: 48000, channels: 2 });
+const averageGain = middleRms(averaged) / middleRms(left);
+check('48 kHz stereo -> 16 kHz mono', Math.abs(averaged.length - 16000) <= 1, `${averaged.length} frames`);
+check('Average downmix', Math.abs(averageGain - 0.5) < 0.005, `gain ${averageGain.toFixed(4)}`);
+
+const right = dsp.formatCapture(stereo, { inputRate: 48000, channels: 2, downmix: 'channel', channel: 1 });
+check('Channel select', middleRms(right) < 1e-6, `rms ${middleRms(right).toExponential(1)}`);
+
+const whole = dsp.formatCapture(stereo, { inputRate: 48000, channels: 2, packetFrames: frames });
+let identical = true;
+for (const packetFrames of [1, 7, 441, 480, 1024, 4801]) {
+    const packets = dsp.formatCapture(stereo, { inputRate: 48000, channels: 2, packetFrames });
+    identical = identical && packets.length === whole.length && packets.every((value, i) => value === whole[i]);
+}
+check('Packetized == one call', identical);
+
+const untouched = dsp.formatCapture(stereo, { inputRate: 48000, channels: 2, downmix: 'none', outputRate: 0 });
+check('No downmix keeps device stream', untouched.length === stereo.length && untouched.every((value, i) => value === stereo[i]));
+
+let rejectsResampledStereo = false;
+try {
+    dsp.formatCapture(stereo, { inputRate: 48000, channels: 2, downmix: 'none', outputRate: 16000 });
+} catch (error) {
+    rejectsResampledStereo = error instanceof RangeError;
+}
+check('Rejects resampling without downmix', rejectsResampledStereo);
+
+finish('Resampler');
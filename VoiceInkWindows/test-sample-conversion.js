@@ -0,0 +1,118 @@
+#!/usr/bin/env node
+
+/**
+ * Verifies the device sample format converters against reference conversions.
+ *
+ * Every encoding the capture path supports (int16, packed int24, int32 and
+ * float32) is converted for several channel counts and lengths, including
+ * lengths that leave a SIMD tail and buffers that start misaligned, and must
+ * match `sample / 2^(bits-1)` rounded to float32 exactly. parseWaveFormat()
+ * must recognise the WAVEFORMATEXTENSIBLE mix formats Windows reports.
+ *
+ * Platform-neutral; run after `npm run build:native`.
+ */
+
+const { check, finish, requireAddons } = require('./tests/test-utils');
+
+console.log('🔍 VoiceInk Windows - Sample Conversion Test');
+console.log('='.repeat(50));
+
+const [dsp] = requireAddons(['audiodsp']);
+
+const WAVE_FORMAT_PCM = 0x0001;
+const WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+const WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+const ENCODINGS = {
+    int16: { bytes: 2, read: (view, offset) => view.getInt16(offset, true) / 32768 },
+    int24: {
+        bytes: 3,
+        read: (view, offset) => {
+            const value = view.getUint8(offset) | (view.getUint8(offset + 1) << 8) | (view.getInt8(offset + 2) << 16);
+            return value / 8388608;
+        },
+    },
+    int32: { bytes: 4, read: (view, offset) => view.getInt32(offset, true) / 2147483648 },
+    float32: { bytes: 4, read: (view, offset) => view.getFloat32(offset, true) },
+};
+
+function randomSamples(encoding, count) {
+    const { bytes } = ENCODINGS[encoding];
+    // One spare byte in front so the samples start misaligned
+    const buffer = Buffer.alloc(count * bytes + 1);
+    const view = new DataView(buffer.buffer, buffer.byteOffset + 1, count * bytes);
+    for (let i = 0; i < count; i++) {
+        const x = Math.random() * 2 - 1;
+        switch (encoding) {
+            case 'int16': view.setInt16(i * 2, Math.round(x * 32767), true); break;
+            case 'int24': {
+                const value = Math.round(x * 8388607);
+                view.setUint8(i * 3, value & 0xff);
+                view.setUint8(i * 3 + 1, (value >> 8) & 0xff);
+                view.setInt8(i * 3 + 2, value >> 16);
+                break;
+            }
+            case 'int32': view.setInt32(i * 4, Math.round(x * 2147483647), true); break;
+            case 'float32': view.setFloat32(i * 4, x, true); break;
+        }
+    }
+    // Full-scale extremes exercise sign extension
+    if (count >= 2 && encoding === 'int16') {
+        view.setInt16(0, -32768, true);
+        view.setInt16(2, 32767, true);
+    }
+    return { bytes: buffer.subarray(1), view };
+}
+
+function checkConversion(encoding, channels, frames) {
+    const count = frames * channels;
+    const { bytes, view } = randomSamples(encoding, count);
+    const converted = dsp.convertSamples(bytes, { encoding, channels });
+    if (!(converted instanceof Float32Array) || converted.length !== count) {
+        return false;
+    }
+    for (let i = 0; i < count; i++) {
+        const expected = Math.fround(ENCODINGS[encoding].read(view, i * ENCODINGS[encoding].bytes));
+        if (converted[i] !== expected) {
+            console.log(`   ${encoding} x${channels}: sample ${i} is ${converted[i]}, expected ${expected}`);
+            return false;
+        }
+    }
+    return true;
+}
+
+console.log(`\n📦 Kernels (SIMD: ${dsp.simd}):`);
+for (const encoding of Object.keys(ENCODINGS)) {
+    let ok = true;
+    for (const channels of [1, 2, 3, 6]) {
+        for (const frames of [0, 1, 7, 33, 4801]) {
+            ok = checkConversion(encoding, channels, frames) && ok;
+        }
+    }
+    check(encoding, ok);
+}
+
+console.log(`\n📦 Wave formats:`);
+const waveCases = [
+    [{ formatTag: WAVE_FORMAT_EXTENSIBLE, channels: 2, bitsPerSample: 32, blockAlign: 8, subFormatTag: WAVE_FORMAT_IEEE_FLOAT }, 'float32'],
+    [{ formatTag: WAVE_FORMAT_EXTENSIBLE, channels: 2, bitsPerSample: 32, blockAlign: 8, subFormatTag: WAVE_FORMAT_PCM }, 'int32'],
+    [{ formatTag: WAVE_FORMAT_EXTENSIBLE, channels: 2, bitsPerSample: 24, blockAlign: 6, subFormatTag: WAVE_FORMAT_PCM }, 'int24'],
+    [{ formatTag: WAVE_FORMAT_IEEE_FLOAT, channels: 1, bitsPerSample: 32, blockAlign: 4 }, 'float32'],
+    [{ formatTag: WAVE_FORMAT_PCM, channels: 2, bitsPerSample: 16, blockAlign: 4 }, 'int16'],
+    [{ formatTag: WAVE_FORMAT_PCM, channels: 1, bitsPerSample: 8, blockAlign: 1 }, null],
+];
+for (const [wave, expected] of waveCases) {
+    const parsed = dsp.parseWaveFormat(wave);
+    const ok = expected === null ? parsed === null : parsed !== null && parsed.encoding === expected;
+    check(`tag 0x${wave.formatTag.toString(16)} ${wave.bitsPerSample}-bit`, ok, parsed ? parsed.encoding : 'unsupported');
+}
+
+let rejectsUnknown = false;
+try {
+    dsp.convertSamples(Buffer.alloc(8), { encoding: 'int8', channels: 1 });
+} catch (error) {
+    rejectsUnknown = error instanceof TypeError;
+}
+check('Rejects unknown encoding', rejectsUnknown);
+
+finish('Sample conversion');
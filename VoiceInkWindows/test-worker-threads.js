@@ -0,0 +1,204 @@
+#!/usr/bin/env node
+
+/**
+ * Stress test for loading the native addons from several worker_threads.
+ *
+ * Eight workers load audiorecorder and whisperbinding at the same time,
+ * create instances, run a transcription (when the tiny.en model is present)
+ * and tear down, twice over. While all eight hold the model, the process-wide
+ * registry must report a single loaded copy; after they exit it must be empty.
+ * A crash, hang or cross-environment mix-up fails the run.
+ *
+ * Then workers with audio and level callbacks set are terminated, idle and
+ * mid-recording; the process must survive their teardown.
+ *
+ * Run from the VoiceInkWindows directory after `npm run build:native`.
+ */
+
+const fs = require('fs');
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads');
+const { addonPath } = require('./tests/test-utils');
+
+const WORKER_COUNT = 8;
+const ROUNDS = 2;
+const SAMPLE_RATE = 16000;
+const WORKER_TIMEOUT_MS = 60000;
+
+const RECORDER_PATH = addonPath('audiorecorder');
+const WHISPER_PATH = addonPath('whisperbinding');
+
+// Runs inside each worker
+async function workerMain() {
+    const report = { index: workerData.index, recorder: null, whisper: null, modelLoaded: false, transcribed: null };
+
+    if (fs.existsSync(RECORDER_PATH)) {
+        const { WASAPIRecorder } = require(RECORDER_PATH);
+        const recorder = new WASAPIRecorder();
+        if (process.platform !== 'win32') {
+            recorder.setSource({ type: 'synthetic', signal: 'speech' });
+        }
+        report.recorder = recorder.initialize() === true && Array.isArray(recorder.enumerateDevices());
+    }
+
+    if (fs.existsSync(WHISPER_PATH)) {
+        const { WhisperTranscription } = require(WHISPER_PATH);
+        const whisper = new WhisperTranscription();
+        whisper.initialize();
+        report.whisper = whisper.getPerformanceStats().activeThreads > 0 &&
+            new Uint8Array(WhisperTranscription.encodeSyntheticResult(60, true)).length > 64;
+
+        report.modelLoaded = (await whisper.loadModel('tiny.en')) === true;
+        if (report.modelLoaded) {
+            const audio = new Float32Array(SAMPLE_RATE * 2);
+            report.transcribed = typeof (await whisper.transcribeBuffer(audio, audio.length, SAMPLE_RATE)) === 'string';
+        }
+
+        // Hold the model until every worker has loaded it
+        parentPort.postMessage({ type: 'ready', report });
+        await new Promise((resolve) => parentPort.once('message', resolve));
+        whisper.cleanup();
+    } else {
+        parentPort.postMessage({ type: 'ready', report });
+        await new Promise((resolve) => parentPort.once('message', resolve));
+    }
+
+    parentPort.postMessage({ type: 'done' });
+}
+
+// Runs inside a worker that is terminated without cleaning up
+async function terminatedWorkerMain() {
+    const { WASAPIRecorder } = require(RECORDER_PATH);
+    const recorder = new WASAPIRecorder();
+    recorder.setSource({ type: 'synthetic', signal: 'speech' });
+    recorder.initialize();
+
+    let delivered;
+    const firstBatch = new Promise((resolve) => { delivered = resolve; });
+    recorder.setAudioDataCallback(() => delivered(), { batchMs: 20 });
+    recorder.setLevelCallback(() => {}, { rateHz: 120 });
+    recorder.enableEndpointing({ hangoverMs: 100 });
+    recorder.setUtteranceCallback(() => {});
+    recorder.setDeviceChangeCallback(() => {});
+    if (workerData.recording) {
+        recorder.startRecording();
+        await firstBatch;
+    }
+    parentPort.postMessage({ type: 'ready', report: { index: workerData.index } });
+
+    // Keep the environment busy until it is torn down
+    setInterval(() => recorder.getPerformanceStats(), 5);
+}
+
+function runWorker(index, options = {}) {
+    const worker = new Worker(__filename, { workerData: { index, ...options } });
+    let report = null;
+    const ready = new Promise((resolve, reject) => {
+        worker.on('message', (message) => {
+            if (message.type === 'ready') {
+                report = message.report;
+                resolve();
+            }
+        });
+        worker.once('error', reject);
+        worker.once('exit', (code) => code !== 0 && reject(new Error(`worker ${index} exited with ${code}`)));
+    });
+    const exited = new Promise((resolve, reject) => {
+        worker.once('error', reject);
+        worker.once('exit', (code) => (code === 0 ? resolve() : reject(new Error(`worker ${index} exited with ${code}`))));
+    });
+    return { worker, ready, exited, report: () => report };
+}
+
+function withTimeout(promise, label) {
+    let timer;
+    const timeout = new Promise((_, reject) => {
+        timer = setTimeout(() => reject(new Error(`${label} timed out`)), WORKER_TIMEOUT_MS);
+    });
+    return Promise.race([promise, timeout]).finally(() => clearTimeout(timer));
+}
+
+async function runRound(round, sharedStats) {
+    const workers = Array.from({ length: WORKER_COUNT }, (_, i) => runWorker(i));
+    await withTimeout(Promise.all(workers.map((w) => w.ready)), `round ${round} startup`);
+
+    const reports = workers.map((w) => w.report());
+    const whileHeld = sharedStats ? sharedStats() : null;
+
+    workers.forEach((w) => w.worker.postMessage('release'));
+    await withTimeout(Promise.all(workers.map((w) => w.exited)), `round ${round} shutdown`);
+    const afterExit = sharedStats ? sharedStats() : null;
+
+    const recorderOk = reports.every((r) => r.recorder !== false);
+    const whisperOk = reports.every((r) => r.whisper !== false && r.transcribed !== false);
+    const modelsLoaded = reports.filter((r) => r.modelLoaded).length;
+
+    console.log(`\n📊 Round ${round}: ${WORKER_COUNT} workers`);
+    console.log(`   Recorder in every worker:   ${recorderOk ? '✅' : '❌'}`);
+    console.log(`   Whisper in every worker:    ${whisperOk ? '✅' : '❌'}`);
+
+    let sharingOk = true;
+    if (modelsLoaded > 0 && whileHeld && afterExit) {
+        sharingOk = whileHeld.loadedModels === 1 && whileHeld.modelReferences >= modelsLoaded && afterExit.loadedModels === 0;
+        console.log(`   Model copies while held:    ${whileHeld.loadedModels} (${whileHeld.modelReferences} references) ${whileHeld.loadedModels === 1 ? '✅' : '❌'}`);
+        console.log(`   Model released after exit:  ${afterExit.loadedModels === 0 ? '✅' : '❌'}`);
+    } else {
+        console.log('   ⚠️  tiny.en model not available - skipping model sharing check');
+    }
+
+    return recorderOk && whisperOk && sharingOk;
+}
+
+// worker.terminate() tears the environment down under the recorder's
+// callbacks; a use-after-free there aborts the whole process
+async function runTerminate(recording) {
+    const workers = Array.from({ length: WORKER_COUNT }, (_, i) => runWorker(i, { terminate: true, recording }));
+    await withTimeout(Promise.all(workers.map((w) => w.ready)), 'terminate startup');
+    workers.forEach((w) => w.exited.catch(() => {})); // Exit code 1 is expected here
+
+    const codes = await withTimeout(Promise.all(workers.map((w) => w.worker.terminate())), 'terminate');
+    const ok = codes.every((code) => code === 1);
+    console.log(`\n📊 Terminate ${recording ? 'while recording' : 'idle'}: ${WORKER_COUNT} workers`);
+    console.log(`   Torn down with callbacks:   ${ok ? '✅' : '❌'}`);
+    return ok;
+}
+
+async function main() {
+    console.log('🔍 VoiceInk Windows - Worker Threads Stress Test');
+    console.log('='.repeat(50));
+
+    const haveRecorder = fs.existsSync(RECORDER_PATH);
+    const haveWhisper = fs.existsSync(WHISPER_PATH);
+    if (!haveRecorder && !haveWhisper) {
+        console.log('   ⚠️  No native modules built - skipping');
+        console.log('   Run: npm run build:native');
+        return;
+    }
+
+    // The main thread loads the addon too, so it stays loaded across rounds
+    const sharedStats = haveWhisper ? require(WHISPER_PATH).WhisperTranscription.getSharedResourceStats : null;
+
+    let passed = true;
+    for (let round = 1; round <= ROUNDS; round++) {
+        passed = (await runRound(round, sharedStats)) && passed;
+    }
+    if (haveRecorder) {
+        passed = (await runTerminate(false)) && passed;
+        passed = (await runTerminate(true)) && passed;
+    }
+
+    console.log(`\n${passed ? '✅ Worker thread checks passed' : '❌ Worker thread checks failed'}`);
+    process.exitCode = passed ? 0 : 1;
+}
+
+if (isMainThread) {
+    main().catch((error) => {
+        console.error(`❌ ${error.message}`);
+        process.exitCode = 1;
+    });
+} else if (workerData.terminate) {
+    terminatedWorkerMain();
+} else {
+    workerMain().catch((error) => {
+        parentPort.postMessage({ type: 'ready', report: { index: workerData.index, recorder: false, whisper: false, error: error.message } });
+    });
+}
@@ -0,0 +1,290 @@
+// Stress test for FixedBlockPool and SpscRingBuffer::EvictOldest, the pair
+// CaptureCore hands audio blocks over with. Build with -fsanitize=thread;
+// test-native-stress.js does.
+//
+// - Several threads acquire and release blocks at once; no block may be
+//   handed to two holders and every block must come back.
+// - A capture thread fills pooled blocks and queues their indices while a
+//   reader falls behind, so the capture thread recycles queued blocks with
+//   EvictOldest() as CaptureCore does. Each sequence must end up read,
+//   recycled or sent to the scratch block exactly once.
+// - Eviction races a reader copying large elements. While the reader holds
+//   the busy bit EvictOldest() must refuse, and whatever either side gets
+//   must be intact.
+
+#include "fixed_block_pool.h"
+#include "spsc_ring_buffer.h"
+#include "stress_check.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void RunConcurrentAcquire() {
+    std::printf("\n📦 Concurrent acquire/release:\n");
+    constexpr uint32_t kBlocks = 8;
+    constexpr size_t kBlockSize = 16;
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 100000;
+
+    FixedBlockPool<uint64_t> pool(kBlocks, kBlockSize);
+    std::atomic<bool> exclusive{ true };
+    std::atomic<uint64_t> acquired{ 0 };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            StressRandom random(t + 1);
+            const uint64_t owner = t + 1;
+            for (int i = 0; i < kIterations; ++i) {
+                const uint32_t block = pool.Acquire();
+                if (block == FixedBlockPool<uint64_t>::kNoBlock) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                acquired.fetch_add(1, std::memory_order_relaxed);
+
+                // A free block holds no owner; stamp it and make sure it stays ours
+                uint64_t* data = pool.Data(block);
+                bool ok = data[0] == 0;
+                for (size_t j = 0; j < kBlockSize; ++j) {
+                    data[j] = owner;
+                }
+                if (random.Between(0, 7) == 0) {
+                    std::this_thread::yield();
+                }
+                for (size_t j = 0; j < kBlockSize; ++j) {
+                    ok = ok && data[j] == owner;
+                    data[j] = 0;
+                }
+                if (!ok) {
+                    exclusive.store(false);
+                }
+                pool.Release(block);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<bool> seen(kBlocks, false);
+    bool distinct = true;
+    for (uint32_t i = 0; i < kBlocks; ++i) {
+        const uint32_t block = pool.Acquire();
+        distinct = distinct && block < kBlocks && !seen[block];
+        if (block < kBlocks) {
+            seen[block] = true;
+        }
+    }
+    Check("One holder per block", exclusive.load(), std::to_string(acquired.load()) + " acquired");
+    Check("Every block returned", distinct && pool.FreeCount() == 0);
+    Check("Empty pool refuses", pool.Acquire() == FixedBlockPool<uint64_t>::kNoBlock);
+    pool.Release(kBlocks);
+    Check("Foreign index ignored", pool.FreeCount() == 0);
+}
+
+// CaptureCore's handoff: MAX_QUEUE_SIZE + 1 blocks, a ring of indices
+// as long as the pool, a scratch block when nothing can be taken back
+void RunCaptureHandoff() {
+    std::printf("\n📦 Capture handoff:\n");
+    constexpr uint32_t kBlocks = 9;
+    constexpr size_t kBlockSize = 64;
+    constexpr uint32_t kPackets = 200000;
+    constexpr uint32_t kNoBlock = FixedBlockPool<uint32_t>::kNoBlock;
+
+    FixedBlockPool<uint32_t> pool(kBlocks, kBlockSize);
+    SpscRingBuffer<uint32_t> filled(kBlocks, RingOverflowPolicy::DropOldest);
+    std::vector<uint32_t> scratch(kBlockSize);
+    std::vector<uint32_t> sequenceOf(kBlocks, 0);  // Side table, like m_blockInfo
+    std::atomic<bool> captureDone{ false };
+    uint64_t recycled = 0;
+    uint64_t scratched = 0;
+    bool recycledIntact = true;
+
+    std::thread capture([&]() {
+        StressRandom random(3);
+        for (uint32_t sequence = 0; sequence < kPackets; ++sequence) {
+            uint32_t block = pool.Acquire();
+            if (block == kNoBlock && filled.EvictOldest(block)) {
+                // The evicted block must still hold the packet it was queued with
+                const uint32_t* data = pool.Data(block);
+                recycledIntact = recycledIntact && data[0] == sequenceOf[block] && data[kBlockSize - 1] == sequenceOf[block];
+                recycled++;
+            }
+
+            uint32_t* data = block != kNoBlock ? pool.Data(block) : scratch.data();
+            for (size_t i = 0; i < kBlockSize; ++i) {
+                data[i] = sequence;
+            }
+            if (block == kNoBlock) {
+                scratched++;
+                continue;
+            }
+            sequenceOf[block] = sequence;
+            filled.Write(&block, 1);
+            if (random.Between(0, 15) == 0) {
+                std::this_thread::yield();
+            }
+        }
+        captureDone.store(true, std::memory_order_release);
+    });
+
+    uint64_t read = 0;
+    bool readIntact = true;
+    bool ordered = true;
+    std::thread reader([&]() {
+        StressRandom random(5);
+        int64_t last = -1;
+        for (;;) {
+            const bool done = captureDone.load(std::memory_order_acquire);
+            uint32_t block = kNoBlock;
+            if (filled.Read(&block, 1) == 0) {
+                if (done) {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            // The reader owns the block until it releases it, partial reads included
+            const uint32_t* data = pool.Data(block);
+            const uint32_t sequence = data[0];
+            for (size_t i = 0; i < kBlockSize; ++i) {
+                readIntact = readIntact && data[i] == sequence;
+            }
+            ordered = ordered && static_cast<int64_t>(sequence) > last;
+            last = sequence;
+            read++;
+            if (random.Between(0, 63) == 0) {
+                // Fall behind so every block ends up queued
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            pool.Release(block);
+        }
+    });
+
+    capture.join();
+    reader.join();
+
+    Check("Read blocks intact", readIntact && ordered, std::to_string(read) + " read");
+    Check("Recycled blocks intact", recycledIntact, std::to_string(recycled) + " recycled");
+    Check("Every packet accounted for", read + recycled + scratched == kPackets,
+          std::to_string(scratched) + " to scratch");
+    Check("Recycling happened", recycled > 0 && filled.Stats().droppedOldest == recycled);
+    Check("Every block back in the pool", pool.FreeCount() == kBlocks && filled.Available() == 0);
+}
+
+// Big enough that the reader's copy holds the busy bit for a while
+struct Payload {
+    uint64_t sequence;
+    uint64_t fill[63];
+};
+
+void RunEvictWhileReading() {
+    std::printf("\n📦 EvictOldest vs. reader:\n");
+    constexpr size_t kCapacity = 64;
+    constexpr uint64_t kPayloads = 100000;
+    constexpr uint64_t kMinRefusals = 100;
+
+    SpscRingBuffer<Payload> ring(kCapacity, RingOverflowPolicy::DropOldest);
+    std::atomic<bool> producerDone{ false };
+    std::vector<uint64_t> evicted;
+    std::vector<uint64_t> droppedNewest;
+    uint64_t refusedWhileFull = 0;
+    bool evictedIntact = true;
+    uint64_t produced = 0;
+
+    std::thread producer([&]() {
+        Payload payload;
+        // Keep going past kPayloads until the busy bit has been hit enough
+        for (uint64_t sequence = 0; sequence < kPayloads || refusedWhileFull < kMinRefusals; ++sequence) {
+            if (ring.Available() == ring.Capacity()) {
+                Payload oldest;
+                if (ring.EvictOldest(oldest)) {
+                    bool intact = true;
+                    for (uint64_t value : oldest.fill) {
+                        intact = intact && value == oldest.sequence;
+                    }
+                    evictedIntact = evictedIntact && intact;
+                    evicted.push_back(oldest.sequence);
+                } else if (ring.Available() == ring.Capacity()) {
+                    // Still full, so the reader was mid-copy
+                    refusedWhileFull++;
+                }
+            }
+
+            payload.sequence = sequence;
+            for (uint64_t& value : payload.fill) {
+                value = sequence;
+            }
+            if (ring.Write(&payload, 1) == 0) {
+                droppedNewest.push_back(sequence);
+            }
+            produced = sequence + 1;
+        }
+        producerDone.store(true, std::memory_order_release);
+    });
+
+    std::vector<uint64_t> consumed;
+    bool readIntact = true;
+    std::thread consumer([&]() {
+        std::vector<Payload> out(kCapacity);
+        for (;;) {
+            const bool done = producerDone.load(std::memory_order_acquire);
+            const size_t taken = ring.Read(out.data(), out.size());
+            for (size_t i = 0; i < taken; ++i) {
+                for (uint64_t value : out[i].fill) {
+                    readIntact = readIntact && value == out[i].sequence;
+                }
+                consumed.push_back(out[i].sequence);
+            }
+            if (taken == 0 && done) {
+                break;
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    // Each sequence lands in exactly one place; those the producer's own
+    // writes pushed out are only counted
+    std::vector<int> hits(produced, 0);
+    bool ordered = true;
+    for (const std::vector<uint64_t>* list : { &consumed, &evicted, &droppedNewest }) {
+        for (size_t i = 0; i < list->size(); ++i) {
+            ordered = ordered && (*list)[i] < produced && (i == 0 || (*list)[i] > (*list)[i - 1]);
+            if ((*list)[i] < produced) {
+                hits[(*list)[i]]++;
+            }
+        }
+    }
+    uint64_t missing = 0;
+    bool once = true;
+    for (int count : hits) {
+        missing += count == 0;
+        once = once && count <= 1;
+    }
+    const RingBufferStats stats = ring.Stats();
+
+    Check("Refused while reader copies", refusedWhileFull >= kMinRefusals, std::to_string(refusedWhileFull) + " refusals");
+    Check("Payloads intact", readIntact && evictedIntact);
+    Check("Each payload seen once", once && ordered,
+          std::to_string(consumed.size()) + "/" + std::to_string(evicted.size()) + "/" + std::to_string(droppedNewest.size()));
+    Check("Missing ones dropped oldest", missing == stats.droppedOldest - evicted.size());
+    Check("Dropped newest counted", stats.droppedNewest == droppedNewest.size());
+}
+
+}  // namespace
+
+int main() {
+    std::printf("🔍 FixedBlockPool Stress Test\n");
+    std::printf("==================================================\n");
+    RunConcurrentAcquire();
+    RunCaptureHandoff();
+    RunEvictWhileReading();
+    return Finish("FixedBlockPool stress");
+}
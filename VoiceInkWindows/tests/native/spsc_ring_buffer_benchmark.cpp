@@ -0,0 +1,110 @@
+// Single-threaded throughput of SpscRingBuffer against the CircularBuffer it
+// replaced in audio-recorder. Both move 3843-byte chunks (an odd packet size,
+// so the ring wraps mid-chunk) through a 1 MB buffer: write one, read it back.
+// Build optimized and without sanitizers; test-native-stress.js does.
+
+#include "spsc_ring_buffer.h"
+#include "stress_check.h"
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+constexpr size_t kBufferBytes = 1024 * 1024;
+constexpr size_t kChunkBytes = 3843;
+
+// audio-recorder's CircularBuffer as it was: one byte per iteration, a modulo
+// per byte, the mutex held for the whole copy
+class CircularBuffer {
+public:
+    explicit CircularBuffer(size_t size) : buffer_(size), head_(0), tail_(0), size_(size) {}
+
+    bool Write(const void* data, size_t size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (size > size_) return false;
+
+        const uint8_t* src = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            buffer_[head_] = src[i];
+            head_ = (head_ + 1) % size_;
+            if (head_ == tail_) {
+                tail_ = (tail_ + 1) % size_;
+            }
+        }
+        return true;
+    }
+
+    size_t Read(void* data, size_t size) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint8_t* dst = static_cast<uint8_t*>(data);
+        size_t bytesRead = 0;
+        while (bytesRead < size && tail_ != head_) {
+            dst[bytesRead] = buffer_[tail_];
+            tail_ = (tail_ + 1) % size_;
+            bytesRead++;
+        }
+        return bytesRead;
+    }
+
+private:
+    std::vector<uint8_t> buffer_;
+    size_t head_;
+    size_t tail_;
+    size_t size_;
+    std::mutex mutex_;
+};
+
+// Moves chunks through `buffer` for about `seconds`; returns bytes per second
+template <typename Buffer>
+double Throughput(Buffer& buffer, double seconds, uint64_t& checksum) {
+    std::vector<uint8_t> in(kChunkBytes);
+    std::vector<uint8_t> out(kChunkBytes);
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    uint64_t bytes = 0;
+    double elapsed = 0.0;
+    do {
+        for (int i = 0; i < 64; ++i) {
+            buffer.Write(in.data(), in.size());
+            bytes += buffer.Read(out.data(), out.size());
+            checksum += out[i];
+        }
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < seconds);
+    return bytes / elapsed;
+}
+
+std::string Rate(double bytesPerSecond) {
+    char text[32];
+    if (bytesPerSecond >= 1e9) {
+        std::snprintf(text, sizeof(text), "%.1f GB/s", bytesPerSecond / 1e9);
+    } else {
+        std::snprintf(text, sizeof(text), "%.0f MB/s", bytesPerSecond / 1e6);
+    }
+    return text;
+}
+
+}  // namespace
+
+int main() {
+    std::printf("🔍 SpscRingBuffer Benchmark\n");
+    std::printf("==================================================\n");
+    std::printf("\n📊 %zu-byte chunks through a %zu KB buffer:\n", kChunkBytes, kBufferBytes / 1024);
+
+    uint64_t checksum = 0;
+    CircularBuffer circular(kBufferBytes);
+    const double before = Throughput(circular, 0.5, checksum);
+    SpscRingBuffer<uint8_t> ring(kBufferBytes, RingOverflowPolicy::DropOldest);
+    const double after = Throughput(ring, 0.5, checksum);
+
+    Check("CircularBuffer (before)", true, Rate(before));
+    Check("SpscRingBuffer", after > before, Rate(after));
+    std::printf("   Speed-up: %.0fx (checksum %llu)\n", after / before, static_cast<unsigned long long>(checksum));
+    return Finish("SpscRingBuffer benchmark");
+}
@@ -0,0 +1,146 @@
+// Producer/consumer stress test for SpscRingBuffer, one run per overflow
+// policy. Build with -fsanitize=thread; test-native-stress.js does.
+//
+// The producer writes two-element frames {sequence, ~sequence} in random
+// chunks while the consumer reads random whole-frame counts. Every frame the
+// consumer sees must be intact and newer than the last one; under Block none
+// may be missing. Once drained, the counters must account for every frame.
+
+#include "spsc_ring_buffer.h"
+#include "stress_check.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kFrameSize = 2;
+constexpr size_t kCapacity = 1024;
+constexpr uint32_t kFrames = 400000;
+constexpr uint32_t kMaxChunkFrames = 96;
+
+const char* PolicyName(RingOverflowPolicy policy) {
+    switch (policy) {
+    case RingOverflowPolicy::DropOldest: return "DropOldest";
+    case RingOverflowPolicy::DropNewest: return "DropNewest";
+    default: return "Block";
+    }
+}
+
+struct ConsumerResult {
+    uint64_t elements = 0;
+    uint64_t frames = 0;
+    bool intact = true;
+    bool ordered = true;
+    bool gapless = true;
+};
+
+void RunPolicy(RingOverflowPolicy policy) {
+    std::printf("\n📦 %s:\n", PolicyName(policy));
+    SpscRingBuffer<uint32_t> ring(kCapacity, policy, kFrameSize);
+    std::atomic<bool> producerDone{ false };
+    uint64_t produced = 0;
+    uint64_t stored = 0;
+
+    std::thread producer([&]() {
+        StressRandom random(7);
+        std::vector<uint32_t> chunk(kMaxChunkFrames * kFrameSize);
+        for (uint32_t next = 0; next < kFrames;) {
+            const uint32_t frames = (std::min)(random.Between(1, kMaxChunkFrames), kFrames - next);
+            for (uint32_t i = 0; i < frames; ++i) {
+                chunk[i * kFrameSize] = next + i;
+                chunk[i * kFrameSize + 1] = ~(next + i);
+            }
+            stored += ring.Write(chunk.data(), frames * kFrameSize);
+            produced += frames * kFrameSize;
+            next += frames;
+            if (random.Between(0, 63) == 0) {
+                std::this_thread::yield();
+            }
+        }
+        producerDone.store(true, std::memory_order_release);
+    });
+
+    ConsumerResult result;
+    std::thread consumer([&]() {
+        StressRandom random(11);
+        std::vector<uint32_t> out(kCapacity);
+        int64_t last = -1;
+        for (;;) {
+            // Sampled before reading, so an empty read after it means drained
+            const bool done = producerDone.load(std::memory_order_acquire);
+            const size_t taken = ring.Read(out.data(), random.Between(1, kCapacity / kFrameSize) * kFrameSize);
+            result.intact = result.intact && taken % kFrameSize == 0;
+            for (size_t i = 0; i + 1 < taken; i += kFrameSize) {
+                const uint32_t sequence = out[i];
+                result.intact = result.intact && out[i + 1] == ~sequence;
+                result.ordered = result.ordered && static_cast<int64_t>(sequence) > last;
+                result.gapless = result.gapless && static_cast<int64_t>(sequence) == last + 1;
+                last = sequence;
+            }
+            result.elements += taken;
+            result.frames += taken / kFrameSize;
+            if (taken == 0) {
+                if (done) {
+                    break;
+                }
+                // Let the producer get ahead so the ring fills up
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    const RingBufferStats stats = ring.Stats();
+    const std::string seen = std::to_string(result.frames) + "/" + std::to_string(kFrames);
+    Check("Frames intact", result.intact);
+    Check("Frames in order", result.ordered, seen);
+    if (policy == RingOverflowPolicy::Block) {
+        Check("Nothing lost", result.gapless && result.frames == kFrames && stats.droppedNewest == 0,
+              std::to_string(stats.blockedWrites) + " waits");
+    } else {
+        Check("Full ring dropped frames", result.frames < kFrames);
+    }
+    Check("Drained", ring.Available() == 0 && stats.read == result.elements);
+    Check("Written = stored", stats.written == stored);
+    Check("Written + dropped newest = sent", stats.written + stats.droppedNewest == produced);
+    Check("Read + dropped oldest = written", stats.read + stats.droppedOldest == stats.written);
+    if (policy != RingOverflowPolicy::DropOldest) {
+        Check("No oldest dropped", stats.droppedOldest == 0);
+    }
+}
+
+// A producer waiting on a full Block ring must return once it is closed
+void RunClose() {
+    std::printf("\n📦 Close():\n");
+    SpscRingBuffer<uint32_t> ring(64, RingOverflowPolicy::Block);
+    std::vector<uint32_t> data(256, 1);
+    std::atomic<size_t> stored{ SIZE_MAX };
+
+    std::thread producer([&]() { stored.store(ring.Write(data.data(), data.size())); });
+    while (ring.Stats().blockedWrites == 0) {
+        std::this_thread::yield();
+    }
+    ring.Close();
+    producer.join();
+
+    const RingBufferStats stats = ring.Stats();
+    Check("Blocked write returns", stored.load() == ring.Capacity(), std::to_string(stored.load()) + " stored");
+    Check("Rest counted as dropped", stats.droppedNewest == data.size() - ring.Capacity());
+    Check("Later writes dropped", ring.Write(data.data(), 1) == 0 && ring.Stats().droppedNewest == stats.droppedNewest + 1);
+}
+
+}  // namespace
+
+int main() {
+    std::printf("🔍 SpscRingBuffer Stress Test\n");
+    std::printf("==================================================\n");
+    RunPolicy(RingOverflowPolicy::DropOldest);
+    RunPolicy(RingOverflowPolicy::DropNewest);
+    RunPolicy(RingOverflowPolicy::Block);
+    RunClose();
+    return Finish("SpscRingBuffer stress");
+}
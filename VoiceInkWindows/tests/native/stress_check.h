@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Result lines for the native stress tests, in the format of check() in
+// tests/test-utils.js so test-native-stress.js can pass them through.
+
+inline bool& StressPassed() {
+    static bool passed = true;
+    return passed;
+}
+
+inline void Check(const char* label, bool ok, const std::string& detail = "") {
+    std::printf("   %-34s %-18s %s\n", label, detail.c_str(), ok ? "✅" : "❌");
+    StressPassed() = StressPassed() && ok;
+}
+
+// Prints the summary line; returns the exit code
+inline int Finish(const char* subject) {
+    const bool passed = StressPassed();
+    std::printf("\n%s %s checks %s\n", passed ? "✅" : "❌", subject, passed ? "passed" : "failed");
+    return passed ? 0 : 1;
+}
+
+// Deterministic xorshift generator, one per thread
+class StressRandom {
+public:
+    explicit StressRandom(uint32_t seed) : m_state(seed ? seed : 1) {}
+
+    // Uniform in [low, high]
+    uint32_t Between(uint32_t low, uint32_t high) {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return low + m_state % (high - low + 1);
+    }
+
+private:
+    uint32_t m_state;
+};
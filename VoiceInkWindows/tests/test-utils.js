@@ -0,0 +1,86 @@
+/**
+ * Helpers shared by the test-*.js scripts in the project root.
+ *
+ * Each script runs in its own process, so the pass/fail state kept here is
+ * per script: report with check(), end with finish().
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+const RELEASE_DIR = path.join(__dirname, '..', 'build', 'Release');
+
+let passed = true;
+
+// One aligned result line; any failure fails the script
+function check(label, ok, detail = '') {
+    console.log(`   ${label.padEnd(34)} ${detail.padEnd(18)} ${ok ? '✅' : '❌'}`);
+    passed = passed && ok;
+}
+
+function allPassed() {
+    return passed;
+}
+
+// Prints the summary line and sets the exit code
+function finish(subject) {
+    console.log(`\n${passed ? `✅ ${subject} checks passed` : `❌ ${subject} checks failed`}`);
+    process.exitCode = passed ? 0 : 1;
+}
+
+function addonPath(name) {
+    return path.join(RELEASE_DIR, `${name}.node`);
+}
+
+// Loads build/Release/<name>.node for every name, or exits successfully
+// with a note when any of them has not been built
+function requireAddons(names, buildHint = 'npm run build:native') {
+    const missing = names.filter((name) => !fs.existsSync(addonPath(name)));
+    if (missing.length > 0) {
+        console.log(`   ⚠️  ${names.join('/')} module${names.length > 1 ? 's' : ''} not built - skipping`);
+        console.log(`   Run: ${buildHint}`);
+        process.exit(0);
+    }
+    return names.map((name) => require(addonPath(name)));
+}
+
+// For scripts that test several modules and skip only the missing ones
+function loadAddon(modulePath) {
+    if (!fs.existsSync(modulePath)) {
+        console.log(`   ⚠️  Not built: ${modulePath}`);
+        return null;
+    }
+    return require(modulePath);
+}
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+const toDb = (ratio) => 20 * Math.log10(Math.max(ratio, 1e-12));
+
+function rms(samples, start = 0, end = samples.length) {
+    let sum = 0;
+    for (let i = start; i < end; i++) {
+        sum += samples[i] * samples[i];
+    }
+    return Math.sqrt(sum / Math.max(end - start, 1));
+}
+
+// Deterministic uniform noise in [-1, 1), one generator per seed
+function makeNoise(seed) {
+    return () => {
+        seed = (seed * 1103515245 + 12345) >>> 0;
+        return seed / 2147483648 - 1;
+    };
+}
+
+module.exports = {
+    check,
+    allPassed,
+    finish,
+    addonPath,
+    requireAddons,
+    loadAddon,
+    sleep,
+    toDb,
+    rms,
+    makeNoise
+};